@@ -0,0 +1,875 @@
+#pragma once
+
+// Minimal microbenchmark harness with a Google Benchmark style interface
+//
+// Benchmarks are functions taking a bench::State and timing the body of a
+// `for (auto _ : state)` loop. The runner picks an iteration count so each
+// run lasts at least --benchmark_min_time, repeats it --benchmark_repetitions
+// times and prints a console table or Google Benchmark compatible JSON, so
+// existing tools (compare.py, CI dashboards) can read the results.
+//
+// Command line (same names as Google Benchmark):
+//   --benchmark_filter=<regex>      Only run benchmarks whose name matches
+//   --benchmark_min_time=<s>        Minimum time per run (default: 0.5)
+//   --benchmark_repetitions=<n>     Runs per benchmark; n > 1 adds mean/median/stddev rows
+//   --benchmark_format=<console|json>
+//   --benchmark_out=<file>          Also write JSON results to a file
+//   --benchmark_list_tests          Print the benchmark names and exit
+//   --benchmark_min_warmup_time=<s> Run each benchmark this long untimed first (default: 0)
+//
+// Regression check against a stored run (see PerfCheck below):
+//   --perf_check=<baseline.json>    Run the benchmarks named in the baseline, compare them
+//                                   and exit with status 1 if any got slower
+//   --perf_threshold=<fraction>     Slowdown tolerated before failing (default: 0.10)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BENCHMARK_UNUSED __attribute__((unused))
+#else
+#define BENCHMARK_UNUSED
+#endif
+
+namespace bench
+{
+
+// Keep the compiler from optimizing away a value or the code computing it
+template <typename T>
+inline void DoNotOptimize(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+// Force pending writes to memory before the next iteration
+inline void ClobberMemory()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+class State
+{
+public:
+    State(uint64_t iterations, const std::vector<int64_t> &args)
+        : max_iterations(iterations), args(args), items_processed(0), cpu_seconds(0.0), real_seconds(0.0)
+    {
+    }
+
+    // Iterating a State runs the timed loop; timing starts at begin() and
+    // stops when the loop finishes
+    struct BENCHMARK_UNUSED Value
+    {
+    };
+
+    struct Iterator
+    {
+        State *state;
+        uint64_t remaining;
+
+        bool operator!=(const Iterator &) const
+        {
+            if (remaining != 0)
+                return true;
+            state->stopTimer();
+            return false;
+        }
+        void operator++() { remaining--; }
+        Value operator*() const { return Value(); }
+    };
+
+    Iterator begin()
+    {
+        startTimer();
+        return Iterator{this, max_iterations};
+    }
+    Iterator end() { return Iterator{this, 0}; }
+
+    // Benchmark argument (from Benchmark::Arg)
+    int64_t range(size_t i = 0) const { return i < args.size() ? args[i] : 0; }
+
+    uint64_t iterations() const { return max_iterations; }
+
+    // Reported as items_per_second
+    void SetItemsProcessed(int64_t items) { items_processed = items; }
+
+    void PauseTiming() { stopTimer(); }
+    void ResumeTiming() { startTimer(); }
+
+private:
+    friend class Runner;
+
+    uint64_t max_iterations;
+    std::vector<int64_t> args;
+    int64_t items_processed;
+    double cpu_seconds;
+    double real_seconds;
+    std::chrono::steady_clock::time_point real_start;
+    std::clock_t cpu_start = 0;
+
+    void startTimer()
+    {
+        real_start = std::chrono::steady_clock::now();
+        cpu_start = std::clock();
+    }
+
+    void stopTimer()
+    {
+        real_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - real_start).count();
+        cpu_seconds += static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    }
+};
+
+using Function = std::function<void(State &)>;
+
+// A registered benchmark; Arg() adds one instance per argument
+class Benchmark
+{
+public:
+    Benchmark(std::string name, Function fn) : name(std::move(name)), fn(std::move(fn)) {}
+
+    Benchmark *Arg(int64_t value)
+    {
+        args.push_back(value);
+        return this;
+    }
+
+    const std::string &getName() const { return name; }
+
+private:
+    friend class Runner;
+
+    std::string name;
+    Function fn;
+    std::vector<int64_t> args;
+};
+
+inline std::vector<Benchmark *> &registry()
+{
+    static std::vector<Benchmark *> benchmarks;
+    return benchmarks;
+}
+
+// Register a benchmark at runtime (for benchmarks generated from data, e.g. one per config file)
+inline Benchmark *RegisterBenchmark(const std::string &name, Function fn)
+{
+    registry().push_back(new Benchmark(name, std::move(fn)));
+    return registry().back();
+}
+
+// One row of results
+struct Run
+{
+    std::string name;     // Reported name, e.g. BM_Foo/64 or BM_Foo/64_median
+    std::string run_name; // Name without the aggregate suffix
+    bool aggregate = false;
+    std::string aggregate_name;
+    int repetitions = 1;
+    int repetition_index = 0;
+    uint64_t iterations = 0;
+    double real_ns = 0.0; // Per iteration
+    double cpu_ns = 0.0;
+    double items_per_second = 0.0; // 0 if not reported
+};
+
+struct Options
+{
+    std::string filter = ".";
+    double min_time = 0.5;
+    int repetitions = 1;
+    double warmup_time = 0.0;
+    bool json = false;
+    bool quiet = false; // No console rows (perf check prints its own table)
+    std::string out_path;
+    bool list = false;
+    std::vector<std::string> names; // Run only these (empty = all matching the filter)
+
+    std::string perf_baseline; // Empty = plain benchmark run
+    double perf_threshold = 0.10;
+};
+
+class Runner
+{
+public:
+    explicit Runner(const Options &options) : options(options) {}
+
+    std::vector<Run> runAll()
+    {
+        std::regex filter(options.filter);
+        std::vector<Run> runs;
+        for (Benchmark *b : registry())
+        {
+            std::vector<std::vector<int64_t>> instances;
+            if (b->args.empty())
+                instances.push_back({});
+            for (int64_t a : b->args)
+                instances.push_back({a});
+
+            for (const std::vector<int64_t> &args : instances)
+            {
+                std::string name = b->name;
+                for (int64_t a : args)
+                    name += "/" + std::to_string(a);
+                if (!std::regex_search(name, filter))
+                    continue;
+                if (!options.names.empty() &&
+                    std::find(options.names.begin(), options.names.end(), name) == options.names.end())
+                    continue;
+                if (options.list)
+                {
+                    std::cout << name << "\n";
+                    continue;
+                }
+
+                // Untimed run first: caches, branch predictors and clock frequency settle
+                if (options.warmup_time > 0.0)
+                    runOne(*b, args, options.warmup_time);
+                if (options.quiet)
+                    std::cerr << name << "\n";
+
+                std::vector<Run> reps;
+                for (int r = 0; r < options.repetitions; r++)
+                {
+                    Run run = runOne(*b, args, options.min_time);
+                    run.name = run.run_name = name;
+                    run.repetitions = options.repetitions;
+                    run.repetition_index = r;
+                    reps.push_back(run);
+                    if (!options.json && !options.quiet)
+                        printConsoleRow(run);
+                }
+                runs.insert(runs.end(), reps.begin(), reps.end());
+                if (reps.size() > 1)
+                {
+                    for (const Run &agg : aggregates(reps))
+                    {
+                        runs.push_back(agg);
+                        if (!options.json && !options.quiet)
+                            printConsoleRow(agg);
+                    }
+                }
+            }
+        }
+        return runs;
+    }
+
+    static void writeJSON(std::ostream &out, const std::vector<Run> &runs)
+    {
+        char date[64];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        out << "{\n  \"context\": {\n";
+        out << "    \"date\": \"" << date << "\",\n";
+        out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+        out << "    \"library_build_type\": \"release\"\n";
+#else
+        out << "    \"library_build_type\": \"debug\"\n";
+#endif
+        out << "  },\n  \"benchmarks\": [";
+
+        char buf[256];
+        for (size_t i = 0; i < runs.size(); i++)
+        {
+            const Run &r = runs[i];
+            out << (i == 0 ? "\n" : ",\n") << "    {\n";
+            out << "      \"name\": \"" << r.name << "\",\n";
+            out << "      \"run_name\": \"" << r.run_name << "\",\n";
+            out << "      \"run_type\": \"" << (r.aggregate ? "aggregate" : "iteration") << "\",\n";
+            out << "      \"repetitions\": " << r.repetitions << ",\n";
+            if (r.aggregate)
+                out << "      \"aggregate_name\": \"" << r.aggregate_name << "\",\n";
+            else
+                out << "      \"repetition_index\": " << r.repetition_index << ",\n";
+            out << "      \"iterations\": " << r.iterations << ",\n";
+            std::snprintf(buf, sizeof(buf), "      \"real_time\": %.6e,\n      \"cpu_time\": %.6e,\n", r.real_ns,
+                          r.cpu_ns);
+            out << buf;
+            if (r.items_per_second > 0.0)
+            {
+                std::snprintf(buf, sizeof(buf), "      \"items_per_second\": %.6e,\n", r.items_per_second);
+                out << buf;
+            }
+            out << "      \"time_unit\": \"ns\"\n    }";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+private:
+    Options options;
+
+    // Grow the iteration count until a run lasts min_time, like Google Benchmark
+    static Run runOne(Benchmark &b, const std::vector<int64_t> &args, double min_time)
+    {
+        uint64_t iterations = 1;
+        for (;;)
+        {
+            State state(iterations, args);
+            b.fn(state);
+
+            bool done = state.real_seconds >= min_time || iterations >= 1000000000ull;
+            if (done)
+            {
+                Run run;
+                run.iterations = iterations;
+                run.real_ns = state.real_seconds * 1e9 / static_cast<double>(iterations);
+                run.cpu_ns = state.cpu_seconds * 1e9 / static_cast<double>(iterations);
+                if (state.items_processed > 0 && state.real_seconds > 0.0)
+                    run.items_per_second = static_cast<double>(state.items_processed) / state.real_seconds;
+                return run;
+            }
+
+            // Aim 40% past min_time, but never grow more than 10x per try
+            double multiplier = state.real_seconds > 0.0 ? min_time * 1.4 / state.real_seconds : 10.0;
+            multiplier = std::min(10.0, std::max(multiplier, 1.0));
+            uint64_t next = static_cast<uint64_t>(static_cast<double>(iterations) * multiplier + 0.5);
+            iterations = std::max(iterations + 1, next);
+        }
+    }
+
+    static std::vector<Run> aggregates(const std::vector<Run> &reps)
+    {
+        auto stat = [&](const char *name, auto reduce)
+        {
+            Run r = reps.front();
+            r.aggregate = true;
+            r.aggregate_name = name;
+            r.name = r.run_name + "_" + name;
+            r.real_ns = reduce([](const Run &x) { return x.real_ns; });
+            r.cpu_ns = reduce([](const Run &x) { return x.cpu_ns; });
+            r.items_per_second = reduce([](const Run &x) { return x.items_per_second; });
+            return r;
+        };
+
+        auto mean = [&](auto field)
+        {
+            double sum = 0.0;
+            for (const Run &r : reps)
+                sum += field(r);
+            return sum / static_cast<double>(reps.size());
+        };
+        auto median = [&](auto field)
+        {
+            std::vector<double> v;
+            for (const Run &r : reps)
+                v.push_back(field(r));
+            std::sort(v.begin(), v.end());
+            size_t n = v.size();
+            return n % 2 ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+        };
+        auto stddev = [&](auto field)
+        {
+            double m = mean(field), sum = 0.0;
+            for (const Run &r : reps)
+                sum += (field(r) - m) * (field(r) - m);
+            return std::sqrt(sum / static_cast<double>(reps.size() - 1));
+        };
+
+        return {stat("mean", mean), stat("median", median), stat("stddev", stddev)};
+    }
+
+    static void printConsoleRow(const Run &r)
+    {
+        char line[256];
+        if (r.items_per_second > 0.0)
+            std::snprintf(line, sizeof(line), "%-44s %13.1f ns %13.1f ns %12llu %11.4g items/s\n", r.name.c_str(),
+                          r.real_ns, r.cpu_ns, static_cast<unsigned long long>(r.iterations), r.items_per_second);
+        else
+            std::snprintf(line, sizeof(line), "%-44s %13.1f ns %13.1f ns %12llu\n", r.name.c_str(), r.real_ns,
+                          r.cpu_ns, static_cast<unsigned long long>(r.iterations));
+        std::cout << line;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// PerfCheck: regression gate against a stored run
+//
+// The baseline is a JSON file this harness wrote (--benchmark_out) with
+// several repetitions per benchmark. Its repetition rows are one sample set
+// and the current run's are another; a benchmark's change is the ratio of
+// the two medians, with a 95% confidence interval from a bootstrap (both
+// sample sets resampled, fixed seed, so a rerun on the same numbers gives the
+// same verdict). A benchmark regressed when even the low end of the interval
+// is slower than the threshold, so noise alone does not fail the check, and
+// a run too noisy to tell is reported but passes. Times are per iteration:
+// for throughput benchmarks (items_per_second) slower means fewer items.
+
+// Machine a baseline was recorded on (from its "context" block)
+struct BaselineMachine
+{
+    int num_cpus = 0;       // 0 = not recorded
+    std::string build_type; // "release" or "debug" (empty = not recorded)
+};
+
+// Repetition times (ns per iteration) by benchmark name. Baselines holding
+// only aggregates contribute their median as a single sample.
+inline std::map<std::string, std::vector<double>> readBaseline(const std::string &path,
+                                                                BaselineMachine *machine = nullptr)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("Failed to open perf baseline: " + path);
+    const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    // Just enough JSON for the file writeJSON produces (any JSON parses; only
+    // objects with a "name" and a "real_time" are kept)
+    size_t p = 0;
+    auto fail = [&](const char *what)
+    { throw std::runtime_error(path + ": " + what + " at offset " + std::to_string(p)); };
+    auto skipSpace = [&]
+    {
+        while (p < text.size() && std::strchr(" \t\r\n", text[p]) != nullptr)
+            p++;
+    };
+    auto readString = [&]
+    {
+        std::string out;
+        p++; // Opening quote
+        while (p < text.size() && text[p] != '"')
+        {
+            if (text[p] == '\\' && p + 1 < text.size())
+                p++; // Names carry no escapes beyond \" and \\ in practice
+            out += text[p++];
+        }
+        if (p >= text.size())
+            fail("unterminated string");
+        p++;
+        return out;
+    };
+
+    struct Row
+    {
+        std::string name, run_type, aggregate_name;
+        double real_time = -1.0;
+    };
+    std::vector<Row> rows;
+    std::function<void()> readValue = [&]
+    {
+        skipSpace();
+        if (p >= text.size())
+            fail("unexpected end");
+        char c = text[p];
+        if (c == '{')
+        {
+            Row object;
+            p++;
+            skipSpace();
+            if (p < text.size() && text[p] == '}')
+            {
+                p++;
+                return;
+            }
+            for (;;)
+            {
+                skipSpace();
+                if (p >= text.size() || text[p] != '"')
+                    fail("expected a key");
+                std::string key = readString();
+                skipSpace();
+                if (p >= text.size() || text[p++] != ':')
+                    fail("expected ':'");
+                skipSpace();
+                if (p < text.size() && text[p] == '"' && (key == "name" || key == "run_type" || key == "aggregate_name"))
+                {
+                    std::string value = readString();
+                    (key == "name" ? object.name : key == "run_type" ? object.run_type : object.aggregate_name) = value;
+                }
+                else if (p < text.size() && text[p] == '"' && key == "library_build_type")
+                {
+                    std::string value = readString();
+                    if (machine)
+                        machine->build_type = value;
+                }
+                else if (key == "real_time" || key == "num_cpus")
+                {
+                    char *end = nullptr;
+                    double value = std::strtod(text.c_str() + p, &end);
+                    if (end == text.c_str() + p)
+                        fail("expected a number");
+                    p = static_cast<size_t>(end - text.c_str());
+                    if (key == "real_time")
+                        object.real_time = value;
+                    else if (machine)
+                        machine->num_cpus = static_cast<int>(value);
+                }
+                else
+                {
+                    readValue();
+                }
+                skipSpace();
+                if (p < text.size() && text[p] == ',')
+                {
+                    p++;
+                    continue;
+                }
+                if (p >= text.size() || text[p++] != '}')
+                    fail("expected ',' or '}'");
+                break;
+            }
+            if (!object.name.empty() && object.real_time >= 0.0)
+                rows.push_back(object);
+        }
+        else if (c == '[')
+        {
+            p++;
+            skipSpace();
+            if (p < text.size() && text[p] == ']')
+            {
+                p++;
+                return;
+            }
+            for (;;)
+            {
+                readValue();
+                skipSpace();
+                if (p < text.size() && text[p] == ',')
+                {
+                    p++;
+                    continue;
+                }
+                if (p >= text.size() || text[p++] != ']')
+                    fail("expected ',' or ']'");
+                break;
+            }
+        }
+        else if (c == '"')
+        {
+            readString();
+        }
+        else
+        {
+            // Number, true, false or null
+            size_t start = p;
+            while (p < text.size() && std::strchr(",]} \t\r\n", text[p]) == nullptr)
+                p++;
+            if (p == start)
+                fail("expected a value");
+        }
+    };
+    readValue();
+
+    std::map<std::string, std::vector<double>> samples, medians;
+    for (const Row &r : rows)
+    {
+        if (r.run_type == "aggregate")
+        {
+            if (r.aggregate_name == "median")
+                medians[r.name.substr(0, r.name.size() - std::strlen("_median"))].push_back(r.real_time);
+        }
+        else
+        {
+            samples[r.name].push_back(r.real_time);
+        }
+    }
+    for (auto &entry : medians)
+    {
+        if (samples.find(entry.first) == samples.end())
+            samples[entry.first] = entry.second;
+    }
+    if (samples.empty())
+        throw std::runtime_error("No benchmark results in perf baseline: " + path);
+    return samples;
+}
+
+inline double medianOf(std::vector<double> v)
+{
+    std::sort(v.begin(), v.end());
+    size_t n = v.size();
+    return n == 0 ? 0.0 : n % 2 ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+struct PerfComparison
+{
+    enum class Verdict
+    {
+        Same,     // Within the threshold, or too noisy to tell
+        Faster,   // Confidently faster by more than the threshold
+        Slower,   // Confidently slower by more than the threshold: fails the check
+        New,      // Not in the baseline
+        Missing   // In the baseline but not run: fails the check (rename? update the baseline)
+    };
+
+    std::string name;
+    double baseline_ns = 0.0; // Medians per iteration
+    double current_ns = 0.0;
+    double change = 0.0; // current / baseline - 1 (positive = slower)
+    double ci_low = 0.0; // 95% interval of change
+    double ci_high = 0.0;
+    Verdict verdict = Verdict::Same;
+};
+
+// Compare two sample sets of one benchmark (see PerfCheck above)
+inline PerfComparison comparePerf(const std::string &name, const std::vector<double> &baseline,
+                                  const std::vector<double> &current, double threshold)
+{
+    PerfComparison c;
+    c.name = name;
+    if (baseline.empty() || current.empty())
+    {
+        c.verdict = baseline.empty() ? PerfComparison::Verdict::New : PerfComparison::Verdict::Missing;
+        c.baseline_ns = medianOf(baseline);
+        c.current_ns = medianOf(current);
+        return c;
+    }
+    c.baseline_ns = medianOf(baseline);
+    c.current_ns = medianOf(current);
+    c.change = c.current_ns / c.baseline_ns - 1.0;
+
+    // Bootstrap the ratio of medians (splitmix64, fixed seed)
+    const int resamples = 2000;
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    auto next = [&seed](size_t n)
+    {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return static_cast<size_t>((z ^ (z >> 31)) % n);
+    };
+    std::vector<double> ratios(resamples), a(baseline.size()), b(current.size());
+    for (int r = 0; r < resamples; r++)
+    {
+        for (double &x : a)
+            x = baseline[next(baseline.size())];
+        for (double &x : b)
+            x = current[next(current.size())];
+        ratios[r] = medianOf(b) / medianOf(a) - 1.0;
+    }
+    std::sort(ratios.begin(), ratios.end());
+    c.ci_low = ratios[resamples * 25 / 1000];
+    c.ci_high = ratios[resamples * 975 / 1000 - 1];
+
+    if (c.ci_low > threshold)
+        c.verdict = PerfComparison::Verdict::Slower;
+    else if (c.ci_high < -threshold)
+        c.verdict = PerfComparison::Verdict::Faster;
+    return c;
+}
+
+// Per-benchmark diff table; returns the number of failures (slower or missing)
+inline int printPerfTable(std::ostream &out, const std::vector<PerfComparison> &rows, double threshold)
+{
+    auto time = [](double ns)
+    {
+        char buf[32];
+        if (ns <= 0.0)
+            std::snprintf(buf, sizeof(buf), "-");
+        else if (ns < 1e4)
+            std::snprintf(buf, sizeof(buf), "%.1f ns", ns);
+        else if (ns < 1e7)
+            std::snprintf(buf, sizeof(buf), "%.1f us", ns * 1e-3);
+        else
+            std::snprintf(buf, sizeof(buf), "%.1f ms", ns * 1e-6);
+        return std::string(buf);
+    };
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-44s %12s %12s %9s  %-19s %s\n", "Benchmark", "Baseline", "Current", "Change",
+                  "95% CI", "Verdict");
+    out << line << std::string(110, '-') << "\n";
+    int failures = 0;
+    for (const PerfComparison &c : rows)
+    {
+        const char *verdict = "ok";
+        switch (c.verdict)
+        {
+        case PerfComparison::Verdict::Faster: verdict = "faster"; break;
+        case PerfComparison::Verdict::Slower: verdict = "SLOWER"; break;
+        case PerfComparison::Verdict::New: verdict = "new (no baseline)"; break;
+        case PerfComparison::Verdict::Missing: verdict = "MISSING (not run)"; break;
+        default: break;
+        }
+        bool compared = c.verdict != PerfComparison::Verdict::New && c.verdict != PerfComparison::Verdict::Missing;
+        char change[16] = "", ci[32] = "";
+        if (compared)
+        {
+            std::snprintf(change, sizeof(change), "%+.1f%%", c.change * 100.0);
+            std::snprintf(ci, sizeof(ci), "[%+.1f%%, %+.1f%%]", c.ci_low * 100.0, c.ci_high * 100.0);
+        }
+        std::snprintf(line, sizeof(line), "%-44s %12s %12s %9s  %-19s %s\n", c.name.c_str(), time(c.baseline_ns).c_str(),
+                      time(c.current_ns).c_str(), change, ci, verdict);
+        out << line;
+        if (c.verdict == PerfComparison::Verdict::Slower || c.verdict == PerfComparison::Verdict::Missing)
+            failures++;
+    }
+    std::snprintf(line, sizeof(line), "%d of %zu benchmarks failed (threshold %.0f%% slower at 95%% confidence)\n",
+                  failures, rows.size(), threshold * 100.0);
+    out << line;
+    return failures;
+}
+
+inline Options parseOptions(int argc, char **argv)
+{
+    Options opts;
+    bool min_time_given = false, repetitions_given = false, warmup_given = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        auto value = [&](const char *flag, std::string &out)
+        {
+            std::string prefix = std::string(flag) + "=";
+            if (arg.compare(0, prefix.size(), prefix) != 0)
+                return false;
+            out = arg.substr(prefix.size());
+            return true;
+        };
+
+        std::string v;
+        if (value("--benchmark_filter", v))
+            opts.filter = v;
+        else if (value("--benchmark_min_time", v))
+        {
+            opts.min_time = std::stod(v); // Google Benchmark also accepts a trailing 's'
+            min_time_given = true;
+        }
+        else if (value("--benchmark_repetitions", v))
+        {
+            opts.repetitions = std::max(1, std::stoi(v));
+            repetitions_given = true;
+        }
+        else if (value("--benchmark_min_warmup_time", v))
+        {
+            opts.warmup_time = std::stod(v);
+            warmup_given = true;
+        }
+        else if (value("--perf_check", v))
+            opts.perf_baseline = v;
+        else if (value("--perf_threshold", v))
+            opts.perf_threshold = std::stod(v);
+        else if (value("--benchmark_format", v))
+        {
+            if (v != "json" && v != "console")
+                throw std::runtime_error("Unknown --benchmark_format: " + v);
+            opts.json = v == "json";
+        }
+        else if (value("--benchmark_out", v))
+            opts.out_path = v;
+        else if (arg == "--benchmark_list_tests" || arg == "--benchmark_list_tests=true")
+            opts.list = true;
+        else
+            throw std::runtime_error("Unknown option: " + arg);
+    }
+
+    // A check needs several samples per benchmark; shorter runs keep it affordable
+    if (!opts.perf_baseline.empty())
+    {
+        if (!repetitions_given)
+            opts.repetitions = 10;
+        if (!min_time_given)
+            opts.min_time = 0.2;
+        if (!warmup_given)
+            opts.warmup_time = 0.2;
+        if (opts.repetitions < 3)
+            throw std::runtime_error("--perf_check needs --benchmark_repetitions of at least 3");
+        opts.quiet = !opts.json;
+    }
+    return opts;
+}
+
+// Run every registered benchmark matching the command line
+inline int RunBenchmarks(int argc, char **argv)
+{
+    try
+    {
+        Options opts = parseOptions(argc, argv);
+        std::map<std::string, std::vector<double>> baseline;
+        if (!opts.perf_baseline.empty())
+        {
+            BaselineMachine machine;
+            baseline = readBaseline(opts.perf_baseline, &machine);
+            for (const auto &entry : baseline)
+                opts.names.push_back(entry.first);
+
+            // Timings from another kind of machine or build say little about this one
+#ifdef NDEBUG
+            const char *build_type = "release";
+#else
+            const char *build_type = "debug";
+#endif
+            const int cpus = static_cast<int>(std::thread::hardware_concurrency());
+            if ((machine.num_cpus > 0 && machine.num_cpus != cpus) ||
+                (!machine.build_type.empty() && machine.build_type != build_type))
+            {
+                std::cerr << "Warning: the baseline was recorded with " << machine.num_cpus << " CPUs ("
+                          << machine.build_type << " build), this run has " << cpus << " (" << build_type
+                          << "); re-record it on this machine (perf_baseline target) before trusting the verdicts\n";
+            }
+        }
+        if (!opts.json && !opts.list && !opts.quiet)
+        {
+            char header[256];
+            std::snprintf(header, sizeof(header), "%-44s %16s %16s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+            std::cout << header << std::string(92, '-') << "\n";
+        }
+
+        Runner runner(opts);
+        std::vector<Run> runs = runner.runAll();
+        if (opts.list)
+            return 0;
+
+        if (opts.json)
+            Runner::writeJSON(std::cout, runs);
+        if (!opts.out_path.empty())
+        {
+            std::ofstream out(opts.out_path);
+            if (!out)
+                throw std::runtime_error("Failed to open benchmark output file: " + opts.out_path);
+            Runner::writeJSON(out, runs);
+        }
+
+        if (!opts.perf_baseline.empty())
+        {
+            // Every baseline entry the filter selects, in baseline (name) order
+            std::map<std::string, std::vector<double>> current;
+            for (const Run &r : runs)
+            {
+                if (!r.aggregate)
+                    current[r.name].push_back(r.real_ns);
+            }
+            std::regex filter(opts.filter);
+            std::vector<PerfComparison> rows;
+            for (const auto &entry : baseline)
+            {
+                if (std::regex_search(entry.first, filter))
+                    rows.push_back(comparePerf(entry.first, entry.second, current[entry.first], opts.perf_threshold));
+            }
+            std::ostream &out = opts.json ? std::cerr : std::cout;
+            return printPerfTable(out, rows, opts.perf_threshold) > 0 ? 1 : 0;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace bench
+
+#define BENCHMARK_CONCAT_(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_(a, b)
+
+// Register a benchmark function: BENCHMARK(BM_Foo)->Arg(64);
+#define BENCHMARK(fn) \
+    static bench::Benchmark *BENCHMARK_CONCAT(benchmark_registration_, __LINE__) = bench::RegisterBenchmark(#fn, fn)
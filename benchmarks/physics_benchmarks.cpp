@@ -0,0 +1,367 @@
+// Microbenchmarks for the physics hot path
+//
+// Run with --benchmark_format=json (or --benchmark_out=<file>) for machine
+// readable results. Build in Release for meaningful numbers.
+#include "benchmark_harness.hpp"
+#include "core/integrator.hpp"
+#include "environment/atmosphere.hpp"
+#include "environment/wind.hpp"
+#include "aerodynamics/aero.hpp"
+#include "aerodynamics/aero_data.hpp"
+#include "control/pid.hpp"
+#include "control/pid_bank.hpp"
+#include "aircraft/aircraft_loader.hpp"
+#include "simulation/simulation_state.hpp"
+#include "simulation/physics_update.hpp"
+#include "simulation/simulation_batch.hpp"
+#include "simulation/specialized_stepper.hpp"
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <string>
+
+#ifndef FLIGHT_CONFIG_DIR
+#define FLIGHT_CONFIG_DIR "config"
+#endif
+
+namespace
+{
+// Inputs cycle through a table so the compiler cannot hoist the work out of the loop
+const size_t INPUT_COUNT = 1024;
+
+std::vector<double> uniformInputs(double lo, double hi, unsigned seed = 1)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(lo, hi);
+    std::vector<double> v(INPUT_COUNT);
+    for (double &x : v)
+        x = dist(rng);
+    return v;
+}
+
+// Typical powered climb with both autopilots engaged
+SimulationState cruiseState(const Aircraft &aircraft)
+{
+    SimulationState state;
+    state.aircraft = aircraft;
+    state.reset();
+    state.position = Vec2(0.0, 100.0);
+    state.velocity = Vec2(20.0, 0.0);
+    state.dt = 0.005;
+    state.record_flight_path = false;
+    state.autopilot_speed = true;
+    state.speed_setpoint = 22.0f;
+    state.autopilot_altitude = true;
+    state.altitude_setpoint = 120.0f;
+    return state;
+}
+
+void BM_IntegrateRK4(bench::State &state)
+{
+    std::vector<double> ax = uniformInputs(-5.0, 5.0, 1), ay = uniformInputs(-12.0, 2.0, 2);
+    Vec2 position(0.0, 100.0), velocity(20.0, 0.0);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        integrateRK4(position, velocity, Vec2(ax[i], ay[i]), 0.005);
+        bench::DoNotOptimize(position);
+        i = (i + 1) % INPUT_COUNT;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_IntegrateRK4);
+
+void BM_GetDensity(bench::State &state)
+{
+    std::vector<double> h = uniformInputs(0.0, 11000.0);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        bench::DoNotOptimize(getDensity(h[i]));
+        i = (i + 1) % INPUT_COUNT;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_GetDensity);
+
+void BM_GetAtmosphere(bench::State &state)
+{
+    std::vector<double> h = uniformInputs(0.0, 11000.0);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        bench::DoNotOptimize(getAtmosphere(h[i]));
+        i = (i + 1) % INPUT_COUNT;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_GetAtmosphere);
+
+void BM_ComputeAtmosphere(bench::State &state)
+{
+    std::vector<double> h = uniformInputs(0.0, 11000.0);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        bench::DoNotOptimize(computeAtmosphere(h[i]));
+        i = (i + 1) % INPUT_COUNT;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_ComputeAtmosphere);
+
+// Moderate Dryden turbulence over a sheared wind: two tile reads, profile
+// interpolation and the gust check per sample
+void BM_WindSample(bench::State &state)
+{
+    WindConditions c;
+    c.speed = 6.0;
+    c.turbulence = TurbulenceModel::Dryden;
+    c.turbulence_w20 = turbulenceIntensity("moderate");
+    c.gusts.push_back(WindGust{5.0, 2.0, 3.0, -2.0});
+    WindField field(c);
+    std::vector<double> h = uniformInputs(0.0, 1200.0), phase = uniformInputs(0.0, TurbulenceTiles::SIZE - 1.0);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        TurbulencePhase p{phase[i], phase[INPUT_COUNT - 1 - i]};
+        bench::DoNotOptimize(field.sample(h[i], 3.0, p));
+        i = (i + 1) % INPUT_COUNT;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_WindSample);
+
+void BM_CalcCLCD_Analytic(bench::State &state)
+{
+    std::vector<double> alpha = uniformInputs(-0.1, 0.25);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        double CL = calcCL(alpha[i], 5.7);
+        bench::DoNotOptimize(calcCD(CL, 0.025, 0.04));
+        i = (i + 1) % INPUT_COUNT;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_CalcCLCD_Analytic);
+
+// Table lookups for each shipped CSV (alpha in degrees, partly outside the table)
+void registerAeroTableBenchmark(const std::string &file)
+{
+    bench::RegisterBenchmark("BM_AeroTableLookup/" + file, [file](bench::State &state)
+                             {
+        AeroDataTable table = AeroDataTable::loadFromCSV(std::string(FLIGHT_CONFIG_DIR) + "/" + file);
+        std::vector<double> alpha = uniformInputs(table.getMinAlpha() - 2.0, table.getMaxAlpha() + 2.0);
+        size_t i = 0;
+        for (auto _ : state)
+        {
+            bench::DoNotOptimize(table.getCLCD(alpha[i]));
+            i = (i + 1) % INPUT_COUNT;
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations())); });
+}
+
+void BM_PIDUpdate(bench::State &state)
+{
+    std::vector<double> measurement = uniformInputs(15.0, 25.0);
+    PIDController pid(0.5, 0.1, 0.05, 0.0, 1.0);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        bench::DoNotOptimize(pid.update(20.0, measurement[i], 0.005));
+        i = (i + 1) % INPUT_COUNT;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_PIDUpdate);
+
+// N controllers per call; items_per_second is controller updates per second
+void BM_PIDBankUpdate(bench::State &state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    std::vector<double> measurement = uniformInputs(15.0, 25.0);
+    measurement.resize(n, 20.0);
+    std::vector<float> setpoint(n, 20.0f), output(n);
+    std::vector<uint8_t> enabled(n, 1);
+    PIDBank bank(n);
+    for (size_t i = 0; i < n; i++)
+        bank.configure(i, 0.5, 0.1, 0.05, 0.0, 1.0);
+
+    for (auto _ : state)
+    {
+        bank.update(setpoint.data(), measurement.data(), 0.005, enabled.data(), output.data());
+        bench::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+BENCHMARK(BM_PIDBankUpdate)->Arg(1024);
+
+// Full physics step; items_per_second is simulation steps per second
+void registerUpdatePhysicsBenchmark(const std::string &config)
+{
+    bench::RegisterBenchmark("BM_UpdatePhysics/" + config, [config](bench::State &state)
+                             {
+        SimulationState sim = cruiseState(AircraftLoader::loadFromJSON(std::string(FLIGHT_CONFIG_DIR) + "/" + config));
+        for (auto _ : state)
+        {
+            updatePhysics(sim);
+            bench::ClobberMemory();
+        }
+        bench::DoNotOptimize(sim.position);
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations())); });
+}
+
+// Same run through the compile-time specialized stepper
+void registerSpecializedStepperBenchmark(const std::string &config)
+{
+    bench::RegisterBenchmark("BM_SpecializedStepper/" + config, [config](bench::State &state)
+                             {
+        SimulationState sim = cruiseState(AircraftLoader::loadFromJSON(std::string(FLIGHT_CONFIG_DIR) + "/" + config));
+        withSpecializedStepper(sim, [&](auto &stepper)
+                               {
+            for (auto _ : state)
+            {
+                stepper.step();
+                bench::ClobberMemory();
+            }
+            bench::DoNotOptimize(stepper.time()); });
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations())); });
+}
+
+// Config load including the aero table it names; items_per_second is files per second
+void registerLoadAircraftBenchmark(const std::string &config)
+{
+    bench::RegisterBenchmark("BM_LoadAircraftJSON/" + config, [config](bench::State &state)
+                             {
+        const std::string path = std::string(FLIGHT_CONFIG_DIR) + "/" + config;
+        for (auto _ : state)
+        {
+            Aircraft ac = AircraftLoader::loadFromJSON(path);
+            bench::DoNotOptimize(ac.mass);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations())); });
+}
+
+void registerLoadAeroCSVBenchmark(const std::string &file)
+{
+    bench::RegisterBenchmark("BM_LoadAeroCSV/" + file, [file](bench::State &state)
+                             {
+        const std::string path = std::string(FLIGHT_CONFIG_DIR) + "/" + file;
+        for (auto _ : state)
+        {
+            AeroDataTable table = AeroDataTable::loadFromCSV(path);
+            bench::DoNotOptimize(table.size());
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations())); });
+}
+
+// Dense alpha x Mach x elevator grid parsed from memory; items_per_second is rows per second
+void BM_ParseAeroCSV_Grid(bench::State &state)
+{
+    std::string csv = "alpha,mach,elevator,CL,CD\n";
+    size_t rows = 0;
+    for (int e = -10; e <= 10; e++)
+        for (int m = 0; m <= 10; m++)
+            for (int a = -10; a <= 20; a++)
+            {
+                csv += std::to_string(a) + "," + std::to_string(m * 0.05) + "," + std::to_string(e * 0.1) + "," +
+                       std::to_string(0.1 * a + 0.05 * e) + "," + std::to_string(0.02 + 0.001 * a * a) + "\n";
+                rows++;
+            }
+    for (auto _ : state)
+    {
+        AeroDataTable table = AeroDataTable::parseCSV(csv.data(), csv.data() + csv.size(), "grid.csv");
+        bench::DoNotOptimize(table.size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * rows));
+}
+BENCHMARK(BM_ParseAeroCSV_Grid);
+
+// The same grid mapped from its compiled .fdaero file; items_per_second is rows per second
+void BM_LoadAeroCompiled_Grid(bench::State &state)
+{
+    std::string csv = "alpha,mach,elevator,CL,CD\n";
+    size_t rows = 0;
+    for (int e = -10; e <= 10; e++)
+        for (int m = 0; m <= 10; m++)
+            for (int a = -10; a <= 20; a++)
+            {
+                csv += std::to_string(a) + "," + std::to_string(m * 0.05) + "," + std::to_string(e * 0.1) + "," +
+                       std::to_string(0.1 * a + 0.05 * e) + "," + std::to_string(0.02 + 0.001 * a * a) + "\n";
+                rows++;
+            }
+    const std::string path = "bench_grid.fdaero";
+    AeroDataTable::parseCSV(csv.data(), csv.data() + csv.size(), "grid.csv")
+        .saveCompiled(path, {AeroDataTable::hashBytes(csv.data(), csv.size()), csv.size()});
+    for (auto _ : state)
+    {
+        AeroDataTable table = AeroDataTable::loadCompiled(path);
+        bench::DoNotOptimize(table.size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * rows));
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_LoadAeroCompiled_Grid);
+
+// N aircraft stepped together; items_per_second is aircraft steps per second.
+// Turbulent lanes each fly their own seed.
+void runSimulationBatch(bench::State &state, bool turbulent)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    SimulationBatch batch;
+    batch.resize(n);
+    SimulationState lane = cruiseState(Aircraft());
+    WindConditions wind;
+    wind.turbulence = TurbulenceModel::Dryden;
+    wind.turbulence_w20 = turbulenceIntensity("moderate");
+    for (size_t i = 0; i < n; i++)
+    {
+        lane.aircraft.mass = 100.0 + static_cast<double>(i % 64);
+        if (turbulent)
+        {
+            wind.seed = turbulenceSeed(1, i % 64);
+            lane.setWind(wind);
+        }
+        batch.setLane(i, lane);
+    }
+    batch.dt = lane.dt;
+
+    for (auto _ : state)
+    {
+        batch.step();
+        bench::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+void BM_SimulationBatch(bench::State &state)
+{
+    runSimulationBatch(state, false);
+}
+BENCHMARK(BM_SimulationBatch)->Arg(64)->Arg(1024);
+
+void BM_SimulationBatchTurbulent(bench::State &state)
+{
+    runSimulationBatch(state, true);
+}
+BENCHMARK(BM_SimulationBatchTurbulent)->Arg(1024);
+} // namespace
+
+int main(int argc, char **argv)
+{
+    registerAeroTableBenchmark("aero_default.csv");
+    registerAeroTableBenchmark("2yp.csv");
+    registerUpdatePhysicsBenchmark("aircraft_light.json");
+    registerUpdatePhysicsBenchmark("aircraft_heavy.json");
+    registerUpdatePhysicsBenchmark("2yp.json");
+    registerSpecializedStepperBenchmark("aircraft_light.json");
+    registerSpecializedStepperBenchmark("aircraft_heavy.json");
+    registerSpecializedStepperBenchmark("2yp.json");
+    registerLoadAircraftBenchmark("aircraft_light.json");
+    registerLoadAircraftBenchmark("aircraft_heavy.json");
+    registerLoadAircraftBenchmark("2yp.json");
+    registerLoadAeroCSVBenchmark("aero_default.csv");
+    registerLoadAeroCSVBenchmark("2yp.csv");
+    return bench::RunBenchmarks(argc, argv);
+}
@@ -0,0 +1,97 @@
+// FlightDynamics Aero Compiler - precompile CSV aero tables to .fdaero files
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+#include "aerodynamics/aero_table_cache.hpp"
+
+namespace
+{
+void printUsage()
+{
+    std::cout << "Usage: FlightDynamicsAeroCompiler [options] <file.csv | directory>...\n"
+                 "  Writes a compiled .fdaero table next to each CSV (every *.csv for a directory).\n"
+                 "  The simulation maps these at startup instead of parsing the CSV.\n"
+                 "  --quiet                   Only report errors\n";
+}
+
+// CSVs named on the command line, directories expanded (non-recursive, sorted)
+std::vector<std::string> collectInputs(const std::vector<std::string> &args)
+{
+    std::vector<std::string> files;
+    for (const std::string &arg : args)
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(arg, ec))
+        {
+            files.push_back(arg);
+            continue;
+        }
+        std::vector<std::string> found;
+        for (const auto &entry : std::filesystem::directory_iterator(arg, ec))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".csv")
+                found.push_back(entry.path().string());
+        }
+        if (ec)
+        {
+            throw std::runtime_error("Failed to read directory: " + arg);
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    return files;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bool quiet = false;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage();
+            return 0;
+        }
+        if (arg == "--quiet")
+            quiet = true;
+        else
+            args.push_back(arg);
+    }
+    if (args.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    int failed = 0;
+    try
+    {
+        for (const std::string &csv : collectInputs(args))
+        {
+            try
+            {
+                std::string compiled = AeroTableCache::compile(csv);
+                if (!quiet)
+                    std::cout << csv << " -> " << compiled << "\n";
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Error: " << e.what() << "\n";
+                failed++;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return failed > 0 ? 1 : 0;
+}
@@ -1,18 +1,6 @@
 #include "aero.hpp"
 #include <cmath>
 
-// Linear lift coefficient (legacy)
-double calcCL(double alpha, double CL_alpha)
-{
-    return CL_alpha * alpha; // alpha in radians
-}
-
-// Drag coefficient (parabolic drag polar - legacy)
-double calcCD(double CL, double CD0, double k)
-{
-    return CD0 + k * CL * CL;
-}
-
 // Lift coefficient from table data
 double calcCL(double alpha, const AeroDataTable *table)
 {
@@ -33,26 +21,26 @@ double calcCD(double alpha, double CD0, const AeroDataTable *table)
     return 0.0;
 }
 
-// Lift force [N]
-double calcLift(double rho, double V, double S, double CL)
-{
-    return 0.5 * rho * V * V * S * CL;
-}
-
-// Drag force [N]
-double calcDrag(double rho, double V, double S, double CD)
+// Lift and drag coefficients from table data (one lookup)
+AeroCoefficients calcCLCD(double alpha, double CD0, const AeroDataTable *table)
 {
-    return 0.5 * rho * V * V * S * CD;
-}
-
-// Weight [N]
-double calcWeight(double mass, double g)
-{
-    return mass * g;
+    if (table && !table->isEmpty())
+    {
+        AeroCoefficients c = table->getCLCD(alpha);
+        c.CD += CD0;
+        return c;
+    }
+    return {0.0, 0.0};
 }
 
-// Thrust [N] (simplified linear with throttle)
-double calcThrust(double throttle, double maxThrust)
+// Lift and drag coefficients at a full flight condition (one lookup)
+AeroCoefficients calcCLCD(const AeroQuery &query, double CD0, const AeroDataTable *table)
 {
-    return throttle * maxThrust;
+    if (table && !table->isEmpty())
+    {
+        AeroCoefficients c = table->getCLCD(query);
+        c.CD += CD0;
+        return c;
+    }
+    return {0.0, 0.0};
 }
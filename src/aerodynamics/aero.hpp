@@ -7,11 +7,20 @@
 // Aerodynamics module for simple flight simulator
 // Calculates lift, drag, weight, and thrust
 
+// The scalar force model is defined inline (constexpr) so batched kernels can
+// vectorize it and specialized steppers can be checked at compile time
+
 // Lift coefficient (linear approximation - legacy)
-double calcCL(double alpha, double CL_alpha);
+constexpr double calcCL(double alpha, double CL_alpha)
+{
+    return CL_alpha * alpha; // alpha in radians
+}
 
 // Drag coefficient (parabolic drag polar - legacy)
-double calcCD(double CL, double CD0, double k);
+constexpr double calcCD(double CL, double CD0, double k)
+{
+    return CD0 + k * CL * CL;
+}
 
 // Lift coefficient from table data
 double calcCL(double alpha, const AeroDataTable *table);
@@ -19,16 +28,35 @@ double calcCL(double alpha, const AeroDataTable *table);
 // Drag coefficient from table data
 double calcCD(double alpha, double CD0, const AeroDataTable *table);
 
-// Lift force
-double calcLift(double rho, double V, double S, double CL);
-
-// Drag force
-double calcDrag(double rho, double V, double S, double CD);
-
-// Weight force
-double calcWeight(double mass, double g);
-
-// Thrust force
-double calcThrust(double throttle, double maxThrust);
+// Lift and drag coefficients from table data with a single lookup
+// (CD includes CD0, same as calcCD)
+AeroCoefficients calcCLCD(double alpha, double CD0, const AeroDataTable *table);
+
+// Lift and drag coefficients at a full flight condition (alpha, Mach, Reynolds, elevator)
+AeroCoefficients calcCLCD(const AeroQuery &query, double CD0, const AeroDataTable *table);
+
+// Lift force [N]
+constexpr double calcLift(double rho, double V, double S, double CL)
+{
+    return 0.5 * rho * V * V * S * CL;
+}
+
+// Drag force [N]
+constexpr double calcDrag(double rho, double V, double S, double CD)
+{
+    return 0.5 * rho * V * V * S * CD;
+}
+
+// Weight [N]
+constexpr double calcWeight(double mass, double g)
+{
+    return mass * g;
+}
+
+// Thrust [N] (simplified linear with throttle)
+constexpr double calcThrust(double throttle, double maxThrust)
+{
+    return throttle * maxThrust;
+}
 
 #endif
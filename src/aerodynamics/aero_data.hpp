@@ -1,19 +1,91 @@
 #pragma once
 
+#include "../utils/mapped_file.hpp"
+#include "../utils/text_scanner.hpp"
 #include <vector>
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <string_view>
 #include <stdexcept>
 #include <algorithm>
 #include <cmath>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+// Lift and drag coefficients from one table lookup
+struct AeroCoefficients
+{
+    double CL;
+    double CD;
+};
+
+// Independent variables an aero table can be gridded over
+enum class AeroAxis
+{
+    Alpha,    // Angle of attack [rad] (always present)
+    Mach,     // Mach number
+    Reynolds, // Reynolds number based on the mean aerodynamic chord
+    Elevator  // Elevator command (-1 to +1, same units as SimulationState::elevator)
+};
+
+// Flight condition for an aero table lookup
+struct AeroQuery
+{
+    double alpha;
+    double mach = 0.0;
+    double reynolds = 0.0;
+    double elevator = 0.0;
+
+    double get(AeroAxis axis) const
+    {
+        switch (axis)
+        {
+        case AeroAxis::Mach:
+            return mach;
+        case AeroAxis::Reynolds:
+            return reynolds;
+        case AeroAxis::Elevator:
+            return elevator;
+        default:
+            return alpha;
+        }
+    }
+};
+
 // Aerodynamic data table loaded from CSV
-// Format: alpha (degrees), CL, CD
+// 1-D format: alpha (degrees), CL, CD
+// N-D format: header naming the axis columns (alpha, mach, reynolds, elevator) plus CL, CD
+//
+// STORAGE:
+// Coefficients are kept as one contiguous array per coefficient (structure of
+// arrays) over a full tensor grid, with alpha varying fastest so the two
+// alpha neighbours of every lookup corner sit next to each other in memory.
+//
+// LOOKUP:
+// Interpolation is multilinear, with the corner loop specialized at compile
+// time for the table's dimension count (1-4). Each axis is checked for uniform
+// spacing at load time and then indexed directly in O(1); if every alpha spacing
+// is a whole multiple of the finest one, the alpha axis is resampled exactly onto
+// that finer grid. Non-uniform axes fall back to a binary search.
+//
+// EXTRAPOLATION:
+// Along alpha, CL is extrapolated linearly from the end segment but clamped to a
+// minimum of 0, and CD is held at the end value. Other axes clamp to the grid.
+//
+// COMPILED FORM:
+// saveCompiled() writes the finished grid (after resampling) as a binary
+// .fdaero file: a versioned header with the source CSV's hash and size, then
+// the axis breakpoints and the CL and CD arrays, each 64-byte aligned.
+// loadCompiled() memory-maps such a file and looks up straight from the
+// mapping, with no parsing. The arrays are immutable, so copies of a table
+// share them (heap or mapping) instead of duplicating them.
 class AeroDataTable
 {
 public:
@@ -24,153 +96,824 @@ public:
         double CD;    // Drag coefficient
     };
 
+    // One axis of an N-D grid: breakpoints must be strictly increasing
+    struct GridAxis
+    {
+        AeroAxis axis;
+        std::vector<double> values;
+    };
+
+    static constexpr size_t MAX_DIMENSIONS = 4;
+
+    // Build a 1-D table from points (any order)
+    static AeroDataTable fromPoints(std::vector<DataPoint> points)
+    {
+        // Sort by alpha for interpolation
+        std::sort(points.begin(), points.end(),
+                  [](const DataPoint &a, const DataPoint &b)
+                  { return a.alpha < b.alpha; });
+        for (size_t i = 1; i < points.size(); i++)
+        {
+            // Two CL/CD values at one alpha would leave a zero-width cell
+            if (!(points[i].alpha > points[i - 1].alpha))
+                throw std::runtime_error("Aero data has more than one point at alpha " +
+                                         std::to_string(points[i].alpha * 180.0 / M_PI) + " deg");
+        }
+
+        std::vector<GridAxis> grid = {{AeroAxis::Alpha, {}}};
+        std::vector<double> CL, CD;
+        for (const DataPoint &p : points)
+        {
+            grid[0].values.push_back(p.alpha);
+            CL.push_back(p.CL);
+            CD.push_back(p.CD);
+        }
+        return build(std::move(grid), std::move(CL), std::move(CD), points.size());
+    }
+
+    // Build an N-D table. The first axis must be alpha. CL/CD are laid out with
+    // the first axis varying fastest: index = i0 + n0 * (i1 + n1 * (i2 + ...)).
+    static AeroDataTable fromGrid(std::vector<GridAxis> grid, std::vector<double> CL, std::vector<double> CD)
+    {
+        if (grid.empty() || grid.size() > MAX_DIMENSIONS || grid[0].axis != AeroAxis::Alpha)
+            throw std::runtime_error("Aero grid needs alpha as its first axis and at most 4 axes");
+
+        size_t stride = 1;
+        for (const GridAxis &g : grid)
+        {
+            for (size_t i = 1; i < g.values.size(); i++)
+            {
+                if (!(g.values[i] > g.values[i - 1]))
+                    throw std::runtime_error("Aero grid axis values must be strictly increasing");
+            }
+            if (g.values.empty())
+                throw std::runtime_error("Aero grid axis has no values");
+            stride *= g.values.size();
+        }
+        if (CL.size() != stride || CD.size() != stride)
+            throw std::runtime_error("Aero grid coefficient count does not match the axes");
+
+        dropSingletonAxes(grid);
+        return build(std::move(grid), std::move(CL), std::move(CD), stride);
+    }
+
     // Load data from CSV file
-    // Expected format: alpha,CL,CD (with optional header row)
+    // Expected format: alpha,CL,CD (with optional header row), or a header row
+    // naming any of alpha/mach/reynolds/elevator plus CL and CD for an N-D grid
     static AeroDataTable loadFromCSV(const std::string &filepath)
     {
-        AeroDataTable table;
-        std::ifstream file(filepath);
-
-        if (!file.is_open())
+        MappedFile map;
+        try
+        {
+            map.open(filepath);
+        }
+        catch (const std::exception &)
         {
             throw std::runtime_error("Failed to open aero data file: " + filepath);
         }
+        const char *text = reinterpret_cast<const char *>(map.data());
+        return parseCSV(text, text + map.size(), filepath);
+    }
+
+    // Parse CSV text already in memory (the loadFromCSV format). Single pass:
+    // numbers are converted in place and rows are stored in one flat array.
+    // Malformed input throws ParseError with the line and column; source
+    // names the text in messages.
+    static AeroDataTable parseCSV(const char *begin, const char *end, const std::string &source)
+    {
+        // Column layout (defaults to headerless alpha,CL,CD)
+        std::vector<int> axisColumns = {0}; // column index per axis, alpha first
+        std::vector<AeroAxis> axisIds = {AeroAxis::Alpha};
+        int clColumn = 1, cdColumn = 2;
 
-        std::string line;
+        TextScanner scan(begin, end, source);
+        std::vector<double> fields;         // Current row (reused)
+        std::vector<double> values;         // Accepted rows, 'width' values each
+        std::vector<const char *> rowStart; // Where each accepted row begins (error positions)
         bool firstLine = true;
 
-        while (std::getline(file, line))
+        while (!scan.atEnd())
         {
             // Skip empty lines
-            if (line.empty() || line.find_first_not_of(" \t\r\n") == std::string::npos)
+            scan.skipSpaces();
+            if (scan.atLineEnd())
+            {
+                scan.skipLine();
                 continue;
+            }
 
-            // Skip header if it contains non-numeric data
+            // Header row if it starts with a letter
             if (firstLine)
             {
                 firstLine = false;
-                // Check if first character is a letter (header row)
-                if (std::isalpha(line[0]))
+                if (std::isalpha(static_cast<unsigned char>(scan.peek())))
+                {
+                    parseHeader(scan.token(""), source, axisColumns, axisIds, clColumn, cdColumn);
+                    scan.skipLine();
                     continue;
+                }
             }
 
-            std::stringstream ss(line);
-            std::string token;
-            DataPoint point;
+            const char *start = scan.position();
+            fields.clear();
+            for (;;)
+            {
+                scan.skipSpaces();
+                if (scan.atLineEnd())
+                    break; // Trailing comma
+                fields.push_back(scan.number());
+                scan.skipSpaces();
+                if (scan.consume(','))
+                    continue;
+                if (!scan.atLineEnd())
+                    scan.fail("expected ',' or end of line");
+                break;
+            }
+            scan.skipLine();
 
-            // Parse alpha (convert from degrees to radians)
-            if (!std::getline(ss, token, ','))
-                continue;
-            point.alpha = std::stod(token) * M_PI / 180.0;
+            size_t width = static_cast<size_t>(requiredColumns(axisColumns, clColumn, cdColumn));
+            if (fields.size() < width)
+            {
+                // 1-D tables skip short rows; a grid needs every point
+                if (axisIds.size() == 1)
+                    continue;
+                scan.failAt(start, "incomplete row in aero grid (" + std::to_string(fields.size()) +
+                                       " columns, expected " + std::to_string(width) + ")");
+            }
+            values.insert(values.end(), fields.begin(), fields.begin() + static_cast<std::ptrdiff_t>(width));
+            rowStart.push_back(start);
+        }
 
-            // Parse CL
-            if (!std::getline(ss, token, ','))
-                continue;
-            point.CL = std::stod(token);
+        const size_t width = static_cast<size_t>(requiredColumns(axisColumns, clColumn, cdColumn));
+        const size_t rows = rowStart.size();
+        auto row = [&](size_t r)
+        { return &values[r * width]; };
 
-            // Parse CD
-            if (!std::getline(ss, token, ','))
-                continue;
-            point.CD = std::stod(token);
+        // 1-D table: keep the original point-list semantics
+        if (axisIds.size() == 1)
+        {
+            std::vector<DataPoint> points;
+            points.reserve(rows);
+            for (size_t r = 0; r < rows; r++)
+                points.push_back({row(r)[axisColumns[0]] * M_PI / 180.0, row(r)[clColumn], row(r)[cdColumn]});
+            if (points.empty())
+            {
+                throw std::runtime_error("No valid data found in: " + source);
+            }
+            // Report a repeated alpha at its row (fromPoints would only name the value)
+            std::vector<size_t> order(rows);
+            for (size_t r = 0; r < rows; r++)
+                order[r] = r;
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                             { return points[a].alpha < points[b].alpha; });
+            for (size_t k = 1; k < rows; k++)
+            {
+                if (!(points[order[k]].alpha > points[order[k - 1]].alpha))
+                    scan.failAt(rowStart[order[k]], "duplicate alpha");
+            }
+            return fromPoints(std::move(points));
+        }
 
-            table.data.push_back(point);
+        // N-D table: collect the breakpoints of each axis, then place every row
+        if (rows == 0)
+        {
+            throw std::runtime_error("No valid data found in: " + source);
+        }
+        std::vector<GridAxis> grid;
+        for (AeroAxis id : axisIds)
+            grid.push_back({id, {}});
+        for (size_t k = 0; k < grid.size(); k++)
+        {
+            grid[k].values.reserve(rows);
+            for (size_t r = 0; r < rows; r++)
+                grid[k].values.push_back(axisValue(grid[k].axis, row(r)[axisColumns[k]]));
         }
 
-        if (table.data.empty())
+        size_t total = 1;
+        for (GridAxis &g : grid)
         {
-            throw std::runtime_error("No valid data found in: " + filepath);
+            std::sort(g.values.begin(), g.values.end());
+            g.values.erase(std::unique(g.values.begin(), g.values.end()), g.values.end());
+            total *= g.values.size();
+        }
+        if (total != rows)
+        {
+            throw std::runtime_error("Aero grid in " + source + " is not a full tensor grid (" +
+                                     std::to_string(rows) + " rows, expected " + std::to_string(total) + ")");
         }
 
-        // Sort by alpha for interpolation
-        std::sort(table.data.begin(), table.data.end(),
-                  [](const DataPoint &a, const DataPoint &b)
-                  { return a.alpha < b.alpha; });
+        std::vector<double> CL(total, 0.0), CD(total, 0.0);
+        std::vector<bool> filled(total, false);
+        for (size_t r = 0; r < rows; r++)
+        {
+            size_t index = 0, stride = 1;
+            for (size_t k = 0; k < grid.size(); k++)
+            {
+                double v = axisValue(grid[k].axis, row(r)[axisColumns[k]]);
+                size_t i = static_cast<size_t>(std::lower_bound(grid[k].values.begin(), grid[k].values.end(), v) -
+                                               grid[k].values.begin());
+                index += i * stride;
+                stride *= grid[k].values.size();
+            }
+            if (filled[index])
+                scan.failAt(rowStart[r], "duplicate grid point");
+            filled[index] = true;
+            CL[index] = row(r)[clColumn];
+            CD[index] = row(r)[cdColumn];
+        }
 
-        return table;
+        return fromGrid(std::move(grid), std::move(CL), std::move(CD));
+    }
+
+    // CL and CD at given alpha (in radians) from a single lookup.
+    // For N-D tables the other axes are taken as 0 (clamped to the grid).
+    AeroCoefficients getCLCD(double alpha) const
+    {
+        AeroQuery q;
+        q.alpha = alpha;
+        return getCLCD(q);
+    }
+
+    // CL and CD at a full flight condition
+    AeroCoefficients getCLCD(const AeroQuery &q) const
+    {
+        return (this->*lookup)(q);
     }
 
     // Interpolate CL at given alpha (in radians)
-    double getCL(double alpha) const
+    double getCL(double alpha) const { return getCLCD(alpha).CL; }
+
+    // Interpolate CD at given alpha (in radians)
+    double getCD(double alpha) const { return getCLCD(alpha).CD; }
+
+    // Get alpha range
+    double getMinAlpha() const { return isEmpty() ? 0.0 : axes[0].values[0]; }
+    double getMaxAlpha() const { return isEmpty() ? 0.0 : axes[0].values[axes[0].count - 1]; }
+
+    bool isEmpty() const { return coefficient_count == 0; }
+
+    // Number of source data points
+    size_t size() const { return source_points; }
+
+    // Number of gridded axes (1 for a plain alpha polar)
+    size_t dimensions() const { return axes.size(); }
+
+    // True if the table varies with the given axis
+    bool hasAxis(AeroAxis axis) const
     {
-        double CL = interpolate(alpha, [](const DataPoint &p)
-                                { return p.CL; });
+        for (const Axis &a : axes)
+        {
+            if (a.id == axis)
+                return true;
+        }
+        return false;
+    }
 
-        // Clamp CL to minimum of 0 only when extrapolating beyond known data
-        if (!data.empty() && (alpha < data.front().alpha || alpha > data.back().alpha))
+    // True when alpha lookups use direct index computation instead of binary search
+    bool isUniform() const { return !axes.empty() && axes[0].uniform; }
+
+    // CSV a compiled table was built from
+    struct CompiledSource
+    {
+        uint64_t hash = 0; // hashBytes() of the file contents
+        uint64_t size = 0; // Bytes
+    };
+
+    static constexpr uint32_t COMPILED_VERSION = 1;
+
+    // Compiled file belonging to a CSV: the same path with the .fdaero extension
+    static std::string compiledPath(const std::string &csvPath)
+    {
+        size_t dot = csvPath.find_last_of('.');
+        size_t slash = csvPath.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+            return csvPath + ".fdaero";
+        return csvPath.substr(0, dot) + ".fdaero";
+    }
+
+    // FNV-1a; identifies CSV contents (compiled files, AeroTableCache)
+    static uint64_t hashBytes(const void *data, size_t n)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        uint64_t h = 14695981039346656037ull;
+        for (size_t i = 0; i < n; i++)
         {
-            return std::max(0.0, CL);
+            h ^= bytes[i];
+            h *= 1099511628211ull;
         }
-        return CL;
+        return h;
     }
 
-    // Interpolate CD at given alpha (in radians)
-    double getCD(double alpha) const
+    // Write the table as a compiled .fdaero file built from 'source'
+    void saveCompiled(const std::string &filepath, const CompiledSource &source) const
     {
-        double CD = interpolate(alpha, [](const DataPoint &p)
-                                { return p.CD; });
+        if (isEmpty())
+            throw std::runtime_error("Cannot compile an empty aero table: " + filepath);
 
-        // When extrapolating, clamp CD to the last known value to prevent unrealistic behavior
-        if (!data.empty())
+        CompiledHeader header = {};
+        std::memcpy(header.magic, "FDAERO\0\0", 8);
+        header.version = COMPILED_VERSION;
+        header.byte_order = BYTE_ORDER_MARK;
+        header.dimensions = static_cast<uint32_t>(axes.size());
+        header.source_hash = source.hash;
+        header.source_size = source.size;
+        header.source_points = source_points;
+        header.coefficients = coefficient_count;
+        uint64_t offset = sizeof(CompiledHeader);
+        for (size_t k = 0; k < axes.size(); k++)
         {
-            if (alpha < data.front().alpha)
-            {
-                return data.front().CD;
-            }
-            if (alpha > data.back().alpha)
+            header.axes[k] = {static_cast<uint32_t>(axes[k].id), axes[k].uniform ? 1u : 0u, axes[k].count, offset,
+                              axes[k].inv_step};
+            offset = alignCompiled(offset + axes[k].count * sizeof(double));
+        }
+        header.cl_offset = offset;
+        header.cd_offset = alignCompiled(offset + coefficient_count * sizeof(double));
+
+        std::FILE *file = std::fopen(filepath.c_str(), "wb");
+        if (!file)
+            throw std::runtime_error("Failed to open compiled aero file: " + filepath);
+        uint64_t written = 0;
+        auto writeAt = [&](uint64_t at, const void *data, size_t bytes)
+        {
+            static const char zeros[COMPILED_ALIGNMENT] = {};
+            bool ok = at >= written && std::fwrite(zeros, 1, static_cast<size_t>(at - written), file) == at - written &&
+                      std::fwrite(data, 1, bytes, file) == bytes;
+            written = at + bytes;
+            return ok;
+        };
+        bool ok = writeAt(0, &header, sizeof(header));
+        for (size_t k = 0; k < axes.size(); k++)
+            ok = ok && writeAt(header.axes[k].offset, axes[k].values, axes[k].count * sizeof(double));
+        ok = ok && writeAt(header.cl_offset, CLs, coefficient_count * sizeof(double));
+        ok = ok && writeAt(header.cd_offset, CDs, coefficient_count * sizeof(double));
+        if (std::fclose(file) != 0 || !ok)
+            throw std::runtime_error("Failed to write compiled aero file: " + filepath);
+    }
+
+    // Map a compiled .fdaero file and use it in place. Throws on a file that
+    // is not a compiled table of this version or whose arrays do not fit it.
+    static AeroDataTable loadCompiled(const std::string &filepath, CompiledSource *source = nullptr)
+    {
+        auto map = std::make_shared<MappedFile>();
+        try
+        {
+            map->open(filepath);
+        }
+        catch (const std::exception &)
+        {
+            throw std::runtime_error("Failed to open compiled aero file: " + filepath);
+        }
+        const uint8_t *base = map->data();
+        const size_t bytes = map->size();
+
+        CompiledHeader header;
+        if (bytes < sizeof(header))
+            throw std::runtime_error(filepath + ": not a compiled aero table");
+        std::memcpy(&header, base, sizeof(header));
+        if (std::memcmp(header.magic, "FDAERO\0\0", 8) != 0 || header.version != COMPILED_VERSION ||
+            header.byte_order != BYTE_ORDER_MARK)
+            throw std::runtime_error(filepath + ": not a version " + std::to_string(COMPILED_VERSION) +
+                                     " compiled aero table");
+
+        // Every array must lie inside the file, aligned for doubles
+        auto array = [&](uint64_t offset, uint64_t count) -> const double *
+        {
+            if (offset % alignof(double) != 0 || offset > bytes || count > (bytes - offset) / sizeof(double))
+                throw std::runtime_error(filepath + ": damaged compiled aero table");
+            return reinterpret_cast<const double *>(base + offset);
+        };
+        if (header.dimensions == 0 || header.dimensions > MAX_DIMENSIONS || header.coefficients == 0 ||
+            header.axes[0].id != static_cast<uint32_t>(AeroAxis::Alpha))
+            throw std::runtime_error(filepath + ": damaged compiled aero table");
+
+        AeroDataTable table;
+        size_t stride = 1;
+        for (uint32_t k = 0; k < header.dimensions; k++)
+        {
+            const CompiledAxis &a = header.axes[k];
+            const double *values = array(a.offset, a.count);
+            bool valid = a.id <= static_cast<uint32_t>(AeroAxis::Elevator) && a.count >= (k == 0 ? 1u : 2u) &&
+                         (a.uniform == 0 || a.inv_step > 0.0);
+            for (uint64_t i = 1; valid && i < a.count; i++)
+                valid = values[i] > values[i - 1];
+            if (!valid || stride > header.coefficients / a.count)
+                throw std::runtime_error(filepath + ": damaged compiled aero table");
+            table.axes.push_back({static_cast<AeroAxis>(a.id), values, static_cast<size_t>(a.count), a.uniform != 0,
+                                  a.uniform != 0 ? a.inv_step : 0.0, stride});
+            stride *= static_cast<size_t>(a.count);
+        }
+        if (stride != header.coefficients)
+            throw std::runtime_error(filepath + ": damaged compiled aero table");
+
+        table.CLs = array(header.cl_offset, header.coefficients);
+        table.CDs = array(header.cd_offset, header.coefficients);
+        table.coefficient_count = static_cast<size_t>(header.coefficients);
+        table.source_points = static_cast<size_t>(header.source_points);
+        table.storage = map;
+        table.mapped = true;
+        table.selectLookup();
+        if (source)
+            *source = {header.source_hash, header.source_size};
+        return table;
+    }
+
+    // True when lookups read from a memory-mapped compiled file
+    bool isMapped() const { return mapped; }
+
+private:
+    struct Axis
+    {
+        AeroAxis id;
+        const double *values; // Breakpoints (resampled grid for alpha), in 'storage'
+        size_t count;
+        bool uniform;
+        double inv_step; // 1 / spacing (uniform only)
+        size_t stride;   // Distance between neighbours in the coefficient arrays
+    };
+
+    // Compiled file layout: header, then each axis, CL and CD at its offset
+    struct CompiledAxis
+    {
+        uint32_t id;      // AeroAxis
+        uint32_t uniform; // 1 = inv_step gives direct indexing
+        uint64_t count;
+        uint64_t offset; // Bytes from the start of the file
+        double inv_step;
+    };
+
+    struct CompiledHeader
+    {
+        char magic[8];       // "FDAERO"
+        uint32_t version;    // COMPILED_VERSION
+        uint32_t byte_order; // BYTE_ORDER_MARK as the writer stored it
+        uint32_t dimensions;
+        uint32_t reserved;
+        uint64_t source_hash;
+        uint64_t source_size;
+        uint64_t source_points;
+        uint64_t coefficients; // Grid points (length of CL and of CD)
+        uint64_t cl_offset;
+        uint64_t cd_offset;
+        CompiledAxis axes[MAX_DIMENSIONS];
+        uint8_t padding[56];
+    };
+    static_assert(sizeof(CompiledHeader) == 256, "Compiled aero header layout changed");
+
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static constexpr size_t COMPILED_ALIGNMENT = 64;
+
+    typedef AeroCoefficients (AeroDataTable::*LookupFn)(const AeroQuery &) const;
+
+    std::vector<Axis> axes;
+    const double *CLs = nullptr; // Lift coefficients over the grid
+    const double *CDs = nullptr; // Drag coefficients over the grid
+    size_t coefficient_count = 0;
+    size_t source_points = 0;
+    std::shared_ptr<const void> storage; // Owns the arrays: a heap block or a MappedFile
+    bool mapped = false;
+    LookupFn lookup = &AeroDataTable::lookupEmpty;
+
+    // Largest alpha axis a non-uniform table may be resampled onto
+    static constexpr size_t MAX_RESAMPLED_POINTS = 1 << 16;
+
+    static uint64_t alignCompiled(uint64_t offset)
+    {
+        return (offset + COMPILED_ALIGNMENT - 1) / COMPILED_ALIGNMENT * COMPILED_ALIGNMENT;
+    }
+
+    static double axisValue(AeroAxis axis, double raw)
+    {
+        return axis == AeroAxis::Alpha ? raw * M_PI / 180.0 : raw;
+    }
+
+    // Columns a data row must have for the layout
+    static int requiredColumns(const std::vector<int> &axisColumns, int clColumn, int cdColumn)
+    {
+        int needed = std::max(clColumn, cdColumn);
+        for (int c : axisColumns)
+            needed = std::max(needed, c);
+        return needed + 1;
+    }
+
+    static void parseHeader(std::string_view line, const std::string &filepath, std::vector<int> &axisColumns,
+                            std::vector<AeroAxis> &axisIds, int &clColumn, int &cdColumn)
+    {
+        int column = 0;
+        int alphaColumn = -1;
+        std::vector<std::pair<AeroAxis, int>> others;
+        clColumn = cdColumn = -1;
+
+        size_t start = 0;
+        while (start <= line.size())
+        {
+            size_t comma = line.find(',', start);
+            std::string_view token = line.substr(start, comma == std::string_view::npos ? std::string_view::npos
+                                                                                        : comma - start);
+            // Lower case without whitespace (short names stay in the small-string buffer)
+            std::string name;
+            for (char ch : token)
             {
-                return data.back().CD;
+                if (!std::isspace(static_cast<unsigned char>(ch)))
+                    name += static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
             }
+
+            if (name == "alpha" || name == "aoa")
+                alphaColumn = column;
+            else if (name == "mach")
+                others.push_back({AeroAxis::Mach, column});
+            else if (name == "re" || name == "reynolds")
+                others.push_back({AeroAxis::Reynolds, column});
+            else if (name == "elevator" || name == "de")
+                others.push_back({AeroAxis::Elevator, column});
+            else if (name == "cl")
+                clColumn = column;
+            else if (name == "cd")
+                cdColumn = column;
+            column++;
+
+            if (comma == std::string_view::npos)
+                break;
+            start = comma + 1;
+        }
+
+        if (alphaColumn < 0 || clColumn < 0 || cdColumn < 0)
+        {
+            // Unrecognised header: keep the positional alpha,CL,CD layout
+            axisColumns = {0};
+            axisIds = {AeroAxis::Alpha};
+            clColumn = 1;
+            cdColumn = 2;
+            return;
+        }
+        if (others.size() + 1 > MAX_DIMENSIONS)
+            throw std::runtime_error("Too many axes in aero data file: " + filepath);
+
+        axisColumns = {alphaColumn};
+        axisIds = {AeroAxis::Alpha};
+        for (const auto &o : others)
+        {
+            axisIds.push_back(o.first);
+            axisColumns.push_back(o.second);
         }
-        return CD;
     }
 
-    // Get alpha range
-    double getMinAlpha() const { return data.empty() ? 0.0 : data.front().alpha; }
-    double getMaxAlpha() const { return data.empty() ? 0.0 : data.back().alpha; }
+    // Axes with a single breakpoint carry no information; dropping them keeps
+    // the corner count minimal (alpha is always kept). The coefficient layout
+    // does not change: a singleton axis has stride factor 1.
+    static void dropSingletonAxes(std::vector<GridAxis> &grid)
+    {
+        std::vector<GridAxis> kept;
+        for (size_t k = 0; k < grid.size(); k++)
+        {
+            if (k > 0 && grid[k].values.size() == 1)
+                continue;
+            kept.push_back(std::move(grid[k]));
+        }
+        grid.swap(kept);
+    }
 
-    bool isEmpty() const { return data.empty(); }
+    // Finish a table: resample alpha, move every array into one shared heap
+    // block and pick the lookup
+    static AeroDataTable build(std::vector<GridAxis> grid, std::vector<double> CL, std::vector<double> CD,
+                               size_t source_points)
+    {
+        if (!CL.empty() && grid[0].values.size() > 1)
+            resampleAlpha(grid, CL, CD);
 
-private:
-    std::vector<DataPoint> data;
+        size_t total = CL.size() + CD.size();
+        for (const GridAxis &g : grid)
+            total += g.values.size();
+        auto block = std::make_shared<std::vector<double>>();
+        block->reserve(total);
+        std::vector<size_t> starts;
+        for (const GridAxis &g : grid)
+        {
+            starts.push_back(block->size());
+            block->insert(block->end(), g.values.begin(), g.values.end());
+        }
+        const size_t cl_start = block->size();
+        block->insert(block->end(), CL.begin(), CL.end());
+        const size_t cd_start = block->size();
+        block->insert(block->end(), CD.begin(), CD.end());
 
-    // Linear interpolation helper with extrapolation
-    template <typename Func>
-    double interpolate(double alpha, Func getValue) const
+        AeroDataTable table;
+        size_t stride = 1;
+        for (size_t k = 0; k < grid.size(); k++)
+        {
+            table.axes.push_back({grid[k].axis, block->data() + starts[k], grid[k].values.size(), false, 0.0, stride});
+            detectUniform(table.axes.back());
+            stride *= grid[k].values.size();
+        }
+        table.CLs = block->data() + cl_start;
+        table.CDs = block->data() + cd_start;
+        table.coefficient_count = CL.size();
+        table.source_points = source_points;
+        table.storage = block;
+        table.selectLookup();
+        return table;
+    }
+
+    void selectLookup()
     {
-        if (data.empty())
-            return 0.0;
+        if (coefficient_count == 0)
+        {
+            lookup = &AeroDataTable::lookupEmpty;
+            return;
+        }
+        if (axes[0].count == 1)
+        {
+            lookup = &AeroDataTable::lookupSinglePoint;
+            return;
+        }
+
+        switch (axes.size())
+        {
+        case 1:
+            lookup = &AeroDataTable::lookupGrid<1>;
+            break;
+        case 2:
+            lookup = &AeroDataTable::lookupGrid<2>;
+            break;
+        case 3:
+            lookup = &AeroDataTable::lookupGrid<3>;
+            break;
+        default:
+            lookup = &AeroDataTable::lookupGrid<4>;
+            break;
+        }
+    }
 
-        if (data.size() == 1)
-            return getValue(data.front());
+    static void detectUniform(Axis &axis)
+    {
+        axis.uniform = false;
+        axis.inv_step = 0.0;
+        const double *v = axis.values;
+        const size_t n = axis.count;
+        if (n < 2)
+            return;
 
-        // Extrapolate below minimum alpha using slope from first two points
-        if (alpha < data.front().alpha)
+        double step = (v[n - 1] - v[0]) / static_cast<double>(n - 1);
+        if (step <= 0.0)
+            return;
+        for (size_t i = 0; i < n; i++)
         {
-            double slope = (getValue(data[1]) - getValue(data[0])) / (data[1].alpha - data[0].alpha);
-            double delta_alpha = alpha - data.front().alpha;
-            return getValue(data.front()) + slope * delta_alpha;
+            if (std::abs(v[i] - (v[0] + i * step)) > 1e-6 * step)
+                return;
         }
+        axis.uniform = true;
+        axis.inv_step = 1.0 / step;
+    }
+
+    // If every alpha spacing is a whole multiple of the finest one, resample each
+    // alpha slice onto the finer uniform grid. Grid nodes either coincide with data
+    // points or lie on a straight segment between two, so linear lookups on the
+    // resampled grid are exactly the same as on the source data.
+    static void resampleAlpha(std::vector<GridAxis> &grid, std::vector<double> &CLs, std::vector<double> &CDs)
+    {
+        const std::vector<double> src = grid[0].values;
+        const size_t n = src.size();
 
-        // Extrapolate above maximum alpha using slope from last two points
-        if (alpha > data.back().alpha)
+        // Finest spacing; every other spacing must be a whole multiple of it
+        double min_step = src[1] - src[0];
+        for (size_t i = 1; i + 1 < n; i++)
+            min_step = std::min(min_step, src[i + 1] - src[i]);
+        if (min_step <= 0.0)
+            return; // Duplicate alphas: keep binary search
+
+        double span = src.back() - src.front();
+        double cells = span / min_step;
+        if (std::abs(cells - std::round(cells)) > 1e-6 || cells + 1.0 > MAX_RESAMPLED_POINTS)
+            return;
+        for (size_t i = 0; i < n; i++)
         {
-            size_t n = data.size();
-            double slope = (getValue(data[n - 1]) - getValue(data[n - 2])) / (data[n - 1].alpha - data[n - 2].alpha);
-            double delta_alpha = alpha - data.back().alpha;
-            return getValue(data.back()) + slope * delta_alpha;
+            double k = (src[i] - src.front()) / min_step;
+            if (std::abs(k - std::round(k)) > 1e-6)
+                return;
         }
 
-        // Interpolate within data range
-        for (size_t i = 0; i < data.size() - 1; i++)
+        size_t count = static_cast<size_t>(std::round(cells)) + 1;
+        if (count == n)
+            return; // Already uniform
+        double step = span / static_cast<double>(count - 1);
+
+        std::vector<double> a(count);
+        std::vector<size_t> seg(count);
+        std::vector<double> frac(count);
+        size_t s = 0;
+        for (size_t k = 0; k < count; k++)
         {
-            if (alpha >= data[i].alpha && alpha <= data[i + 1].alpha)
+            double x = (k + 1 == count) ? src.back() : src.front() + k * step;
+            while (s + 2 < n && x > src[s + 1])
+                s++;
+            a[k] = x;
+            seg[k] = s;
+            frac[k] = (x - src[s]) / (src[s + 1] - src[s]);
+        }
+
+        size_t slices = CLs.size() / n;
+        std::vector<double> cl(count * slices), cd(count * slices);
+        for (size_t slice = 0; slice < slices; slice++)
+        {
+            const double *CLsrc = &CLs[slice * n];
+            const double *CDsrc = &CDs[slice * n];
+            for (size_t k = 0; k < count; k++)
             {
-                // Linear interpolation
-                double t = (alpha - data[i].alpha) / (data[i + 1].alpha - data[i].alpha);
-                return getValue(data[i]) + t * (getValue(data[i + 1]) - getValue(data[i]));
+                size_t j = seg[k];
+                cl[slice * count + k] = CLsrc[j] + frac[k] * (CLsrc[j + 1] - CLsrc[j]);
+                cd[slice * count + k] = CDsrc[j] + frac[k] * (CDsrc[j + 1] - CDsrc[j]);
             }
         }
 
-        return getValue(data.back());
+        grid[0].values.swap(a);
+        CLs.swap(cl);
+        CDs.swap(cd);
+    }
+
+    // Find cell i (values[i]..values[i+1]) and fraction t for x.
+    // Outside the axis the end cell is used, giving t < 0 or t > 1.
+    static void locate(const Axis &axis, double x, size_t &i, double &t)
+    {
+        const double *v = axis.values;
+        const size_t last = axis.count - 2;
+        if (axis.uniform)
+        {
+            double u = (x - v[0]) * axis.inv_step;
+            if (!(u > 0.0)) // NaN lands here rather than in the integer cast
+                i = 0;
+            else if (u >= static_cast<double>(last))
+                i = last;
+            else
+                i = static_cast<size_t>(u);
+            t = u - static_cast<double>(i);
+            return;
+        }
+
+        size_t upper = static_cast<size_t>(std::upper_bound(v, v + axis.count, x) - v);
+        i = upper == 0 ? 0 : std::min(upper - 1, last);
+        t = (x - v[i]) / (v[i + 1] - v[i]);
+    }
+
+    // Multilinear interpolation over N axes (alpha first)
+    template <size_t N>
+    AeroCoefficients lookupGrid(const AeroQuery &q) const
+    {
+        // Alpha: CL extrapolates, CD holds the end value
+        size_t i0;
+        double t_cl;
+        locate(axes[0], q.alpha, i0, t_cl);
+        double t_cd = std::min(1.0, std::max(0.0, t_cl));
+
+        // Other axes clamp to the grid
+        size_t base = i0;
+        double w[N > 1 ? N : 1] = {};
+        size_t stride[N > 1 ? N : 1] = {};
+        for (size_t k = 1; k < N; k++)
+        {
+            size_t i;
+            double t;
+            locate(axes[k], q.get(axes[k].id), i, t);
+            w[k] = std::min(1.0, std::max(0.0, t));
+            stride[k] = axes[k].stride;
+            base += i * stride[k];
+        }
+
+        // 2^(N-1) corners, each an adjacent pair along alpha
+        double CL = 0.0, CD = 0.0;
+        for (size_t corner = 0; corner < (size_t(1) << (N - 1)); corner++)
+        {
+            size_t offset = base;
+            double weight = 1.0;
+            for (size_t k = 1; k < N; k++)
+            {
+                if ((corner >> (k - 1)) & 1)
+                {
+                    offset += stride[k];
+                    weight *= w[k];
+                }
+                else
+                {
+                    weight *= 1.0 - w[k];
+                }
+            }
+            const double *cl = &CLs[offset];
+            const double *cd = &CDs[offset];
+            CL += weight * (cl[0] + t_cl * (cl[1] - cl[0]));
+            CD += weight * (cd[0] + t_cd * (cd[1] - cd[0]));
+        }
+
+        // Clamp CL to minimum of 0 only when extrapolating beyond known data
+        if (q.alpha < axes[0].values[0] || q.alpha > axes[0].values[axes[0].count - 1])
+            CL = std::max(0.0, CL);
+        return {CL, CD};
+    }
+
+    AeroCoefficients lookupSinglePoint(const AeroQuery &q) const
+    {
+        return {q.alpha == axes[0].values[0] ? CLs[0] : std::max(0.0, CLs[0]), CDs[0]};
+    }
+
+    AeroCoefficients lookupEmpty(const AeroQuery &) const
+    {
+        return {0.0, 0.0};
     }
 };
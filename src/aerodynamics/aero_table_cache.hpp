@@ -0,0 +1,244 @@
+#pragma once
+
+#include "aero_data.hpp"
+#include "../utils/mapped_file.hpp"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <system_error>
+#include <utility>
+
+// Process-wide cache of parsed aero tables
+//
+// Tables are immutable once built, so every aircraft that names the same data
+// shares one copy. Entries are keyed by canonical path and revalidated
+// against the file's modification time and size; on a change the file is
+// re-read and its bytes hashed, so identical contents under different names
+// (or a touched but unchanged file) still map to the same table.
+//
+// The cache holds weak references: a table is freed once the last aircraft
+// using it goes away, and is loaded again on the next load.
+//
+// A compiled .fdaero file next to a CSV (see compile() and
+// AeroDataTable::saveCompiled) is mapped instead of parsing when the hash and
+// size of the CSV it was built from match the CSV's current bytes, so a stale
+// file is never used whatever the timestamps say. The CSV is still read to
+// hash it; only the parse is skipped. Loading writes no files unless
+// setWriteCompiled(true) is called; releases compile ahead of time instead.
+class AeroTableCache
+{
+public:
+    struct Stats
+    {
+        size_t hits = 0;     // Served from a live table
+        size_t parses = 0;   // Files actually parsed
+        size_t compiled = 0; // Served by mapping a compiled file
+    };
+
+    static AeroTableCache &instance()
+    {
+        static AeroTableCache cache;
+        return cache;
+    }
+
+    // Shared table for a CSV file; throws like AeroDataTable::loadFromCSV
+    std::shared_ptr<const AeroDataTable> load(const std::string &filepath)
+    {
+        std::error_code ec;
+        std::filesystem::path canonical = std::filesystem::canonical(filepath, ec);
+        if (ec)
+            throw std::runtime_error("Failed to open aero data file: " + filepath);
+        std::filesystem::file_time_type mtime = std::filesystem::last_write_time(canonical, ec);
+        uintmax_t size = ec ? 0 : std::filesystem::file_size(canonical, ec);
+        if (ec)
+            throw std::runtime_error("Failed to open aero data file: " + filepath);
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Unchanged file with a live table
+        auto path_it = paths.find(canonical.string());
+        if (path_it != paths.end() && path_it->second.mtime == mtime && path_it->second.size == size)
+        {
+            if (std::shared_ptr<const AeroDataTable> table = lookup(path_it->second.content))
+            {
+                stats.hits++;
+                return table;
+            }
+        }
+
+        // Read the bytes once: hash them, and parse only if nothing else has them
+        MappedFile map;
+        try
+        {
+            map.open(canonical.string());
+        }
+        catch (const std::exception &)
+        {
+            throw std::runtime_error("Failed to open aero data file: " + filepath);
+        }
+        const char *text = reinterpret_cast<const char *>(map.data());
+        ContentKey content{AeroDataTable::hashBytes(text, map.size()), map.size()};
+        paths[canonical.string()] = {mtime, size, content};
+
+        if (std::shared_ptr<const AeroDataTable> live = lookup(content))
+        {
+            stats.hits++;
+            return live;
+        }
+
+        // A compiled table built from these exact bytes is used in place
+        const std::string compiled = AeroDataTable::compiledPath(canonical.string());
+        if (read_compiled && std::filesystem::exists(compiled, ec))
+        {
+            try
+            {
+                AeroDataTable::CompiledSource source;
+                AeroDataTable table = AeroDataTable::loadCompiled(compiled, &source);
+                if (source.hash == content.first && source.size == content.second)
+                {
+                    auto shared = std::make_shared<const AeroDataTable>(std::move(table));
+                    tables[content] = shared;
+                    stats.compiled++;
+                    return shared;
+                }
+            }
+            catch (const std::exception &)
+            {
+                // Damaged or another version: parse the CSV below
+            }
+        }
+
+        auto table = std::make_shared<const AeroDataTable>(AeroDataTable::parseCSV(text, text + map.size(), filepath));
+        tables[content] = table;
+        stats.parses++;
+        if (write_compiled)
+            writeCompiled(*table, compiled, {content.first, content.second});
+        return table;
+    }
+
+    // Map compiled .fdaero files that match their CSV (on by default)
+    void setUseCompiled(bool enabled)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        read_compiled = enabled;
+    }
+
+    // Write a compiled .fdaero file next to each CSV this cache parses (off by
+    // default, so a load never touches the data directory)
+    void setWriteCompiled(bool enabled)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        write_compiled = enabled;
+    }
+
+    // Compile one CSV to its .fdaero file (e.g. ahead of time for a release).
+    // Returns the compiled path; throws if the CSV cannot be parsed or the file written.
+    static std::string compile(const std::string &csvPath)
+    {
+        MappedFile map;
+        try
+        {
+            map.open(csvPath);
+        }
+        catch (const std::exception &)
+        {
+            throw std::runtime_error("Failed to open aero data file: " + csvPath);
+        }
+        const char *text = reinterpret_cast<const char *>(map.data());
+        AeroDataTable table = AeroDataTable::parseCSV(text, text + map.size(), csvPath);
+        std::string compiled = AeroDataTable::compiledPath(csvPath);
+        std::string temp = temporaryPath(compiled);
+        table.saveCompiled(temp, {AeroDataTable::hashBytes(text, map.size()), map.size()});
+        std::filesystem::rename(temp, compiled);
+        return compiled;
+    }
+
+    Stats getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+    // Number of tables still alive
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t n = 0;
+        for (const auto &t : tables)
+            n += t.second.expired() ? 0 : 1;
+        return n;
+    }
+
+    // Forget every entry (tables in use stay valid) and reset the stats
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        paths.clear();
+        tables.clear();
+        stats = Stats();
+    }
+
+private:
+    // AeroDataTable::hashBytes of the file contents, plus the length
+    using ContentKey = std::pair<uint64_t, size_t>;
+
+    struct PathEntry
+    {
+        std::filesystem::file_time_type mtime;
+        uintmax_t size;
+        ContentKey content;
+    };
+
+    AeroTableCache() = default;
+
+    // Sibling of target no other writer uses: the name carries a random
+    // per-process token and a per-call counter
+    static std::string temporaryPath(const std::string &target)
+    {
+        static const uint64_t process = (static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}();
+        static std::atomic<uint64_t> counter{0};
+        return target + ".tmp" + std::to_string(process) + "-" + std::to_string(counter++);
+    }
+
+    // Written next to the target and renamed, so other processes never map half a file
+    static void writeCompiled(const AeroDataTable &table, const std::string &compiled,
+                              const AeroDataTable::CompiledSource &source)
+    {
+        std::string temp = temporaryPath(compiled);
+        try
+        {
+            table.saveCompiled(temp, source);
+            std::filesystem::rename(temp, compiled);
+        }
+        catch (const std::exception &)
+        {
+            // Read-only directory, or the old file is mapped (Windows): parsed again next time
+            std::error_code ec;
+            std::filesystem::remove(temp, ec);
+        }
+    }
+
+    // Live table for the content, dropping the entry if it has expired
+    std::shared_ptr<const AeroDataTable> lookup(const ContentKey &content)
+    {
+        auto it = tables.find(content);
+        if (it == tables.end())
+            return nullptr;
+        std::shared_ptr<const AeroDataTable> table = it->second.lock();
+        if (!table)
+            tables.erase(it);
+        return table;
+    }
+
+    mutable std::mutex mutex;
+    std::map<std::string, PathEntry> paths;
+    std::map<ContentKey, std::weak_ptr<const AeroDataTable>> tables;
+    Stats stats;
+    bool read_compiled = true;
+    bool write_compiled = false;
+};
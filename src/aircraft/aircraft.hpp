@@ -2,10 +2,32 @@
 
 #include <string>
 #include <memory>
+#include <cstdint>
+#include <cstring>
 
 // Forward declaration
 class AeroDataTable;
 
+// Autopilot gains stored with a config (optional keys pid_kp, pid_ki, pid_kd,
+// alt_pid_kp, alt_pid_ki, alt_pid_kd). Defaults match SimulationState.
+struct AutopilotGains
+{
+    double speed_kp = 0.02;
+    double speed_ki = 0.001;
+    double speed_kd = 0.01;
+    double altitude_kp = 0.1;
+    double altitude_ki = 0.001;
+    double altitude_kd = 0.5;
+
+    // Gain by index in the order above, for code that treats all six alike
+    double &at(int i)
+    {
+        double *fields[6] = {&speed_kp, &speed_ki, &speed_kd, &altitude_kp, &altitude_ki, &altitude_kd};
+        return *fields[i];
+    }
+    double at(int i) const { return const_cast<AutopilotGains *>(this)->at(i); }
+};
+
 // Aircraft class representing a fixed-wing aircraft with its physical and aerodynamic properties
 class Aircraft
 {
@@ -22,24 +44,71 @@ public:
     // Propulsion
     double maxThrust; // Maximum thrust in N
 
+    // Geometry for Reynolds number (optional)
+    double chord; // Mean aerodynamic chord in m (0 = unknown)
+
     // Aerodynamic table data (optional, overrides legacy params if present)
-    std::shared_ptr<AeroDataTable> aeroTable;
+    std::shared_ptr<const AeroDataTable> aeroTable; // Shared, immutable (see AeroTableCache)
     std::string aeroDataFile; // Path to CSV file
 
+    // Tuned autopilot gains (not part of configHash: they do not change the airframe)
+    AutopilotGains autopilot;
+    bool autopilotFromConfig; // Set if the config file gave any of the gains
+
     // Default constructor with typical ultralight aircraft values
     Aircraft()
-        : mass(120.0), S(1.60), CL_alpha(5.7), CD0(0.025), k(0.04), maxThrust(500.0),
-          aeroTable(nullptr), aeroDataFile("")
+        : mass(120.0), S(1.60), CL_alpha(5.7), CD0(0.025), k(0.04), maxThrust(500.0), chord(0.0),
+          aeroTable(nullptr), aeroDataFile(""), autopilot(), autopilotFromConfig(false)
     {
     }
 
     // Constructor with custom values
     Aircraft(double mass_, double S_, double CL_alpha_, double CD0_, double k_, double maxThrust_)
-        : mass(mass_), S(S_), CL_alpha(CL_alpha_), CD0(CD0_), k(k_), maxThrust(maxThrust_),
-          aeroTable(nullptr), aeroDataFile("")
+        : mass(mass_), S(S_), CL_alpha(CL_alpha_), CD0(CD0_), k(k_), maxThrust(maxThrust_), chord(0.0),
+          aeroTable(nullptr), aeroDataFile(""), autopilot(), autopilotFromConfig(false)
     {
     }
 
     // Check if using table data
     bool hasAeroTable() const { return aeroTable != nullptr; }
+
+    // Copy that references the aero table without owning it: copies of the
+    // result (one per run or batch lane) never touch the table's atomic
+    // reference count. The owner of the table must outlive every copy.
+    Aircraft borrowed() const
+    {
+        Aircraft copy = *this;
+        // Aliasing constructor with an empty owner: non-null, but no control block
+        copy.aeroTable =
+            std::shared_ptr<const AeroDataTable>(std::shared_ptr<const AeroDataTable>(), aeroTable.get());
+        return copy;
+    }
+
+    // False for a borrowed() copy (and without a table)
+    bool ownsAeroTable() const { return aeroTable.use_count() > 0; }
+
+    // FNV-1a hash of the configuration (physical parameters and aero data
+    // file name), used to tie recordings and caches to the aircraft they
+    // were made with
+    uint64_t configHash() const
+    {
+        uint64_t h = 14695981039346656037ull;
+        auto mix = [&h](const void *data, size_t n)
+        {
+            const unsigned char *p = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < n; i++)
+            {
+                h ^= p[i];
+                h *= 1099511628211ull;
+            }
+        };
+        const double params[] = {mass, S, CL_alpha, CD0, k, maxThrust, chord};
+        for (double v : params)
+        {
+            double canonical = v == 0.0 ? 0.0 : v; // -0.0 and 0.0 hash the same
+            mix(&canonical, sizeof(canonical));
+        }
+        mix(aeroDataFile.data(), aeroDataFile.size());
+        return h;
+    }
 };
@@ -2,25 +2,41 @@
 
 #include "aircraft.hpp"
 #include "../aerodynamics/aero_data.hpp"
+#include "../aerodynamics/aero_table_cache.hpp"
+#include "../utils/mapped_file.hpp"
+#include "../utils/text_scanner.hpp"
 #include <string>
-#include <fstream>
+#include <string_view>
 #include <stdexcept>
-#include <sstream>
 #include <filesystem>
 #include <memory>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
 
-// Simple JSON parser for aircraft configuration
+// JSON parser for aircraft configuration
 // Expects format: { "key": value, ... }
+//
+// The file is memory mapped and read in one pass: keys are compared in place
+// and numbers converted with std::from_chars, so a config loads without
+// copying the text. Unknown keys (including nested objects and arrays) are
+// skipped; syntax errors throw ParseError with the line and column.
 class AircraftLoader
 {
 public:
+    // Optional autopilot gain keys, in AutopilotGains field order
+    static constexpr const char *GAIN_KEYS[6] = {"pid_kp", "pid_ki", "pid_kd", "alt_pid_kp", "alt_pid_ki", "alt_pid_kd"};
+
     static Aircraft loadFromJSON(const std::string &filepath)
     {
-        // Try to open the file with the given path
-        std::ifstream file(filepath);
-
-        // If that fails, try relative to various common locations
-        if (!file.is_open())
+        MappedFile map;
+        try
+        {
+            map.open(filepath);
+        }
+        catch (const std::exception &)
         {
             // Build a helpful error message with absolute path
             std::filesystem::path absPath;
@@ -37,32 +53,19 @@ public:
                                      "\n  Absolute path tried: " + absPath.string());
         }
 
-        std::string content((std::istreambuf_iterator<char>(file)),
-                            std::istreambuf_iterator<char>());
-        file.close();
+        const char *text = reinterpret_cast<const char *>(map.data());
+        Aircraft ac = parseJSON(text, text + map.size(), filepath);
 
-        // Parse JSON manually (simple approach for our known structure)
-        Aircraft ac;
-        ac.mass = parseDouble(content, "mass");
-        ac.S = parseDouble(content, "S");
-        ac.CL_alpha = parseDouble(content, "CL_alpha");
-        ac.CD0 = parseDouble(content, "CD0");
-        ac.k = parseDouble(content, "k");
-        ac.maxThrust = parseDouble(content, "maxThrust");
-
-        // Check for optional aeroDataFile field
-        std::string aeroFile = parseString(content, "aeroDataFile");
-        if (!aeroFile.empty())
+        // Load the aero data file next to the config (shared with every other
+        // config naming the same file)
+        if (!ac.aeroDataFile.empty())
         {
-            ac.aeroDataFile = aeroFile;
-
-            // Try to load the aero data file
             std::filesystem::path configDir = std::filesystem::path(filepath).parent_path();
-            std::filesystem::path aeroPath = configDir / aeroFile;
+            std::filesystem::path aeroPath = configDir / ac.aeroDataFile;
 
             try
             {
-                ac.aeroTable = std::make_shared<AeroDataTable>(AeroDataTable::loadFromCSV(aeroPath.string()));
+                ac.aeroTable = AeroTableCache::instance().load(aeroPath.string());
             }
             catch (const std::exception &e)
             {
@@ -75,97 +78,310 @@ public:
         return ac;
     }
 
-private:
-    static double parseDouble(const std::string &json, const std::string &key)
+    // Parse config text already in memory. Sets aeroDataFile but does not load
+    // the table (loadFromJSON resolves it relative to the config file).
+    static Aircraft parseJSON(const char *begin, const char *end, const std::string &source)
     {
-        // Find the key in the JSON string
-        std::string searchKey = "\"" + key + "\"";
-        size_t keyPos = json.find(searchKey);
-        if (keyPos == std::string::npos)
-        {
-            throw std::runtime_error("Key not found in JSON: " + key);
-        }
+        TextScanner scan(begin, end, source);
+        Aircraft ac;
+        bool found[6] = {false, false, false, false, false, false};
+        const char *names[6] = {"mass", "S", "CL_alpha", "CD0", "k", "maxThrust"};
+        double *fields[6] = {&ac.mass, &ac.S, &ac.CL_alpha, &ac.CD0, &ac.k, &ac.maxThrust};
+        std::string scratch;
 
-        // Find the colon after the key
-        size_t colonPos = json.find(':', keyPos);
-        if (colonPos == std::string::npos)
+        scan.skipWhitespace();
+        scan.expect('{', "'{' at start of config");
+        scan.skipWhitespace();
+        if (!scan.consume('}'))
         {
-            throw std::runtime_error("Invalid JSON format for key: " + key);
+            for (;;)
+            {
+                scan.skipWhitespace();
+                std::string_view key = readString(scan, scratch);
+                std::string keyName(key); // scratch may be reused by the value
+                scan.skipWhitespace();
+                scan.expect(':', "':' after key");
+                scan.skipWhitespace();
+
+                bool known = false;
+                for (int i = 0; i < 6; i++)
+                {
+                    if (keyName == names[i])
+                    {
+                        *fields[i] = readNumber(scan, keyName);
+                        found[i] = true;
+                        known = true;
+                    }
+                }
+                for (int i = 0; i < 6; i++)
+                {
+                    if (keyName == GAIN_KEYS[i])
+                    {
+                        ac.autopilot.at(i) = readNumber(scan, keyName);
+                        ac.autopilotFromConfig = true;
+                        known = true;
+                    }
+                }
+                if (keyName == "chord")
+                {
+                    ac.chord = readNumber(scan, keyName);
+                }
+                else if (keyName == "aeroDataFile")
+                {
+                    // Non-string values are ignored, as before
+                    if (scan.peek() == '"')
+                        ac.aeroDataFile = std::string(readString(scan, scratch));
+                    else
+                        skipValue(scan, 0);
+                }
+                else if (!known)
+                {
+                    skipValue(scan, 0);
+                }
+
+                scan.skipWhitespace();
+                if (scan.consume(','))
+                    continue;
+                scan.expect('}', "',' or '}' after value");
+                break;
+            }
         }
+        scan.skipWhitespace();
+        if (!scan.atEnd())
+            scan.fail("unexpected text after config object");
 
-        // Extract the value (skip whitespace and stop at comma or closing brace)
-        size_t valueStart = colonPos + 1;
-        while (valueStart < json.length() && (json[valueStart] == ' ' || json[valueStart] == '\t' || json[valueStart] == '\n'))
+        for (int i = 0; i < 6; i++)
         {
-            valueStart++;
+            if (!found[i])
+                throw std::runtime_error("Key not found in JSON: " + std::string(names[i]));
         }
+        return ac;
+    }
 
-        size_t valueEnd = valueStart;
-        while (valueEnd < json.length() && json[valueEnd] != ',' && json[valueEnd] != '}' && json[valueEnd] != '\n')
+    // Write autopilot gains into an existing config, keeping everything else
+    // (other keys, their order and formatting) as it is. Gains already in the
+    // file are replaced in place and missing ones appended to the object. The
+    // file is replaced by a rename, so a hot reload never sees it half written.
+    static void writeAutopilotGains(const std::string &filepath, const AutopilotGains &gains)
+    {
+        std::string text;
         {
-            valueEnd++;
+            std::ifstream in(filepath, std::ios::binary);
+            if (!in)
+            {
+                throw std::runtime_error("Failed to open aircraft config file: " + filepath);
+            }
+            text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
         }
 
-        std::string valueStr = json.substr(valueStart, valueEnd - valueStart);
+        struct Edit
+        {
+            size_t pos, length;
+            std::string replacement;
+        };
+        std::vector<Edit> edits;
+        bool found[6] = {false, false, false, false, false, false};
+        std::string indent = "    ";
+        std::string scratch;
+        const char *begin = text.data();
 
-        // Remove trailing whitespace
-        while (!valueStr.empty() && (valueStr.back() == ' ' || valueStr.back() == '\t' || valueStr.back() == '\r'))
+        TextScanner scan(begin, begin + text.size(), filepath);
+        scan.skipWhitespace();
+        scan.expect('{', "'{' at start of config");
+        size_t insert_at = static_cast<size_t>(scan.position() - begin);
+        scan.skipWhitespace();
+        bool empty = scan.consume('}');
+        if (!empty)
         {
-            valueStr.pop_back();
+            // New keys copy the indentation of the first one when it starts a line
+            const char *first = scan.position();
+            const char *line = first;
+            while (line > begin && line[-1] != '\n')
+                line--;
+            if (line > begin && std::all_of(line, first, [](char c) { return c == ' ' || c == '\t'; }))
+                indent.assign(line, first);
+
+            for (;;)
+            {
+                scan.skipWhitespace();
+                std::string keyName(readString(scan, scratch));
+                scan.skipWhitespace();
+                scan.expect(':', "':' after key");
+                scan.skipWhitespace();
+                size_t value_pos = static_cast<size_t>(scan.position() - begin);
+                skipValue(scan, 0);
+                insert_at = static_cast<size_t>(scan.position() - begin);
+                for (int i = 0; i < 6; i++)
+                {
+                    if (keyName == GAIN_KEYS[i])
+                    {
+                        edits.push_back({value_pos, insert_at - value_pos, formatNumber(gains.at(i))});
+                        found[i] = true;
+                    }
+                }
+
+                scan.skipWhitespace();
+                if (scan.consume(','))
+                    continue;
+                scan.expect('}', "',' or '}' after value");
+                break;
+            }
         }
 
-        try
+        std::string added;
+        for (int i = 0; i < 6; i++)
         {
-            return std::stod(valueStr);
+            if (found[i])
+                continue;
+            if (!added.empty() || !empty)
+                added += ",";
+            added += "\n" + indent + "\"" + GAIN_KEYS[i] + "\": " + formatNumber(gains.at(i));
         }
-        catch (const std::exception &e)
+        if (!added.empty())
+            edits.push_back({insert_at, 0, empty ? added + "\n" : added});
+
+        // Back to front so earlier offsets stay valid
+        std::sort(edits.begin(), edits.end(), [](const Edit &a, const Edit &b) { return a.pos > b.pos; });
+        for (const Edit &e : edits)
+            text.replace(e.pos, e.length, e.replacement);
+
+        std::string temp = filepath + ".tmp";
         {
-            throw std::runtime_error("Failed to parse value for key '" + key + "': " + valueStr);
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+            if (!out)
+            {
+                throw std::runtime_error("Failed to write aircraft config file: " + temp);
+            }
         }
+        std::filesystem::rename(temp, filepath);
     }
 
-    static std::string parseString(const std::string &json, const std::string &key)
+private:
+    // Six significant digits, more than the gain sliders show
+    static std::string formatNumber(double v)
     {
-        // Find the key in the JSON string
-        std::string searchKey = "\"" + key + "\"";
-        size_t keyPos = json.find(searchKey);
-        if (keyPos == std::string::npos)
-        {
-            return ""; // Key not found, return empty string
-        }
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.6g", v);
+        return buf;
+    }
 
-        // Find the colon after the key
-        size_t colonPos = json.find(':', keyPos);
-        if (colonPos == std::string::npos)
+    // Quoted string; a view into the buffer unless it has escapes, which are
+    // decoded into scratch
+    static std::string_view readString(TextScanner &scan, std::string &scratch)
+    {
+        scan.expect('"', "'\"'");
+        const char *start = scan.position();
+        bool escaped = false;
+        while (!scan.atEnd() && scan.peek() != '"')
         {
-            return "";
+            if (scan.peek() == '\n')
+                scan.fail("unterminated string");
+            if (scan.peek() == '\\')
+            {
+                escaped = true;
+                scan.advance();
+                if (scan.atEnd())
+                    break;
+            }
+            scan.advance();
         }
+        if (scan.atEnd())
+            scan.failAt(start - 1, "unterminated string");
+        std::string_view raw(start, static_cast<size_t>(scan.position() - start));
+        scan.advance(); // Closing quote
+        if (!escaped)
+            return raw;
 
-        // Skip whitespace after colon
-        size_t valueStart = colonPos + 1;
-        while (valueStart < json.length() && (json[valueStart] == ' ' || json[valueStart] == '\t' || json[valueStart] == '\n'))
+        scratch.clear();
+        for (size_t i = 0; i < raw.size(); i++)
         {
-            valueStart++;
+            char c = raw[i];
+            if (c != '\\')
+            {
+                scratch += c;
+                continue;
+            }
+            char e = raw[++i];
+            switch (e)
+            {
+            case 'n':
+                scratch += '\n';
+                break;
+            case 't':
+                scratch += '\t';
+                break;
+            case 'r':
+                scratch += '\r';
+                break;
+            case 'b':
+                scratch += '\b';
+                break;
+            case 'f':
+                scratch += '\f';
+                break;
+            case '"':
+            case '\\':
+            case '/':
+                scratch += e;
+                break;
+            default:
+                // \uXXXX is not needed for file names and keys here
+                scan.failAt(start + i - 1, std::string("unsupported escape '\\") + e + "'");
+            }
         }
+        return scratch;
+    }
+
+    static double readNumber(TextScanner &scan, const std::string &key)
+    {
+        if (scan.peek() != '-' && !(scan.peek() >= '0' && scan.peek() <= '9'))
+            scan.fail("expected a number for key '" + key + "'");
+        return scan.number();
+    }
 
-        // Check if value is a string (starts with quote)
-        if (valueStart >= json.length() || json[valueStart] != '"')
+    // Skip any JSON value (used for keys the loader does not know)
+    static void skipValue(TextScanner &scan, int depth)
+    {
+        if (depth > 64)
+            scan.fail("nesting too deep");
+        std::string scratch;
+        char c = scan.peek();
+        if (c == '"')
         {
-            return "";
+            readString(scan, scratch);
         }
-
-        // Find closing quote
-        size_t valueEnd = valueStart + 1;
-        while (valueEnd < json.length() && json[valueEnd] != '"')
+        else if (c == '{' || c == '[')
         {
-            valueEnd++;
+            char close = c == '{' ? '}' : ']';
+            scan.advance();
+            scan.skipWhitespace();
+            if (scan.consume(close))
+                return;
+            for (;;)
+            {
+                scan.skipWhitespace();
+                if (c == '{')
+                {
+                    readString(scan, scratch);
+                    scan.skipWhitespace();
+                    scan.expect(':', "':' after key");
+                    scan.skipWhitespace();
+                }
+                skipValue(scan, depth + 1);
+                scan.skipWhitespace();
+                if (scan.consume(','))
+                    continue;
+                if (!scan.consume(close))
+                    scan.fail(close == '}' ? "expected ',' or '}'" : "expected ',' or ']'");
+                return;
+            }
         }
-
-        if (valueEnd >= json.length())
+        else if (!scan.consume("true") && !scan.consume("false") && !scan.consume("null"))
         {
-            return "";
+            if (c != '-' && !(c >= '0' && c <= '9'))
+                scan.fail("expected a value");
+            scan.number();
         }
-
-        return json.substr(valueStart + 1, valueEnd - valueStart - 1);
     }
 };
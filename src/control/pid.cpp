@@ -1,4 +1,5 @@
 #include "pid.hpp"
+#include "../core/profiler.hpp"
 #include <algorithm>  // for std::clamp
 
 /**
@@ -23,6 +24,8 @@ PIDController::PIDController(double Kp, double Ki, double Kd,
 
 double PIDController::update(double setpoint, double measurement, double dt)
 {
+    PROFILE_ZONE(ProfileZone::PID);
+
     // STEP 1: Calculate current error
     // Positive error means we're below setpoint (need to increase output)
     double error = setpoint - measurement;
@@ -85,3 +88,35 @@ void PIDController::setOutputLimits(double min, double max)
     output_min = min;
     output_max = max;
 }
+
+void PIDController::setGains(double new_Kp, double new_Ki, double new_Kd)
+{
+    // Keep i_term = Ki * integral continuous where the new Ki allows it
+    // (with Ki = 0 the integral contributes nothing and is left as is)
+    if (new_Ki > 1e-12) {
+        integral *= Ki / new_Ki;
+    }
+    Kp = new_Kp;
+    Ki = new_Ki;
+    Kd = new_Kd;
+
+    // Respect the anti-windup bound of the new gains
+    double max_integral = (output_max - output_min) / (Ki + 1e-10);
+    integral = std::clamp(integral, -max_integral, max_integral);
+    i_term = Ki * integral;
+}
+
+PIDController::State PIDController::getState() const
+{
+    return {integral, previous_error, first_update, p_term, i_term, d_term};
+}
+
+void PIDController::setState(const State& state)
+{
+    integral = state.integral;
+    previous_error = state.previous_error;
+    first_update = state.first_update;
+    p_term = state.p_term;
+    i_term = state.i_term;
+    d_term = state.d_term;
+}
@@ -79,6 +79,15 @@ public:
      */
     void setOutputLimits(double min, double max);
 
+    /**
+     * Retune the controller without resetting it (bumpless transfer)
+     * The integral is rescaled so the integral term Ki * integral stays the
+     * same, so changing Ki mid-flight does not kick the output; integral and
+     * previous error are otherwise kept. Cheaper and smoother than
+     * constructing a new controller whenever a gain slider moves.
+     */
+    void setGains(double Kp, double Ki, double Kd);
+
     /**
      * Get individual term contributions (for tuning/debugging)
      */
@@ -86,6 +95,33 @@ public:
     double getIntegralTerm() const { return i_term; }
     double getDerivativeTerm() const { return d_term; }
 
+    /**
+     * Gains and limits (for snapshots and tuning readouts)
+     */
+    double getKp() const { return Kp; }
+    double getKi() const { return Ki; }
+    double getKd() const { return Kd; }
+    double getOutputMin() const { return output_min; }
+    double getOutputMax() const { return output_max; }
+
+    /**
+     * Internal state carried between updates
+     * Restoring a saved State into a controller with the same gains makes it
+     * continue exactly as the original would have (used by simulation
+     * checkpoints for rewind and forked runs).
+     */
+    struct State {
+        double integral;
+        double previous_error;
+        bool first_update;
+        double p_term;
+        double i_term;
+        double d_term;
+    };
+
+    State getState() const;
+    void setState(const State& state);
+
 private:
     // PID gains
     double Kp;  // Proportional gain
@@ -0,0 +1,98 @@
+#include "pid_bank.hpp"
+#include "../core/batch_kernel.hpp"
+#include "../core/profiler.hpp"
+#include <algorithm>
+
+namespace
+{
+// Anti-windup bound for a gain set (the same expression as PIDController::update)
+double maxIntegral(double Ki, double output_min, double output_max)
+{
+    return (output_max - output_min) / (Ki + 1e-10);
+}
+
+// One pass over all controllers; PIDController::update written with selects
+BATCH_KERNEL void updateKernel(size_t n, const float *__restrict setpoint, const double *__restrict measurement,
+                               double dt, const uint8_t *__restrict enabled, const double *__restrict Kp,
+                               const double *__restrict Ki, const double *__restrict Kd,
+                               const double *__restrict out_min, const double *__restrict out_max,
+                               const double *__restrict max_integral, double *__restrict integral,
+                               double *__restrict previous_error, double *__restrict first_update,
+                               float *__restrict output)
+{
+    const double derivative_gate = dt > 1e-10 ? 1.0 : 0.0;
+    const double dt_safe = dt > 1e-10 ? dt : 1.0;
+    for (size_t i = 0; i < n; i++)
+    {
+        double error = setpoint[i] - measurement[i];
+        double integ = std::min(std::max(integral[i] + error * dt, -max_integral[i]), max_integral[i]);
+        double gate = (1.0 - first_update[i]) * derivative_gate;
+        double derivative = gate * ((error - previous_error[i]) / dt_safe);
+        double out = Kp[i] * error + Ki[i] * integ + Kd[i] * derivative;
+        out = std::min(std::max(out, out_min[i]), out_max[i]);
+
+        bool on = enabled[i] != 0;
+        integral[i] = on ? integ : integral[i];
+        previous_error[i] = on ? error : previous_error[i];
+        first_update[i] = on ? 0.0 : first_update[i];
+        output[i] = on ? static_cast<float>(out) : output[i];
+    }
+}
+} // namespace
+
+void PIDBank::resize(size_t n)
+{
+    size_t old = count;
+    count = n;
+    for (std::vector<double> *v : {&Kp, &Ki, &Kd, &out_min, &out_max, &max_integral, &integral, &previous_error,
+                                   &first_update})
+        v->resize(n);
+    for (size_t i = old; i < n; i++)
+        configure(i, 0.0, 0.0, 0.0, -1.0, 1.0);
+}
+
+void PIDBank::configure(size_t i, double kp, double ki, double kd, double output_min, double output_max)
+{
+    Kp[i] = kp;
+    Ki[i] = ki;
+    Kd[i] = kd;
+    out_min[i] = output_min;
+    out_max[i] = output_max;
+    max_integral[i] = maxIntegral(ki, output_min, output_max);
+    reset(i);
+}
+
+void PIDBank::setGains(size_t i, double kp, double ki, double kd)
+{
+    // Keep the integral term Ki * integral where the new Ki allows it
+    if (ki > 1e-12)
+        integral[i] *= Ki[i] / ki;
+    Kp[i] = kp;
+    Ki[i] = ki;
+    Kd[i] = kd;
+    max_integral[i] = maxIntegral(ki, out_min[i], out_max[i]);
+    integral[i] = std::clamp(integral[i], -max_integral[i], max_integral[i]);
+}
+
+void PIDBank::setOutputLimits(size_t i, double min, double max)
+{
+    out_min[i] = min;
+    out_max[i] = max;
+    max_integral[i] = maxIntegral(Ki[i], min, max);
+}
+
+void PIDBank::reset(size_t i)
+{
+    integral[i] = 0.0;
+    previous_error[i] = 0.0;
+    first_update[i] = 1.0;
+}
+
+void PIDBank::update(const float* setpoint, const double* measurement, double dt, const uint8_t* enabled,
+                     float* output)
+{
+    PROFILE_ZONE(ProfileZone::PID);
+    updateKernel(count, setpoint, measurement, dt, enabled, Kp.data(), Ki.data(), Kd.data(), out_min.data(),
+                 out_max.data(), max_integral.data(), integral.data(), previous_error.data(), first_update.data(),
+                 output);
+}
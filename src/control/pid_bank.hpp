@@ -0,0 +1,77 @@
+#ifndef PID_BANK_HPP
+#define PID_BANK_HPP
+
+#include "pid.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Bank of N independent PID controllers updated in one pass
+ *
+ * Same update rule as PIDController::update, but every gain, limit and
+ * state variable lives in its own contiguous array (structure of arrays).
+ * update() is a single loop without calls or branches, so the compiler
+ * vectorizes it: one call advances thousands of controllers (batch lanes,
+ * sweep cases) for about the cost of a few scalar updates.
+ *
+ * GAIN CHANGES:
+ * setGains() retunes a controller in place. The integral is rescaled so
+ * Ki * integral (the integral term) is unchanged, so the output does not
+ * jump when Ki changes (bumpless transfer) and the accumulated state is
+ * kept, unlike constructing a new controller.
+ */
+class PIDBank {
+public:
+    explicit PIDBank(size_t n = 0) { resize(n); }
+
+    size_t size() const { return count; }
+
+    /**
+     * Change the number of controllers
+     * New controllers have zero gains, limits [-1, 1] and a reset state.
+     */
+    void resize(size_t n);
+
+    /**
+     * Set gains and limits of controller i and reset it
+     * (the same as assigning a new PIDController)
+     */
+    void configure(size_t i, double Kp, double Ki, double Kd, double output_min, double output_max);
+
+    /**
+     * Retune controller i keeping its state (bumpless, see above)
+     */
+    void setGains(size_t i, double Kp, double Ki, double Kd);
+
+    void setOutputLimits(size_t i, double min, double max);
+
+    /**
+     * Clear integral and previous error of controller i
+     */
+    void reset(size_t i);
+
+    /**
+     * Advance every controller whose enabled flag is non-zero by dt
+     * and write its output; disabled controllers and their outputs are
+     * left untouched. All arrays hold size() elements.
+     */
+    void update(const float* setpoint, const double* measurement, double dt, const uint8_t* enabled,
+                float* output);
+
+    double getKp(size_t i) const { return Kp[i]; }
+    double getKi(size_t i) const { return Ki[i]; }
+    double getKd(size_t i) const { return Kd[i]; }
+    double getOutputMin(size_t i) const { return out_min[i]; }
+    double getOutputMax(size_t i) const { return out_max[i]; }
+    double getIntegral(size_t i) const { return integral[i]; }
+
+private:
+    size_t count = 0;
+    std::vector<double> Kp, Ki, Kd, out_min, out_max;
+    std::vector<double> max_integral; // Anti-windup bound, as in PIDController::update
+    std::vector<double> integral, previous_error;
+    std::vector<double> first_update; // 1.0 until the first update (double keeps the kernel single-width)
+};
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+// Monotonic (bump) arena
+//
+// allocate() hands out consecutive bytes from a list of blocks and
+// deallocate() does nothing, so an allocation costs a pointer bump and a
+// whole run's worth of memory is released at once by rewinding: rewind(mark)
+// drops everything allocated after mark() was taken, reset() drops
+// everything. Blocks are kept when rewinding, so after the first few runs an
+// arena that is rewound between runs stops calling the upstream allocator
+// altogether. Not thread-safe: use one arena per thread.
+//
+// It is a std::pmr::memory_resource, so pmr containers can live in it.
+// Objects must be destroyed (or never touched again) before the memory
+// under them is rewound.
+class MonotonicArena : public std::pmr::memory_resource {
+public:
+    // Position to rewind to
+    struct Mark {
+        size_t block = 0;
+        size_t offset = 0;
+    };
+
+    explicit MonotonicArena(size_t initial_bytes = 64 * 1024)
+        : initial_bytes(std::max<size_t>(initial_bytes, 256)), current(0), offset(0), high_water(0) {}
+
+    ~MonotonicArena() override {
+        for (Block& b : blocks)
+            ::operator delete(b.data);
+    }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    Mark mark() const { return {current, offset}; }
+
+    void rewind(const Mark& m) {
+        current = m.block;
+        offset = m.offset;
+    }
+
+    void reset() { rewind(Mark()); }
+
+    // Bytes handed out since the last reset (including alignment padding)
+    size_t used() const {
+        size_t total = offset;
+        for (size_t i = 0; i < current && i < blocks.size(); i++)
+            total += blocks[i].size;
+        return total;
+    }
+
+    // Bytes held from the upstream allocator
+    size_t capacity() const {
+        size_t total = 0;
+        for (const Block& b : blocks)
+            total += b.size;
+        return total;
+    }
+
+    size_t blockCount() const { return blocks.size(); }
+
+    // Most bytes ever in use at once
+    size_t highWater() const { return high_water; }
+
+    // Typed allocation of n uninitialized objects
+    template <typename T>
+    T* allocateArray(size_t n) {
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t initial_bytes;
+    size_t current; // Block being bumped
+    size_t offset;  // Next free byte in blocks[current]
+    size_t high_water;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        for (;;) {
+            if (current < blocks.size()) {
+                Block& b = blocks[current];
+                uintptr_t base = reinterpret_cast<uintptr_t>(b.data);
+                uintptr_t aligned = (base + offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+                size_t end = static_cast<size_t>(aligned - base) + bytes;
+                if (end <= b.size) {
+                    offset = end;
+                    high_water = std::max(high_water, used());
+                    return reinterpret_cast<void*>(aligned);
+                }
+                if (offset == 0 && b.size < bytes + alignment) {
+                    // Nothing lives in this block (it is past the rewind point): replace it
+                    // by one that fits instead of skipping it forever
+                    ::operator delete(b.data);
+                    b.size = growSize(bytes + alignment);
+                    b.data = static_cast<char*>(::operator new(b.size));
+                    continue;
+                }
+                if (current + 1 < blocks.size()) {
+                    current++;
+                    offset = 0;
+                    continue;
+                }
+            }
+            // Out of blocks: add one at least twice the size of the last
+            size_t size = growSize(bytes + alignment);
+            blocks.push_back({static_cast<char*>(::operator new(size)), size});
+            current = blocks.size() - 1;
+            offset = 0;
+        }
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    size_t growSize(size_t needed) const {
+        size_t size = blocks.empty() ? initial_bytes : blocks.back().size * 2;
+        return std::max(size, needed);
+    }
+};
+
+#endif // ARENA_HPP
@@ -0,0 +1,14 @@
+#ifndef BATCH_KERNEL_HPP
+#define BATCH_KERNEL_HPP
+
+// Keeps a kernel out of line: GCC drops __restrict on inlined parameters,
+// and without it loops with many arrays are not vectorized
+#if defined(_MSC_VER)
+#define BATCH_KERNEL __declspec(noinline)
+#elif defined(__GNUC__)
+#define BATCH_KERNEL __attribute__((noinline))
+#else
+#define BATCH_KERNEL
+#endif
+
+#endif // BATCH_KERNEL_HPP
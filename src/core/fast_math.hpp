@@ -0,0 +1,70 @@
+#ifndef FAST_MATH_HPP
+#define FAST_MATH_HPP
+
+#include <cmath>
+
+// Branch-free double precision sin/cos and atan2 for batched kernels
+//
+// libm calls cannot be vectorized, so a loop over thousands of aircraft
+// spends most of its time in them. These versions use only arithmetic and
+// selects (Cephes polynomials with Cody-Waite range reduction), so the
+// compiler can vectorize loops that call them. Accuracy is within a few
+// ulp of libm for the ranges used by the physics (|x| up to a few pi).
+namespace fastmath {
+
+// sin(x) and cos(x) in one call
+inline void sincos(double x, double &s, double &c) {
+    // Reduce to r in [-pi/4, pi/4] with x = q * pi/2 + r
+    const double round_magic = 6755399441055744.0; // 1.5 * 2^52: adding it rounds to an integer
+    double q = (x * 0.63661977236758134308 + round_magic) - round_magic;
+    double r = (x - q * 1.57079632673412561417e+00) - q * 6.07710050650619224932e-11; // pi/2 in two parts
+    double z = r * r;
+
+    double sin_r = r + r * z * (((((1.58962301576546568060e-10 * z - 2.50507477628578072866e-8) * z +
+                                   2.75573136213857245213e-6) * z - 1.98412698295895385996e-4) * z +
+                                 8.33333333332211858878e-3) * z - 1.66666666666666307295e-1);
+    double cos_r = 1.0 - 0.5 * z + z * z * (((((-1.13585365213876817300e-11 * z + 2.08757008419747316778e-9) * z -
+                                                2.75573141792967388112e-7) * z + 2.48015872888517045348e-5) * z -
+                                              1.38888888888730564116e-3) * z + 4.16666666666665929218e-2);
+
+    // Quadrant q mod 4 rotates (sin_r, cos_r)
+    double m = q - 4.0 * ((q * 0.25 - 0.375 + round_magic) - round_magic); // floor(q / 4) for integer q
+    bool swap = m == 1.0 || m == 3.0;
+    double s0 = swap ? cos_r : sin_r;
+    double c0 = swap ? sin_r : cos_r;
+    s = (m >= 2.0) ? -s0 : s0;
+    c = (m == 1.0 || m == 2.0) ? -c0 : c0;
+}
+
+// atan2(y, x) (atan2(0, 0) = 0)
+inline double atan2(double y, double x) {
+    double ax = std::abs(x);
+    double ay = std::abs(y);
+    double hi = ax > ay ? ax : ay;
+    double lo = ax > ay ? ay : ax;
+
+    // atan(lo / hi) with lo / hi in [0, 1]; above tan(pi/8) it is reduced with
+    // atan(a) = pi/4 + atan((a - 1) / (a + 1)), folded into a single division
+    bool big = lo > 0.41421356237309504880 * hi;
+    double num = big ? lo - hi : lo;
+    double den = big ? lo + hi : hi;
+    double u = den > 0.0 ? num / den : 0.0;
+    double z = u * u;
+    double p = (((-8.750608600031904122785e-1 * z - 1.615753718733365076637e1) * z -
+                 7.500855792314704667340e1) * z - 1.228866684490136173410e2) * z -
+               6.485021904942025371773e1;
+    double qd = ((((z + 2.485846490142306297962e1) * z + 1.650270098316988542046e2) * z +
+                  4.328810604912902668951e2) * z + 4.853903996359136964868e2) * z +
+                1.945506571482613964425e2;
+    double t = u + u * z * p / qd;
+    t = big ? t + (7.85398163397448309616e-1 + 3.061616997868382943065e-17) : t;
+
+    // Undo the octant folding
+    t = ay > ax ? (1.57079632679489661923 - t) : t;
+    t = x < 0.0 ? (3.14159265358979323846 - t) : t;
+    return std::copysign(t, y);
+}
+
+} // namespace fastmath
+
+#endif
@@ -45,3 +45,22 @@ void integrateRK4(Vec2& position, Vec2& velocity, const Vec2& acceleration, doub
     velocity = velocity + (k1_vel + k2_vel * 2.0 + k3_vel * 2.0 + k4_vel) * (dt / 6.0);
     position = position + (k1_pos + k2_pos * 2.0 + k3_pos * 2.0 + k4_pos) * (dt / 6.0);
 }
+
+// Weighted RMS norm used by the adaptive step controller
+// Each component is scaled by abs_tol + rel_tol * max(|y0|, |y1|), so
+// positions of hundreds of meters and pitch rates near zero are both
+// controlled sensibly.
+double errorNorm(const FlightState& error, const FlightState& y0, const FlightState& y1, const AdaptiveOptions& opts) {
+    auto term = [&opts](double e, double a, double b) {
+        double scale = opts.abs_tol + opts.rel_tol * std::max(std::abs(a), std::abs(b));
+        double r = e / scale;
+        return r * r;
+    };
+    double sum = term(error.position.x, y0.position.x, y1.position.x) +
+                 term(error.position.y, y0.position.y, y1.position.y) +
+                 term(error.velocity.x, y0.velocity.x, y1.velocity.x) +
+                 term(error.velocity.y, y0.velocity.y, y1.velocity.y) +
+                 term(error.pitch_deg, y0.pitch_deg, y1.pitch_deg) +
+                 term(error.pitch_rate, y0.pitch_rate, y1.pitch_rate);
+    return std::sqrt(sum / 6.0);
+}
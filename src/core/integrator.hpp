@@ -2,9 +2,139 @@
 #define INTEGRATOR_HPP
 
 #include "vec2.hpp"
+#include <algorithm>
+#include <cmath>
 
 // Generic RK4 integrator for position and velocity
 // Uses Runge-Kutta 4th order method (RK4)
+// NOTE: the acceleration is held constant over the step, so this is only as
+// accurate as the force evaluation that produced it. Use the FlightState
+// overloads below to re-evaluate forces at every stage.
 void integrateRK4(Vec2& position, Vec2& velocity, const Vec2& acceleration, double dt);
 
+// Full state of the 2D flight model integrated by the coupled methods
+// The derivative of a FlightState is again a FlightState
+// (velocity, acceleration, pitch rate, pitch acceleration).
+struct FlightState {
+    Vec2 position;     // m
+    Vec2 velocity;     // m/s
+    double pitch_deg;  // deg
+    double pitch_rate; // deg/s
+
+    constexpr FlightState operator+(const FlightState& o) const {
+        return {position + o.position, velocity + o.velocity, pitch_deg + o.pitch_deg, pitch_rate + o.pitch_rate};
+    }
+
+    constexpr FlightState operator*(double s) const {
+        return {position * s, velocity * s, pitch_deg * s, pitch_rate * s};
+    }
+};
+
+// Tolerances for the adaptive integrator. A step is accepted when the RMS of
+// the error estimate, each component scaled by abs_tol + rel_tol * |y|, is <= 1.
+struct AdaptiveOptions {
+    double rel_tol = 1e-6;
+    double abs_tol = 1e-6;
+    double min_dt = 1e-6; // Steps are never shrunk below this (accepted anyway)
+    double max_dt = 1.0;
+};
+
+// Counters from one integrateAdaptive call
+struct AdaptiveStats {
+    int accepted = 0;
+    int rejected = 0;
+    int evaluations = 0; // Derivative evaluations
+};
+
+// RMS of the error scaled by the per-component tolerance (<= 1 means accept)
+// Other state types used with integrateAdaptive provide their own overload.
+double errorNorm(const FlightState& error, const FlightState& y0, const FlightState& y1, const AdaptiveOptions& opts);
+
+// Classic RK4 with the derivative f(t, y) evaluated at every stage
+template <typename State, typename Derivative>
+State integrateRK4(const State& y, double t, double dt, Derivative&& f) {
+    State k1 = f(t, y);
+    State k2 = f(t + 0.5 * dt, y + k1 * (0.5 * dt));
+    State k3 = f(t + 0.5 * dt, y + k2 * (0.5 * dt));
+    State k4 = f(t + dt, y + k3 * dt);
+    return y + (k1 + k2 * 2.0 + k3 * 2.0 + k4) * (dt / 6.0);
+}
+
+// One Dormand-Prince 5(4) step from (t, y) with slope k1 = f(t, y)
+// Returns the 5th order solution; error gets the difference to the embedded
+// 4th order solution and k7 = f(t + dt, result), which is the next step's k1
+// (first same as last).
+template <typename State, typename Derivative>
+State stepDormandPrince(const State& y, const State& k1, double t, double dt, Derivative&& f, State& error,
+                        State& k7) {
+    State k2 = f(t + dt * (1.0 / 5.0), y + k1 * (dt * (1.0 / 5.0)));
+    State k3 = f(t + dt * (3.0 / 10.0), y + (k1 * (3.0 / 40.0) + k2 * (9.0 / 40.0)) * dt);
+    State k4 = f(t + dt * (4.0 / 5.0), y + (k1 * (44.0 / 45.0) + k2 * (-56.0 / 15.0) + k3 * (32.0 / 9.0)) * dt);
+    State k5 = f(t + dt * (8.0 / 9.0), y + (k1 * (19372.0 / 6561.0) + k2 * (-25360.0 / 2187.0) +
+                                            k3 * (64448.0 / 6561.0) + k4 * (-212.0 / 729.0)) * dt);
+    State k6 = f(t + dt, y + (k1 * (9017.0 / 3168.0) + k2 * (-355.0 / 33.0) + k3 * (46732.0 / 5247.0) +
+                              k4 * (49.0 / 176.0) + k5 * (-5103.0 / 18656.0)) * dt);
+    State result = y + (k1 * (35.0 / 384.0) + k3 * (500.0 / 1113.0) + k4 * (125.0 / 192.0) +
+                        k5 * (-2187.0 / 6784.0) + k6 * (11.0 / 84.0)) * dt;
+    k7 = f(t + dt, result);
+    error = (k1 * (71.0 / 57600.0) + k3 * (-71.0 / 16695.0) + k4 * (71.0 / 1920.0) + k5 * (-17253.0 / 339200.0) +
+             k6 * (22.0 / 525.0) + k7 * (-1.0 / 40.0)) * dt;
+    return result;
+}
+
+// Integrate y over [t, t + interval] with error-controlled Dormand-Prince
+// substeps. dt_hint is the first substep to try and receives the suggested
+// size for the next call, so smooth segments (cruise) keep taking large
+// steps while fast transients shrink them.
+template <typename State, typename Derivative>
+AdaptiveStats integrateAdaptive(State& y, double t, double interval, double& dt_hint, const AdaptiveOptions& opts,
+                                Derivative&& f) {
+    AdaptiveStats stats;
+    const double t_end = t + interval;
+    double h = dt_hint > 0.0 ? dt_hint : interval;
+    h = std::min(std::max(h, opts.min_dt), opts.max_dt);
+
+    State k1 = f(t, y);
+    stats.evaluations = 1;
+    while (t_end - t > 1e-12 * std::max(1.0, std::abs(t_end))) {
+        // Land exactly on the interval end; remember the unclipped size for the hint
+        double step = std::min(h, t_end - t);
+
+        State error, k7;
+        State y_new = stepDormandPrince(y, k1, t, step, f, error, k7);
+        stats.evaluations += 6;
+        double err = errorNorm(error, y, y_new, opts);
+
+        // Standard controller: h_new = h * 0.9 * err^(-1/5), growth limited to [0.2, 5].
+        // A non-finite error (the derivative produced NaN or inf) shrinks the step.
+        const bool finite = std::isfinite(err);
+        double factor = !finite ? 0.2 : err > 0.0 ? 0.9 * std::pow(err, -0.2) : 5.0;
+        factor = std::min(5.0, std::max(0.2, factor));
+
+        if (!finite && step <= opts.min_dt) {
+            // Diverged even at the smallest step: carry the non-finite state to
+            // the interval end in one go, as the fixed-step methods do
+            y = y_new;
+            t = t_end;
+            stats.accepted++;
+            break;
+        }
+        if (!(err <= 1.0) && step > opts.min_dt) {
+            // Written so a NaN error lands here: reject and shrink
+            stats.rejected++;
+            h = std::max(opts.min_dt, step * factor);
+        } else {
+            y = y_new;
+            k1 = k7;
+            t += step;
+            stats.accepted++;
+            // A step clipped to the interval end says little about h; keep it
+            if (step >= h)
+                h = std::min(opts.max_dt, std::max(opts.min_dt, step * factor));
+        }
+    }
+    dt_hint = h;
+    return stats;
+}
+
 #endif
@@ -0,0 +1,401 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Hot-path timing zones
+//
+// PROFILE_ZONE(ProfileZone::Physics) times the rest of the enclosing scope and
+// appends {zone, start, duration} to a ring buffer owned by the calling
+// thread, so recording never locks or allocates once that thread's ring
+// exists. Readers (the profiler panel, trace export) copy events out of every
+// ring and drop any slot the writer may have reused during the copy.
+//
+// Zones are compiled in only when FLIGHT_PROFILER is defined non-zero (the
+// CMake option of the same name); otherwise PROFILE_ZONE expands to nothing.
+// At run time recording stays off until Profiler::setEnabled(true), which
+// leaves one relaxed load and a branch per zone.
+
+#ifndef FLIGHT_PROFILER
+#define FLIGHT_PROFILER 0
+#endif
+
+enum class ProfileZone : uint8_t {
+    Physics,    // One updatePhysics call or batch step
+    AeroLookup, // Aero table lookup
+    Atmosphere, // Atmosphere table lookup
+    Wind,       // Wind field sample (shear, turbulence tiles, gusts)
+    PID,        // Autopilot controller update
+    Integrator, // Integration scheme (includes its force evaluations)
+    Render,     // Flight view draw list
+    ImGui,      // ImGui::Render and the GL draw
+    Swap,       // Buffer swap (includes vsync wait)
+    Count
+};
+
+constexpr size_t PROFILE_ZONE_COUNT = static_cast<size_t>(ProfileZone::Count);
+
+inline const char* profileZoneName(ProfileZone zone) {
+    static const char* const names[PROFILE_ZONE_COUNT] = {"Physics", "Aero lookup", "Atmosphere", "Wind",
+                                                          "PID", "Integrator", "Render", "ImGui", "Swap"};
+    size_t i = static_cast<size_t>(zone);
+    return i < PROFILE_ZONE_COUNT ? names[i] : "?";
+}
+
+struct ProfileEvent {
+    uint64_t start_ns;    // Since the profiler epoch
+    uint32_t duration_ns; // Saturates at ~4.3 s
+    ProfileZone zone;
+};
+
+// Timing of one zone over a window of recent events
+struct ProfileZoneStats {
+    static constexpr size_t HISTOGRAM_BINS = 32;
+
+    size_t count = 0;
+    double busy = 0.0; // Summed duration / window length (1 = one thread fully busy)
+    double mean_us = 0.0, p50_us = 0.0, p95_us = 0.0, p99_us = 0.0, max_us = 0.0;
+    std::vector<float> recent_us;                 // Latest durations, oldest first
+    std::array<float, HISTOGRAM_BINS> histogram{}; // Counts over [0, histogram_max_us]
+    double histogram_max_us = 0.0;                  // Last bin also holds everything above
+};
+
+struct ProfileSummary {
+    double window_seconds = 0.0;
+    std::array<ProfileZoneStats, PROFILE_ZONE_COUNT> zones;
+};
+
+// Events of one thread's ring buffer
+class ProfileRing {
+public:
+    static constexpr size_t Capacity = size_t(1) << 17; // 2 MiB per thread
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    explicit ProfileRing(uint32_t lane) : lane(lane), head(0), events(new ProfileEvent[Capacity]) {}
+
+    // Owning thread only
+    void push(const ProfileEvent& e) {
+        size_t h = head.load(std::memory_order_relaxed);
+        events[h & (Capacity - 1)] = e;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Any thread: append the events written since cursor `from` (at most the
+    // last Capacity) to out and return the new cursor. Slots the writer
+    // reused while they were being copied are removed again, so what is
+    // returned is intact even though the copy races with push().
+    size_t copySince(size_t from, std::vector<ProfileEvent>& out) const {
+        size_t h = head.load(std::memory_order_acquire);
+        size_t begin = std::max(from, h > Capacity ? h - Capacity : size_t(0));
+        size_t old_size = out.size();
+        for (size_t i = begin; i < h; i++)
+            out.push_back(events[i & (Capacity - 1)]);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        size_t h2 = head.load(std::memory_order_relaxed);
+        size_t first_intact = h2 > Capacity ? h2 - Capacity : 0;
+        if (first_intact > begin) {
+            size_t torn = std::min(first_intact, h) - begin;
+            out.erase(out.begin() + static_cast<std::ptrdiff_t>(old_size),
+                      out.begin() + static_cast<std::ptrdiff_t>(old_size + torn));
+        }
+        return h;
+    }
+
+    size_t written() const { return head.load(std::memory_order_acquire); }
+
+    const uint32_t lane;  // Trace thread id
+    std::string name;     // Guarded by the Profiler mutex
+    bool in_use = true;   // Guarded by the Profiler mutex; false once the thread exits
+
+private:
+    std::atomic<size_t> head;
+    std::unique_ptr<ProfileEvent[]> events;
+};
+
+// Process-wide registry of per-thread rings
+class Profiler {
+public:
+    // Never destroyed, so zones in static destructors and exiting threads stay safe
+    static Profiler& instance() {
+        static Profiler* profiler = new Profiler();
+        return *profiler;
+    }
+
+    bool enabled() const { return recording.load(std::memory_order_relaxed); }
+    void setEnabled(bool on) { recording.store(on, std::memory_order_relaxed); }
+
+    // Nanoseconds since the profiler was created
+    uint64_t now() const {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    void record(ProfileZone zone, uint64_t start_ns, uint64_t end_ns) {
+        uint64_t d = end_ns > start_ns ? end_ns - start_ns : 0;
+        ring().push({start_ns, static_cast<uint32_t>(std::min<uint64_t>(d, UINT32_MAX)), zone});
+    }
+
+    // Label the calling thread in the panel and trace. Cheap: the ring itself
+    // is only allocated when the thread first records a zone.
+    void setThreadName(const std::string& name) {
+        ThreadSlot& slot = threadSlot();
+        slot.name = name;
+        if (slot.ring) {
+            std::lock_guard<std::mutex> lock(mutex);
+            slot.ring->name = name;
+        }
+    }
+
+    // Forget everything recorded so far (rings are left in place; events
+    // older than now are filtered out of later reads)
+    void clear() { cleared_at.store(now(), std::memory_order_relaxed); }
+
+    struct ThreadEvents {
+        uint32_t lane;
+        std::string name;
+        std::vector<ProfileEvent> events; // In recording order
+    };
+
+    // Every retained event of every thread since the last clear()
+    std::vector<ThreadEvents> snapshot() const {
+        std::vector<ThreadEvents> out;
+        uint64_t since = cleared_at.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::unique_ptr<ProfileRing>& r : rings) {
+            ThreadEvents t{r->lane, r->name, {}};
+            r->copySince(0, t.events);
+            t.events.erase(std::remove_if(t.events.begin(), t.events.end(),
+                                          [since](const ProfileEvent& e) { return e.start_ns < since; }),
+                           t.events.end());
+            if (!t.events.empty())
+                out.push_back(std::move(t));
+        }
+        return out;
+    }
+
+    // Percentiles, load and histograms per zone over the last window_seconds
+    ProfileSummary summarize(double window_seconds, size_t recent_count = 240) const {
+        ProfileSummary summary;
+        summary.window_seconds = window_seconds;
+        uint64_t t_end = now();
+        uint64_t window_ns = static_cast<uint64_t>(std::max(0.0, window_seconds) * 1e9);
+        uint64_t t_begin = std::max(t_end > window_ns ? t_end - window_ns : 0,
+                                    cleared_at.load(std::memory_order_relaxed));
+
+        std::array<std::vector<ProfileEvent>, PROFILE_ZONE_COUNT> by_zone;
+        for (const ThreadEvents& t : snapshot()) {
+            for (const ProfileEvent& e : t.events) {
+                size_t z = static_cast<size_t>(e.zone);
+                if (e.start_ns >= t_begin && z < PROFILE_ZONE_COUNT)
+                    by_zone[z].push_back(e);
+            }
+        }
+
+        for (size_t z = 0; z < PROFILE_ZONE_COUNT; z++) {
+            std::vector<ProfileEvent>& events = by_zone[z];
+            ProfileZoneStats& s = summary.zones[z];
+            s.count = events.size();
+            if (events.empty())
+                continue;
+
+            // Plot the newest events across all threads in time order
+            std::sort(events.begin(), events.end(),
+                      [](const ProfileEvent& a, const ProfileEvent& b) { return a.start_ns < b.start_ns; });
+            size_t first = events.size() > recent_count ? events.size() - recent_count : 0;
+            for (size_t i = first; i < events.size(); i++)
+                s.recent_us.push_back(static_cast<float>(events[i].duration_ns * 1e-3));
+
+            std::vector<double> us(events.size());
+            double total = 0.0;
+            for (size_t i = 0; i < events.size(); i++) {
+                us[i] = events[i].duration_ns * 1e-3;
+                total += us[i];
+            }
+            std::sort(us.begin(), us.end());
+            s.mean_us = total / us.size();
+            s.p50_us = percentile(us, 0.50);
+            s.p95_us = percentile(us, 0.95);
+            s.p99_us = percentile(us, 0.99);
+            s.max_us = us.back();
+            if (window_seconds > 0.0)
+                s.busy = total * 1e-6 / window_seconds;
+
+            // Linear bins up to p99 keep rare spikes from squashing the shape
+            s.histogram_max_us = s.p99_us > 0.0 ? s.p99_us : s.max_us;
+            for (double v : us) {
+                size_t bin = s.histogram_max_us > 0.0
+                                 ? static_cast<size_t>(v / s.histogram_max_us * ProfileZoneStats::HISTOGRAM_BINS)
+                                 : 0;
+                s.histogram[std::min(bin, ProfileZoneStats::HISTOGRAM_BINS - 1)] += 1.0f;
+            }
+        }
+        return summary;
+    }
+
+    // Write every retained event as Chrome trace event JSON (chrome://tracing,
+    // ui.perfetto.dev). Returns the number of zone events written.
+    size_t writeChromeTrace(const std::string& path) const {
+        std::FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f)
+            throw std::runtime_error("Failed to open trace file: " + path);
+
+        size_t written = 0;
+        bool first = true;
+        auto separator = [&] {
+            std::fputs(first ? "\n" : ",\n", f);
+            first = false;
+        };
+        std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", f);
+        for (const ThreadEvents& t : snapshot()) {
+            separator();
+            std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                         t.lane, jsonEscape(t.name).c_str());
+            for (const ProfileEvent& e : t.events) {
+                bool frame = e.zone == ProfileZone::Render || e.zone == ProfileZone::ImGui ||
+                             e.zone == ProfileZone::Swap;
+                separator();
+                std::fprintf(f, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                                "\"ts\":%.3f,\"dur\":%.3f}",
+                             profileZoneName(e.zone), frame ? "frame" : "sim", t.lane, e.start_ns * 1e-3,
+                             e.duration_ns * 1e-3);
+                written++;
+            }
+        }
+        std::fputs("\n]}\n", f);
+        bool ok = std::ferror(f) == 0;
+        ok = std::fclose(f) == 0 && ok;
+        if (!ok)
+            throw std::runtime_error("Failed to write trace file: " + path);
+        return written;
+    }
+
+    // Number of threads that have recorded at least one zone
+    size_t threadCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return rings.size();
+    }
+
+private:
+    Profiler() : recording(false), cleared_at(0), epoch(std::chrono::steady_clock::now()) {}
+
+    // Rings of exited threads are kept (with their names) until this many
+    // exist; after that a new thread takes over a free one, so repeatedly
+    // created worker pools cannot grow the registry without bound
+    static constexpr size_t MAX_RETAINED_RINGS = 16;
+
+    // Per-thread handle; hands the ring back when the thread exits
+    struct ThreadSlot {
+        ProfileRing* ring = nullptr;
+        std::string name;
+        ~ThreadSlot() {
+            if (ring)
+                Profiler::instance().release(ring);
+        }
+    };
+
+    static ThreadSlot& threadSlot() {
+        static thread_local ThreadSlot slot;
+        return slot;
+    }
+
+    ProfileRing& ring() {
+        ThreadSlot& slot = threadSlot();
+        if (!slot.ring)
+            slot.ring = acquire(slot.name);
+        return *slot.ring;
+    }
+
+    ProfileRing* acquire(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ProfileRing* r = nullptr;
+        if (rings.size() >= MAX_RETAINED_RINGS) {
+            for (std::unique_ptr<ProfileRing>& candidate : rings) {
+                if (!candidate->in_use) {
+                    r = candidate.get();
+                    break;
+                }
+            }
+        }
+        if (!r) {
+            rings.push_back(std::make_unique<ProfileRing>(static_cast<uint32_t>(rings.size() + 1)));
+            r = rings.back().get();
+        }
+        r->in_use = true;
+        r->name = name.empty() ? "thread " + std::to_string(r->lane) : name;
+        return r;
+    }
+
+    void release(ProfileRing* r) {
+        std::lock_guard<std::mutex> lock(mutex);
+        r->in_use = false;
+    }
+
+    // Nearest-rank percentile of sorted values
+    static double percentile(const std::vector<double>& sorted, double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+        return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+    }
+
+    static std::string jsonEscape(const std::string& s) {
+        std::string out;
+        for (char c : s) {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            if (static_cast<unsigned char>(c) >= 0x20)
+                out += c;
+        }
+        return out;
+    }
+
+    std::atomic<bool> recording;
+    std::atomic<uint64_t> cleared_at;
+    const std::chrono::steady_clock::time_point epoch;
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<ProfileRing>> rings;
+};
+
+// Times its own lifetime as one zone event while the profiler is enabled
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileZone zone) : zone(zone), active(Profiler::instance().enabled()), start(0) {
+        if (active)
+            start = Profiler::instance().now();
+    }
+
+    ~ProfileScope() {
+        if (active) {
+            Profiler& p = Profiler::instance();
+            p.record(zone, start, p.now());
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfileZone zone;
+    bool active;
+    uint64_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if FLIGHT_PROFILER
+#define PROFILE_ZONE(zone) ProfileScope PROFILE_CONCAT(profile_zone_, __LINE__)(zone)
+#else
+#define PROFILE_ZONE(zone) ((void)0)
+#endif
+
+#endif // PROFILER_HPP
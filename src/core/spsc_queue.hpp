@@ -0,0 +1,52 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread
+//
+// Head and tail are free-running counters; the slot index is counter & (Capacity - 1).
+// Each counter is written by only one side, so a release store / acquire load pair
+// is all the synchronisation needed. Pushing into a full queue fails instead of
+// blocking.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    // Producer: returns false if the queue is full
+    bool tryPush(T value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == Capacity)
+            return false;
+        slots[h & (Capacity - 1)] = std::move(value);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: returns false if the queue is empty
+    bool tryPop(T& out) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+        out = std::move(slots[t & (Capacity - 1)]);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called concurrently with push/pop
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head; // next slot to write (producer)
+    alignas(64) std::atomic<size_t> tail; // next slot to read (consumer)
+    T slots[Capacity];
+};
+
+#endif // SPSC_QUEUE_HPP
@@ -0,0 +1,177 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include "profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool
+//
+// Every worker owns a deque of tasks. A worker pops from the back of its own
+// deque (newest first, cache-warm) and, when that is empty, steals from the
+// front of another worker's deque (oldest first, i.e. the biggest
+// remaining chunks). Tasks submitted from outside the pool are spread
+// round-robin over the workers, so there is no single shared queue to contend
+// on. Each deque has its own small mutex; tasks are expected to be coarse
+// (a whole simulation run), so lock cost is negligible next to the work.
+class ThreadPool {
+public:
+    // threads = 0 uses one worker per hardware thread
+    explicit ThreadPool(size_t threads = 0) : pending(0), stopping(false), next_queue(0) {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < threads; i++)
+            queues.push_back(std::make_unique<WorkerQueue>());
+        for (size_t i = 0; i < threads; i++)
+            workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers)
+            t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // Queue a task. From inside a worker it goes to that worker's own deque.
+    void submit(std::function<void()> task) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        size_t q = current_worker >= 0 && current_pool == this
+                       ? static_cast<size_t>(current_worker)
+                       : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        {
+            std::lock_guard<std::mutex> lock(queues[q]->mutex);
+            queues[q]->tasks.push_back(std::move(task));
+        }
+        {
+            // Pairs with the predicate check in workerLoop so a wake-up is never lost
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+        }
+        wake.notify_one();
+    }
+
+    // Block until every submitted task (including tasks they submit) has finished.
+    // Must not be called from a worker.
+    void wait() {
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        done.wait(lock, [this] { return pending.load(std::memory_order_acquire) == 0; });
+    }
+
+    // Run f(i) for every i in [begin, end) and wait. grain = indices per task
+    // (0 picks a size that gives each worker several chunks to balance with).
+    template <typename Func>
+    void parallelFor(size_t begin, size_t end, Func f, size_t grain = 0) {
+        if (end <= begin)
+            return;
+        size_t count = end - begin;
+        if (grain == 0)
+            grain = std::max<size_t>(1, count / (workers.size() * 8));
+        for (size_t lo = begin; lo < end; lo += grain) {
+            size_t hi = std::min(end, lo + grain);
+            submit([f, lo, hi] {
+                for (size_t i = lo; i < hi; i++)
+                    f(i);
+            });
+        }
+        wait();
+    }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> pending; // Submitted but not yet finished
+    bool stopping;               // Guarded by sleep_mutex
+    std::atomic<size_t> next_queue;
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake; // Workers wait here for tasks
+    std::condition_variable done; // wait() waits here for pending == 0
+
+    // Which pool/worker the calling thread is (submit() targets its own deque)
+    static inline thread_local int current_worker = -1;
+    static inline thread_local const ThreadPool* current_pool = nullptr;
+
+    bool popLocal(size_t self, std::function<void()>& task) {
+        WorkerQueue& q = *queues[self];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty())
+            return false;
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t self, std::function<void()>& task) {
+        size_t n = queues.size();
+        size_t start = (self * 7 + static_cast<size_t>(next_queue.load(std::memory_order_relaxed))) % n;
+        for (size_t k = 0; k < n; k++) {
+            size_t victim = (start + k) % n;
+            if (victim == self)
+                continue;
+            WorkerQueue& q = *queues[victim];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty()) {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool hasWork() {
+        for (auto& q : queues) {
+            std::lock_guard<std::mutex> lock(q->mutex);
+            if (!q->tasks.empty())
+                return true;
+        }
+        return false;
+    }
+
+    void workerLoop(size_t self) {
+        current_worker = static_cast<int>(self);
+        current_pool = this;
+        Profiler::instance().setThreadName("worker " + std::to_string(self));
+
+        std::function<void()> task;
+        for (;;) {
+            if (popLocal(self, task) || steal(self, task)) {
+                task();
+                task = nullptr;
+                if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> lock(sleep_mutex);
+                    done.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            wake.wait(lock, [this] { return stopping || hasWork(); });
+            if (stopping && !hasWork())
+                return;
+        }
+    }
+};
+
+#endif
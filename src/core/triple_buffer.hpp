@@ -0,0 +1,54 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free triple buffer for one producer thread and one consumer thread
+//
+// The producer always owns a "back" slot it can fill at leisure, the consumer
+// always owns a "front" slot it can read at leisure, and the third slot sits in
+// the middle. publish() swaps back <-> middle, update() swaps middle <-> front.
+// Neither side ever waits for the other: a slow consumer simply skips states,
+// and a slow producer means the consumer keeps reading the last one.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1 /* slot 1, not fresh */), back(0), front(2) {}
+
+    // --- Producer side ---
+
+    // Slot to fill before calling publish(); contents are whatever was there last time
+    T& writeBuffer() { return slots[back]; }
+
+    // Make the write buffer visible to the consumer
+    void publish() {
+        uint8_t previous = middle.exchange(static_cast<uint8_t>(back | FRESH), std::memory_order_acq_rel);
+        back = previous & INDEX_MASK;
+    }
+
+    // --- Consumer side ---
+
+    // Pick up the newest published value, if any. Returns true if it changed.
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+        uint8_t previous = middle.exchange(front, std::memory_order_acq_rel);
+        front = previous & INDEX_MASK;
+        return true;
+    }
+
+    // Latest value picked up by update()
+    const T& readBuffer() const { return slots[front]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    T slots[3];
+    alignas(64) std::atomic<uint8_t> middle; // slot index | FRESH flag
+    alignas(64) uint8_t back;                // producer-owned
+    alignas(64) uint8_t front;               // consumer-owned
+};
+
+#endif // TRIPLE_BUFFER_HPP
@@ -7,33 +7,34 @@
 #include <string>
 
 // 2D Vector class for flight dynamics
+// Arithmetic is constexpr; magnitude/rotation use <cmath> and run at runtime.
 struct Vec2 {
     double x, y;
     
-    Vec2(double x = 0.0, double y = 0.0) : x(x), y(y) {}
+    constexpr Vec2(double x = 0.0, double y = 0.0) : x(x), y(y) {}
     
     // Vector addition
-    Vec2 operator+(const Vec2& other) const {
+    constexpr Vec2 operator+(const Vec2& other) const {
         return Vec2(x + other.x, y + other.y);
     }
     
     // Vector subtraction
-    Vec2 operator-(const Vec2& other) const {
+    constexpr Vec2 operator-(const Vec2& other) const {
         return Vec2(x - other.x, y - other.y);
     }
     
     // Scalar multiplication
-    Vec2 operator*(double scalar) const {
+    constexpr Vec2 operator*(double scalar) const {
         return Vec2(x * scalar, y * scalar);
     }
     
     // Scalar division
-    Vec2 operator/(double scalar) const {
+    constexpr Vec2 operator/(double scalar) const {
         return Vec2(x / scalar, y / scalar);
     }
     
     // Dot product
-    double dot(const Vec2& other) const {
+    constexpr double dot(const Vec2& other) const {
         return x * other.x + y * other.y;
     }
     
@@ -43,7 +44,7 @@ struct Vec2 {
     }
     
     // Magnitude squared (useful for comparisons without sqrt)
-    double magnitudeSquared() const {
+    constexpr double magnitudeSquared() const {
         return x * x + y * y;
     }
     
@@ -74,7 +75,7 @@ struct Vec2 {
 };
 
 // Scalar * Vector (for commutative multiplication)
-inline Vec2 operator*(double scalar, const Vec2& vec) {
+constexpr Vec2 operator*(double scalar, const Vec2& vec) {
     return vec * scalar;
 }
 
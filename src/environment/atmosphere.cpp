@@ -1,5 +1,7 @@
 #include "atmosphere.hpp"
+#include "../core/profiler.hpp"
 #include <cmath>
+#include <vector>
 
 // Temperature in Kelvin (linear lapse in troposphere)
 double getTemperature(double h) {
@@ -22,5 +24,78 @@ double getDensity(double h) {
 // Speed of sound
 double getSpeedOfSound(double h) {
     double T = getTemperature(h);
-    return sqrt(gamma * R * T);
+    return sqrt(gamma_air * R * T);
+}
+
+// Dynamic viscosity (Sutherland's law)
+double getDynamicViscosity(double h) {
+    double T = getTemperature(h);
+    return mu_ref * T * sqrt(T) / (T + T_suth);
+}
+
+// All properties from the analytic model
+AtmosphereState computeAtmosphere(double h) {
+    double T = getTemperature(h);
+    double p = p0 * pow(T / T0, g / (R * L));
+    return {T, p, p / (R * T), sqrt(gamma_air * R * T), mu_ref * T * sqrt(T) / (T + T_suth)};
+}
+
+// Table rows every ATMOS_TABLE_STEP metres from sea level to ATMOS_TABLE_TOP.
+// Linear interpolation of the exponential-like pressure/density profile over
+// 20 m stays within 2e-6 relative error (worst near the top, where the scale
+// height is smallest); temperature is exact and a, mu within 1e-7.
+static const std::vector<AtmosphereState> &atmosphereTable() {
+    static const std::vector<AtmosphereState> table = [] {
+        int rows = static_cast<int>(ATMOS_TABLE_TOP / ATMOS_TABLE_STEP) + 1;
+        std::vector<AtmosphereState> t(rows);
+        for (int i = 0; i < rows; i++) {
+            t[i] = computeAtmosphere(i * ATMOS_TABLE_STEP);
+        }
+        return t;
+    }();
+    return table;
+}
+
+// Atmosphere from the precomputed table
+AtmosphereState getAtmosphere(double h) {
+    PROFILE_ZONE(ProfileZone::Atmosphere);
+    const std::vector<AtmosphereState> &table = atmosphereTable();
+    double u = h * (1.0 / ATMOS_TABLE_STEP);
+    if (!(u >= 0.0) || u >= static_cast<double>(table.size() - 1)) {
+        return computeAtmosphere(h);
+    }
+
+    size_t i = static_cast<size_t>(u);
+    double f = u - static_cast<double>(i);
+    const AtmosphereState &lo = table[i];
+    const AtmosphereState &hi = table[i + 1];
+    return {lo.T + f * (hi.T - lo.T),
+            lo.p + f * (hi.p - lo.p),
+            lo.rho + f * (hi.rho - lo.rho),
+            lo.a + f * (hi.a - lo.a),
+            lo.mu + f * (hi.mu - lo.mu)};
+}
+
+// Batched atmosphere lookup (one table fetch for the whole batch)
+void getAtmosphere(const double* altitude, size_t count, double* rho, double* a, double* mu) {
+    PROFILE_ZONE(ProfileZone::Atmosphere);
+    const std::vector<AtmosphereState> &table = atmosphereTable();
+    const double last = static_cast<double>(table.size() - 1);
+    for (size_t k = 0; k < count; k++) {
+        double u = altitude[k] * (1.0 / ATMOS_TABLE_STEP);
+        if (!(u >= 0.0) || u >= last) {
+            AtmosphereState s = computeAtmosphere(altitude[k]);
+            rho[k] = s.rho;
+            a[k] = s.a;
+            mu[k] = s.mu;
+            continue;
+        }
+        size_t i = static_cast<size_t>(u);
+        double f = u - static_cast<double>(i);
+        const AtmosphereState &lo = table[i];
+        const AtmosphereState &hi = table[i + 1];
+        rho[k] = lo.rho + f * (hi.rho - lo.rho);
+        a[k] = lo.a + f * (hi.a - lo.a);
+        mu[k] = lo.mu + f * (hi.mu - lo.mu);
+    }
 }
\ No newline at end of file
@@ -1,18 +1,47 @@
 #ifndef ATMOSPHERE_HPP
 #define ATMOSPHERE_HPP
 
+#include <cstddef>
+
 // Constants for ISA
-const double T0 = 288.15;      // Sea level temperature [K]
-const double p0 = 101325.0;    // Sea level pressure [Pa]
-const double L  = 0.0065;      // Temperature lapse rate [K/m]
-const double R  = 287.0;       // Gas constant [J/kgK]
-const double g  = 9.80665;     // Gravity [m/s^2]
-const double gamma = 1.4;      // Heat capacity ratio
+constexpr double T0 = 288.15;      // Sea level temperature [K]
+constexpr double p0 = 101325.0;    // Sea level pressure [Pa]
+constexpr double L  = 0.0065;      // Temperature lapse rate [K/m]
+constexpr double R  = 287.0;       // Gas constant [J/kgK]
+constexpr double g  = 9.80665;     // Gravity [m/s^2]
+constexpr double gamma_air = 1.4;  // Heat capacity ratio (not 'gamma': clashes with glibc's gamma())
+constexpr double mu_ref = 1.458e-6; // Sutherland constant [kg/(m s K^0.5)]
+constexpr double T_suth = 110.4;    // Sutherland temperature [K]
 
 // Functions to calculate atmospheric properties
 double getTemperature(double altitude); // K
 double getPressure(double altitude);    // Pa
 double getDensity(double altitude);     // kg/m^3
 double getSpeedOfSound(double altitude);// m/s
+double getDynamicViscosity(double altitude); // Pa s (Sutherland's law)
+
+// All atmospheric properties at one altitude
+struct AtmosphereState {
+    double T;   // Temperature [K]
+    double p;   // Pressure [Pa]
+    double rho; // Density [kg/m^3]
+    double a;   // Speed of sound [m/s]
+    double mu;  // Dynamic viscosity [Pa s]
+};
+
+// Tabulated atmosphere (built once, linear interpolation between rows)
+constexpr double ATMOS_TABLE_STEP = 20.0;     // Row spacing [m]
+constexpr double ATMOS_TABLE_TOP  = 20000.0;  // Highest tabulated altitude [m]
+
+// Combined lookup for the physics step and UI; outside 0..ATMOS_TABLE_TOP
+// it falls back to the analytic functions above
+AtmosphereState getAtmosphere(double altitude);
+
+// Batched lookup into separate density, speed of sound and viscosity arrays
+// (same values as getAtmosphere for each altitude)
+void getAtmosphere(const double* altitude, size_t count, double* rho, double* a, double* mu);
+
+// Analytic reference (same values as the individual functions)
+AtmosphereState computeAtmosphere(double altitude);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,327 @@
+#include "wind.hpp"
+#include "../core/profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double FT = 0.3048;   // [m]
+constexpr double KNOT = 0.514444; // [m/s]
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Two independent standard normal values (Box-Muller)
+void gaussianPair(uint64_t& state, double& a, double& b) {
+    double u1 = (static_cast<double>(splitmix64(state) >> 11) + 1.0) * (1.0 / 9007199254740992.0); // (0, 1]
+    double u2 = static_cast<double>(splitmix64(state) >> 11) * (1.0 / 9007199254740992.0);
+    double r = std::sqrt(-2.0 * std::log(u1));
+    a = r * std::cos(2.0 * PI * u2);
+    b = r * std::sin(2.0 * PI * u2);
+}
+
+// In-place radix-2 DFT with e^(+i...) kernel (inverse direction, unscaled)
+void inverseFFT(std::vector<std::complex<double>>& a) {
+    const size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(a[i], a[j]);
+        }
+    }
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const double angle = 2.0 * PI / static_cast<double>(len);
+        const std::complex<double> step(std::cos(angle), std::sin(angle));
+        for (size_t i = 0; i < n; i += len) {
+            std::complex<double> w(1.0, 0.0);
+            for (size_t k = 0; k < len / 2; k++) {
+                std::complex<double> even = a[i + k];
+                std::complex<double> odd = a[i + k + len / 2] * w;
+                a[i + k] = even + odd;
+                a[i + k + len / 2] = even - odd;
+                w *= step;
+            }
+        }
+    }
+}
+
+// Power spectra over the wavenumber in radians per scale length (shape only;
+// the tiles are normalized to unit variance afterwards)
+double spectrumU(TurbulenceModel model, double omega) {
+    if (model == TurbulenceModel::VonKarman) {
+        double a = 1.339 * omega;
+        return std::pow(1.0 + a * a, -5.0 / 6.0);
+    }
+    return 1.0 / (1.0 + omega * omega);
+}
+
+double spectrumW(TurbulenceModel model, double omega) {
+    if (model == TurbulenceModel::VonKarman) {
+        double a = 1.339 * omega;
+        return (1.0 + (8.0 / 3.0) * a * a) * std::pow(1.0 + a * a, -11.0 / 6.0);
+    }
+    double o2 = omega * omega;
+    return (1.0 + 3.0 * o2) / ((1.0 + o2) * (1.0 + o2));
+}
+
+// Periodic Gaussian noise with the given spectrum: random amplitudes per
+// frequency bin, one inverse FFT, then scaled to zero mean and unit variance
+std::vector<float> synthesizeTile(TurbulenceModel model, bool vertical, uint64_t rng) {
+    const size_t n = TurbulenceTiles::SIZE;
+    const double d_omega = 2.0 * PI / (static_cast<double>(n) * TurbulenceTiles::SPACING);
+    std::vector<std::complex<double>> bins(n, std::complex<double>(0.0, 0.0));
+    for (size_t k = 1; k <= n / 2; k++) {
+        double omega = d_omega * static_cast<double>(k);
+        double amplitude = std::sqrt(vertical ? spectrumW(model, omega) : spectrumU(model, omega));
+        double re, im;
+        gaussianPair(rng, re, im);
+        if (k == n / 2) {
+            bins[k] = std::complex<double>(amplitude * re, 0.0); // Nyquist bin is real
+        } else {
+            bins[k] = std::complex<double>(amplitude * re, amplitude * im);
+            bins[n - k] = std::conj(bins[k]);
+        }
+    }
+    inverseFFT(bins);
+
+    double mean = 0.0;
+    for (const auto& b : bins) {
+        mean += b.real();
+    }
+    mean /= static_cast<double>(n);
+    double variance = 0.0;
+    for (const auto& b : bins) {
+        variance += (b.real() - mean) * (b.real() - mean);
+    }
+    double scale = 1.0 / std::sqrt(variance / static_cast<double>(n));
+
+    std::vector<float> tile(n + 1);
+    for (size_t i = 0; i < n; i++) {
+        tile[i] = static_cast<float>((bins[i].real() - mean) * scale);
+    }
+    tile[n] = tile[0];
+    return tile;
+}
+
+// Intensities and scale lengths at one altitude (MIL-F-8785C low altitude
+// model up to 1000 ft, medium/high altitude scale lengths from 2000 ft,
+// linear in between). Above 1000 ft both intensities stay at 0.1 W20.
+struct TurbulenceScales {
+    double sigma_u, sigma_w; // [m/s]
+    double L_u, L_w;         // [m]
+};
+
+TurbulenceScales turbulenceScales(TurbulenceModel model, double w20, double altitude) {
+    const bool karman = model == TurbulenceModel::VonKarman;
+    const double sigma = 0.1 * w20;
+    auto low = [&](double h_ft) {
+        double d = 0.177 + 0.000823 * h_ft;
+        return TurbulenceScales{sigma / std::pow(d, 0.4), sigma, h_ft / std::pow(d, 1.2) * FT,
+                                (karman ? 0.5 * h_ft : h_ft) * FT};
+    };
+    const TurbulenceScales high = {sigma, sigma, (karman ? 2500.0 : 1750.0) * FT,
+                                   (karman ? 1250.0 : 1750.0) * FT};
+
+    double h_ft = std::max(altitude / FT, 10.0);
+    if (h_ft <= 1000.0) {
+        return low(h_ft);
+    }
+    if (h_ft >= 2000.0) {
+        return high;
+    }
+    TurbulenceScales a = low(1000.0);
+    double f = (h_ft - 1000.0) / 1000.0;
+    return {a.sigma_u + f * (high.sigma_u - a.sigma_u), a.sigma_w + f * (high.sigma_w - a.sigma_w),
+            a.L_u + f * (high.L_u - a.L_u), a.L_w + f * (high.L_w - a.L_w)};
+}
+
+} // namespace
+
+bool WindConditions::calm() const {
+    if (speed != 0.0 || (turbulence != TurbulenceModel::None && turbulence_w20 > 0.0)) {
+        return false;
+    }
+    for (const WindGust& g : gusts) {
+        if (g.u != 0.0 || g.w != 0.0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double turbulenceIntensity(const char* name) {
+    if (std::strcmp(name, "light") == 0) return 15.0 * KNOT;
+    if (std::strcmp(name, "moderate") == 0) return 30.0 * KNOT;
+    if (std::strcmp(name, "severe") == 0) return 45.0 * KNOT;
+    return -1.0;
+}
+
+bool parseTurbulenceModel(const char* name, TurbulenceModel& model) {
+    for (TurbulenceModel m : {TurbulenceModel::None, TurbulenceModel::Dryden, TurbulenceModel::VonKarman}) {
+        if (std::strcmp(name, turbulenceModelName(m)) == 0) {
+            model = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* turbulenceModelName(TurbulenceModel model) {
+    switch (model) {
+    case TurbulenceModel::None:
+        return "none";
+    case TurbulenceModel::Dryden:
+        return "dryden";
+    case TurbulenceModel::VonKarman:
+        return "vonkarman";
+    }
+    return "";
+}
+
+uint64_t turbulenceSeed(uint64_t base, uint64_t index) {
+    uint64_t state = base ^ (0x9E3779B97F4A7C15ull * (index + 1));
+    return splitmix64(state);
+}
+
+TurbulenceTiles::TurbulenceTiles(TurbulenceModel model, uint64_t seed) : model_(model), seed_(seed) {
+    if (model == TurbulenceModel::None) {
+        throw std::runtime_error("Turbulence tiles need a turbulence model");
+    }
+    // Separate streams, so u and w are independent
+    u_ = synthesizeTile(model, false, seed ^ 0x75A5C1F3D2E6B481ull);
+    w_ = synthesizeTile(model, true, seed ^ 0x3C8E91B7F04D2A65ull);
+}
+
+std::shared_ptr<const TurbulenceTiles> TurbulenceTiles::get(TurbulenceModel model, uint64_t seed) {
+    static std::mutex mutex;
+    static std::map<std::pair<int, uint64_t>, std::weak_ptr<const TurbulenceTiles>> cache;
+
+    const std::pair<int, uint64_t> key(static_cast<int>(model), seed);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (auto tiles = cache[key].lock()) {
+            return tiles;
+        }
+    }
+    // Generated outside the lock; two threads racing for one seed build identical tiles
+    auto tiles = std::make_shared<const TurbulenceTiles>(model, seed);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (auto existing = cache[key].lock()) {
+        return existing;
+    }
+    cache[key] = tiles;
+    // Seed sweeps leave many dead entries behind
+    if (cache.size() > 256) {
+        for (auto it = cache.begin(); it != cache.end();) {
+            it = it->second.expired() ? cache.erase(it) : std::next(it);
+        }
+    }
+    return tiles;
+}
+
+WindField::WindField(const WindConditions& conditions) : conditions_(conditions) {
+    if (!(conditions.reference_altitude > 0.0)) {
+        throw std::runtime_error("Wind reference altitude must be positive");
+    }
+    if (!(conditions.shear_exponent >= 0.0)) {
+        throw std::runtime_error("Wind shear exponent must not be negative");
+    }
+    if (!(conditions.turbulence_w20 >= 0.0)) {
+        throw std::runtime_error("Turbulence intensity must not be negative");
+    }
+    for (const WindGust& g : conditions.gusts) {
+        if (!(g.duration > 0.0)) {
+            throw std::runtime_error("Gust duration must be positive");
+        }
+    }
+
+    const bool turbulent = conditions.turbulence != TurbulenceModel::None && conditions.turbulence_w20 > 0.0;
+    const size_t rows = static_cast<size_t>(PROFILE_TOP / PROFILE_STEP) + 1;
+    profile.resize(rows);
+    for (size_t i = 0; i < rows; i++) {
+        double h = static_cast<double>(i) * PROFILE_STEP;
+        ProfileRow& row = profile[i];
+        row.shear = conditions.speed * std::pow(h / conditions.reference_altitude, conditions.shear_exponent);
+        row.sigma_u = row.sigma_w = row.rate_u = row.rate_w = 0.0;
+        if (turbulent) {
+            TurbulenceScales s = turbulenceScales(conditions.turbulence, conditions.turbulence_w20, h);
+            row.sigma_u = s.sigma_u;
+            row.sigma_w = s.sigma_w;
+            row.rate_u = 1.0 / (s.L_u * TurbulenceTiles::SPACING);
+            row.rate_w = 1.0 / (s.L_w * TurbulenceTiles::SPACING);
+        }
+    }
+    if (turbulent) {
+        tiles_ = TurbulenceTiles::get(conditions.turbulence, conditions.seed);
+    }
+}
+
+WindSample WindField::lookup(double altitude, double t, double phase_u, double phase_w) const {
+    const double last = static_cast<double>(profile.size() - 1);
+    double u = altitude * (1.0 / PROFILE_STEP);
+    u = u > 0.0 ? (u < last ? u : last) : 0.0; // Also maps NaN to the ground row
+    size_t i = std::min(static_cast<size_t>(u), profile.size() - 2);
+    double f = u - static_cast<double>(i);
+    const ProfileRow& lo = profile[i];
+    const ProfileRow& hi = profile[i + 1];
+
+    WindSample s;
+    s.x = lo.shear + f * (hi.shear - lo.shear);
+    s.y = 0.0;
+    s.rate_u = lo.rate_u + f * (hi.rate_u - lo.rate_u);
+    s.rate_w = lo.rate_w + f * (hi.rate_w - lo.rate_w);
+    if (tiles_) {
+        s.x += (lo.sigma_u + f * (hi.sigma_u - lo.sigma_u)) * tiles_->u(phase_u);
+        s.y += (lo.sigma_w + f * (hi.sigma_w - lo.sigma_w)) * tiles_->w(phase_w);
+    }
+    for (const WindGust& g : conditions_.gusts) {
+        double x = (t - g.start) / g.duration;
+        if (x > 0.0 && x < 1.0) {
+            double shape = 0.5 * (1.0 - std::cos(2.0 * PI * x));
+            s.x += g.u * shape;
+            s.y += g.w * shape;
+        }
+    }
+    return s;
+}
+
+WindSample WindField::sample(double altitude, double t, const TurbulencePhase& phase) const {
+    PROFILE_ZONE(ProfileZone::Wind);
+    return lookup(altitude, t, phase.u, phase.w);
+}
+
+// Batched sample (one profiler zone for the whole batch)
+void WindField::sample(const WindField* const* fields, size_t count, const double* altitude, double t,
+                       const double* phase_u, const double* phase_w, double* x, double* y, double* rate_u,
+                       double* rate_w) {
+    PROFILE_ZONE(ProfileZone::Wind);
+    for (size_t k = 0; k < count; k++) {
+        WindSample s = fields[k] ? fields[k]->lookup(altitude[k], t, phase_u[k], phase_w[k])
+                                 : WindSample{0.0, 0.0, 0.0, 0.0};
+        x[k] = s.x;
+        y[k] = s.y;
+        rate_u[k] = s.rate_u;
+        rate_w[k] = s.rate_w;
+    }
+}
+
+std::shared_ptr<const WindField> WindField::withSeed(uint64_t seed) const {
+    WindConditions c = conditions_;
+    c.seed = seed;
+    return std::make_shared<const WindField>(c);
+}
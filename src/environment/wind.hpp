@@ -0,0 +1,167 @@
+#ifndef WIND_HPP
+#define WIND_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Wind: steady wind with altitude shear, continuous turbulence and discrete
+// gusts, in the 2D frame of the simulation (x horizontal, y up)
+//
+// Turbulence is a frozen field (Taylor's hypothesis): the aircraft flies
+// through a fixed random velocity profile, advancing along it by the
+// distance it flies through the air. The profile comes from tiles of
+// unit-variance noise pregenerated for a spectrum and seed, so a step costs
+// a couple of table reads instead of running shaping filters. Intensities
+// and scale lengths follow MIL-F-8785C / MIL-HDBK-1797; the tiles are laid
+// out in scale lengths, so one tile serves every altitude.
+
+// Continuous turbulence spectrum
+enum class TurbulenceModel {
+    None,
+    Dryden,
+    VonKarman
+};
+
+// 1-cosine discrete gust: the wind rises from zero to (u, w) at the middle of
+// [start, start + duration] and falls back to zero at its end
+struct WindGust {
+    double start = 0.0;    // Simulated time [s]
+    double duration = 2.0; // [s]
+    double u = 0.0;        // Horizontal peak [m/s] (+x)
+    double w = 0.0;        // Vertical peak [m/s] (+ up)
+};
+
+// Everything that defines a wind field (a WindField is built from it)
+struct WindConditions {
+    // Steady wind, power-law shear: speed * (h / reference_altitude)^shear_exponent
+    double speed = 0.0;               // Wind at the reference altitude [m/s] (+ blows towards +x)
+    double reference_altitude = 10.0; // [m]
+    double shear_exponent = 1.0 / 7.0;
+
+    // Continuous turbulence. The intensity is the wind speed at 20 ft (W20):
+    // about 7.7 m/s light, 15.4 moderate, 23.1 severe.
+    TurbulenceModel turbulence = TurbulenceModel::None;
+    double turbulence_w20 = 0.0; // [m/s]
+    uint64_t seed = 1;           // Selects the noise tiles
+
+    std::vector<WindGust> gusts;
+
+    // True if nothing would blow (the simulation then skips the wind entirely)
+    bool calm() const;
+};
+
+// W20 for a named intensity ("light", "moderate", "severe"); negative if unknown
+double turbulenceIntensity(const char* name);
+
+// Turbulence model by name ("none", "dryden", "vonkarman"); false if unknown
+bool parseTurbulenceModel(const char* name, TurbulenceModel& model);
+const char* turbulenceModelName(TurbulenceModel model);
+
+// Independent seed for run 'index' of a set sharing a base seed (Monte Carlo)
+uint64_t turbulenceSeed(uint64_t base, uint64_t index);
+
+// Wind velocity for one step, and how fast the turbulence phase advances
+struct WindSample {
+    double x; // [m/s]
+    double y; // [m/s]
+    double rate_u, rate_w; // Tile samples per metre flown through the air
+};
+
+// Position of an aircraft along the turbulence tiles [tile samples]
+struct TurbulencePhase {
+    double u = 0.0;
+    double w = 0.0;
+};
+
+// Periodic unit-variance noise for the horizontal (u) and vertical (w)
+// turbulence components, shaped by the model's spectrum in scale lengths
+class TurbulenceTiles {
+public:
+    static constexpr size_t SIZE = 4096;     // Samples per tile (the tile repeats after SIZE)
+    static constexpr double SPACING = 0.125; // Sample spacing [scale lengths]
+
+    TurbulenceTiles(TurbulenceModel model, uint64_t seed);
+
+    // Shared tiles for a model and seed: generated on first use, freed with the last user
+    static std::shared_ptr<const TurbulenceTiles> get(TurbulenceModel model, uint64_t seed);
+
+    // Linear interpolation at a phase in [0, SIZE)
+    double u(double phase) const { return read(u_, phase); }
+    double w(double phase) const { return read(w_, phase); }
+
+    TurbulenceModel model() const { return model_; }
+    uint64_t seed() const { return seed_; }
+
+private:
+    TurbulenceModel model_;
+    uint64_t seed_;
+    std::vector<float> u_, w_; // SIZE + 1 samples; the last repeats the first
+
+    static double read(const std::vector<float>& tile, double phase) {
+        size_t i = static_cast<size_t>(phase);
+        double f = phase - static_cast<double>(i);
+        double a = tile[i];
+        return a + f * (tile[i + 1] - a);
+    }
+};
+
+// Immutable wind field shared by every state (and batch lane) flying in it
+class WindField {
+public:
+    // Shear and turbulence intensity tabulated up to this altitude; constant above
+    static constexpr double PROFILE_STEP = 5.0;   // [m]
+    static constexpr double PROFILE_TOP = 1000.0; // [m]
+
+    // Throws std::runtime_error for a non-positive reference altitude, a
+    // negative shear exponent or intensity, or a gust without a positive duration
+    explicit WindField(const WindConditions& conditions);
+
+    const WindConditions& conditions() const { return conditions_; }
+    bool turbulent() const { return tiles_ != nullptr; }
+
+    // Wind at an altitude and simulated time for the given turbulence phase
+    WindSample sample(double altitude, double t, const TurbulencePhase& phase) const;
+
+    // Batched sample for lanes with their own fields (null = still air) into
+    // separate arrays (same values as sample() for each lane)
+    static void sample(const WindField* const* fields, size_t count, const double* altitude, double t,
+                       const double* phase_u, const double* phase_w, double* x, double* y, double* rate_u,
+                       double* rate_w);
+
+    // Move the phase along the tiles by a distance flown through the air [m]
+    static void advance(TurbulencePhase& phase, const WindSample& s, double distance) {
+        phase.u = wrapPhase(phase.u + distance * s.rate_u);
+        phase.w = wrapPhase(phase.w + distance * s.rate_w);
+    }
+
+    static double wrapPhase(double p) {
+        const double size = static_cast<double>(TurbulenceTiles::SIZE);
+        if (!(p >= 0.0 && p < size)) {
+            p -= size * std::floor(p / size);
+            p = (p >= 0.0 && p < size) ? p : 0.0; // Rounding at the boundary, or NaN
+        }
+        return p;
+    }
+
+    // Same field with another turbulence seed (per-run seeds of a sweep)
+    std::shared_ptr<const WindField> withSeed(uint64_t seed) const;
+
+private:
+    // Values at one profile altitude
+    struct ProfileRow {
+        double shear;            // Steady wind [m/s]
+        double sigma_u, sigma_w; // Turbulence intensities [m/s]
+        double rate_u, rate_w;   // 1 / (scale length * SPACING) [1/m]
+    };
+
+    WindSample lookup(double altitude, double t, double phase_u, double phase_w) const;
+
+    WindConditions conditions_;
+    std::vector<ProfileRow> profile;
+    std::shared_ptr<const TurbulenceTiles> tiles_;
+};
+
+#endif
@@ -31,6 +31,13 @@ public:
         return ImVec2(screen_x, screen_y);
     }
 
+    // Convert screen coordinates back to world coordinates
+    void screenToWorld(ImVec2 screen, ImVec2 canvas_p0, ImVec2 canvas_p1, float &world_x, float &world_z) const
+    {
+        world_x = (screen.x - canvas_p0.x - view_offset.x) / view_scale;
+        world_z = (canvas_p1.y + view_offset.y - screen.y) / view_scale;
+    }
+
     // Auto-follow the aircraft
     void followAircraft(float aircraft_x, float aircraft_y, ImVec2 canvas_p0, ImVec2 canvas_p1, bool paused)
     {
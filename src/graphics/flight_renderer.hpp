@@ -2,19 +2,29 @@
 
 #include "imgui.h"
 #include "camera.hpp"
+#include "polyline_lod.hpp"
+#include "trail_renderer.hpp"
 #include "../simulation/simulation_state.hpp"
+#include "../simulation/fixed_step.hpp"
 #include "../core/vec2.hpp"
 #include <vector>
+#include <cmath>
 
 // Render the flight path visualization
 class FlightRenderer
 {
 public:
     float vector_scale;
+    size_t path_vertices; // Flight path vertices drawn last frame (after decimation and culling)
+    TrailRenderer trails; // Settings and statistics for drawing many runs
 
-    FlightRenderer() : vector_scale(0.05f) {}
+    FlightRenderer() : vector_scale(0.05f), path_vertices(0) {}
 
-    void render(const SimulationState &state, Camera &camera, bool show_vectors, ImVec2 canvas_p0, ImVec2 canvas_sz)
+    // 'frame' is the aircraft pose interpolated between the last two physics steps;
+    // the flight path and force vectors come from the latest step in 'state'.
+    // trail_set, if given, is drawn underneath (batch or sweep trajectories).
+    void render(const SimulationState &state, const PhysicsFrame &frame, Camera &camera, bool show_vectors,
+                ImVec2 canvas_p0, ImVec2 canvas_sz, const TrajectorySet *trail_set = nullptr)
     {
         ImVec2 canvas_p1 = ImVec2(canvas_p0.x + canvas_sz.x, canvas_p0.y + canvas_sz.y);
 
@@ -26,32 +36,45 @@ public:
         draw_list->AddRect(canvas_p0, canvas_p1, IM_COL32(255, 255, 255, 255));
 
         // Auto-follow aircraft
-        camera.followAircraft(static_cast<float>(state.position.x), static_cast<float>(state.position.y),
+        camera.followAircraft(static_cast<float>(frame.position.x), static_cast<float>(frame.position.y),
                               canvas_p0, canvas_p1, state.paused);
 
-        // Draw ground line
-        ImVec2 ground_p0 = camera.worldToScreen(-10000.0f, 0.0f, canvas_p0, canvas_p1);
-        ImVec2 ground_p1 = camera.worldToScreen(10000.0f, 0.0f, canvas_p0, canvas_p1);
-        draw_list->AddLine(ground_p0, ground_p1, IM_COL32(100, 200, 100, 255), 2.0f);
-
         // Draw grid lines
         drawGrid(draw_list, camera, canvas_p0, canvas_p1);
 
+        // Draw ground line across the visible width
+        float ground_y = camera.worldToScreen(0.0f, 0.0f, canvas_p0, canvas_p1).y;
+        draw_list->AddLine(ImVec2(canvas_p0.x, ground_y), ImVec2(canvas_p1.x, ground_y), IM_COL32(100, 200, 100, 255),
+                           2.0f);
+
+        // Draw other runs
+        if (trail_set)
+            trails.render(draw_list, *trail_set, camera, canvas_p0, canvas_p1);
+
         // Draw flight path
+        path_vertices = 0;
         if (state.flightPath.size() > 1)
         {
-            for (size_t i = 0; i < state.flightPath.size() - 1; i++)
-            {
-                ImVec2 p1 = camera.worldToScreen(state.flightPath[i].x, state.flightPath[i].z, canvas_p0, canvas_p1);
-                ImVec2 p2 = camera.worldToScreen(state.flightPath[i + 1].x, state.flightPath[i + 1].z, canvas_p0, canvas_p1);
-                draw_list->AddLine(p1, p2, IM_COL32(255, 255, 0, 255), 2.0f);
-            }
+            // Each point is projected once; sub-pixel steps and off-screen
+            // stretches never reach the draw list, and what is left goes out
+            // as one polyline per visible run
+            const float margin = 4.0f; // Line thickness plus anti-aliasing fringe
+            path.begin({canvas_p0.x - margin, canvas_p0.y - margin, canvas_p1.x + margin, canvas_p1.y + margin},
+                       PATH_MIN_SPACING);
+            auto emit = [&](const ImVec2 *points, int count)
+            { draw_list->AddPolyline(points, count, IM_COL32(255, 255, 0, 255), ImDrawFlags_None, 2.0f); };
+            state.flightPath.forEach([&](const FlightPoint &p)
+                                     {
+                ImVec2 s = camera.worldToScreen(p.x, p.z, canvas_p0, canvas_p1);
+                path.add(s.x, s.y, emit); });
+            path.end(emit);
+            path_vertices = path.keptPoints();
 
             // Draw aircraft
             if (!state.flightPath.empty())
             {
-                ImVec2 aircraft_pos = camera.worldToScreen(static_cast<float>(state.position.x),
-                                                           static_cast<float>(state.position.y), canvas_p0, canvas_p1);
+                ImVec2 aircraft_pos = camera.worldToScreen(static_cast<float>(frame.position.x),
+                                                           static_cast<float>(frame.position.y), canvas_p0, canvas_p1);
                 draw_list->AddCircleFilled(aircraft_pos, 5.0f, IM_COL32(255, 0, 0, 255));
 
                 // Draw force vectors
@@ -69,25 +92,33 @@ public:
     }
 
 private:
+    // Minimum screen distance between kept path vertices [px]
+    static constexpr float PATH_MIN_SPACING = 1.5f;
+    // Minimum screen distance between grid lines [px]
+    static constexpr float GRID_MIN_SPACING = 80.0f;
+
+    // Grid over the visible area only, with a 1-2-5 spacing that follows the zoom
     void drawGrid(ImDrawList *draw_list, const Camera &camera, ImVec2 canvas_p0, ImVec2 canvas_p1)
     {
-        int grid_spacing = 100;
         ImU32 grid_color = IM_COL32(80, 80, 80, 255);
+        float spacing = gridSpacing(camera.view_scale, GRID_MIN_SPACING);
+
+        float x_min, z_max, x_max, z_min;
+        camera.screenToWorld(canvas_p0, canvas_p0, canvas_p1, x_min, z_max);
+        camera.screenToWorld(canvas_p1, canvas_p0, canvas_p1, x_max, z_min);
 
         // Vertical grid lines
-        for (int x = -10000; x <= 10000; x += grid_spacing)
+        for (float i = std::ceil(x_min / spacing); i * spacing <= x_max; i += 1.0f)
         {
-            ImVec2 p0 = camera.worldToScreen(static_cast<float>(x), -1000.0f, canvas_p0, canvas_p1);
-            ImVec2 p1 = camera.worldToScreen(static_cast<float>(x), 10000.0f, canvas_p0, canvas_p1);
-            draw_list->AddLine(p0, p1, grid_color, 1.0f);
+            float x = camera.worldToScreen(i * spacing, 0.0f, canvas_p0, canvas_p1).x;
+            draw_list->AddLine(ImVec2(x, canvas_p0.y), ImVec2(x, canvas_p1.y), grid_color, 1.0f);
         }
 
         // Horizontal grid lines
-        for (int z = 0; z <= 10000; z += grid_spacing)
+        for (float i = std::ceil(z_min / spacing); i * spacing <= z_max; i += 1.0f)
         {
-            ImVec2 p0 = camera.worldToScreen(-10000.0f, static_cast<float>(z), canvas_p0, canvas_p1);
-            ImVec2 p1 = camera.worldToScreen(10000.0f, static_cast<float>(z), canvas_p0, canvas_p1);
-            draw_list->AddLine(p0, p1, grid_color, 1.0f);
+            float y = camera.worldToScreen(0.0f, i * spacing, canvas_p0, canvas_p1).y;
+            draw_list->AddLine(ImVec2(canvas_p0.x, y), ImVec2(canvas_p1.x, y), grid_color, 1.0f);
         }
     }
 
@@ -117,4 +148,6 @@ private:
         draw_list->AddTriangleFilled(tip, p1, p2, color);
         draw_list->AddText(ImVec2(end_pos.x + 5, end_pos.y - 10), color, label);
     }
+
+    PolylineBuilder<ImVec2> path;
 };
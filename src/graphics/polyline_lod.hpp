@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Screen-space level of detail for the flight visualization
+// (kept free of ImGui so the geometry can be reused and checked on its own)
+
+// Axis-aligned screen rectangle in pixels
+struct ScreenRect
+{
+    float x0, y0, x1, y1;
+};
+
+// Turns a stream of projected points into as few polyline vertices as the
+// screen can show:
+// - a point closer than min_spacing pixels to the last kept vertex is
+//   dropped (the last point before a break is always kept)
+// - a segment lying entirely beyond one edge of the clip rect is culled,
+//   which splits the path into separate runs
+// Each finished run of two or more vertices is passed to emit(points, count).
+// The vertex buffer is reused, so steady-state frames do not allocate.
+template <typename Point>
+class PolylineBuilder
+{
+public:
+    void begin(ScreenRect clip_rect, float min_spacing)
+    {
+        clip = clip_rect;
+        min_spacing_sq = min_spacing * min_spacing;
+        run.clear();
+        has_prev = false;
+        prev_dropped = false;
+        kept = 0;
+    }
+
+    template <typename Emit>
+    void add(float x, float y, Emit &&emit)
+    {
+        int code = outcode(x, y);
+        if (has_prev)
+        {
+            if ((code & prev_code) != 0)
+            {
+                // Off screen: end the current run here
+                flush(emit);
+            }
+            else
+            {
+                if (run.empty())
+                    run.push_back(Point(prev_x, prev_y));
+                float dx = x - run.back().x;
+                float dy = y - run.back().y;
+                prev_dropped = dx * dx + dy * dy < min_spacing_sq;
+                if (!prev_dropped)
+                    run.push_back(Point(x, y));
+            }
+        }
+        prev_x = x;
+        prev_y = y;
+        prev_code = code;
+        has_prev = true;
+    }
+
+    template <typename Emit>
+    void end(Emit &&emit)
+    {
+        flush(emit);
+        has_prev = false;
+    }
+
+    // Vertices emitted since begin()
+    size_t keptPoints() const { return kept; }
+
+private:
+    int outcode(float x, float y) const
+    {
+        return (x < clip.x0 ? 1 : 0) | (x > clip.x1 ? 2 : 0) | (y < clip.y0 ? 4 : 0) | (y > clip.y1 ? 8 : 0);
+    }
+
+    template <typename Emit>
+    void flush(Emit &&emit)
+    {
+        if (prev_dropped && !run.empty())
+            run.push_back(Point(prev_x, prev_y));
+        if (run.size() >= 2)
+        {
+            emit(run.data(), static_cast<int>(run.size()));
+            kept += run.size();
+        }
+        run.clear();
+        prev_dropped = false;
+    }
+
+    ScreenRect clip{0.0f, 0.0f, 0.0f, 0.0f};
+    float min_spacing_sq = 0.0f;
+    std::vector<Point> run;
+    float prev_x = 0.0f, prev_y = 0.0f;
+    int prev_code = 0;
+    bool has_prev = false;
+    bool prev_dropped = false; // Last point was skipped by decimation
+    size_t kept = 0;
+};
+
+// World spacing of grid lines for a zoom level: the smallest 1-2-5 step
+// (…, 10, 20, 50, 100, …) that keeps lines at least min_pixels apart
+inline float gridSpacing(float pixels_per_unit, float min_pixels)
+{
+    if (!(pixels_per_unit > 0.0f))
+        return 1.0f;
+    double target = static_cast<double>(min_pixels) / pixels_per_unit;
+    double decade = std::pow(10.0, std::floor(std::log10(target)));
+    for (double step : {1.0, 2.0, 5.0, 10.0})
+    {
+        if (step * decade >= target * (1.0 - 1e-9))
+            return static_cast<float>(step * decade);
+    }
+    return static_cast<float>(10.0 * decade);
+}
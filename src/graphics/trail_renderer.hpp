@@ -0,0 +1,347 @@
+#pragma once
+
+#include "imgui.h"
+#include "camera.hpp"
+#include "polyline_lod.hpp"
+#include "../simulation/trajectory_set.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// How a TrajectorySet is drawn
+enum class TrailMode
+{
+    Auto,   // Lines up to density_threshold runs, density above
+    Lines,  // One decimated polyline per run, coloured by the selected metric
+    Density // Heatmap of how many runs cross each cell
+};
+
+// Viridis colormap (t in 0..1)
+inline ImU32 colormapViridis(float t, int alpha = 255)
+{
+    static const float stops[5][3] = {{68, 1, 84}, {59, 82, 139}, {33, 145, 140}, {94, 201, 98}, {253, 231, 37}};
+    t = std::max(0.0f, std::min(t, 1.0f)) * 4.0f;
+    int i = std::min(static_cast<int>(t), 3);
+    float f = t - static_cast<float>(i);
+    int c[3];
+    for (int k = 0; k < 3; k++)
+        c[k] = static_cast<int>(stops[i][k] + (stops[i + 1][k] - stops[i][k]) * f);
+    return IM_COL32(c[0], c[1], c[2], alpha);
+}
+
+// Draws many trajectories (batch lanes, sweep cases, recordings) at once
+//
+// Runs whose bounding box is off screen are skipped outright. In line mode
+// each visible run goes through the same decimating PolylineBuilder as the
+// live flight path. In density mode the runs are rasterized once into a
+// world-space grid whose cells are a few pixels at the current zoom; the grid
+// is rebuilt only when the data or the zoom changes (panning just moves it),
+// and adjacent cells of equal colour are merged into one rectangle. Aircraft
+// markers for all runs are written straight into the vertex buffer in large
+// batches rather than one draw call each.
+class TrailRenderer
+{
+public:
+    TrailMode mode = TrailMode::Auto;
+    size_t density_threshold = 1000; // Auto switches to density above this many runs
+    int metric = 0;                  // Metric used for colours
+    float marker_time = 1.0f;        // Marker position along each run (0 = start, 1 = end)
+    bool show_markers = true;
+
+    // Statistics of the last frame
+    size_t drawn_runs = 0;
+    size_t drawn_vertices = 0;
+    bool drew_density = false;
+
+    void render(ImDrawList *draw_list, const TrajectorySet &set, const Camera &camera, ImVec2 canvas_p0,
+                ImVec2 canvas_p1)
+    {
+        drawn_runs = 0;
+        drawn_vertices = 0;
+        drew_density = false;
+        if (set.empty())
+            return;
+
+        size_t m = set.metricCount() > 0 ? static_cast<size_t>(std::max(0, metric)) % set.metricCount() : 0;
+        float lo = 0.0f, hi = 0.0f;
+        if (set.metricCount() > 0)
+            set.metricRange(m, lo, hi);
+        float inv_range = hi > lo ? 1.0f / (hi - lo) : 0.0f;
+        auto runColor = [&](size_t r, int alpha)
+        {
+            float t = set.metricCount() > 0 ? (set.metric(r, m) - lo) * inv_range : 0.5f;
+            return colormapViridis(t, alpha);
+        };
+
+        // World rectangle in view, for culling whole runs
+        float vx0, vz1, vx1, vz0;
+        camera.screenToWorld(canvas_p0, canvas_p0, canvas_p1, vx0, vz1);
+        camera.screenToWorld(canvas_p1, canvas_p0, canvas_p1, vx1, vz0);
+        auto visible = [&](size_t r)
+        {
+            const TrajectorySet::Bounds &b = set.bounds(r);
+            return set.pointCount(r) > 0 && b.x1 >= vx0 && b.x0 <= vx1 && b.z1 >= vz0 && b.z0 <= vz1;
+        };
+
+        bool density = mode == TrailMode::Density || (mode == TrailMode::Auto && set.size() > density_threshold);
+        if (density)
+        {
+            drawDensity(draw_list, set, camera, canvas_p0, canvas_p1);
+            drew_density = true;
+            drawn_runs = set.size();
+        }
+        else
+        {
+            const float margin = 2.0f;
+            ScreenRect clip = {canvas_p0.x - margin, canvas_p0.y - margin, canvas_p1.x + margin, canvas_p1.y + margin};
+            for (size_t r = 0; r < set.size(); r++)
+            {
+                if (!visible(r))
+                    continue;
+                ImU32 color = runColor(r, 160);
+                auto emit = [&](const ImVec2 *points, int count)
+                { draw_list->AddPolyline(points, count, color, ImDrawFlags_None, 1.0f); };
+                path.begin(clip, 1.5f);
+                const float *x = set.x(r);
+                const float *z = set.z(r);
+                for (size_t i = 0; i < set.pointCount(r); i++)
+                {
+                    ImVec2 s = camera.worldToScreen(x[i], z[i], canvas_p0, canvas_p1);
+                    path.add(s.x, s.y, emit);
+                }
+                path.end(emit);
+                drawn_vertices += path.keptPoints();
+                drawn_runs++;
+            }
+        }
+
+        if (show_markers)
+        {
+            markers.clear();
+            for (size_t r = 0; r < set.size(); r++)
+            {
+                size_t n = set.pointCount(r);
+                if (n == 0)
+                    continue;
+                size_t i = static_cast<size_t>(std::lround(std::max(0.0f, std::min(marker_time, 1.0f)) *
+                                                           static_cast<float>(n - 1)));
+                ImVec2 s = camera.worldToScreen(set.x(r)[i], set.z(r)[i], canvas_p0, canvas_p1);
+                if (s.x < canvas_p0.x || s.x > canvas_p1.x || s.y < canvas_p0.y || s.y > canvas_p1.y)
+                    continue;
+                // Point along the direction of travel
+                size_t j = i > 0 ? i - 1 : std::min<size_t>(1, n - 1);
+                float dx = (set.x(r)[i] - set.x(r)[j]) * (i > 0 ? 1.0f : -1.0f);
+                float dz = (set.z(r)[i] - set.z(r)[j]) * (i > 0 ? 1.0f : -1.0f);
+                float len = std::sqrt(dx * dx + dz * dz);
+                markers.push_back({s, len > 0.0f ? dx / len : 1.0f, len > 0.0f ? -dz / len : 0.0f, runColor(r, 255)});
+            }
+            drawMarkers(draw_list);
+        }
+    }
+
+private:
+    struct Marker
+    {
+        ImVec2 pos;
+        float dir_x, dir_y; // Unit direction on screen
+        ImU32 color;
+    };
+
+    struct Rect
+    {
+        ImVec2 a, b;
+        ImU32 color;
+    };
+
+    // Density grid in world space, valid for one data revision and zoom
+    struct DensityGrid
+    {
+        uint64_t revision = ~0ull;
+        float scale = 0.0f;
+        float x0 = 0.0f, z0 = 0.0f, cell = 1.0f;
+        int w = 0, h = 0;
+        uint32_t max_count = 0;
+        std::vector<uint32_t> count;
+        std::vector<uint32_t> last_run; // Run that last touched each cell (+1), so a run counts once per cell
+    };
+
+    static constexpr float DENSITY_CELL_PX = 3.0f;
+    static constexpr int DENSITY_MAX_CELLS = 1024; // Per axis
+    static constexpr int DENSITY_LEVELS = 32;
+    static constexpr int PRIMS_PER_BATCH = 8192; // Keeps each batch within 16-bit indices
+
+    void buildDensity(const TrajectorySet &set, float scale)
+    {
+        DensityGrid &g = grid;
+        g.revision = set.getRevision();
+        g.scale = scale;
+        g.w = g.h = 0;
+        g.max_count = 0;
+        g.count.clear();
+        g.last_run.clear();
+
+        // Runs without a finite point have empty (inverted) bounds
+        float x0 = std::numeric_limits<float>::max(), z0 = x0;
+        float x1 = std::numeric_limits<float>::lowest(), z1 = x1;
+        for (size_t r = 0; r < set.size(); r++)
+        {
+            const TrajectorySet::Bounds &b = set.bounds(r);
+            if (b.x0 > b.x1)
+                continue;
+            x0 = std::min(x0, b.x0);
+            x1 = std::max(x1, b.x1);
+            z0 = std::min(z0, b.z0);
+            z1 = std::max(z1, b.z1);
+        }
+        if (x0 > x1)
+            return; // Nothing to draw
+
+        g.cell = std::max({DENSITY_CELL_PX / scale, (x1 - x0) / (DENSITY_MAX_CELLS - 1),
+                           (z1 - z0) / (DENSITY_MAX_CELLS - 1), 1e-6f});
+        g.x0 = x0;
+        g.z0 = z0;
+        g.w = static_cast<int>((x1 - x0) / g.cell) + 1;
+        g.h = static_cast<int>((z1 - z0) / g.cell) + 1;
+        g.count.assign(static_cast<size_t>(g.w) * g.h, 0);
+        g.last_run.assign(g.count.size(), 0);
+
+        const float inv = 1.0f / g.cell;
+        for (size_t r = 0; r < set.size(); r++)
+        {
+            const uint32_t stamp = static_cast<uint32_t>(r + 1);
+            const float *x = set.x(r);
+            const float *z = set.z(r);
+            auto touch = [&](float cx, float cz)
+            {
+                int ix = std::min(std::max(static_cast<int>(cx), 0), g.w - 1);
+                int iz = std::min(std::max(static_cast<int>(cz), 0), g.h - 1);
+                size_t c = static_cast<size_t>(iz) * g.w + ix;
+                if (g.last_run[c] != stamp)
+                {
+                    g.last_run[c] = stamp;
+                    g.max_count = std::max(g.max_count, ++g.count[c]);
+                }
+            };
+            // Non-finite samples (a diverged run) are skipped and break the line
+            bool have_previous = false;
+            float px = 0.0f, pz = 0.0f;
+            for (size_t i = 0; i < set.pointCount(r); i++)
+            {
+                if (!std::isfinite(x[i]) || !std::isfinite(z[i]))
+                {
+                    have_previous = false;
+                    continue;
+                }
+                float cx = (x[i] - x0) * inv, cz = (z[i] - z0) * inv;
+                if (!have_previous)
+                {
+                    touch(cx, cz);
+                }
+                else
+                {
+                    int steps = static_cast<int>(std::max(std::fabs(cx - px), std::fabs(cz - pz))) + 1;
+                    float sx = (cx - px) / steps, sz = (cz - pz) / steps;
+                    for (int k = 1; k <= steps; k++)
+                        touch(px + sx * k, pz + sz * k);
+                }
+                px = cx;
+                pz = cz;
+                have_previous = true;
+            }
+        }
+    }
+
+    void drawDensity(ImDrawList *draw_list, const TrajectorySet &set, const Camera &camera, ImVec2 canvas_p0,
+                     ImVec2 canvas_p1)
+    {
+        if (grid.revision != set.getRevision() || grid.scale != camera.view_scale)
+            buildDensity(set, camera.view_scale);
+        const DensityGrid &g = grid;
+        if (g.max_count == 0)
+            return;
+
+        // Visible cell range
+        float wx0, wz1, wx1, wz0;
+        camera.screenToWorld(canvas_p0, canvas_p0, canvas_p1, wx0, wz1);
+        camera.screenToWorld(canvas_p1, canvas_p0, canvas_p1, wx1, wz0);
+        int ix0 = std::max(0, static_cast<int>(std::floor((wx0 - g.x0) / g.cell)));
+        int ix1 = std::min(g.w - 1, static_cast<int>(std::floor((wx1 - g.x0) / g.cell)));
+        int iz0 = std::max(0, static_cast<int>(std::floor((wz0 - g.z0) / g.cell)));
+        int iz1 = std::min(g.h - 1, static_cast<int>(std::floor((wz1 - g.z0) / g.cell)));
+
+        // Log scale so single stray runs stay visible next to dense bundles
+        const float inv_log_max = 1.0f / std::log1p(static_cast<float>(g.max_count));
+        auto level = [&](uint32_t c)
+        {
+            if (c == 0)
+                return 0;
+            float t = std::log1p(static_cast<float>(c)) * inv_log_max;
+            return 1 + std::min(DENSITY_LEVELS - 1, static_cast<int>(t * (DENSITY_LEVELS - 1)));
+        };
+
+        rects.clear();
+        for (int iz = iz0; iz <= iz1; iz++)
+        {
+            const uint32_t *row = g.count.data() + static_cast<size_t>(iz) * g.w;
+            int ix = ix0;
+            while (ix <= ix1)
+            {
+                int l = level(row[ix]);
+                int start = ix;
+                while (ix <= ix1 && level(row[ix]) == l)
+                    ix++;
+                if (l == 0)
+                    continue;
+                // Merged run of equal cells [start, ix)
+                ImVec2 a = camera.worldToScreen(g.x0 + start * g.cell, g.z0 + (iz + 1) * g.cell, canvas_p0, canvas_p1);
+                ImVec2 b = camera.worldToScreen(g.x0 + ix * g.cell, g.z0 + iz * g.cell, canvas_p0, canvas_p1);
+                float t = static_cast<float>(l - 1) / (DENSITY_LEVELS - 1);
+                rects.push_back({a, b, colormapViridis(t, 220)});
+            }
+        }
+
+        for (size_t first = 0; first < rects.size(); first += PRIMS_PER_BATCH)
+        {
+            int n = static_cast<int>(std::min<size_t>(PRIMS_PER_BATCH, rects.size() - first));
+            draw_list->PrimReserve(n * 6, n * 4);
+            for (int i = 0; i < n; i++)
+            {
+                const Rect &r = rects[first + i];
+                draw_list->PrimRect(r.a, r.b, r.color);
+            }
+        }
+        drawn_vertices = rects.size() * 4;
+    }
+
+    void drawMarkers(ImDrawList *draw_list)
+    {
+        const float size = 5.0f;
+        const ImVec2 uv = ImGui::GetFontTexUvWhitePixel();
+        for (size_t first = 0; first < markers.size(); first += PRIMS_PER_BATCH)
+        {
+            int n = static_cast<int>(std::min<size_t>(PRIMS_PER_BATCH, markers.size() - first));
+            draw_list->PrimReserve(n * 3, n * 3);
+            for (int i = 0; i < n; i++)
+            {
+                const Marker &mk = markers[first + i];
+                float fx = mk.dir_x * size, fy = mk.dir_y * size; // Forward
+                float sx = -fy * 0.5f, sy = fx * 0.5f;            // Sideways
+                ImDrawIdx base = static_cast<ImDrawIdx>(draw_list->_VtxCurrentIdx);
+                draw_list->PrimWriteVtx(ImVec2(mk.pos.x + fx, mk.pos.y + fy), uv, mk.color);
+                draw_list->PrimWriteVtx(ImVec2(mk.pos.x - fx * 0.6f + sx, mk.pos.y - fy * 0.6f + sy), uv, mk.color);
+                draw_list->PrimWriteVtx(ImVec2(mk.pos.x - fx * 0.6f - sx, mk.pos.y - fy * 0.6f - sy), uv, mk.color);
+                draw_list->PrimWriteIdx(base);
+                draw_list->PrimWriteIdx(static_cast<ImDrawIdx>(base + 1));
+                draw_list->PrimWriteIdx(static_cast<ImDrawIdx>(base + 2));
+            }
+        }
+        drawn_vertices += markers.size() * 3;
+    }
+
+    PolylineBuilder<ImVec2> path;
+    DensityGrid grid;
+    std::vector<Rect> rects;
+    std::vector<Marker> markers;
+};
@@ -2,11 +2,25 @@
 
 #include "imgui.h"
 #include "../simulation/simulation_state.hpp"
+#include "../simulation/flight_recording.hpp"
+#include "../simulation/trajectory_set.hpp"
+#include "../simulation/gain_tuner.hpp"
+#include "../simulation/flight_envelope.hpp"
+#include "trail_renderer.hpp"
 #include "../environment/atmosphere.hpp"
 #include "../aircraft/aircraft_loader.hpp"
+#include "../core/profiler.hpp"
+#include "../telemetry/telemetry_publisher.hpp"
 #include <string>
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <random>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -24,13 +38,85 @@ struct UIState
 {
     bool show_demo;
     bool show_metrics;
+    bool show_profiler;
     bool show_vectors;
     ImVec4 clear_color;
     float avg_fps;
     float avg_frame_time;
+    int physics_substeps;    // Physics steps run in the last simulation thread wake-up
+    float dropped_time_ms;   // Wall time discarded by the substep guard
+    float sim_steps_per_sec; // Measured simulation thread step rate
+    float achieved_warp;     // Simulated seconds per wall second actually reached
+    bool warp_limited;       // The simulation thread ran out of its step budget
+    bool aircraft_changed;   // Set when a new aircraft was loaded into the UI state
+
+    // Rewind (handled by the simulation thread's keyframe ring)
+    double rewind_oldest;  // Earliest reachable simulated time [s]
+    float rewind_time;     // Slider value; follows the current time unless dragged
+    bool rewind_scrubbing; // Slider is being dragged
+    bool rewind_requested; // Set when the UI wants the simulation rewound to rewind_time
+
+    // Replay of a recording (.fdrec) instead of the live simulation
+    RecordingPlayer replay;
+    char replay_path[512];
+    std::string replay_message;
+    bool replay_error;
+
+    // Trajectories of many runs drawn under the live flight (batch results, recordings)
+    TrajectorySet trails;
+    std::future<TrajectorySet> trails_job; // Batch being flown in the background
+    int trails_lanes;
+    float trails_duration; // Simulated seconds per lane
+    float trails_spread;   // Relative spread of mass and setpoints across lanes
+    char trails_path[512]; // Recording file or directory of recordings
+    std::string trails_message;
+    bool trails_error;
+
+    // Trimmed start from the aircraft's level-flight trim map (flight_envelope.hpp)
+    FlightEnvelope envelope;
+    std::future<FlightEnvelope> envelope_job; // Loaded from the cache or computed in the background
+    bool envelope_stale;                      // Aircraft changed since the map was requested
+    float trim_speed;
+    float trim_altitude;
+    bool trim_requested; // Set when the UI wants a reset into trim / trim_result
+    TrimCondition trim;
+    TrimResult trim_result;
+    std::string trim_message;
+    bool trim_error;
+
+    // Autopilot gain search (gain_tuner.hpp) on a copy of the aircraft
+    std::future<GainTuneResult> tune_job;
+    GainTuneResult tune_result;
+    bool tune_done; // tune_result holds a finished search
+    std::string tune_message;
+    bool tune_error;
+
+    // Telemetry stream (telemetry_publisher.hpp); opened here, run by the simulation thread
+    std::shared_ptr<TelemetryPublisher> telemetry;
+    bool telemetry_changed; // Set when the simulation thread should be handed 'telemetry'
+    bool telemetry_udp;
+    char telemetry_address[64];
+    int telemetry_port;
+    bool telemetry_shm;
+    char telemetry_shm_name[64];
+    float telemetry_rate; // Packets per simulated second
+    std::string telemetry_message;
+    bool telemetry_error;
+
+    // Profiler panel (zones from profiler.hpp)
+    ProfileSummary profile;  // Refreshed a few times per second
+    double profile_refreshed; // ImGui time of the last refresh [s]
+    int profile_zone;        // Zone shown in the plots
+    char trace_path[512];
+    std::string trace_message;
+    bool trace_error;
 
     std::string load_message;
     bool load_error;
+    bool load_requested;       // Set when the UI wants load_request parsed (off the UI thread)
+    std::string load_request;  // Config path to load
+    std::string active_config; // Path of the loaded config; hot reloads apply to it
+    bool configs_scanning;     // Config directory scan still running
     int selected_aircraft;
     std::vector<AircraftConfigUI> aircraft_configs;
     std::vector<std::string> aircraft_name_storage;
@@ -39,12 +125,58 @@ struct UIState
     UIState()
         : show_demo(false),
           show_metrics(false),
+          show_profiler(false),
           show_vectors(true),
           clear_color(0.45f, 0.55f, 0.60f, 1.00f),
           avg_fps(0.0f),
           avg_frame_time(0.0f),
+          physics_substeps(0),
+          dropped_time_ms(0.0f),
+          sim_steps_per_sec(0.0f),
+          achieved_warp(1.0f),
+          warp_limited(false),
+          aircraft_changed(false),
+          rewind_oldest(0.0),
+          rewind_time(0.0f),
+          rewind_scrubbing(false),
+          rewind_requested(false),
+          replay_path("recording.fdrec"),
+          replay_message(""),
+          replay_error(false),
+          trails_lanes(1000),
+          trails_duration(60.0f),
+          trails_spread(0.2f),
+          trails_path("recordings"),
+          trails_message(""),
+          trails_error(false),
+          envelope_stale(true),
+          trim_speed(22.0f),
+          trim_altitude(120.0f),
+          trim_requested(false),
+          trim({0.0, 0.0}),
+          trim_message(""),
+          trim_error(false),
+          tune_done(false),
+          tune_message(""),
+          tune_error(false),
+          telemetry_changed(false),
+          telemetry_udp(true),
+          telemetry_address("239.255.0.1"),
+          telemetry_port(5005),
+          telemetry_shm(true),
+          telemetry_shm_name("flightsim_telemetry"),
+          telemetry_rate(100.0f),
+          telemetry_message(""),
+          telemetry_error(false),
+          profile_refreshed(0.0),
+          profile_zone(0),
+          trace_path("flight_trace.json"),
+          trace_message(""),
+          trace_error(false),
           load_message(""),
           load_error(false),
+          load_requested(false),
+          configs_scanning(true),
           selected_aircraft(0)
     {
     }
@@ -71,6 +203,114 @@ inline void renderControlPanel(SimulationState &state, UIState &ui_state)
         state.reset_requested = true;
     }
 
+    // Time warp: the simulation thread runs as many steps as its budget allows
+    ImGui::SliderFloat("Time Warp", &state.time_warp, SimulationState::MIN_TIME_WARP, SimulationState::MAX_TIME_WARP,
+                       "%.0fx", ImGuiSliderFlags_Logarithmic);
+    for (float warp : {1.0f, 10.0f, 100.0f, 1000.0f})
+    {
+        char label[16];
+        std::snprintf(label, sizeof(label), "%.0fx", warp);
+        if (warp > 1.0f)
+            ImGui::SameLine();
+        if (ImGui::Button(label, ImVec2(55, 0)))
+            state.time_warp = warp;
+    }
+
+    // Rewind: the run continues from the chosen time with the current controls,
+    // so e.g. an autopilot can be engaged at an earlier point of the flight
+    float oldest = static_cast<float>(ui_state.rewind_oldest);
+    float now = static_cast<float>(state.t);
+    if (ImGui::Button("-30 s"))
+    {
+        ui_state.rewind_time = std::max(oldest, now - 30.0f);
+        ui_state.rewind_requested = true;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("-5 s"))
+    {
+        ui_state.rewind_time = std::max(oldest, now - 5.0f);
+        ui_state.rewind_requested = true;
+    }
+    ImGui::SameLine();
+    if (!ui_state.rewind_scrubbing && !ui_state.rewind_requested)
+        ui_state.rewind_time = now;
+    ImGui::SliderFloat("Rewind (s)", &ui_state.rewind_time, oldest, std::max(oldest, now), "%.1f");
+    ui_state.rewind_scrubbing = ImGui::IsItemActive();
+    if (ImGui::IsItemDeactivatedAfterEdit())
+        ui_state.rewind_requested = true;
+
+    // Trimmed start: level flight at the chosen speed and altitude instead of
+    // waiting for the aircraft to settle
+    ImGui::Separator();
+    ImGui::Text("Trimmed Start:");
+    bool mapping = ui_state.envelope_job.valid();
+    if (mapping && ui_state.envelope_job.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        try
+        {
+            ui_state.envelope = ui_state.envelope_job.get();
+        }
+        catch (const std::exception &e)
+        {
+            ui_state.envelope = FlightEnvelope();
+            ui_state.trim_message = std::string("Error: ") + e.what();
+            ui_state.trim_error = true;
+        }
+        mapping = false;
+    }
+    if (ui_state.aircraft_changed ||
+        (!ui_state.envelope.empty() && ui_state.envelope.configHash() != state.aircraft.configHash()))
+        ui_state.envelope_stale = true;
+    if (!mapping && ui_state.envelope_stale)
+    {
+        // Cached on disk by config hash, so only the first use of an aircraft computes it
+        Aircraft aircraft = state.aircraft;
+        ui_state.envelope_job = std::async(std::launch::async, [aircraft]()
+                                           {
+            ThreadPool pool;
+            return loadOrComputeEnvelope(aircraft, EnvelopeGrid(), ENVELOPE_CACHE_DIR, pool); });
+        ui_state.envelope_stale = false;
+        mapping = true;
+    }
+
+    ImGui::SliderFloat("Trim Speed (m/s)", &ui_state.trim_speed, 5.0f, 80.0f, "%.1f");
+    ImGui::SliderFloat("Trim Altitude (m)", &ui_state.trim_altitude, 0.0f, 4000.0f, "%.0f");
+    double range_lo = 0.0, range_hi = 0.0;
+    if (mapping)
+        ImGui::TextDisabled("Computing trim map...");
+    else if (ui_state.envelope.speedRange(ui_state.trim_altitude, range_lo, range_hi))
+        ImGui::Text("Level flight from %.0f to %.0f m/s at this altitude", range_lo, range_hi);
+    else
+        ImGui::Text("No trimmed level flight at this altitude");
+    if (ImGui::Button("Start Trimmed", ImVec2(120, 0)))
+    {
+        TrimCondition cond = {ui_state.trim_speed, ui_state.trim_altitude};
+        const FlightEnvelope *env = mapping || ui_state.envelope.empty() ? nullptr : &ui_state.envelope;
+        TrimResult r = trimFromEnvelope(state.aircraft, env, cond);
+        if (r.trimmed())
+        {
+            ui_state.trim = cond;
+            ui_state.trim_result = r;
+            ui_state.trim_requested = true;
+            char msg[96];
+            std::snprintf(msg, sizeof(msg), "Trimmed: throttle %.3f, pitch %.2f deg", r.throttle, r.pitch_deg);
+            ui_state.trim_message = msg;
+            ui_state.trim_error = false;
+        }
+        else
+        {
+            ui_state.trim_message = std::string("Cannot trim here: ") + trimStatusName(r.status);
+            ui_state.trim_error = true;
+        }
+    }
+    if (!ui_state.trim_message.empty())
+    {
+        if (ui_state.trim_error)
+            ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s", ui_state.trim_message.c_str());
+        else
+            ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%s", ui_state.trim_message.c_str());
+    }
+
     ImGui::Separator();
     ImGui::Text("Controls:");
     ImGui::SliderFloat("Throttle %%", &state.throttle, 0.0f, 1.0f, "%.2f");
@@ -100,11 +340,11 @@ inline void renderControlPanel(SimulationState &state, UIState &ui_state)
         ImGui::SliderFloat("Target Speed (m/s)", &state.speed_setpoint, 10.0f, 100.0f, "%.1f");
         ImGui::Text("PID Gains:");
         if (ImGui::SliderFloat("Kp (Proportional)", &state.pid_kp, 0.0f, 0.1f, "%.4f"))
-            state.speed_pid = PIDController(state.pid_kp, state.pid_ki, state.pid_kd, 0.0, 1.0);
+            state.speed_pid.setGains(state.pid_kp, state.pid_ki, state.pid_kd);
         if (ImGui::SliderFloat("Ki (Integral)", &state.pid_ki, 0.0f, 0.01f, "%.5f"))
-            state.speed_pid = PIDController(state.pid_kp, state.pid_ki, state.pid_kd, 0.0, 1.0);
+            state.speed_pid.setGains(state.pid_kp, state.pid_ki, state.pid_kd);
         if (ImGui::SliderFloat("Kd (Derivative)", &state.pid_kd, 0.0f, 0.05f, "%.4f"))
-            state.speed_pid = PIDController(state.pid_kp, state.pid_ki, state.pid_kd, 0.0, 1.0);
+            state.speed_pid.setGains(state.pid_kp, state.pid_ki, state.pid_kd);
 
         ImGui::Text("PID Terms:");
         ImGui::Text("  P: %.4f  I: %.4f  D: %.4f",
@@ -128,11 +368,11 @@ inline void renderControlPanel(SimulationState &state, UIState &ui_state)
         ImGui::SliderFloat("Target Altitude (m)", &state.altitude_setpoint, 0.0f, 1000.0f, "%.1f");
         ImGui::Text("PID Gains:");
         if (ImGui::SliderFloat("Kp (Proportional)##alt", &state.alt_pid_kp, 0.0f, 1.0f, "%.4f"))
-            state.altitude_pid = PIDController(state.alt_pid_kp, state.alt_pid_ki, state.alt_pid_kd, -10.0, 15.0);
+            state.altitude_pid.setGains(state.alt_pid_kp, state.alt_pid_ki, state.alt_pid_kd);
         if (ImGui::SliderFloat("Ki (Integral)##alt", &state.alt_pid_ki, 0.0f, 0.01f, "%.5f"))
-            state.altitude_pid = PIDController(state.alt_pid_kp, state.alt_pid_ki, state.alt_pid_kd, -10.0, 15.0);
+            state.altitude_pid.setGains(state.alt_pid_kp, state.alt_pid_ki, state.alt_pid_kd);
         if (ImGui::SliderFloat("Kd (Derivative)##alt", &state.alt_pid_kd, 0.0f, 2.0f, "%.4f"))
-            state.altitude_pid = PIDController(state.alt_pid_kp, state.alt_pid_ki, state.alt_pid_kd, -10.0, 15.0);
+            state.altitude_pid.setGains(state.alt_pid_kp, state.alt_pid_ki, state.alt_pid_kd);
 
         ImGui::Text("PID Terms:");
         ImGui::Text("  P: %.4f  I: %.4f  D: %.4f",
@@ -142,6 +382,77 @@ inline void renderControlPanel(SimulationState &state, UIState &ui_state)
         ImGui::Text("Altitude Error: %.2f m", state.altitude_setpoint - state.position.y);
     }
 
+    // Auto-tune: step responses of both loops flown in parallel batches in
+    // the background; the best gains are put on the sliders
+    ImGui::Separator();
+    ImGui::Text("Autopilot - Auto-tune:");
+    bool tuning = ui_state.tune_job.valid();
+    if (tuning && ui_state.tune_job.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        try
+        {
+            ui_state.tune_result = ui_state.tune_job.get();
+            const AutopilotGains &g = ui_state.tune_result.gains;
+            state.applyAutopilotGains(g);
+            state.speed_pid.setGains(state.pid_kp, state.pid_ki, state.pid_kd);
+            state.altitude_pid.setGains(state.alt_pid_kp, state.alt_pid_ki, state.alt_pid_kd);
+            ui_state.tune_done = true;
+            ui_state.tune_message = "Tuned gains applied";
+            ui_state.tune_error = false;
+        }
+        catch (const std::exception &e)
+        {
+            ui_state.tune_message = std::string("Error: ") + e.what();
+            ui_state.tune_error = true;
+        }
+        tuning = false;
+    }
+    if (tuning)
+    {
+        ImGui::Text("Tuning...");
+    }
+    else if (ImGui::Button("Auto-tune Gains", ImVec2(150, 0)))
+    {
+        Aircraft aircraft = state.aircraft;
+        AutopilotGains start = state.autopilotGains();
+        GainTuneOptions opts;
+        opts.dt = state.dt;
+        ui_state.tune_job = std::async(std::launch::async, [aircraft, start, opts]()
+                                       {
+            ThreadPool pool;
+            return tuneAutopilotGains(aircraft, start, pool, opts); });
+    }
+    if (!ui_state.active_config.empty())
+    {
+        ImGui::SameLine();
+        if (ImGui::Button("Save Gains to Config", ImVec2(150, 0)))
+        {
+            try
+            {
+                AircraftLoader::writeAutopilotGains(ui_state.active_config, state.autopilotGains());
+                ui_state.tune_message = "Saved gains to " + ui_state.active_config;
+                ui_state.tune_error = false;
+            }
+            catch (const std::exception &e)
+            {
+                ui_state.tune_message = std::string("Error: ") + e.what();
+                ui_state.tune_error = true;
+            }
+        }
+    }
+    if (ui_state.tune_done)
+    {
+        ImGui::Text("Score %.3f -> %.3f (%zu flights, %.2f s)", ui_state.tune_result.initial_score,
+                    ui_state.tune_result.score, ui_state.tune_result.evaluations, ui_state.tune_result.seconds);
+    }
+    if (!ui_state.tune_message.empty())
+    {
+        if (ui_state.tune_error)
+            ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s", ui_state.tune_message.c_str());
+        else
+            ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%s", ui_state.tune_message.c_str());
+    }
+
     // Flight Data
     ImGui::Separator();
     ImGui::Text("Flight Data:");
@@ -160,8 +471,9 @@ inline void renderControlPanel(SimulationState &state, UIState &ui_state)
     double current_CL, current_CD;
     if (state.aircraft.hasAeroTable())
     {
-        current_CL = calcCL(current_alpha, state.aircraft.aeroTable.get());
-        current_CD = calcCD(current_alpha, state.aircraft.CD0, state.aircraft.aeroTable.get());
+        AeroCoefficients coeffs = calcCLCD(current_alpha, state.aircraft.CD0, state.aircraft.aeroTable.get());
+        current_CL = coeffs.CL;
+        current_CD = coeffs.CD;
     }
     else
     {
@@ -205,29 +517,31 @@ inline void renderControlPanel(SimulationState &state, UIState &ui_state)
     }
 
     ImGui::SameLine();
-    if (ImGui::Button("Load Selected"))
+    bool has_selection = ui_state.selected_aircraft >= 0 &&
+                         ui_state.selected_aircraft < static_cast<int>(ui_state.aircraft_configs.size());
+    if (ImGui::Button("Load Selected") && has_selection)
     {
-        try
+        const AircraftConfigUI &config = ui_state.aircraft_configs[ui_state.selected_aircraft];
+        if (config.filepath.empty())
         {
-            if (ui_state.aircraft_configs[ui_state.selected_aircraft].filepath.empty())
-            {
-                state.aircraft = Aircraft();
-                ui_state.load_message = std::string("Loaded: ") + ui_state.aircraft_configs[ui_state.selected_aircraft].name;
-                ui_state.load_error = false;
-            }
-            else
-            {
-                state.aircraft = AircraftLoader::loadFromJSON(ui_state.aircraft_configs[ui_state.selected_aircraft].filepath);
-                ui_state.load_message = std::string("Loaded: ") + ui_state.aircraft_configs[ui_state.selected_aircraft].name;
-                ui_state.load_error = false;
-            }
+            state.aircraft = Aircraft();
+            ui_state.active_config.clear();
+            ui_state.load_request.clear(); // Drops any load still in flight
+            ui_state.load_message = std::string("Loaded: ") + config.name;
+            ui_state.load_error = false;
+            ui_state.aircraft_changed = true;
         }
-        catch (const std::exception &e)
+        else
         {
-            ui_state.load_message = std::string("Error: ") + e.what();
-            ui_state.load_error = true;
+            // Parsed by the config watcher; the result arrives in a later frame
+            ui_state.load_request = config.filepath;
+            ui_state.load_requested = true;
+            ui_state.load_message = std::string("Loading: ") + config.name;
+            ui_state.load_error = false;
         }
     }
+    if (ui_state.configs_scanning)
+        ImGui::TextDisabled("Scanning config directory...");
 
     if (!ui_state.load_message.empty())
     {
@@ -237,12 +551,98 @@ inline void renderControlPanel(SimulationState &state, UIState &ui_state)
             ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%s", ui_state.load_message.c_str());
     }
 
+    // Telemetry stream for external tools
+    ImGui::Separator();
+    ImGui::Text("Telemetry:");
+    if (!ui_state.telemetry)
+    {
+        ImGui::Checkbox("UDP", &ui_state.telemetry_udp);
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(120);
+        ImGui::InputText("##telemetry_address", ui_state.telemetry_address, sizeof(ui_state.telemetry_address));
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(90);
+        ImGui::InputInt("Port", &ui_state.telemetry_port);
+        ui_state.telemetry_port = std::clamp(ui_state.telemetry_port, 1, 65535);
+        ImGui::Checkbox("Shared Memory", &ui_state.telemetry_shm);
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(160);
+        ImGui::InputText("##telemetry_shm", ui_state.telemetry_shm_name, sizeof(ui_state.telemetry_shm_name));
+        ImGui::SliderFloat("Rate (Hz)", &ui_state.telemetry_rate, 1.0f, 1000.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+        if (ImGui::Button("Start Telemetry") && (ui_state.telemetry_udp || ui_state.telemetry_shm))
+        {
+            TelemetryOptions opts;
+            if (ui_state.telemetry_udp)
+            {
+                opts.udp_address = ui_state.telemetry_address;
+                opts.udp_port = static_cast<uint16_t>(ui_state.telemetry_port);
+            }
+            if (ui_state.telemetry_shm)
+                opts.shm_name = ui_state.telemetry_shm_name;
+            opts.rate_hz = ui_state.telemetry_rate;
+            try
+            {
+                ui_state.telemetry = std::make_shared<TelemetryPublisher>(opts);
+                ui_state.telemetry_changed = true;
+                ui_state.telemetry_message.clear();
+                ui_state.telemetry_error = false;
+            }
+            catch (const std::exception &e)
+            {
+                ui_state.telemetry_message = e.what();
+                ui_state.telemetry_error = true;
+            }
+        }
+    }
+    else
+    {
+        const TelemetryOptions &opts = ui_state.telemetry->getOptions();
+        if (!opts.udp_address.empty())
+            ImGui::Text("UDP:          %s:%u", opts.udp_address.c_str(), static_cast<unsigned>(opts.udp_port));
+        if (!opts.shm_name.empty())
+            ImGui::Text("Ring:         %s", opts.shm_name.c_str());
+        ImGui::Text("Sent:         %llu packets at %.0f Hz",
+                    static_cast<unsigned long long>(ui_state.telemetry->packetsSent()), opts.rate_hz);
+        if (ui_state.telemetry->udpDropped() > 0)
+            ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "Dropped:      %llu UDP sends",
+                               static_cast<unsigned long long>(ui_state.telemetry->udpDropped()));
+        if (ImGui::Button("Stop Telemetry"))
+        {
+            ui_state.telemetry.reset(); // The simulation thread drops its reference when it gets the change
+            ui_state.telemetry_changed = true;
+        }
+    }
+    if (ui_state.telemetry_error)
+        ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s", ui_state.telemetry_message.c_str());
+
     // Visualization and Performance
     ImGui::Separator();
     ImGui::Text("Performance:");
     ImGui::Text("FPS:          %.1f", ui_state.avg_fps);
     ImGui::Text("Frame Time:   %.2f ms", ui_state.avg_frame_time);
-    ImGui::Text("Sim Step:     %.3f ms", state.dt * 1000.0);
+    ImGui::Text("Sim Step:     %.3f ms (%.0f Hz)", state.dt * 1000.0, 1.0 / state.dt);
+    ImGui::Text("Sim Thread:   %.0f steps/s (%d per wake)", ui_state.sim_steps_per_sec, ui_state.physics_substeps);
+    if (ui_state.dropped_time_ms > 0.0f)
+        ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "Dropped:      %.0f ms (sim behind)", ui_state.dropped_time_ms);
+    if (ui_state.warp_limited && !state.paused)
+        ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "Time Warp:    %.0fx of %.0fx (CPU budget)",
+                           ui_state.achieved_warp, state.time_warp);
+    else
+        ImGui::Text("Time Warp:    %.1fx", state.paused ? 0.0f : ui_state.achieved_warp);
+    ImGui::SliderFloat("Step Budget (ms)", &state.step_budget_ms, 0.5f, 10.0f, "%.1f");
+    const ProfileZoneStats &physics_zone = ui_state.profile.zones[static_cast<size_t>(ProfileZone::Physics)];
+    if (ui_state.show_profiler && physics_zone.count > 0)
+        ImGui::Text("Physics Step: %.1f us p50, %.1f us p99", physics_zone.p50_us, physics_zone.p99_us);
+
+    // Physics rate is independent of the render rate (fixed-step accumulator)
+    float physics_hz = static_cast<float>(1.0 / state.dt);
+    if (ImGui::SliderFloat("Physics Rate (Hz)", &physics_hz, 30.0f, 1000.0f, "%.0f", ImGuiSliderFlags_Logarithmic))
+        state.dt = 1.0 / physics_hz;
+
+    const char *integrators[] = {"Legacy (1 force eval)", "RK4 (coupled)", "Dormand-Prince 5(4)"};
+    int integrator = static_cast<int>(state.integration_method);
+    if (ImGui::Combo("Integrator", &integrator, integrators, IM_ARRAYSIZE(integrators)))
+        state.integration_method = static_cast<IntegrationMethod>(integrator);
 
 #ifdef NDEBUG
     ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "Build: Release");
@@ -253,6 +653,7 @@ inline void renderControlPanel(SimulationState &state, UIState &ui_state)
     ImGui::Separator();
     ImGui::Checkbox("Show Demo Window", &ui_state.show_demo);
     ImGui::Checkbox("Show Metrics", &ui_state.show_metrics);
+    ImGui::Checkbox("Show Profiler", &ui_state.show_profiler);
 
     ImGui::End();
 }
@@ -290,12 +691,339 @@ inline void renderInstrumentationPanel(const SimulationState &state)
     ImGui::Separator();
 
     // Atmospheric data
-    double alt = std::max(0.0, state.position.y);
+    AtmosphereState atm = getAtmosphere(std::max(0.0, state.position.y));
     ImGui::Text("Atmospheric Conditions:");
-    ImGui::Text("Temperature: %.1f °C", getTemperature(alt) - 273.15);
-    ImGui::Text("Pressure:    %.0f Pa", getPressure(alt));
-    ImGui::Text("Density:     %.3f kg/m³", getDensity(alt));
-    ImGui::Text("Sound Speed: %.1f m/s", getSpeedOfSound(alt));
+    ImGui::Text("Temperature: %.1f °C", atm.T - 273.15);
+    ImGui::Text("Pressure:    %.0f Pa", atm.p);
+    ImGui::Text("Density:     %.3f kg/m³", atm.rho);
+    ImGui::Text("Sound Speed: %.1f m/s", atm.a);
+
+    ImGui::End();
+}
+
+// Render the recording replay panel
+// current_config_hash identifies the loaded aircraft (recordings made with a
+// different configuration still play, with a warning).
+inline void renderReplayPanel(UIState &ui_state, uint64_t current_config_hash)
+{
+    ImGui::SetNextWindowPos(ImVec2(10, 720), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(400, 0), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Replay");
+
+    RecordingPlayer &replay = ui_state.replay;
+    ImGui::InputText("File", ui_state.replay_path, sizeof(ui_state.replay_path));
+    if (ImGui::Button(replay.isOpen() ? "Reopen" : "Open", ImVec2(120, 0)))
+    {
+        try
+        {
+            replay.open(ui_state.replay_path);
+            ui_state.replay_message = "Opened " + std::string(ui_state.replay_path);
+            ui_state.replay_error = false;
+        }
+        catch (const std::exception &e)
+        {
+            replay.close();
+            ui_state.replay_message = e.what();
+            ui_state.replay_error = true;
+        }
+    }
+    if (replay.isOpen())
+    {
+        ImGui::SameLine();
+        if (ImGui::Button("Back to Live", ImVec2(120, 0)))
+        {
+            replay.close();
+            ui_state.replay_message = "";
+        }
+    }
+
+    if (!ui_state.replay_message.empty())
+    {
+        ImVec4 color = ui_state.replay_error ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImVec4(0.5f, 1.0f, 0.5f, 1.0f);
+        ImGui::TextColored(color, "%s", ui_state.replay_message.c_str());
+    }
+
+    if (replay.isOpen())
+    {
+        const RecordingReader &rec = replay.recording();
+        ImGui::Text("%llu samples, %.1f s to %.1f s", static_cast<unsigned long long>(rec.sampleCount()),
+                    rec.startTime(), rec.endTime());
+        if (rec.configHash() != current_config_hash)
+        {
+            ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "Recorded with a different aircraft configuration");
+        }
+
+        if (ImGui::Button(replay.playing ? "Pause##replay" : "Play##replay", ImVec2(120, 0)))
+        {
+            if (!replay.playing && replay.currentTime() >= rec.endTime())
+                replay.seek(rec.startTime());
+            replay.playing = !replay.playing;
+        }
+        float speed = static_cast<float>(replay.speed);
+        if (ImGui::SliderFloat("Speed", &speed, 0.1f, 100.0f, "%.1fx", ImGuiSliderFlags_Logarithmic))
+            replay.speed = speed;
+        float t = static_cast<float>(replay.currentTime());
+        if (ImGui::SliderFloat("Time (s)", &t, static_cast<float>(rec.startTime()), static_cast<float>(rec.endTime()),
+                               "%.2f"))
+            replay.seek(t);
+    }
+
+    ImGui::End();
+}
+
+// Render the multi-run trajectory panel: fly a batch of variants of the
+// current aircraft in the background, or load recordings, and choose how the
+// runs are drawn
+inline void renderTrailsPanel(UIState &ui_state, TrailRenderer &trails, const SimulationState &state)
+{
+    ImGui::SetNextWindowPos(ImVec2(420, 720), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(400, 0), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Trajectories");
+
+    // Pick up a finished batch
+    bool busy = ui_state.trails_job.valid();
+    if (busy && ui_state.trails_job.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        ui_state.trails = ui_state.trails_job.get();
+        ui_state.trails_message = "Flew " + std::to_string(ui_state.trails.size()) + " lanes";
+        ui_state.trails_error = false;
+        busy = false;
+    }
+
+    ImGui::SliderInt("Lanes", &ui_state.trails_lanes, 10, 10000, "%d", ImGuiSliderFlags_Logarithmic);
+    ImGui::SliderFloat("Duration (s)", &ui_state.trails_duration, 5.0f, 300.0f, "%.0f");
+    ImGui::SliderFloat("Spread", &ui_state.trails_spread, 0.0f, 0.5f, "%.2f");
+    if (busy)
+    {
+        ImGui::Text("Flying batch...");
+    }
+    else if (ImGui::Button("Fly Batch", ImVec2(120, 0)))
+    {
+        // Variants of the current aircraft and setpoints, flown on a worker
+        // thread from a copy of the state
+        SimulationState base = state;
+        size_t lanes = static_cast<size_t>(std::max(1, ui_state.trails_lanes));
+        double duration = ui_state.trails_duration;
+        float spread = ui_state.trails_spread;
+        ui_state.trails_job = std::async(std::launch::async, [base, lanes, duration, spread]()
+                                         {
+            SimulationBatch batch(lanes);
+            batch.dt = base.dt;
+            std::mt19937 rng(12345);
+            std::uniform_real_distribution<float> u(-spread, spread);
+            SimulationState lane = base;
+            for (size_t i = 0; i < lanes; i++)
+            {
+                lane.aircraft.mass = base.aircraft.mass * (1.0 + u(rng));
+                lane.speed_setpoint = base.speed_setpoint * (1.0f + u(rng));
+                lane.altitude_setpoint = base.altitude_setpoint * (1.0f + u(rng));
+                lane.throttle = std::max(0.0f, std::min(1.0f, base.throttle * (1.0f + u(rng))));
+                batch.setLane(i, lane);
+            }
+            TrajectorySet set;
+            flyBatchTrajectories(batch, duration, std::max(0.05, duration / 1000.0), set);
+            return set; });
+    }
+
+    ImGui::InputText("Recordings", ui_state.trails_path, sizeof(ui_state.trails_path));
+    if (ImGui::Button("Load Recordings", ImVec2(120, 0)) && !busy)
+    {
+        // A single .fdrec file, or every .fdrec file in a directory
+        std::vector<std::string> files;
+        std::error_code ec;
+        if (std::filesystem::is_directory(ui_state.trails_path, ec))
+        {
+            for (const auto &entry : std::filesystem::directory_iterator(ui_state.trails_path, ec))
+            {
+                if (entry.path().extension() == ".fdrec")
+                    files.push_back(entry.path().string());
+            }
+            std::sort(files.begin(), files.end());
+        }
+        else
+        {
+            files.push_back(ui_state.trails_path);
+        }
+
+        TrajectorySet set;
+        set.setMetricNames({"Final altitude", "Max altitude", "Final speed", "Duration"});
+        size_t failed = 0;
+        std::string last_error;
+        for (const std::string &file : files)
+        {
+            try
+            {
+                set.addRecording(RecordingReader(file));
+            }
+            catch (const std::exception &e)
+            {
+                failed++;
+                last_error = e.what();
+            }
+        }
+        ui_state.trails = std::move(set);
+        ui_state.trails_message = "Loaded " + std::to_string(ui_state.trails.size()) + " recordings";
+        if (failed > 0)
+            ui_state.trails_message += " (" + std::to_string(failed) + " failed: " + last_error + ")";
+        ui_state.trails_error = ui_state.trails.empty();
+    }
+    if (!ui_state.trails.empty())
+    {
+        ImGui::SameLine();
+        if (ImGui::Button("Clear", ImVec2(120, 0)))
+        {
+            ui_state.trails.clear();
+            ui_state.trails_message = "";
+        }
+    }
+
+    if (!ui_state.trails_message.empty())
+    {
+        ImVec4 color = ui_state.trails_error ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImVec4(0.5f, 1.0f, 0.5f, 1.0f);
+        ImGui::TextColored(color, "%s", ui_state.trails_message.c_str());
+    }
+
+    if (!ui_state.trails.empty())
+    {
+        const TrajectorySet &set = ui_state.trails;
+        static const char *modes[] = {"Auto", "Lines", "Density"};
+        int mode = static_cast<int>(trails.mode);
+        if (ImGui::Combo("Mode", &mode, modes, 3))
+            trails.mode = static_cast<TrailMode>(mode);
+
+        if (set.metricCount() > 0)
+        {
+            std::vector<const char *> names;
+            for (const std::string &n : set.metricNames())
+                names.push_back(n.c_str());
+            trails.metric = std::min(trails.metric, static_cast<int>(names.size()) - 1);
+            ImGui::Combo("Colour by", &trails.metric, names.data(), static_cast<int>(names.size()));
+            float lo, hi;
+            set.metricRange(static_cast<size_t>(trails.metric), lo, hi);
+            ImGui::Text("Range: %.2f to %.2f", lo, hi);
+        }
+        ImGui::Checkbox("Markers", &trails.show_markers);
+        if (trails.show_markers)
+        {
+            ImGui::SameLine();
+            ImGui::SliderFloat("Marker time", &trails.marker_time, 0.0f, 1.0f, "%.2f");
+        }
+        ImGui::Text("%zu runs, %zu points | drawn: %zu runs, %zu vertices%s", set.size(), set.totalPoints(),
+                    trails.drawn_runs, trails.drawn_vertices, trails.drew_density ? " (density)" : "");
+    }
+
+    ImGui::End();
+}
+
+// Render the profiler panel: per-zone percentiles over the last two seconds,
+// a plot of recent durations and their distribution for one zone, and
+// Chrome trace export of everything still in the per-thread buffers
+inline void renderProfilerPanel(UIState &ui_state)
+{
+    if (!ui_state.show_profiler)
+        return;
+
+    ImGui::SetNextWindowPos(ImVec2(830, 720), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(520, 0), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Profiler", &ui_state.show_profiler))
+    {
+        ImGui::End();
+        return;
+    }
+
+#if !FLIGHT_PROFILER
+    ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "Zones are compiled out (configure with -DFLIGHT_PROFILER=ON)");
+#endif
+
+    Profiler &profiler = Profiler::instance();
+    bool recording = profiler.enabled();
+    if (ImGui::Checkbox("Record zones", &recording))
+        profiler.setEnabled(recording);
+    ImGui::SameLine();
+    if (ImGui::Button("Clear"))
+        profiler.clear();
+    ImGui::SameLine();
+    ImGui::Text("%zu threads", profiler.threadCount());
+
+    // Summarizing copies every ring, so only refresh a few times per second
+    double now = ImGui::GetTime();
+    if (now - ui_state.profile_refreshed >= 0.25)
+    {
+        ui_state.profile = profiler.summarize(2.0);
+        ui_state.profile_refreshed = now;
+    }
+
+    const ProfileSummary &summary = ui_state.profile;
+    if (ImGui::BeginTable("zones", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        for (const char *header : {"Zone", "Calls/s", "Mean us", "p50 us", "p95 us", "p99 us", "Load %"})
+            ImGui::TableSetupColumn(header);
+        ImGui::TableHeadersRow();
+        for (size_t z = 0; z < PROFILE_ZONE_COUNT; z++)
+        {
+            const ProfileZoneStats &s = summary.zones[z];
+            if (s.count == 0)
+                continue;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(profileZoneName(static_cast<ProfileZone>(z)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", s.count / summary.window_seconds);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", s.mean_us);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", s.p50_us);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", s.p95_us);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", s.p99_us);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", s.busy * 100.0);
+        }
+        ImGui::EndTable();
+    }
+
+    const char *zone_names[PROFILE_ZONE_COUNT];
+    for (size_t z = 0; z < PROFILE_ZONE_COUNT; z++)
+        zone_names[z] = profileZoneName(static_cast<ProfileZone>(z));
+    ImGui::Combo("Zone", &ui_state.profile_zone, zone_names, static_cast<int>(PROFILE_ZONE_COUNT));
+    const ProfileZoneStats &zone = summary.zones[static_cast<size_t>(ui_state.profile_zone)];
+    if (zone.count > 0)
+    {
+        char overlay[64];
+        std::snprintf(overlay, sizeof(overlay), "max %.1f us", zone.max_us);
+        ImGui::PlotLines("Recent", zone.recent_us.data(), static_cast<int>(zone.recent_us.size()), 0, overlay, 0.0f,
+                         static_cast<float>(zone.p99_us * 1.5), ImVec2(0, 60));
+        std::snprintf(overlay, sizeof(overlay), "0 .. %.1f us", zone.histogram_max_us);
+        ImGui::PlotHistogram("Distribution", zone.histogram.data(), static_cast<int>(zone.histogram.size()), 0,
+                             overlay, 0.0f, 3.4e38f, ImVec2(0, 60));
+    }
+    else
+    {
+        ImGui::TextDisabled("No events for this zone in the last %.0f s", summary.window_seconds);
+    }
+
+    ImGui::Separator();
+    ImGui::InputText("Trace file", ui_state.trace_path, sizeof(ui_state.trace_path));
+    if (ImGui::Button("Export Chrome Trace", ImVec2(200, 0)))
+    {
+        try
+        {
+            size_t events = profiler.writeChromeTrace(ui_state.trace_path);
+            ui_state.trace_message = "Wrote " + std::to_string(events) + " events to " + ui_state.trace_path;
+            ui_state.trace_error = false;
+        }
+        catch (const std::exception &e)
+        {
+            ui_state.trace_message = e.what();
+            ui_state.trace_error = true;
+        }
+    }
+    if (!ui_state.trace_message.empty())
+    {
+        ImVec4 color = ui_state.trace_error ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImVec4(0.5f, 1.0f, 0.5f, 1.0f);
+        ImGui::TextColored(color, "%s", ui_state.trace_message.c_str());
+    }
 
     ImGui::End();
 }
@@ -7,7 +7,7 @@
 
 // Simulation
 #include "simulation/simulation_state.hpp"
-#include "simulation/physics_update.hpp"
+#include "simulation/sim_thread.hpp"
 
 // Graphics
 #include "graphics/camera.hpp"
@@ -20,6 +20,9 @@
 // Utils
 #include "utils/aircraft_config_manager.hpp"
 
+// Profiling
+#include "core/profiler.hpp"
+
 int main(int, char **)
 {
     // Initialize SDL
@@ -77,18 +80,13 @@ int main(int, char **)
     FlightRenderer renderer;
     CameraInput camera_input;
     UIState ui_state;
+    Profiler::instance().setThreadName("main");
 
-    // Load aircraft configurations
-    auto configs = AircraftConfigManager::scanConfigs();
-    for (const auto &config : configs)
-    {
-        ui_state.aircraft_configs.push_back({config.name, config.filepath});
-        ui_state.aircraft_name_storage.push_back(config.name);
-    }
-    for (const auto &name : ui_state.aircraft_name_storage)
-    {
-        ui_state.aircraft_names.push_back(name.c_str());
-    }
+    // Aircraft configurations are scanned, loaded and watched for edits on a
+    // background thread; results are picked up once per frame
+    ConfigWatcher config_watcher(AircraftConfigManager::scanConfigs);
+    std::vector<AircraftConfigEntry> configs; // Also keeps the listed aero tables cached
+    config_watcher.start();
 
     // Performance tracking
     Uint64 last_frame_time = SDL_GetPerformanceCounter();
@@ -97,6 +95,16 @@ int main(int, char **)
     int frame_time_index = 0;
     int frame_count = 0;
 
+    // Physics runs on its own thread; sim_state is the UI-side view of it
+    SimulationThread sim_thread(sim_state);
+    ControlInputs sent_controls = ControlInputs::capture(sim_state);
+    uint32_t seen_generation = 0;
+    SimulationState replay_view; // Display state filled from an open recording
+    uint64_t path_seen = 0;
+    uint64_t rate_steps = 0;
+    double rate_time = SimulationThread::now();
+    sim_thread.start();
+
     // Main loop
     bool done = false;
     while (!done)
@@ -135,17 +143,134 @@ int main(int, char **)
         ImGui_ImplSDL3_NewFrame();
         ImGui::NewFrame();
 
-        // Reset if requested
-        if (sim_state.reset_requested)
+        // New config list: rebuild the combo, keeping the selected file
+        if (config_watcher.takeConfigs(configs))
+        {
+            std::string selected;
+            if (ui_state.selected_aircraft < static_cast<int>(ui_state.aircraft_configs.size()))
+                selected = ui_state.aircraft_configs[ui_state.selected_aircraft].filepath;
+            ui_state.aircraft_configs.clear();
+            ui_state.aircraft_name_storage.clear();
+            ui_state.aircraft_names.clear();
+            ui_state.selected_aircraft = 0;
+            for (const auto &config : configs)
+            {
+                if (config.filepath == selected)
+                    ui_state.selected_aircraft = static_cast<int>(ui_state.aircraft_configs.size());
+                ui_state.aircraft_configs.push_back({config.name, config.filepath});
+                ui_state.aircraft_name_storage.push_back(config.name);
+            }
+            for (const auto &name : ui_state.aircraft_name_storage)
+            {
+                ui_state.aircraft_names.push_back(name.c_str());
+            }
+            ui_state.configs_scanning = false;
+        }
+
+        // Finished loads and hot reloads; the aircraft reaches the simulation
+        // thread through LoadAircraft below and is swapped in between steps
+        ConfigLoadResult loaded;
+        while (config_watcher.takeResult(loaded))
+        {
+            // Superseded by a later selection
+            if (loaded.reload ? loaded.filepath != ui_state.active_config : loaded.filepath != ui_state.load_request)
+                continue;
+            std::string name = loaded.filepath;
+            for (const auto &config : ui_state.aircraft_configs)
+            {
+                if (config.filepath == loaded.filepath)
+                    name = config.name;
+            }
+            if (loaded.aircraft)
+            {
+                sim_state.aircraft = *loaded.aircraft;
+                if (loaded.aircraft->autopilotFromConfig)
+                    sim_state.applyAutopilotGains(loaded.aircraft->autopilot);
+                ui_state.active_config = loaded.filepath;
+                ui_state.aircraft_changed = true;
+                ui_state.load_message = std::string(loaded.reload ? "Reloaded: " : "Loaded: ") + name;
+                ui_state.load_error = false;
+            }
+            else
+            {
+                ui_state.load_message = std::string("Error: ") + loaded.error;
+                ui_state.load_error = true;
+            }
+        }
+
+        // Reset if requested (retried next frame if the command queue is full)
+        if (sim_state.reset_requested && sim_thread.post({SimCommand::Type::Reset, {}, nullptr}))
         {
             sim_state.reset();
         }
 
-        // Update simulation
-        updatePhysics(sim_state);
+        // Trimmed start solved by the control panel; both sides apply the same trim
+        if (ui_state.trim_requested)
+        {
+            SimCommand cmd;
+            cmd.type = SimCommand::Type::ResetTrimmed;
+            cmd.trim = ui_state.trim;
+            cmd.trim_result = ui_state.trim_result;
+            if (sim_thread.post(cmd))
+            {
+                sim_state.reset();
+                applyTrim(sim_state, ui_state.trim, ui_state.trim_result);
+                ui_state.trim_requested = false;
+            }
+        }
+
+        // Telemetry started or stopped in the control panel
+        if (ui_state.telemetry_changed)
+        {
+            SimCommand cmd;
+            cmd.type = SimCommand::Type::SetTelemetry;
+            cmd.telemetry = ui_state.telemetry;
+            if (sim_thread.post(cmd))
+                ui_state.telemetry_changed = false;
+        }
+
+        // Pick up the newest simulation snapshot (never blocks)
+        const SimulationSnapshot &snapshot = sim_thread.latest();
+        if (snapshot.generation != seen_generation)
+        {
+            sim_state.flightPath.clear();
+            path_seen = 0;
+            seen_generation = snapshot.generation;
+        }
+        snapshot.applyTo(sim_state, path_seen);
+
+        double now = SimulationThread::now();
+        PhysicsFrame render_frame = snapshot.frameAt(now);
+        ui_state.physics_substeps = snapshot.substeps;
+        ui_state.dropped_time_ms = static_cast<float>(snapshot.dropped_time * 1000.0);
+        ui_state.rewind_oldest = snapshot.rewind_oldest;
+        ui_state.achieved_warp = static_cast<float>(snapshot.achieved_warp);
+        ui_state.warp_limited = snapshot.warp_limited;
+        if (now - rate_time >= 0.5)
+        {
+            ui_state.sim_steps_per_sec = static_cast<float>((snapshot.step_count - rate_steps) / (now - rate_time));
+            rate_steps = snapshot.step_count;
+            rate_time = now;
+        }
 
         // Render UI panels
         renderControlPanel(sim_state, ui_state);
+        renderReplayPanel(ui_state, sim_state.aircraft.configHash());
+        renderTrailsPanel(ui_state, renderer.trails, sim_state);
+        renderProfilerPanel(ui_state);
+
+        // While a recording is open the views below show it instead of the live simulation
+        const SimulationState *view = &sim_state;
+        if (ui_state.replay.isOpen())
+        {
+            replay_view.aircraft = sim_state.aircraft;
+            replay_view.paused = !ui_state.replay.playing;
+            if (ui_state.replay.update(delta_time, replay_view))
+            {
+                view = &replay_view;
+                render_frame = PhysicsFrame::capture(replay_view);
+            }
+        }
 
         // Flight Path Visualization
         ImGui::SetNextWindowPos(ImVec2(420, 10), ImGuiCond_FirstUseEver);
@@ -166,10 +291,15 @@ int main(int, char **)
         camera_input.handleInput(camera, canvas_p0, canvas_sz, is_hovered);
 
         // Render flight visualization
-        renderer.render(sim_state, camera, ui_state.show_vectors, canvas_p0, canvas_sz);
+        {
+            PROFILE_ZONE(ProfileZone::Render);
+            renderer.render(*view, render_frame, camera, ui_state.show_vectors, canvas_p0, canvas_sz,
+                            &ui_state.trails);
+        }
 
         ImGui::Text("Controls: Left-click drag to pan, Mouse wheel to zoom");
-        ImGui::Text("Zoom: %.2fx | Position: (%.0f, %.0f) m", camera.view_scale, sim_state.position.x, sim_state.position.y);
+        ImGui::Text("Zoom: %.2fx | Position: (%.0f, %.0f) m | Path vertices: %zu", camera.view_scale, view->position.x,
+                    view->position.y, renderer.path_vertices);
         ImGui::Checkbox("Show Force Vectors", &ui_state.show_vectors);
         if (ui_state.show_vectors)
         {
@@ -186,14 +316,42 @@ int main(int, char **)
         if (ImGui::Button("Center on Aircraft"))
         {
             ImVec2 canvas_p1 = ImVec2(canvas_p0.x + canvas_sz.x, canvas_p0.y + canvas_sz.y);
-            camera.centerOnAircraft(static_cast<float>(sim_state.position.x), static_cast<float>(sim_state.position.y),
+            camera.centerOnAircraft(static_cast<float>(view->position.x), static_cast<float>(view->position.y),
                                     canvas_p0, canvas_sz);
         }
 
         ImGui::End();
 
         // Instrumentation Panel
-        renderInstrumentationPanel(sim_state);
+        renderInstrumentationPanel(*view);
+
+        // Push control changes made by the panels to the simulation thread.
+        // Autopilot-driven throttle/elevator come from the simulation, so they don't count as edits.
+        ControlInputs controls = ControlInputs::capture(sim_state);
+        if (controls.autopilot_speed)
+            controls.throttle = sent_controls.throttle;
+        if (controls.autopilot_altitude)
+            controls.elevator = sent_controls.elevator;
+        if (controls != sent_controls && sim_thread.post({SimCommand::Type::SetControls, controls, nullptr}))
+        {
+            sent_controls = controls;
+        }
+        if (ui_state.load_requested)
+        {
+            config_watcher.requestLoad(ui_state.load_request);
+            ui_state.load_requested = false;
+        }
+        if (ui_state.aircraft_changed &&
+            sim_thread.post({SimCommand::Type::LoadAircraft, {}, std::make_shared<const Aircraft>(sim_state.aircraft)}))
+        {
+            ui_state.aircraft_changed = false;
+        }
+        // Sent after the controls so the rewound run continues with them
+        if (ui_state.rewind_requested &&
+            sim_thread.post({SimCommand::Type::Rewind, {}, nullptr, static_cast<double>(ui_state.rewind_time)}))
+        {
+            ui_state.rewind_requested = false;
+        }
 
         // Optional windows
         if (ui_state.show_demo)
@@ -202,18 +360,25 @@ int main(int, char **)
             ImGui::ShowMetricsWindow(&ui_state.show_metrics);
 
         // Rendering
-        ImGui::Render();
-        glViewport(0, 0, (int)io.DisplaySize.x, (int)io.DisplaySize.y);
-        glClearColor(ui_state.clear_color.x * ui_state.clear_color.w,
-                     ui_state.clear_color.y * ui_state.clear_color.w,
-                     ui_state.clear_color.z * ui_state.clear_color.w,
-                     ui_state.clear_color.w);
-        glClear(GL_COLOR_BUFFER_BIT);
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        SDL_GL_SwapWindow(window);
+        {
+            PROFILE_ZONE(ProfileZone::ImGui);
+            ImGui::Render();
+            glViewport(0, 0, (int)io.DisplaySize.x, (int)io.DisplaySize.y);
+            glClearColor(ui_state.clear_color.x * ui_state.clear_color.w,
+                         ui_state.clear_color.y * ui_state.clear_color.w,
+                         ui_state.clear_color.z * ui_state.clear_color.w,
+                         ui_state.clear_color.w);
+            glClear(GL_COLOR_BUFFER_BIT);
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
+        {
+            PROFILE_ZONE(ProfileZone::Swap);
+            SDL_GL_SwapWindow(window);
+        }
     }
 
     // Cleanup
+    sim_thread.stop();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL3_Shutdown();
     ImGui::DestroyContext();
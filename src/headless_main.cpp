@@ -0,0 +1,997 @@
+// FlightDynamics Headless - batch simulation runner without a window
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <thread>
+
+// Simulation
+#include "simulation/simulation_state.hpp"
+#include "simulation/headless_runner.hpp"
+#include "simulation/trajectory_writer.hpp"
+#include "simulation/parameter_sweep.hpp"
+#include "simulation/distributed_sweep.hpp"
+#include "simulation/simulation_checkpoint.hpp"
+#include "simulation/flight_recording.hpp"
+#include "simulation/gain_tuner.hpp"
+#include "simulation/flight_envelope.hpp"
+
+// Aircraft
+#include "aircraft/aircraft_loader.hpp"
+
+// Profiling
+#include "core/profiler.hpp"
+#include "telemetry/telemetry_publisher.hpp"
+
+namespace
+{
+struct HeadlessOptions
+{
+    std::vector<std::string> config_paths; // More than one only for sweeps (every config flies every case)
+    std::string output_path;
+    TrajectoryWriter::Format format = TrajectoryWriter::Format::CSV;
+    bool recording = false; // --format rec: columnar recording with forces (see flight_recording.hpp)
+    HeadlessRunConfig run;
+
+    // Initial conditions
+    double altitude = 0.0;
+    double speed = 0.0;
+    double throttle = 0.3;
+    double pitch_deg = 5.0;
+    double elevator = 0.0;
+
+    // Autopilot (disabled when setpoint is negative)
+    double speed_setpoint = -1.0;
+    double altitude_setpoint = -1.0;
+
+    // Wind (see wind.hpp; still air unless any wind option is given)
+    WindConditions wind;
+    bool windy = false;
+
+    // Parameter sweep (enabled by one or more --sweep options)
+    SweepDesign sweep;
+    size_t threads = 0; // 0 = one per hardware thread
+    double fork_time = -1.0; // Fork every case from the state at this time (negative = off)
+    size_t batch_lanes = 0;  // Cases per SimulationBatch (0 = one scalar run per case)
+
+    // Distributed sweep (see distributed_sweep.hpp)
+    bool coordinator = false;
+    uint16_t coordinator_port = 0;
+    std::string worker_address; // host:port of the coordinator (empty = not a worker)
+    std::string store_path = "sweep_store";
+    size_t chunk_cases = 0; // 0 = automatic
+    size_t shards = 16;
+
+    // Checkpoints (empty = off)
+    std::string checkpoint_in;
+    std::string checkpoint_out;
+
+    // Trimmed start and envelope map (see flight_envelope.hpp)
+    bool trim = false;
+    std::string envelope_path; // Write the envelope map as CSV and exit (empty = off)
+    std::string envelope_cache = ENVELOPE_CACHE_DIR;
+
+    // Autopilot gain tuning (see gain_tuner.hpp)
+    bool autotune = false;
+    bool write_gains = false; // Also store the tuned gains in the --config file
+
+    // Chrome trace of the profiler zones (empty = off)
+    std::string trace_path;
+
+    // Telemetry stream (see telemetry_publisher.hpp; off unless a destination is given)
+    TelemetryOptions telemetry;
+    bool realtime = false; // Pace the run to the wall clock (for live telemetry consumers)
+
+    IntegrationMethod integration_method = IntegrationMethod::Legacy;
+    double tolerance = 1e-6;
+
+    bool quiet = false;
+};
+
+void printUsage()
+{
+    std::cout << "Usage: FlightDynamicsHeadless [options]\n"
+                 "  --config <file.json>      Aircraft configuration (default: built-in aircraft; repeat to\n"
+                 "                            sweep several configs)\n"
+                 "  --duration <s>            Simulated time to run (default: 60)\n"
+                 "  --dt <s>                  Physics timestep (default: 0.016)\n"
+                 "  --output <file>           Trajectory output file (omit to only print the final state)\n"
+                 "  --format <csv|bin|rec>    Trajectory format (default: csv; rec = chunked columnar recording\n"
+                 "                            with force vectors, replayable in the GUI)\n"
+                 "  --every <n>               Record every n-th step (default: 1)\n"
+                 "  --integrator <name>       legacy, rk4 or dp45 (adaptive; default: legacy)\n"
+                 "  --tolerance <tol>         dp45 error tolerance (default: 1e-6)\n"
+                 "  --altitude <m>            Initial altitude (default: 0)\n"
+                 "  --speed <m/s>             Initial horizontal speed (default: 0)\n"
+                 "  --throttle <0..1>         Initial throttle (default: 0.3)\n"
+                 "  --pitch <deg>             Initial pitch angle (default: 5)\n"
+                 "  --elevator <-1..1>        Elevator stick (default: 0)\n"
+                 "  --autopilot-speed <m/s>   Enable speed autopilot with this setpoint\n"
+                 "  --autopilot-altitude <m>  Enable altitude autopilot with this setpoint\n"
+                 "  --wind <m/s>              Steady wind at the reference altitude (+ = tailwind; default: 0)\n"
+                 "  --wind-reference <m>      Reference altitude of the wind shear profile (default: 10)\n"
+                 "  --wind-shear <exp>        Power-law shear exponent (default: 0.143; 0 = uniform)\n"
+                 "  --turbulence <model>      none, dryden or vonkarman (default: dryden with an intensity)\n"
+                 "  --turbulence-intensity <w20>\n"
+                 "                            light, moderate, severe or the wind at 20 ft in m/s\n"
+                 "  --turbulence-seed <n>     Turbulence noise tiles (default: 1)\n"
+                 "  --gust <t>,<len>,<u>,<w>  1-cosine gust starting at t s, len s long, peaking at u m/s\n"
+                 "                            horizontal and w m/s vertical (repeatable)\n"
+                 "  --trim                    Start in trimmed level flight at --speed and --altitude (throttle\n"
+                 "                            and pitch solved; overrides --throttle, --pitch and --elevator)\n"
+                 "  --envelope <file.csv>     Write the level-flight trim map (speed x altitude) and exit\n"
+                 "  --envelope-cache <dir>    Where trim maps are cached by config hash (default: envelope_cache)\n"
+                 "  --sweep <p>=<min>:<max>[:<n>]\n"
+                 "                            Sweep parameter p over n values (repeatable; p is one of mass,\n"
+                 "                            maxThrust, CD0, pid_kp, pid_ki, pid_kd, alt_pid_kp, alt_pid_ki,\n"
+                 "                            alt_pid_kd, wind_speed, turbulence, turbulence_seed). --output then\n"
+                 "                            receives the result table\n"
+                 "  --samples <n>             Draw n random cases instead of the full grid\n"
+                 "  --seed <n>                Random design seed (default: 1)\n"
+                 "  --threads <n>             Sweep worker threads (default: all cores)\n"
+                 "  --fork-at <s>             Fly the first s seconds once and fork every sweep case from there\n"
+                 "  --batch-lanes <n>         Fly n sweep cases at a time through the batched kernel\n"
+                 "                            (legacy integrator; matches scalar runs to rounding)\n"
+                 "  --coordinator <port>      Hand the sweep out to --worker processes instead of flying it;\n"
+                 "                            --output receives the merged result table\n"
+                 "  --worker <host:port>      Fly chunks of the coordinator's sweep until it is done (all sweep\n"
+                 "                            options come from the coordinator; config paths must exist here)\n"
+                 "  --store <dir>             Coordinator result shards (default: sweep_store)\n"
+                 "  --chunk-cases <n>         Cases per chunk handed to a worker (default: automatic)\n"
+                 "  --shards <n>              Shard files in the store (default: 16)\n"
+                 "  --autotune                Tune the autopilot gains: step responses from --speed/--altitude to\n"
+                 "                            the autopilot setpoints (default: 22 m/s, 120 m, +3 m/s, +20 m),\n"
+                 "                            --duration long at --dt, flown in parallel batches\n"
+                 "  --write-gains             With --autotune, store the gains in the --config file\n"
+                 "  --checkpoint-in <file>    Start from a saved checkpoint (overrides initial conditions)\n"
+                 "  --checkpoint-out <file>   Save the final state as a checkpoint\n"
+                 "  --trace <file.json>       Record profiler zones and write a Chrome trace (chrome://tracing,\n"
+                 "                            ui.perfetto.dev); the ring buffers keep each thread's latest events\n"
+                 "  --telemetry-udp <ip:port> Stream telemetry packets to a UDP address or multicast group\n"
+                 "  --telemetry-shm <name>    Publish telemetry packets in a shared-memory ring\n"
+                 "  --telemetry-rate <Hz>     Packets per simulated second (default: 100; 0 = every step)\n"
+                 "  --realtime                Run no faster than the wall clock (e.g. for telemetry consumers)\n"
+                 "  --quiet                   Suppress the summary\n";
+}
+
+double parseNumber(const std::string &flag, const char *value)
+{
+    char *end = nullptr;
+    double v = std::strtod(value, &end);
+    if (end == value || *end != '\0')
+    {
+        throw std::runtime_error("Invalid number for " + flag + ": " + value);
+    }
+    return v;
+}
+
+// "name=min:max[:count]"
+SweepAxis parseSweepAxis(const std::string &spec)
+{
+    size_t eq = spec.find('=');
+    if (eq == std::string::npos)
+    {
+        throw std::runtime_error("Invalid --sweep (expected name=min:max[:n]): " + spec);
+    }
+    SweepAxis axis;
+    axis.parameter = parseSweepParameter(spec.substr(0, eq));
+
+    std::vector<std::string> fields;
+    size_t start = eq + 1;
+    for (;;)
+    {
+        size_t colon = spec.find(':', start);
+        fields.push_back(spec.substr(start, colon == std::string::npos ? std::string::npos : colon - start));
+        if (colon == std::string::npos)
+            break;
+        start = colon + 1;
+    }
+    if (fields.size() < 2 || fields.size() > 3)
+    {
+        throw std::runtime_error("Invalid --sweep (expected name=min:max[:n]): " + spec);
+    }
+    axis.min = parseNumber("--sweep", fields[0].c_str());
+    axis.max = parseNumber("--sweep", fields[1].c_str());
+    axis.count = fields.size() == 3 ? static_cast<int>(parseNumber("--sweep", fields[2].c_str())) : 5;
+    if (axis.count < 1)
+    {
+        throw std::runtime_error("--sweep count must be at least 1: " + spec);
+    }
+    return axis;
+}
+
+// "start,duration,u,w"
+WindGust parseGust(const std::string &spec)
+{
+    std::vector<double> fields;
+    size_t start = 0;
+    for (;;)
+    {
+        size_t comma = spec.find(',', start);
+        std::string field = spec.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        fields.push_back(parseNumber("--gust", field.c_str()));
+        if (comma == std::string::npos)
+            break;
+        start = comma + 1;
+    }
+    if (fields.size() != 4)
+    {
+        throw std::runtime_error("Invalid --gust (expected start,duration,u,w): " + spec);
+    }
+    return WindGust{fields[0], fields[1], fields[2], fields[3]};
+}
+
+// Wind options (--wind*, --turbulence*, --gust); false if arg is not one of them
+bool parseWindOption(const std::string &arg, const char *value, WindConditions &wind)
+{
+    if (arg == "--wind")
+        wind.speed = parseNumber(arg, value);
+    else if (arg == "--wind-reference")
+        wind.reference_altitude = parseNumber(arg, value);
+    else if (arg == "--wind-shear")
+        wind.shear_exponent = parseNumber(arg, value);
+    else if (arg == "--turbulence")
+    {
+        if (!parseTurbulenceModel(value, wind.turbulence))
+            throw std::runtime_error("Unknown turbulence model: " + std::string(value));
+    }
+    else if (arg == "--turbulence-intensity")
+    {
+        double w20 = turbulenceIntensity(value);
+        wind.turbulence_w20 = w20 >= 0.0 ? w20 : parseNumber(arg, value);
+        if (wind.turbulence == TurbulenceModel::None)
+            wind.turbulence = TurbulenceModel::Dryden;
+    }
+    else if (arg == "--turbulence-seed")
+        wind.seed = static_cast<uint64_t>(parseNumber(arg, value));
+    else if (arg == "--gust")
+        wind.gusts.push_back(parseGust(value));
+    else
+        return false;
+    return true;
+}
+
+// "ip:port" (port optional)
+void parseUdpDestination(const std::string &spec, TelemetryOptions &telemetry)
+{
+    size_t colon = spec.rfind(':');
+    telemetry.udp_address = spec.substr(0, colon);
+    if (colon != std::string::npos)
+    {
+        double port = parseNumber("--telemetry-udp", spec.c_str() + colon + 1);
+        if (port < 1 || port > 65535 || port != std::floor(port))
+        {
+            throw std::runtime_error("Invalid --telemetry-udp port: " + spec);
+        }
+        telemetry.udp_port = static_cast<uint16_t>(port);
+    }
+    if (telemetry.udp_address.empty())
+    {
+        throw std::runtime_error("Invalid --telemetry-udp (expected ip:port): " + spec);
+    }
+}
+
+HeadlessOptions parseArguments(const std::vector<std::string> &args)
+{
+    HeadlessOptions opts;
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        const std::string &arg = args[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage();
+            std::exit(0);
+        }
+        if (arg == "--quiet")
+        {
+            opts.quiet = true;
+            continue;
+        }
+        if (arg == "--realtime")
+        {
+            opts.realtime = true;
+            continue;
+        }
+        if (arg == "--trim")
+        {
+            opts.trim = true;
+            continue;
+        }
+        if (arg == "--autotune" || arg == "--write-gains")
+        {
+            opts.autotune = true;
+            opts.write_gains = opts.write_gains || arg == "--write-gains";
+            continue;
+        }
+        if (i + 1 >= args.size())
+        {
+            throw std::runtime_error("Missing value for " + arg);
+        }
+        const char *value = args[++i].c_str();
+
+        if (arg == "--config")
+            opts.config_paths.push_back(value);
+        else if (arg == "--output")
+            opts.output_path = value;
+        else if (arg == "--format")
+        {
+            std::string f = value;
+            if (f == "csv")
+                opts.format = TrajectoryWriter::Format::CSV;
+            else if (f == "bin")
+                opts.format = TrajectoryWriter::Format::Binary;
+            else if (f == "rec")
+                opts.recording = true;
+            else
+                throw std::runtime_error("Unknown format: " + f);
+        }
+        else if (arg == "--integrator")
+        {
+            std::string m = value;
+            if (m == "legacy")
+                opts.integration_method = IntegrationMethod::Legacy;
+            else if (m == "rk4")
+                opts.integration_method = IntegrationMethod::RK4;
+            else if (m == "dp45")
+                opts.integration_method = IntegrationMethod::DormandPrince45;
+            else
+                throw std::runtime_error("Unknown integrator: " + m);
+        }
+        else if (arg == "--tolerance")
+            opts.tolerance = parseNumber(arg, value);
+        else if (arg == "--duration")
+            opts.run.duration = parseNumber(arg, value);
+        else if (arg == "--dt")
+            opts.run.dt = parseNumber(arg, value);
+        else if (arg == "--every")
+            opts.run.record_every = static_cast<int>(parseNumber(arg, value));
+        else if (arg == "--altitude")
+            opts.altitude = parseNumber(arg, value);
+        else if (arg == "--speed")
+            opts.speed = parseNumber(arg, value);
+        else if (arg == "--throttle")
+            opts.throttle = parseNumber(arg, value);
+        else if (arg == "--pitch")
+            opts.pitch_deg = parseNumber(arg, value);
+        else if (arg == "--elevator")
+            opts.elevator = parseNumber(arg, value);
+        else if (arg == "--autopilot-speed")
+            opts.speed_setpoint = parseNumber(arg, value);
+        else if (arg == "--autopilot-altitude")
+            opts.altitude_setpoint = parseNumber(arg, value);
+        else if (parseWindOption(arg, value, opts.wind))
+            opts.windy = true;
+        else if (arg == "--sweep")
+            opts.sweep.axes.push_back(parseSweepAxis(value));
+        else if (arg == "--samples")
+        {
+            opts.sweep.kind = SweepDesign::Kind::Random;
+            opts.sweep.samples = static_cast<size_t>(parseNumber(arg, value));
+        }
+        else if (arg == "--seed")
+            opts.sweep.seed = static_cast<uint64_t>(parseNumber(arg, value));
+        else if (arg == "--threads")
+            opts.threads = static_cast<size_t>(parseNumber(arg, value));
+        else if (arg == "--batch-lanes")
+            opts.batch_lanes = static_cast<size_t>(parseNumber(arg, value));
+        else if (arg == "--fork-at")
+            opts.fork_time = parseNumber(arg, value);
+        else if (arg == "--coordinator")
+        {
+            double port = parseNumber(arg, value);
+            if (port < 0.0 || port > 65535.0)
+                throw std::runtime_error("Invalid port for --coordinator");
+            opts.coordinator = true;
+            opts.coordinator_port = static_cast<uint16_t>(port);
+        }
+        else if (arg == "--worker")
+            opts.worker_address = value;
+        else if (arg == "--store")
+            opts.store_path = value;
+        else if (arg == "--chunk-cases")
+            opts.chunk_cases = static_cast<size_t>(parseNumber(arg, value));
+        else if (arg == "--shards")
+            opts.shards = static_cast<size_t>(parseNumber(arg, value));
+        else if (arg == "--checkpoint-in")
+            opts.checkpoint_in = value;
+        else if (arg == "--checkpoint-out")
+            opts.checkpoint_out = value;
+        else if (arg == "--trace")
+            opts.trace_path = value;
+        else if (arg == "--envelope")
+            opts.envelope_path = value;
+        else if (arg == "--envelope-cache")
+            opts.envelope_cache = value;
+        else if (arg == "--telemetry-udp")
+            parseUdpDestination(value, opts.telemetry);
+        else if (arg == "--telemetry-shm")
+            opts.telemetry.shm_name = value;
+        else if (arg == "--telemetry-rate")
+            opts.telemetry.rate_hz = parseNumber(arg, value);
+        else
+            throw std::runtime_error("Unknown option: " + arg);
+    }
+
+    if (opts.run.dt <= 0.0 || opts.run.duration < 0.0)
+    {
+        throw std::runtime_error("--dt must be positive and --duration non-negative");
+    }
+    if (opts.sweep.kind == SweepDesign::Kind::Random && opts.sweep.axes.empty())
+    {
+        throw std::runtime_error("--samples needs at least one --sweep parameter");
+    }
+    if (opts.fork_time > opts.run.duration)
+    {
+        throw std::runtime_error("--fork-at must not be later than --duration");
+    }
+    if (opts.batch_lanes > 0 && opts.fork_time >= 0.0)
+    {
+        throw std::runtime_error("--batch-lanes cannot be combined with --fork-at");
+    }
+    if (opts.trim && opts.speed <= 0.0)
+    {
+        throw std::runtime_error("--trim needs a positive --speed");
+    }
+    if (opts.write_gains && opts.config_paths.size() != 1)
+    {
+        throw std::runtime_error("--write-gains needs one --config");
+    }
+    if (opts.autotune && !opts.sweep.axes.empty())
+    {
+        throw std::runtime_error("--autotune cannot be combined with --sweep");
+    }
+    if (opts.telemetry.rate_hz < 0.0)
+    {
+        throw std::runtime_error("--telemetry-rate must not be negative");
+    }
+    if (opts.telemetry.enabled() && (opts.autotune || !opts.sweep.axes.empty()))
+    {
+        throw std::runtime_error("Telemetry streams a single run; it cannot be combined with --sweep or --autotune");
+    }
+    if (opts.config_paths.size() > 1 && opts.sweep.axes.empty())
+    {
+        throw std::runtime_error("Several --config files need a --sweep");
+    }
+    if (opts.coordinator && (opts.sweep.axes.empty() || !opts.worker_address.empty()))
+    {
+        throw std::runtime_error("--coordinator needs a --sweep and cannot be a --worker");
+    }
+    if (!opts.worker_address.empty() && (!opts.sweep.axes.empty() || opts.autotune || !opts.config_paths.empty()))
+    {
+        throw std::runtime_error("--worker takes the sweep from the coordinator; give only --threads and --quiet");
+    }
+    return opts;
+}
+
+// Apply command-line initial conditions on top of SimulationState::reset()
+void applyInitialConditions(SimulationState &state, const HeadlessOptions &opts)
+{
+    state.reset();
+    state.position = Vec2(0.0, opts.altitude);
+    state.velocity = Vec2(opts.speed, 0.0);
+    state.throttle = static_cast<float>(opts.throttle);
+    state.pitch_deg = static_cast<float>(opts.pitch_deg);
+    state.elevator = static_cast<float>(opts.elevator);
+    state.integration_method = opts.integration_method;
+    state.integration_tolerance = opts.tolerance;
+
+    if (opts.speed_setpoint >= 0.0)
+    {
+        state.autopilot_speed = true;
+        state.speed_setpoint = static_cast<float>(opts.speed_setpoint);
+    }
+    if (opts.altitude_setpoint >= 0.0)
+    {
+        state.autopilot_altitude = true;
+        state.altitude_setpoint = static_cast<float>(opts.altitude_setpoint);
+    }
+    if (opts.windy)
+    {
+        state.setWind(opts.wind); // Throws for invalid conditions
+    }
+}
+// Level-flight trim map of the aircraft, from the cache or computed now
+FlightEnvelope envelopeFor(const Aircraft &aircraft, const HeadlessOptions &opts)
+{
+    ThreadPool pool(opts.threads);
+    bool from_cache = false;
+    auto start = std::chrono::steady_clock::now();
+    FlightEnvelope env = loadOrComputeEnvelope(aircraft, EnvelopeGrid(), opts.envelope_cache, pool, &from_cache);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!opts.quiet)
+    {
+        std::cerr << (from_cache ? "Loaded" : "Computed") << " trim map (" << env.trimmedCount() << " of "
+                  << env.grid().cellCount() << " points trimmed) in " << elapsed * 1000.0 << " ms\n";
+    }
+    return env;
+}
+
+// Replace the initial flight state by trimmed level flight at --speed and --altitude
+void applyTrimmedStart(SimulationState &state, const HeadlessOptions &opts)
+{
+    FlightEnvelope env = envelopeFor(state.aircraft, opts);
+    TrimCondition cond = {opts.speed, opts.altitude};
+    TrimResult trim = trimFromEnvelope(state.aircraft, &env, cond);
+    if (!trim.trimmed())
+    {
+        throw std::runtime_error("Cannot trim at " + std::to_string(opts.speed) + " m/s, " +
+                                 std::to_string(opts.altitude) + " m: " + trimStatusName(trim.status));
+    }
+    applyTrim(state, cond, trim);
+    if (!opts.quiet)
+    {
+        std::cerr << "Trimmed: throttle " << trim.throttle << ", pitch " << trim.pitch_deg << " deg ("
+                  << trim.iterations << " Newton iterations)\n";
+    }
+}
+
+// Write the recorded profiler zones if --trace was given
+void writeTrace(const HeadlessOptions &opts)
+{
+    if (opts.trace_path.empty())
+        return;
+    size_t events = Profiler::instance().writeChromeTrace(opts.trace_path);
+    if (!opts.quiet)
+        std::cerr << "Wrote " << events << " trace events to " << opts.trace_path << "\n";
+}
+
+// Aircraft from a config file (empty = built-in) at the command-line initial conditions
+SimulationState configuredState(const HeadlessOptions &opts, const std::string &config_path)
+{
+    SimulationState state;
+    if (!config_path.empty())
+    {
+        state.aircraft = AircraftLoader::loadFromJSON(config_path);
+        if (state.aircraft.autopilotFromConfig)
+            state.applyAutopilotGains(state.aircraft.autopilot);
+    }
+    applyInitialConditions(state, opts);
+    return state;
+}
+
+// State a run or sweep starts from: configured, then trimmed or restored if asked
+SimulationState makeBaseState(const HeadlessOptions &opts, const std::string &config_path)
+{
+    SimulationState state = configuredState(opts, config_path);
+    if (opts.trim)
+    {
+        applyTrimmedStart(state, opts);
+    }
+    if (!opts.checkpoint_in.empty())
+    {
+        SimulationCheckpoint::load(opts.checkpoint_in).restore(state);
+    }
+    return state;
+}
+
+// The cases of a sweep over every --config: case i flies design case
+// i % n of config i / n (n = cases in the design). Local sweeps and
+// distributed workers fly the same slices the same way.
+class SweepCases
+{
+public:
+    explicit SweepCases(const HeadlessOptions &opts) : opts(opts), per_config(opts.sweep.caseCount())
+    {
+        std::vector<std::string> paths = opts.config_paths;
+        if (paths.empty())
+            paths.push_back("");
+        for (const std::string &path : paths)
+        {
+            bases.push_back(makeBaseState(opts, path));
+            if (opts.fork_time >= 0.0)
+                forks.push_back(flyToFork(bases.back(), opts.run.dt, opts.fork_time)); // Shared prefix flown once
+        }
+    }
+
+    size_t count() const { return bases.size() * per_config; }
+
+    // Cases [first, first + count), in case order
+    std::vector<SweepResult> run(size_t first, size_t count, ThreadPool &pool) const
+    {
+        std::vector<SweepResult> results;
+        results.reserve(count);
+        for (size_t end = first + count; first < end;)
+        {
+            const size_t config = first / per_config;
+            const size_t local = first % per_config;
+            const size_t n = std::min(end - first, per_config - local);
+            std::vector<SweepResult> part;
+            if (opts.fork_time >= 0.0)
+            {
+                HeadlessRunConfig rest = opts.run;
+                rest.duration = opts.run.duration - opts.fork_time; // Cases cover the rest of the duration
+                part = runSweepRange(forks[config], rest, opts.sweep, local, n, pool);
+            }
+            else if (opts.batch_lanes > 0)
+                part = runSweepBatchedRange(bases[config], opts.run, opts.sweep, local, n, pool, opts.batch_lanes);
+            else
+                part = runSweepRange(bases[config], opts.run, opts.sweep, local, n, pool);
+            for (SweepResult &r : part)
+            {
+                r.index += config * per_config;
+                r.config = config;
+                results.push_back(std::move(r));
+            }
+            first += n;
+        }
+        return results;
+    }
+
+private:
+    const HeadlessOptions &opts;
+    size_t per_config;
+    std::vector<SimulationState> bases;
+    std::vector<SimulationCheckpoint> forks;
+};
+
+// Write a sweep's result table and summary; exit status 1 if any case failed
+int reportSweep(const HeadlessOptions &opts, const std::vector<SweepResult> &results, const std::string &where,
+                double elapsed)
+{
+    if (opts.output_path.empty())
+        writeSweepCSV(stdout, opts.sweep, results, opts.config_paths);
+    else
+        writeSweepCSV(opts.output_path, opts.sweep, results, opts.config_paths);
+
+    size_t failed = 0;
+    long long steps = 0;
+    for (const SweepResult &r : results)
+    {
+        steps += r.steps;
+        if (!r.error.empty())
+            failed++;
+    }
+
+    if (!opts.quiet)
+    {
+        std::cerr << "Swept " << results.size() << " cases " << where << " in " << elapsed * 1000.0 << " ms ("
+                  << (elapsed > 0.0 ? steps / elapsed : 0.0) << " steps/s)";
+        if (failed > 0)
+            std::cerr << ", " << failed << " failed";
+        std::cerr << "\n";
+        if (!opts.output_path.empty())
+            std::cerr << "Wrote results to " << opts.output_path << "\n";
+    }
+    return failed > 0 ? 1 : 0;
+}
+
+// Run every case of the sweep design in parallel and write the result table
+int runSweepMode(const HeadlessOptions &opts)
+{
+    ThreadPool pool(opts.threads);
+    SweepCases cases(opts);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SweepResult> results = cases.run(0, cases.count(), pool);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return reportSweep(opts, results, "on " + std::to_string(pool.size()) + " threads", elapsed);
+}
+
+// Hand the sweep out to workers, then merge the store into the result table.
+// Workers get this command line minus the options that only concern this process.
+int runCoordinatorMode(const HeadlessOptions &opts, const std::vector<std::string> &args)
+{
+    static const char *const local_options[] = {"--coordinator", "--threads", "--trace",  "--output",
+                                                "--store",       "--shards",  "--chunk-cases"};
+    std::vector<std::string> job;
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        if (args[i] == "--quiet")
+            continue;
+        if (std::find(std::begin(local_options), std::end(local_options), args[i]) != std::end(local_options))
+        {
+            i++; // And its value
+            continue;
+        }
+        job.push_back(args[i]);
+    }
+
+    const uint64_t case_count = std::max<size_t>(1, opts.config_paths.size()) * opts.sweep.caseCount();
+    SweepCoordinatorOptions options;
+    options.port = opts.coordinator_port;
+    options.chunk_cases = opts.chunk_cases;
+    if (options.chunk_cases == 0 && opts.batch_lanes > 0)
+    {
+        // Whole batches per chunk, so workers fill their lanes
+        size_t automatic = static_cast<size_t>(std::clamp<uint64_t>(case_count / 512, 1, 4096));
+        options.chunk_cases = (automatic + opts.batch_lanes - 1) / opts.batch_lanes * opts.batch_lanes;
+    }
+    if (!opts.quiet)
+        options.log = [](const std::string &text) { std::cerr << text << "\n"; };
+
+    SweepStore store(opts.store_path, opts.sweep, opts.config_paths, case_count, opts.shards);
+    SweepCoordinator coordinator(job, case_count, store, options);
+    if (!opts.quiet)
+    {
+        std::cerr << "Coordinating " << case_count << " cases in chunks of " << coordinator.chunkCases()
+                  << " on port " << coordinator.port() << "\n";
+    }
+    SweepCoordinatorStats stats = coordinator.run();
+    store.close();
+
+    SweepStoreContents contents = readSweepStore(opts.store_path);
+    if (contents.results.size() != case_count)
+        throw std::runtime_error("Sweep store is missing results");
+    if (!opts.quiet && stats.reissued > 0)
+        std::cerr << stats.reissued << " chunks were flown again after a worker was lost or overdue\n";
+    return reportSweep(opts, contents.results,
+                       "on " + std::to_string(stats.workers) + " workers (store: " + opts.store_path + ")",
+                       stats.seconds);
+}
+
+// Worker side of a distributed sweep: the coordinator's command line, flown
+// with this process's threads
+class HeadlessSweepJob : public SweepWorkerJob
+{
+public:
+    explicit HeadlessSweepJob(const HeadlessOptions &local) : local(local), pool(local.threads) {}
+
+    void prepare(const std::vector<std::string> &args, uint64_t case_count) override
+    {
+        if (cases && args == job_args)
+            return; // Reconnected to the same sweep
+        cases.reset();
+        opts = parseArguments(args);
+        opts.threads = local.threads;
+        opts.quiet = local.quiet;
+        cases = std::make_unique<SweepCases>(opts);
+        if (cases->count() != case_count)
+            throw std::runtime_error("Worker and coordinator disagree on the number of sweep cases");
+        job_args = args;
+    }
+
+    std::vector<SweepResult> run(size_t first, size_t count) override { return cases->run(first, count, pool); }
+
+    size_t axisCount() const override { return opts.sweep.axes.size(); }
+
+    size_t threads() const { return pool.size(); }
+
+private:
+    HeadlessOptions local;
+    HeadlessOptions opts;
+    ThreadPool pool;
+    std::vector<std::string> job_args;
+    std::unique_ptr<SweepCases> cases;
+};
+
+int runWorkerMode(const HeadlessOptions &opts)
+{
+    std::string host;
+    uint16_t port = 0;
+    parseSweepAddress(opts.worker_address, host, port);
+
+    HeadlessSweepJob job(opts);
+    SweepWorkerOptions options;
+    options.name = "FlightDynamicsHeadless";
+    options.threads = static_cast<uint32_t>(job.threads());
+    if (!opts.quiet)
+        options.log = [](const std::string &text) { std::cerr << text << "\n"; };
+
+    auto start = std::chrono::steady_clock::now();
+    SweepWorkerStats stats = runSweepWorker(host, port, job, options);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!opts.quiet)
+    {
+        std::cerr << "Flew " << stats.cases << " cases in " << stats.chunks << " chunks on " << job.threads()
+                  << " threads in " << elapsed * 1000.0 << " ms\n";
+    }
+    return 0;
+}
+
+// Run with an observer, publishing telemetry after every step if enabled.
+// Telemetry paces itself by simulated time, so the observer still sees only
+// every --every-th step. With --realtime each step waits until its simulated
+// time has passed on the wall clock.
+template <typename Observer>
+long long runObserved(SimulationState &state, const HeadlessOptions &opts, TelemetryPublisher *telemetry,
+                      Observer &&observer)
+{
+    if (!telemetry && !opts.realtime)
+        return runHeadless(state, opts.run, observer);
+
+    HeadlessRunConfig run = opts.run;
+    run.record_every = 1;
+    const int every = std::max(1, opts.run.record_every);
+    const double t0 = state.t;
+    const auto start = std::chrono::steady_clock::now();
+    long long calls = 0;
+    return runHeadless(state, run, [&](const SimulationState &s)
+                       {
+                           if (opts.realtime)
+                           {
+                               std::chrono::duration<double> sim_elapsed(s.t - t0);
+                               std::this_thread::sleep_until(
+                                   start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(sim_elapsed));
+                           }
+                           if (telemetry)
+                               telemetry->publish(s);
+                           if (calls++ % every == 0)
+                               observer(s);
+                       });
+}
+
+// Search the autopilot gains on the pool and print them (and store them in
+// the config with --write-gains)
+int runAutotuneMode(const SimulationState &state, const HeadlessOptions &opts)
+{
+    GainTuneOptions tune;
+    tune.duration = opts.run.duration;
+    tune.dt = opts.run.dt;
+    if (opts.speed > 0.0)
+        tune.cruise_speed = opts.speed;
+    if (opts.altitude > 0.0)
+        tune.cruise_altitude = opts.altitude;
+    if (opts.speed_setpoint >= 0.0)
+        tune.speed_step = opts.speed_setpoint - tune.cruise_speed;
+    if (opts.altitude_setpoint >= 0.0)
+        tune.altitude_step = opts.altitude_setpoint - tune.cruise_altitude;
+    if (tune.speed_step == 0.0 || tune.altitude_step == 0.0 || tune.duration <= 0.0)
+    {
+        throw std::runtime_error("--autotune needs setpoints away from the initial speed and altitude and a "
+                                 "positive --duration");
+    }
+
+    ThreadPool pool(opts.threads);
+    GainTuneResult result = tuneAutopilotGains(state.aircraft, state.autopilotGains(), pool, tune);
+
+    if (!opts.quiet)
+    {
+        std::cerr << "Tuned in " << result.seconds * 1000.0 << " ms (" << result.evaluations << " flights on "
+                  << pool.size() << " threads), score " << result.initial_score << " -> " << result.score << "\n";
+    }
+    for (int i = 0; i < 6; i++)
+    {
+        std::cout << "\"" << AircraftLoader::GAIN_KEYS[i] << "\": " << result.gains.at(i) << (i < 5 ? ",\n" : "\n");
+    }
+
+    if (opts.write_gains)
+    {
+        AircraftLoader::writeAutopilotGains(opts.config_paths.front(), result.gains);
+        if (!opts.quiet)
+            std::cerr << "Wrote gains to " << opts.config_paths.front() << "\n";
+    }
+    return std::isfinite(result.score) ? 0 : 1;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const std::vector<std::string> args(argv + 1, argv + argc);
+        HeadlessOptions opts = parseArguments(args);
+        if (!opts.trace_path.empty())
+        {
+#if !FLIGHT_PROFILER
+            std::cerr << "Warning: profiler zones are compiled out (FLIGHT_PROFILER=OFF); the trace will be empty\n";
+#endif
+            Profiler::instance().setThreadName("main");
+            Profiler::instance().setEnabled(true);
+        }
+
+        if (!opts.worker_address.empty())
+        {
+            return runWorkerMode(opts);
+        }
+
+        const std::string config_path = opts.config_paths.empty() ? "" : opts.config_paths.front();
+        if (!opts.envelope_path.empty())
+        {
+            FlightEnvelope env = envelopeFor(configuredState(opts, config_path).aircraft, opts);
+            std::FILE *out = std::fopen(opts.envelope_path.c_str(), "w");
+            if (!out)
+            {
+                throw std::runtime_error("Failed to open envelope output file: " + opts.envelope_path);
+            }
+            writeEnvelopeCSV(out, env);
+            std::fclose(out);
+            return 0;
+        }
+        if (opts.coordinator)
+        {
+            int status = runCoordinatorMode(opts, args);
+            writeTrace(opts);
+            return status;
+        }
+
+        if (!opts.sweep.axes.empty())
+        {
+            int status = runSweepMode(opts);
+            writeTrace(opts);
+            return status;
+        }
+
+        SimulationState state = makeBaseState(opts, config_path);
+        if (opts.autotune)
+        {
+            int status = runAutotuneMode(state, opts);
+            writeTrace(opts);
+            return status;
+        }
+
+        std::unique_ptr<TelemetryPublisher> telemetry;
+        if (opts.telemetry.enabled())
+        {
+            telemetry = std::make_unique<TelemetryPublisher>(opts.telemetry);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        long long steps = 0;
+        size_t samples = 0;
+
+        if (opts.output_path.empty() && !telemetry && !opts.realtime)
+        {
+            steps = runHeadless(state, opts.run);
+        }
+        else if (opts.output_path.empty())
+        {
+            steps = runObserved(state, opts, telemetry.get(), [](const SimulationState &) {});
+        }
+        else if (opts.recording)
+        {
+            RecordingWriter writer(opts.output_path, state.aircraft.configHash(),
+                                   opts.run.dt * std::max(1, opts.run.record_every));
+            steps = runObserved(state, opts, telemetry.get(), [&writer](const SimulationState &s)
+                                { writer.write(s); });
+            writer.close();
+            samples = static_cast<size_t>(writer.sampleCount());
+        }
+        else
+        {
+            TrajectoryWriter writer(opts.output_path, opts.format);
+            steps = runObserved(state, opts, telemetry.get(), [&writer](const SimulationState &s)
+                                { writer.write(TrajectorySample::fromState(s)); });
+            writer.close();
+            samples = writer.sampleCount();
+        }
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        writeTrace(opts);
+
+        if (!opts.checkpoint_out.empty())
+        {
+            SimulationCheckpoint::capture(state).save(opts.checkpoint_out);
+        }
+
+        if (!opts.quiet)
+        {
+            std::cout << "Simulated " << state.t << " s in " << steps << " steps (" << elapsed * 1000.0 << " ms, "
+                      << (elapsed > 0.0 ? steps / elapsed : 0.0) << " steps/s)\n";
+            if (!opts.output_path.empty())
+            {
+                std::cout << "Wrote " << samples << " samples to " << opts.output_path << "\n";
+            }
+            if (telemetry)
+            {
+                std::cout << "Published " << telemetry->packetsSent() << " telemetry packets";
+                if (telemetry->udpDropped() > 0)
+                    std::cout << " (" << telemetry->udpDropped() << " UDP sends dropped)";
+                std::cout << "\n";
+            }
+            if (!opts.checkpoint_out.empty())
+            {
+                std::cout << "Saved checkpoint at t = " << state.t << " s to " << opts.checkpoint_out << "\n";
+            }
+            std::cout << "Final state:\n";
+            std::cout << "  Position: ";
+            state.position.print();
+            std::cout << " m\n";
+            std::cout << "  Velocity: ";
+            state.velocity.print();
+            std::cout << " m/s\n";
+            std::cout << "  Pitch: " << state.pitch_deg << " deg, AoA: " << state.alpha_deg << " deg\n";
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
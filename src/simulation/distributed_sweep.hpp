@@ -0,0 +1,1013 @@
+#pragma once
+
+#include "parameter_sweep.hpp"
+#include "../utils/mapped_file.hpp"
+#include "../utils/tcp_socket.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Sweeps spread over several machines
+//
+// A coordinator owns the case space (every config variant times every case
+// of the design) and hands it out in fixed-size chunks; workers pull chunks
+// over TCP, fly them on their own thread pool and send the results back.
+// Workers get the coordinator's command line, so every node builds the same
+// base states and a case gives the same result on whichever node flies it.
+//
+// Results travel and are stored as sweep chunks in the columnar layout of
+// flight recordings (see flight_recording.hpp): a 16-byte chunk header, then
+// one contiguous block of doubles per column. The coordinator appends the
+// bytes it receives to one of several shard files without decoding them, so
+// its cost per chunk is a lock and a write whatever the worker count.
+//
+// A chunk stays leased to its worker until the results arrive. If the worker
+// disconnects its chunks go back to the queue; if it stays silent for longer
+// than the lease timeout while others are idle, its chunks are also given to
+// another worker and the first result wins. Workers reconnect after a lost
+// connection, so restarting a worker or the network only costs the chunks in
+// flight.
+
+// ---------------------------------------------------------------------------
+// Result store (.fdsweep shards)
+//
+// Layout: a 64-byte SweepStoreHeader, the schema text (schema_bytes long,
+// padded with zeros to a multiple of 8: column names separated by commas on
+// the first line, then one config name per line), then chunks. A shard cut
+// short by a crash keeps its complete chunks. Values are host-order
+// (little-endian) doubles.
+
+struct SweepStoreHeader
+{
+    char magic[8];         // "FDSWEEP\0"
+    uint32_t version;      // Format version (1)
+    uint32_t column_count; // Doubles per case
+    uint32_t axis_count;   // Swept parameters (columns 2 .. 2 + axis_count)
+    uint32_t schema_bytes; // Schema text length (without padding)
+    uint64_t case_count;   // Cases in the whole sweep (all shards)
+    uint64_t reserved[4];
+};
+static_assert(sizeof(SweepStoreHeader) == 64, "SweepStoreHeader layout");
+
+struct SweepChunkHeader
+{
+    uint32_t count; // Cases in this chunk
+    uint32_t reserved;
+    uint64_t first_case; // Case index of the first row
+};
+static_assert(sizeof(SweepChunkHeader) == 16, "SweepChunkHeader layout");
+
+// Columns after the swept values: SweepMetrics in declaration order, then steps and a failure flag
+static const char *const SWEEP_METRIC_COLUMNS[] = {
+    "speed_settling_time", "speed_overshoot", "altitude_settling_time", "altitude_overshoot", "altitude_loss",
+    "fuel", "throttle_activity", "elevator_activity", "final_speed", "final_altitude"};
+static const size_t SWEEP_METRIC_COUNT = sizeof(SWEEP_METRIC_COLUMNS) / sizeof(SWEEP_METRIC_COLUMNS[0]);
+static_assert(sizeof(SweepMetrics) == SWEEP_METRIC_COUNT * sizeof(double), "Every metric needs a column");
+
+inline size_t sweepColumnCount(size_t axis_count) { return 2 + axis_count + SWEEP_METRIC_COUNT + 2; }
+
+inline std::vector<std::string> sweepColumnNames(const SweepDesign &design)
+{
+    std::vector<std::string> names = {"case", "config"};
+    for (const SweepAxis &a : design.axes)
+        names.push_back(sweepParameterName(a.parameter));
+    names.insert(names.end(), SWEEP_METRIC_COLUMNS, SWEEP_METRIC_COLUMNS + SWEEP_METRIC_COUNT);
+    names.push_back("steps");
+    names.push_back("failed");
+    return names;
+}
+
+// One chunk (header and column blocks) holding the given results
+inline std::vector<uint8_t> encodeSweepChunk(const std::vector<SweepResult> &results, size_t axis_count)
+{
+    const size_t n = results.size();
+    const size_t columns = sweepColumnCount(axis_count);
+    std::vector<uint8_t> bytes(sizeof(SweepChunkHeader) + columns * n * sizeof(double));
+    SweepChunkHeader header = {static_cast<uint32_t>(n), 0, n > 0 ? static_cast<uint64_t>(results[0].index) : 0};
+    std::memcpy(bytes.data(), &header, sizeof(header));
+
+    double *column = reinterpret_cast<double *>(bytes.data() + sizeof(header));
+    auto put = [&](auto value_of)
+    {
+        for (size_t i = 0; i < n; i++)
+            column[i] = value_of(results[i]);
+        column += n;
+    };
+    put([](const SweepResult &r) { return static_cast<double>(r.index); });
+    put([](const SweepResult &r) { return static_cast<double>(r.config); });
+    for (size_t k = 0; k < axis_count; k++)
+        put([k](const SweepResult &r) { return k < r.values.size() ? r.values[k] : 0.0; });
+    for (size_t m = 0; m < SWEEP_METRIC_COUNT; m++)
+        put([m](const SweepResult &r) { return reinterpret_cast<const double *>(&r.metrics)[m]; });
+    put([](const SweepResult &r) { return static_cast<double>(r.steps); });
+    put([](const SweepResult &r) { return r.error.empty() ? 0.0 : 1.0; });
+    return bytes;
+}
+
+// Results of one chunk; consumed receives its size in bytes. Throws if the
+// chunk does not fit in the given bytes.
+inline std::vector<SweepResult> decodeSweepChunk(const uint8_t *data, size_t size, size_t axis_count,
+                                                 size_t &consumed)
+{
+    SweepChunkHeader header;
+    if (size < sizeof(header))
+        throw std::runtime_error("Sweep chunk is truncated");
+    std::memcpy(&header, data, sizeof(header));
+    const size_t n = header.count;
+    const size_t columns = sweepColumnCount(axis_count);
+    if (n > (size - sizeof(header)) / (columns * sizeof(double)))
+        throw std::runtime_error("Sweep chunk is truncated");
+    consumed = sizeof(header) + columns * n * sizeof(double);
+
+    // Columns are read with memcpy: shard files only keep 8-byte alignment by convention
+    std::vector<SweepResult> results(n);
+    const uint8_t *column = data + sizeof(header);
+    auto get = [&](size_t i) {
+        double v;
+        std::memcpy(&v, column + i * sizeof(double), sizeof(v));
+        return v;
+    };
+    auto next = [&] { column += n * sizeof(double); };
+    for (size_t i = 0; i < n; i++)
+        results[i].index = static_cast<size_t>(get(i));
+    next();
+    for (size_t i = 0; i < n; i++)
+        results[i].config = static_cast<size_t>(get(i));
+    next();
+    for (size_t i = 0; i < n; i++)
+        results[i].values.resize(axis_count);
+    for (size_t k = 0; k < axis_count; k++, next())
+        for (size_t i = 0; i < n; i++)
+            results[i].values[k] = get(i);
+    for (size_t m = 0; m < SWEEP_METRIC_COUNT; m++, next())
+        for (size_t i = 0; i < n; i++)
+            reinterpret_cast<double *>(&results[i].metrics)[m] = get(i);
+    for (size_t i = 0; i < n; i++)
+        results[i].steps = static_cast<long long>(get(i));
+    next();
+    for (size_t i = 0; i < n; i++)
+        if (get(i) != 0.0)
+            results[i].error = "failed";
+    return results;
+}
+
+// Writes chunks into a directory of shard files (shard-NNN.fdsweep). Chunks
+// go to shard (first case / chunk size) mod shard count; every shard has its
+// own lock, so connections storing different chunks rarely wait on each other.
+class SweepStore
+{
+public:
+    // Replaces any shards already in the directory
+    SweepStore(const std::string &directory, const SweepDesign &design, const std::vector<std::string> &configs,
+               uint64_t case_count, size_t shard_count)
+        : axis_count(design.axes.size())
+    {
+        std::filesystem::create_directories(directory);
+        std::error_code ec;
+        for (const auto &entry : std::filesystem::directory_iterator(directory, ec))
+        {
+            if (entry.path().extension() == ".fdsweep")
+                std::filesystem::remove(entry.path(), ec);
+        }
+
+        std::string schema;
+        for (const std::string &c : sweepColumnNames(design))
+            schema += (schema.empty() ? "" : ",") + c;
+        for (const std::string &c : configs)
+            schema += "\n" + c;
+
+        SweepStoreHeader header = {};
+        std::memcpy(header.magic, "FDSWEEP\0", 8);
+        header.version = 1;
+        header.column_count = static_cast<uint32_t>(sweepColumnCount(axis_count));
+        header.axis_count = static_cast<uint32_t>(axis_count);
+        header.schema_bytes = static_cast<uint32_t>(schema.size());
+        header.case_count = case_count;
+        schema.resize((schema.size() + 7) / 8 * 8, '\0');
+
+        for (size_t i = 0; i < std::max<size_t>(1, shard_count); i++)
+            shards.push_back(std::make_unique<Shard>());
+        for (size_t i = 0; i < shards.size(); i++)
+        {
+            std::string number = std::to_string(i);
+            std::string name = "shard-" + std::string(number.size() < 3 ? 3 - number.size() : 0, '0') + number + ".fdsweep";
+            std::string path = (std::filesystem::path(directory) / name).string();
+            Shard &shard = *shards[i];
+            shard.file = std::fopen(path.c_str(), "wb");
+            if (!shard.file || std::fwrite(&header, sizeof(header), 1, shard.file) != 1 ||
+                std::fwrite(schema.data(), 1, schema.size(), shard.file) != schema.size())
+            {
+                close();
+                throw std::runtime_error("Failed to create sweep shard: " + path);
+            }
+        }
+    }
+
+    ~SweepStore() { close(); }
+
+    SweepStore(const SweepStore &) = delete;
+    SweepStore &operator=(const SweepStore &) = delete;
+
+    size_t shardCount() const { return shards.size(); }
+    size_t axisCount() const { return axis_count; }
+
+    // Append one encoded chunk (thread-safe)
+    void append(size_t shard_index, const uint8_t *chunk, size_t bytes)
+    {
+        Shard &shard = *shards[shard_index % shards.size()];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.file || std::fwrite(chunk, 1, bytes, shard.file) != bytes)
+            throw std::runtime_error("Failed to write sweep shard");
+    }
+
+    void close()
+    {
+        for (auto &shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            if (shard->file)
+                std::fclose(shard->file);
+            shard->file = nullptr;
+        }
+    }
+
+private:
+    struct Shard
+    {
+        std::mutex mutex;
+        std::FILE *file = nullptr;
+    };
+
+    size_t axis_count;
+    std::vector<std::unique_ptr<Shard>> shards; // Stable addresses for the locks
+};
+
+// Everything in a store directory, merged
+struct SweepStoreContents
+{
+    std::vector<std::string> columns;
+    std::vector<std::string> configs;
+    size_t axis_count = 0;
+    uint64_t case_count = 0;
+    std::vector<SweepResult> results; // Ordered by case index, one per case found
+};
+
+// Read and merge every shard of a store (duplicate cases, from chunks flown
+// twice, are kept once). Throws if there are no shards or they disagree.
+inline SweepStoreContents readSweepStore(const std::string &directory)
+{
+    std::vector<std::filesystem::path> paths;
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(directory, ec))
+    {
+        if (entry.path().extension() == ".fdsweep")
+            paths.push_back(entry.path());
+    }
+    if (paths.empty())
+        throw std::runtime_error("No sweep shards in " + directory);
+    std::sort(paths.begin(), paths.end());
+
+    SweepStoreContents contents;
+    std::string first_schema;
+    for (const std::filesystem::path &path : paths)
+    {
+        MappedFile map(path.string());
+        SweepStoreHeader header;
+        if (map.size() < sizeof(header))
+            throw std::runtime_error("Sweep shard is truncated: " + path.string());
+        std::memcpy(&header, map.data(), sizeof(header));
+        if (std::memcmp(header.magic, "FDSWEEP", 7) != 0 || header.version != 1 ||
+            header.column_count != sweepColumnCount(header.axis_count))
+            throw std::runtime_error("Not a sweep shard: " + path.string());
+        size_t offset = sizeof(header) + (static_cast<size_t>(header.schema_bytes) + 7) / 8 * 8;
+        if (offset > map.size())
+            throw std::runtime_error("Sweep shard is truncated: " + path.string());
+
+        std::string schema(reinterpret_cast<const char *>(map.data()) + sizeof(header), header.schema_bytes);
+        if (first_schema.empty())
+        {
+            first_schema = schema;
+            contents.axis_count = header.axis_count;
+            contents.case_count = header.case_count;
+            size_t line_start = 0;
+            for (size_t line = 0; line_start <= schema.size(); line++)
+            {
+                size_t end = schema.find('\n', line_start);
+                std::string text = schema.substr(line_start, end == std::string::npos ? std::string::npos : end - line_start);
+                if (line == 0)
+                {
+                    for (size_t p = 0; p <= text.size();)
+                    {
+                        size_t comma = text.find(',', p);
+                        contents.columns.push_back(text.substr(p, comma == std::string::npos ? std::string::npos : comma - p));
+                        p = comma == std::string::npos ? text.size() + 1 : comma + 1;
+                    }
+                }
+                else
+                {
+                    contents.configs.push_back(text);
+                }
+                if (end == std::string::npos)
+                    break;
+                line_start = end + 1;
+            }
+        }
+        else if (schema != first_schema || header.axis_count != contents.axis_count)
+        {
+            throw std::runtime_error("Sweep shards belong to different sweeps: " + path.string());
+        }
+
+        while (offset < map.size())
+        {
+            size_t consumed = 0;
+            std::vector<SweepResult> chunk;
+            try
+            {
+                chunk = decodeSweepChunk(map.data() + offset, map.size() - offset, header.axis_count, consumed);
+            }
+            catch (const std::runtime_error &)
+            {
+                break; // Incomplete last chunk
+            }
+            for (SweepResult &r : chunk)
+                contents.results.push_back(std::move(r));
+            offset += consumed;
+        }
+    }
+
+    std::stable_sort(contents.results.begin(), contents.results.end(),
+                     [](const SweepResult &a, const SweepResult &b) { return a.index < b.index; });
+    contents.results.erase(std::unique(contents.results.begin(), contents.results.end(),
+                                       [](const SweepResult &a, const SweepResult &b) { return a.index == b.index; }),
+                           contents.results.end());
+    return contents;
+}
+
+// ---------------------------------------------------------------------------
+// Protocol: every message is a 16-byte header followed by its payload
+
+enum class SweepMessageType : uint32_t
+{
+    Hello = 1, // Worker -> coordinator: protocol version, threads, worker name
+    Job,       // Coordinator -> worker: sweep command line and case count
+    Request,   // Worker -> coordinator: ready for another chunk
+    Chunk,     // Coordinator -> worker: first case, case count
+    Results,   // Worker -> coordinator: first case, then one encoded sweep chunk
+    Wait,      // Coordinator -> worker: nothing to hand out yet, ask again after [s]
+    Done       // Coordinator -> worker: every case has its result
+};
+
+struct SweepMessageHeader
+{
+    char magic[4]; // "FDSW"
+    uint32_t type; // SweepMessageType
+    uint64_t size; // Payload bytes
+};
+static_assert(sizeof(SweepMessageHeader) == 16, "SweepMessageHeader layout");
+
+static const uint32_t SWEEP_PROTOCOL_VERSION = 1;
+
+// Largest payload a peer may announce; checked before anything is allocated.
+// Result chunks are sized by the coordinator to stay below it.
+static const uint64_t SWEEP_MAX_PAYLOAD = uint64_t(16) << 20;
+
+// Payload builder and parser (host-order values, strings as uint32 length + bytes)
+struct SweepMessage
+{
+    SweepMessageType type = SweepMessageType::Request;
+    std::vector<uint8_t> payload;
+    size_t read_offset = 0;
+
+    template <typename T>
+    void put(const T &v)
+    {
+        const uint8_t *p = reinterpret_cast<const uint8_t *>(&v);
+        payload.insert(payload.end(), p, p + sizeof(T));
+    }
+
+    void putString(const std::string &s)
+    {
+        put(static_cast<uint32_t>(s.size()));
+        payload.insert(payload.end(), s.begin(), s.end());
+    }
+
+    template <typename T>
+    T get()
+    {
+        if (payload.size() - read_offset < sizeof(T))
+            throw std::runtime_error("Malformed sweep message");
+        T v;
+        std::memcpy(&v, payload.data() + read_offset, sizeof(T));
+        read_offset += sizeof(T);
+        return v;
+    }
+
+    std::string getString()
+    {
+        uint32_t n = get<uint32_t>();
+        if (payload.size() - read_offset < n)
+            throw std::runtime_error("Malformed sweep message");
+        std::string s(reinterpret_cast<const char *>(payload.data() + read_offset), n);
+        read_offset += n;
+        return s;
+    }
+
+    const uint8_t *rest() const { return payload.data() + read_offset; }
+    size_t restSize() const { return payload.size() - read_offset; }
+};
+
+inline void sendSweepMessage(TcpStream &stream, const SweepMessage &message)
+{
+    SweepMessageHeader header = {{'F', 'D', 'S', 'W'}, static_cast<uint32_t>(message.type), message.payload.size()};
+    stream.sendAll(&header, sizeof(header));
+    if (!message.payload.empty())
+        stream.sendAll(message.payload.data(), message.payload.size());
+}
+
+inline void sendSweepMessage(TcpStream &stream, SweepMessageType type)
+{
+    SweepMessage message;
+    message.type = type;
+    sendSweepMessage(stream, message);
+}
+
+inline SweepMessage receiveSweepMessage(TcpStream &stream)
+{
+    SweepMessageHeader header;
+    stream.receiveAll(&header, sizeof(header));
+    if (std::memcmp(header.magic, "FDSW", 4) != 0 || header.type < 1 ||
+        header.type > static_cast<uint32_t>(SweepMessageType::Done) || header.size > SWEEP_MAX_PAYLOAD)
+        throw std::runtime_error("Not a sweep protocol peer");
+    SweepMessage message;
+    message.type = static_cast<SweepMessageType>(header.type);
+    message.payload.resize(static_cast<size_t>(header.size));
+    if (!message.payload.empty())
+        stream.receiveAll(message.payload.data(), message.payload.size());
+    return message;
+}
+
+// "host:port"
+inline void parseSweepAddress(const std::string &spec, std::string &host, uint16_t &port)
+{
+    size_t colon = spec.rfind(':');
+    char *end = nullptr;
+    long value = colon == std::string::npos ? 0 : std::strtol(spec.c_str() + colon + 1, &end, 10);
+    if (colon == std::string::npos || colon == 0 || *end != '\0' || value < 1 || value > 65535)
+        throw std::runtime_error("Invalid address (expected host:port): " + spec);
+    host = spec.substr(0, colon);
+    port = static_cast<uint16_t>(value);
+}
+
+// ---------------------------------------------------------------------------
+// Coordinator
+
+struct SweepCoordinatorOptions
+{
+    uint16_t port = 0;            // 0 = any free port (see SweepCoordinator::port())
+    size_t chunk_cases = 0;       // Cases per chunk (0 = about 512 chunks, at most 4096 cases each)
+    double lease_timeout = 300.0; // Reissue a chunk leased this long while workers are idle [s]
+    double wait_interval = 0.5;   // How long an idle worker waits before asking again [s]
+    std::function<void(const std::string &)> log; // Connection events (optional)
+};
+
+struct SweepCoordinatorStats
+{
+    size_t cases = 0;
+    size_t chunks = 0;
+    size_t workers = 0;          // Connections that sent a Hello
+    size_t reissued = 0;         // Chunks handed out again (lost or overdue worker)
+    size_t duplicate_chunks = 0; // Results that arrived for an already finished chunk
+    long long steps = 0;
+    size_t failed_cases = 0;
+    double seconds = 0.0;
+};
+
+class SweepCoordinator
+{
+public:
+    // job: command line the workers run (see runSweepWorker); results go to store
+    SweepCoordinator(std::vector<std::string> job, uint64_t case_count, SweepStore &store,
+                     const SweepCoordinatorOptions &options = SweepCoordinatorOptions())
+        : job(std::move(job)), case_count(case_count), store(store), options(options), done_count(0),
+          finished(false), stopping(false)
+    {
+        chunk_cases = options.chunk_cases > 0
+                          ? options.chunk_cases
+                          : static_cast<size_t>(std::clamp<uint64_t>(case_count / 512, 1, 4096));
+        // A chunk's results must fit in one message
+        const size_t case_bytes = sweepColumnCount(store.axisCount()) * sizeof(double);
+        chunk_cases = std::min(chunk_cases, static_cast<size_t>((SWEEP_MAX_PAYLOAD - 1024) / case_bytes));
+        const size_t chunk_count = static_cast<size_t>((case_count + chunk_cases - 1) / chunk_cases);
+        chunks.resize(chunk_count);
+        for (size_t i = 0; i < chunk_count; i++)
+            pending.push_back(i);
+        stats.cases = static_cast<size_t>(case_count);
+        stats.chunks = chunk_count;
+        listener.listen(options.port);
+    }
+
+    ~SweepCoordinator() { stop(); }
+
+    SweepCoordinator(const SweepCoordinator &) = delete;
+    SweepCoordinator &operator=(const SweepCoordinator &) = delete;
+
+    uint16_t port() const { return listener.localPort(); }
+    size_t chunkCases() const { return chunk_cases; }
+
+    // Serve workers until every case has a result (or stop() is called from
+    // another thread). Throws if the store cannot be written.
+    SweepCoordinatorStats run()
+    {
+        const auto start = std::chrono::steady_clock::now();
+        while (!isFinished() && !stopping.load())
+        {
+            TcpStream stream = listener.accept(0.1);
+            if (stream.isOpen())
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto connection = std::make_shared<Connection>();
+                connection->stream = std::move(stream);
+                connection->id = next_connection_id++;
+                connections.push_back(connection);
+                connection->thread = std::thread(&SweepCoordinator::serve, this, connection);
+            }
+            reapConnections();
+        }
+        listener.close();
+
+        // Workers that ask for more now get Done; give them a moment to hear it
+        // before cutting the connections of those still flying duplicate chunks
+        waitForConnections(2.0);
+        stop();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!store_error.empty())
+            throw std::runtime_error(store_error);
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+
+    // Disconnect every worker and end run()
+    void stop()
+    {
+        stopping.store(true);
+        // Take the list so each thread has one joiner: whatever reapConnections()
+        // removed before this is joined there, the rest here
+        std::vector<std::shared_ptr<Connection>> all;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            all.swap(connections);
+        }
+        for (auto &c : all)
+            c->stream.shutdown();
+        for (auto &c : all)
+        {
+            if (c->thread.joinable())
+                c->thread.join();
+        }
+    }
+
+    // Connections not yet reaped (open ones, and closed ones until the next accept poll)
+    size_t connectionCount() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return connections.size();
+    }
+
+    bool isFinished() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return finished;
+    }
+
+private:
+    enum class ChunkState
+    {
+        Pending,
+        Leased,
+        Done
+    };
+
+    struct ChunkInfo
+    {
+        ChunkState state = ChunkState::Pending;
+        size_t owner = 0; // Connection id of the latest lease
+        std::chrono::steady_clock::time_point leased;
+    };
+
+    struct Connection
+    {
+        TcpStream stream;
+        size_t id = 0;
+        std::thread thread;
+        std::atomic<bool> closed{false};
+    };
+
+    std::vector<std::string> job;
+    uint64_t case_count;
+    SweepStore &store;
+    SweepCoordinatorOptions options;
+    size_t chunk_cases = 1;
+    TcpListener listener;
+
+    mutable std::mutex mutex; // Guards everything below
+    std::condition_variable all_closed;
+    std::vector<ChunkInfo> chunks;
+    std::deque<size_t> pending;
+    size_t done_count;
+    bool finished;
+    std::atomic<bool> stopping;
+    std::vector<std::shared_ptr<Connection>> connections; // Open or not yet reaped
+    size_t next_connection_id = 0;                        // Lease owner ids stay unique after reaping
+    SweepCoordinatorStats stats;
+    std::string store_error;
+
+    void log(const std::string &text)
+    {
+        if (options.log)
+            options.log(text);
+    }
+
+    // Join and drop the connections whose serve() has returned, so workers
+    // that reconnect many times during a long sweep leave no threads or
+    // sockets behind. Entries leave the list under the lock before they are
+    // joined, and stop() empties it the same way, so no thread is joined twice.
+    void reapConnections()
+    {
+        std::vector<std::shared_ptr<Connection>> finished_connections;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto done = std::stable_partition(connections.begin(), connections.end(),
+                                              [](const std::shared_ptr<Connection> &c) { return !c->closed.load(); });
+            finished_connections.assign(done, connections.end());
+            connections.erase(done, connections.end());
+        }
+        for (auto &c : finished_connections)
+        {
+            if (c->thread.joinable())
+                c->thread.join();
+        }
+    }
+
+    void waitForConnections(double seconds)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        all_closed.wait_for(lock, std::chrono::duration<double>(seconds), [&]
+                            {
+                                for (auto &c : connections)
+                                    if (!c->closed.load())
+                                        return false;
+                                return true;
+                            });
+    }
+
+    // Next reply to a Request from connection 'worker'
+    SweepMessage nextAssignment(size_t worker)
+    {
+        SweepMessage reply;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (finished)
+        {
+            reply.type = SweepMessageType::Done;
+            return reply;
+        }
+
+        size_t chunk = chunks.size();
+        if (!pending.empty())
+        {
+            chunk = pending.front();
+            pending.pop_front();
+        }
+        else
+        {
+            // Nothing left to hand out: take over the oldest overdue lease of another worker
+            auto now = std::chrono::steady_clock::now();
+            auto oldest = now;
+            for (size_t i = 0; i < chunks.size(); i++)
+            {
+                const ChunkInfo &c = chunks[i];
+                if (c.state == ChunkState::Leased && c.owner != worker && c.leased < oldest &&
+                    std::chrono::duration<double>(now - c.leased).count() > options.lease_timeout)
+                {
+                    oldest = c.leased;
+                    chunk = i;
+                }
+            }
+            if (chunk < chunks.size())
+                stats.reissued++;
+        }
+
+        if (chunk == chunks.size())
+        {
+            reply.type = SweepMessageType::Wait;
+            reply.put(options.wait_interval);
+            return reply;
+        }
+        ChunkInfo &c = chunks[chunk];
+        c.state = ChunkState::Leased;
+        c.owner = worker;
+        c.leased = std::chrono::steady_clock::now();
+        uint64_t first = static_cast<uint64_t>(chunk) * chunk_cases;
+        reply.type = SweepMessageType::Chunk;
+        reply.put(first);
+        reply.put(std::min<uint64_t>(chunk_cases, case_count - first));
+        return reply;
+    }
+
+    void storeResults(SweepMessage &message)
+    {
+        uint64_t first = message.get<uint64_t>();
+        const size_t chunk = static_cast<size_t>(first / chunk_cases);
+        if (first % chunk_cases != 0 || chunk >= chunks.size())
+            throw std::runtime_error("Results for an unknown chunk");
+
+        // Check the chunk before taking it, so a malformed one cannot mark the chunk done
+        SweepChunkHeader header;
+        if (message.restSize() < sizeof(header))
+            throw std::runtime_error("Sweep chunk is truncated");
+        std::memcpy(&header, message.rest(), sizeof(header));
+        const uint64_t expected = std::min<uint64_t>(chunk_cases, case_count - first);
+        const size_t bytes = sizeof(header) + sweepColumnCount(store.axisCount()) * header.count * sizeof(double);
+        if (header.count != expected || header.first_case != first || message.restSize() != bytes)
+            throw std::runtime_error("Results do not match the chunk");
+
+        // Steps and failures for the summary (the last two columns)
+        const size_t n = header.count;
+        const uint8_t *steps_column =
+            message.rest() + sizeof(header) + (sweepColumnCount(store.axisCount()) - 2) * n * sizeof(double);
+        const uint8_t *failed_column = steps_column + n * sizeof(double);
+        long long steps = 0;
+        size_t failed = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            double v, f;
+            std::memcpy(&v, steps_column + i * sizeof(double), sizeof(v));
+            std::memcpy(&f, failed_column + i * sizeof(double), sizeof(f));
+            steps += static_cast<long long>(v);
+            failed += f != 0.0 ? 1 : 0;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (chunks[chunk].state == ChunkState::Done)
+            {
+                stats.duplicate_chunks++;
+                return;
+            }
+            chunks[chunk].state = ChunkState::Done; // Claimed; a duplicate arriving now is dropped
+        }
+        try
+        {
+            store.append(chunk, message.rest(), message.restSize());
+        }
+        catch (const std::exception &e)
+        {
+            // Not the worker's fault: end the sweep rather than hand the chunk out again
+            std::lock_guard<std::mutex> lock(mutex);
+            store_error = e.what();
+            stopping.store(true);
+            throw;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.steps += steps;
+        stats.failed_cases += failed;
+        if (++done_count == chunks.size())
+            finished = true;
+    }
+
+    // Give the chunks of a lost connection back to the queue (front: they are the oldest)
+    void release(size_t worker)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = chunks.size(); i-- > 0;)
+        {
+            ChunkInfo &c = chunks[i];
+            if (c.state == ChunkState::Leased && c.owner == worker)
+            {
+                c.state = ChunkState::Pending;
+                pending.push_front(i);
+                stats.reissued++;
+            }
+        }
+    }
+
+    void serve(std::shared_ptr<Connection> connection)
+    {
+        TcpStream &stream = connection->stream;
+        std::string name = stream.peerName();
+        // A peer silent for longer than a lease has lost its lease anyway; drop
+        // it rather than holding a thread for a connection that never speaks
+        stream.setReceiveTimeout(options.lease_timeout);
+        try
+        {
+            SweepMessage hello = receiveSweepMessage(stream);
+            if (hello.type != SweepMessageType::Hello || hello.get<uint32_t>() != SWEEP_PROTOCOL_VERSION)
+                throw std::runtime_error("incompatible worker");
+            uint32_t threads = hello.get<uint32_t>();
+            name = hello.getString() + " (" + name + ")";
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stats.workers++;
+            }
+            log("Worker " + name + " connected with " + std::to_string(threads) + " threads");
+
+            SweepMessage job_message;
+            job_message.type = SweepMessageType::Job;
+            job_message.put(case_count);
+            job_message.put(static_cast<uint32_t>(job.size()));
+            for (const std::string &arg : job)
+                job_message.putString(arg);
+            sendSweepMessage(stream, job_message);
+
+            for (;;)
+            {
+                SweepMessage message = receiveSweepMessage(stream);
+                if (message.type == SweepMessageType::Request)
+                {
+                    SweepMessage reply = nextAssignment(connection->id);
+                    sendSweepMessage(stream, reply);
+                    if (reply.type == SweepMessageType::Done)
+                        break;
+                }
+                else if (message.type == SweepMessageType::Results)
+                {
+                    storeResults(message);
+                }
+                else
+                {
+                    throw std::runtime_error("unexpected message");
+                }
+            }
+            log("Worker " + name + " finished");
+        }
+        catch (const std::exception &e)
+        {
+            release(connection->id);
+            if (!stopping.load())
+                log("Worker " + name + " lost: " + e.what());
+        }
+        stream.shutdown();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            connection->closed.store(true);
+        }
+        all_closed.notify_all();
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Worker
+
+// What a worker flies: built from the coordinator's command line
+class SweepWorkerJob
+{
+public:
+    virtual ~SweepWorkerJob() = default;
+
+    // Set up for a sweep (called once per connection, with the job's command
+    // line); an exception stops the worker, since retrying cannot help
+    virtual void prepare(const std::vector<std::string> &args, uint64_t case_count) = 0;
+
+    // Fly cases [first, first + count); results in case order
+    virtual std::vector<SweepResult> run(size_t first, size_t count) = 0;
+
+    // Swept parameters of the prepared job (columns of the encoded chunks)
+    virtual size_t axisCount() const = 0;
+};
+
+struct SweepWorkerOptions
+{
+    std::string name = "worker";
+    uint32_t threads = 0;        // Reported to the coordinator
+    double retry_delay = 1.0;    // Before reconnecting [s]
+    int max_retries = 30;        // Consecutive failed connections before giving up
+    int prefetch = 2;            // Chunks requested ahead (the next one is queued while one runs)
+    std::function<void(const std::string &)> log; // Connection events (optional)
+};
+
+struct SweepWorkerStats
+{
+    size_t chunks = 0;
+    size_t cases = 0;
+    size_t connections = 0;
+};
+
+// Pull and fly chunks from the coordinator at host:port until it reports
+// that the sweep is done. A lost connection is retried every retry_delay
+// seconds; after max_retries consecutive failures the worker gives up
+// (throws, unless it already took part in the sweep, in which case the
+// coordinator is assumed to have finished and exited).
+inline SweepWorkerStats runSweepWorker(const std::string &host, uint16_t port, SweepWorkerJob &job,
+                                       const SweepWorkerOptions &options = SweepWorkerOptions())
+{
+    auto log = [&](const std::string &text)
+    {
+        if (options.log)
+            options.log(text);
+    };
+
+    SweepWorkerStats stats;
+    int failures = 0;
+    for (;;)
+    {
+        bool preparing = false;
+        try
+        {
+            TcpStream stream;
+            stream.connect(host, port);
+            stats.connections++;
+            failures = 0;
+
+            SweepMessage hello;
+            hello.type = SweepMessageType::Hello;
+            hello.put(SWEEP_PROTOCOL_VERSION);
+            hello.put(options.threads);
+            hello.putString(options.name);
+            sendSweepMessage(stream, hello);
+
+            SweepMessage job_message = receiveSweepMessage(stream);
+            if (job_message.type != SweepMessageType::Job)
+                throw std::runtime_error("Expected a job from the coordinator");
+            uint64_t case_count = job_message.get<uint64_t>();
+            std::vector<std::string> args(job_message.get<uint32_t>());
+            for (std::string &arg : args)
+                arg = job_message.getString();
+            preparing = true;
+            job.prepare(args, case_count);
+            preparing = false;
+
+            const int prefetch = std::max(1, options.prefetch);
+            for (int i = 0; i < prefetch; i++)
+                sendSweepMessage(stream, SweepMessageType::Request);
+
+            for (;;)
+            {
+                SweepMessage message = receiveSweepMessage(stream);
+                if (message.type == SweepMessageType::Done)
+                {
+                    log("Sweep done");
+                    return stats;
+                }
+                if (message.type == SweepMessageType::Wait)
+                {
+                    double seconds = message.get<double>();
+                    std::this_thread::sleep_for(std::chrono::duration<double>(std::clamp(seconds, 0.0, 10.0)));
+                    sendSweepMessage(stream, SweepMessageType::Request);
+                    continue;
+                }
+                if (message.type != SweepMessageType::Chunk)
+                    throw std::runtime_error("Unexpected message from the coordinator");
+
+                uint64_t first = message.get<uint64_t>();
+                uint64_t count = message.get<uint64_t>();
+                if (count == 0 || first > case_count || count > case_count - first)
+                    throw std::runtime_error("Chunk outside the sweep");
+                std::vector<SweepResult> results = job.run(static_cast<size_t>(first), static_cast<size_t>(count));
+
+                SweepMessage reply;
+                reply.type = SweepMessageType::Results;
+                reply.put(first);
+                std::vector<uint8_t> chunk = encodeSweepChunk(results, job.axisCount());
+                reply.payload.insert(reply.payload.end(), chunk.begin(), chunk.end());
+                sendSweepMessage(stream, reply);
+                sendSweepMessage(stream, SweepMessageType::Request);
+                stats.chunks++;
+                stats.cases += static_cast<size_t>(count);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            if (preparing)
+                throw; // The job cannot run here; reconnecting would fail the same way
+            failures++;
+            if (failures > options.max_retries)
+            {
+                if (stats.chunks > 0)
+                {
+                    log("Coordinator gone; stopping");
+                    return stats;
+                }
+                throw std::runtime_error(std::string("Giving up on the coordinator: ") + e.what());
+            }
+            log(std::string(e.what()) + "; reconnecting");
+            std::this_thread::sleep_for(std::chrono::duration<double>(options.retry_delay));
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include "../core/vec2.hpp"
+#include <cmath>
+
+// Kinematic state captured after a physics step, used to draw the aircraft
+// at a point between the last two steps
+struct PhysicsFrame
+{
+    Vec2 position;
+    Vec2 velocity;
+    float pitch_deg;
+
+    static PhysicsFrame capture(const SimulationState &state)
+    {
+        return {state.position, state.velocity, state.pitch_deg};
+    }
+
+    // Blend two frames; alpha = 0 gives 'from', alpha = 1 gives 'to'
+    static PhysicsFrame interpolate(const PhysicsFrame &from, const PhysicsFrame &to, double alpha)
+    {
+        // Pitch wraps at +/-180, so blend along the shorter arc
+        float delta_pitch = to.pitch_deg - from.pitch_deg;
+        if (delta_pitch > 180.0f)
+            delta_pitch -= 360.0f;
+        else if (delta_pitch < -180.0f)
+            delta_pitch += 360.0f;
+
+        return {from.position + (to.position - from.position) * alpha,
+                from.velocity + (to.velocity - from.velocity) * alpha,
+                from.pitch_deg + delta_pitch * static_cast<float>(alpha)};
+    }
+};
+
+// Fixed-timestep accumulator ("fix your timestep")
+// Wall-clock time is fed in once per frame and converted into a whole number of
+// physics steps, so simulated time tracks real time at any frame rate while
+// every step uses the same dt. The leftover fraction of a step is exposed as
+// alpha() for render interpolation.
+class FixedStepAccumulator
+{
+public:
+    double step;       // Physics timestep [s]
+    int max_substeps;  // Upper bound on steps per frame (spiral-of-death guard)
+
+    FixedStepAccumulator(double step_ = 0.016, int max_substeps_ = 8)
+        : step(step_), max_substeps(max_substeps_), accumulator(0.0), dropped_time(0.0)
+    {
+    }
+
+    // Add elapsed wall time and return how many physics steps to run now
+    int advance(double frame_dt)
+    {
+        if (frame_dt > 0.0)
+            accumulator += frame_dt;
+
+        int steps = static_cast<int>(accumulator / step);
+        if (steps > max_substeps)
+        {
+            // Too far behind (breakpoint, window drag, slow frame): drop the
+            // backlog instead of trying to catch up and falling further behind
+            dropped_time += (steps - max_substeps) * step;
+            accumulator = std::fmod(accumulator, step);
+            return max_substeps;
+        }
+        accumulator -= steps * step;
+        return steps;
+    }
+
+    // Fraction of a step left in the accumulator, in [0, 1)
+    double alpha() const { return accumulator / step; }
+
+    // Total wall time discarded by the substep guard [s]
+    double droppedTime() const { return dropped_time; }
+
+    // Clear leftover time (e.g. while paused, so resuming does not burst)
+    void reset() { accumulator = 0.0; }
+
+private:
+    double accumulator;
+    double dropped_time;
+};
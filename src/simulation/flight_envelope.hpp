@@ -0,0 +1,424 @@
+#pragma once
+
+#include "trim_solver.hpp"
+#include "../core/thread_pool.hpp"
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+// Speed x altitude grid the envelope is trimmed over
+struct EnvelopeGrid
+{
+    double speed_min = 5.0;  // [m/s]
+    double speed_max = 80.0;
+    int speed_count = 76;
+    double altitude_min = 0.0; // [m]
+    double altitude_max = 4000.0;
+    int altitude_count = 17;
+
+    double speedAt(int i) const { return axisValue(speed_min, speed_max, speed_count, i); }
+    double altitudeAt(int j) const { return axisValue(altitude_min, altitude_max, altitude_count, j); }
+    size_t cellCount() const { return static_cast<size_t>(speed_count) * static_cast<size_t>(altitude_count); }
+
+    bool operator==(const EnvelopeGrid &o) const
+    {
+        return speed_min == o.speed_min && speed_max == o.speed_max && speed_count == o.speed_count &&
+               altitude_min == o.altitude_min && altitude_max == o.altitude_max && altitude_count == o.altitude_count;
+    }
+    bool operator!=(const EnvelopeGrid &o) const { return !(*this == o); }
+
+private:
+    static double axisValue(double lo, double hi, int count, int i)
+    {
+        return count <= 1 ? lo : lo + (hi - lo) * static_cast<double>(i) / static_cast<double>(count - 1);
+    }
+};
+
+// Level-flight trim of one grid point
+struct TrimCell
+{
+    float throttle;
+    float alpha_deg;
+    TrimStatus status;
+    uint8_t iterations;
+    uint16_t reserved;
+};
+static_assert(sizeof(TrimCell) == 12, "TrimCell is stored as is in envelope files");
+
+// Precomputed level-flight trim over a speed x altitude grid
+//
+// Each point is solved independently with solveTrim, so the grid is spread
+// over a thread pool. The map answers "can this aircraft hold level flight
+// here, and with what throttle and attitude" without a solve, and seeds the
+// Newton iteration for points in between (trimFromEnvelope). It is tied to
+// the aircraft by its config hash and a fingerprint of the aero model, and
+// saved in a small binary file (see loadOrComputeEnvelope).
+class FlightEnvelope
+{
+public:
+    // Binary layout: header, then cellCount() TrimCells, speed fastest
+    struct BinaryHeader
+    {
+        char magic[8];     // "FDENV\0\0\0"
+        uint32_t version;  // Format version (1)
+        uint32_t speed_count;
+        uint32_t altitude_count;
+        uint32_t reserved;
+        uint64_t config_hash;
+        uint64_t model_fingerprint;
+        double speed_min, speed_max;
+        double altitude_min, altitude_max;
+    };
+
+    FlightEnvelope() : config_hash(0), model_fingerprint(0) {}
+
+    static FlightEnvelope compute(const Aircraft &aircraft, const EnvelopeGrid &grid, ThreadPool &pool)
+    {
+        FlightEnvelope env;
+        env.grid_ = grid;
+        env.config_hash = aircraft.configHash();
+        env.model_fingerprint = modelFingerprint(aircraft);
+        env.cells.resize(grid.cellCount());
+
+        // One altitude row per task: neighbouring speeds seed each other
+        pool.parallelFor(0, static_cast<size_t>(grid.altitude_count), [&](size_t j)
+                         {
+            TrimOptions opts;
+            for (int i = 0; i < grid.speed_count; i++)
+            {
+                TrimCondition cond = {grid.speedAt(i), grid.altitudeAt(static_cast<int>(j))};
+                TrimResult r = solveTrim(aircraft, cond, opts);
+                if (!r.trimmed() && opts.throttle_guess >= 0.0)
+                {
+                    // Past the edge of the envelope the seed may lead to the
+                    // wrong branch (e.g. beyond the stall); retry from the polar estimate
+                    TrimResult fresh = solveTrim(aircraft, cond);
+                    if (fresh.trimmed() || r.status == TrimStatus::Failed)
+                        r = fresh;
+                }
+                env.cells[j * grid.speed_count + i] = {static_cast<float>(r.throttle), static_cast<float>(r.alpha_deg),
+                                                       r.status, static_cast<uint8_t>(std::min(r.iterations, 255)), 0};
+
+                // Seed the next speed from this one while inside the envelope
+                opts = TrimOptions();
+                if (r.trimmed())
+                {
+                    opts.throttle_guess = r.throttle;
+                    opts.alpha_guess_deg = r.alpha_deg;
+                }
+            } }, 1);
+        return env;
+    }
+
+    const EnvelopeGrid &grid() const { return grid_; }
+    uint64_t configHash() const { return config_hash; }
+    bool empty() const { return cells.empty(); }
+    const TrimCell &cell(int speed_index, int altitude_index) const
+    {
+        return cells[static_cast<size_t>(altitude_index) * grid_.speed_count + speed_index];
+    }
+
+    // Made for this aircraft (same config and aero model) over this grid
+    bool matches(const Aircraft &aircraft, const EnvelopeGrid &grid) const
+    {
+        return !empty() && grid == grid_ && config_hash == aircraft.configHash() &&
+               model_fingerprint == modelFingerprint(aircraft);
+    }
+
+    // Throttle and angle of attack at a point inside the grid, interpolated
+    // bilinearly from the surrounding trimmed cells (nearest trimmed corner
+    // at the edge of the envelope). False if no corner is trimmed.
+    bool estimate(double speed, double altitude, double &throttle, double &alpha_deg) const
+    {
+        if (empty())
+            return false;
+        double fi, fj;
+        int i0, j0;
+        if (!locate(speed, grid_.speed_min, grid_.speed_max, grid_.speed_count, i0, fi) ||
+            !locate(altitude, grid_.altitude_min, grid_.altitude_max, grid_.altitude_count, j0, fj))
+            return false;
+        int i1 = std::min(i0 + 1, grid_.speed_count - 1);
+        int j1 = std::min(j0 + 1, grid_.altitude_count - 1);
+
+        const TrimCell *corner[4] = {&cell(i0, j0), &cell(i1, j0), &cell(i0, j1), &cell(i1, j1)};
+        const double weight[4] = {(1 - fi) * (1 - fj), fi * (1 - fj), (1 - fi) * fj, fi * fj};
+        double sum_w = 0.0, t = 0.0, a = 0.0;
+        int nearest = -1;
+        for (int c = 0; c < 4; c++)
+        {
+            if (corner[c]->status != TrimStatus::Trimmed)
+                continue;
+            sum_w += weight[c];
+            t += weight[c] * corner[c]->throttle;
+            a += weight[c] * corner[c]->alpha_deg;
+            if (nearest < 0 || weight[c] > weight[nearest])
+                nearest = c;
+        }
+        if (nearest < 0)
+            return false;
+        if (sum_w < 1.0 - 1e-9)
+        {
+            throttle = corner[nearest]->throttle;
+            alpha_deg = corner[nearest]->alpha_deg;
+            return true;
+        }
+        throttle = t;
+        alpha_deg = a;
+        return true;
+    }
+
+    // Slowest and fastest trimmed speed in the altitude row nearest to altitude
+    bool speedRange(double altitude, double &lo, double &hi) const
+    {
+        if (empty())
+            return false;
+        double f;
+        int j;
+        locate(std::clamp(altitude, grid_.altitude_min, grid_.altitude_max), grid_.altitude_min,
+               grid_.altitude_max, grid_.altitude_count, j, f);
+        if (f > 0.5 && j + 1 < grid_.altitude_count)
+            j++;
+        bool any = false;
+        for (int i = 0; i < grid_.speed_count; i++)
+        {
+            if (cell(i, j).status != TrimStatus::Trimmed)
+                continue;
+            if (!any)
+                lo = grid_.speedAt(i);
+            hi = grid_.speedAt(i);
+            any = true;
+        }
+        return any;
+    }
+
+    size_t trimmedCount() const
+    {
+        return static_cast<size_t>(std::count_if(cells.begin(), cells.end(), [](const TrimCell &c)
+                                                 { return c.status == TrimStatus::Trimmed; }));
+    }
+
+    void save(const std::string &filepath) const
+    {
+        BinaryHeader header = {};
+        std::memcpy(header.magic, "FDENV\0\0\0", 8);
+        header.version = 1;
+        header.speed_count = static_cast<uint32_t>(grid_.speed_count);
+        header.altitude_count = static_cast<uint32_t>(grid_.altitude_count);
+        header.config_hash = config_hash;
+        header.model_fingerprint = model_fingerprint;
+        header.speed_min = grid_.speed_min;
+        header.speed_max = grid_.speed_max;
+        header.altitude_min = grid_.altitude_min;
+        header.altitude_max = grid_.altitude_max;
+
+        std::FILE *file = std::fopen(filepath.c_str(), "wb");
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open envelope file: " + filepath);
+        }
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  std::fwrite(cells.data(), sizeof(TrimCell), cells.size(), file) == cells.size();
+        if (std::fclose(file) != 0 || !ok)
+        {
+            throw std::runtime_error("Failed to write envelope file: " + filepath);
+        }
+    }
+
+    static FlightEnvelope load(const std::string &filepath)
+    {
+        std::FILE *file = std::fopen(filepath.c_str(), "rb");
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open envelope file: " + filepath);
+        }
+        BinaryHeader header;
+        bool ok = std::fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, "FDENV", 5) == 0;
+        if (!ok || header.version != 1 || header.speed_count == 0 || header.altitude_count == 0 ||
+            header.speed_count > 100000 || header.altitude_count > 100000)
+        {
+            std::fclose(file);
+            throw std::runtime_error(filepath + ": not a version 1 flight envelope");
+        }
+
+        FlightEnvelope env;
+        env.grid_.speed_min = header.speed_min;
+        env.grid_.speed_max = header.speed_max;
+        env.grid_.speed_count = static_cast<int>(header.speed_count);
+        env.grid_.altitude_min = header.altitude_min;
+        env.grid_.altitude_max = header.altitude_max;
+        env.grid_.altitude_count = static_cast<int>(header.altitude_count);
+        env.config_hash = header.config_hash;
+        env.model_fingerprint = header.model_fingerprint;
+        env.cells.resize(env.grid_.cellCount());
+        ok = std::fread(env.cells.data(), sizeof(TrimCell), env.cells.size(), file) == env.cells.size();
+        char extra;
+        ok = ok && std::fread(&extra, 1, 1, file) == 0;
+        std::fclose(file);
+        if (!ok)
+        {
+            throw std::runtime_error(filepath + ": envelope size does not match its header");
+        }
+        for (const TrimCell &c : env.cells)
+        {
+            if (c.status > TrimStatus::Failed)
+                throw std::runtime_error(filepath + ": envelope has an invalid trim status");
+        }
+        return env;
+    }
+
+    // FNV-1a over the aero coefficients at a spread of alphas, speeds and
+    // altitudes. The config hash names the aero data file but not its
+    // contents; this catches an edited table with the same name.
+    static uint64_t modelFingerprint(const Aircraft &aircraft)
+    {
+        uint64_t h = 14695981039346656037ull;
+        auto mix = [&h](double v)
+        {
+            unsigned char bytes[sizeof(double)];
+            std::memcpy(bytes, &v, sizeof(v));
+            for (unsigned char b : bytes)
+            {
+                h ^= b;
+                h *= 1099511628211ull;
+            }
+        };
+        AircraftAeroModel aero(aircraft);
+        const double speeds[] = {10.0, 30.0, 60.0};
+        const double altitudes[] = {0.0, 2000.0};
+        for (double altitude : altitudes)
+        {
+            AtmosphereState atm = getAtmosphere(altitude);
+            for (double speed : speeds)
+            {
+                for (int a = -16; a <= 16; a++)
+                {
+                    AeroCoefficients c = aero.coefficients(a * 1.25 * M_PI / 180.0, speed, atm, 0.0);
+                    mix(c.CL);
+                    mix(c.CD);
+                }
+            }
+        }
+        return h;
+    }
+
+private:
+    // Cell index below v and the fraction towards the next one; false outside the axis
+    static bool locate(double v, double lo, double hi, int count, int &index, double &frac)
+    {
+        if (count <= 1 || !(v >= lo && v <= hi))
+        {
+            index = 0;
+            frac = 0.0;
+            return count == 1 && v == lo;
+        }
+        double x = (v - lo) / (hi - lo) * (count - 1);
+        index = std::min(static_cast<int>(x), count - 2);
+        frac = x - index;
+        return true;
+    }
+
+    EnvelopeGrid grid_;
+    uint64_t config_hash;
+    uint64_t model_fingerprint;
+    std::vector<TrimCell> cells; // Altitude-major, speed fastest
+};
+
+// Trim at a condition, seeded from the envelope where it covers the point
+// (usually one or two Newton iterations instead of a dozen)
+inline TrimResult trimFromEnvelope(const Aircraft &aircraft, const FlightEnvelope *envelope, const TrimCondition &cond)
+{
+    TrimOptions opts;
+    double throttle, alpha_deg;
+    if (envelope && envelope->configHash() == aircraft.configHash() &&
+        envelope->estimate(cond.speed, cond.altitude, throttle, alpha_deg))
+    {
+        opts.throttle_guess = throttle;
+        opts.alpha_guess_deg = alpha_deg;
+        TrimResult r = solveTrim(aircraft, cond, opts);
+        if (r.status != TrimStatus::Failed)
+            return r;
+        opts = TrimOptions();
+    }
+    return solveTrim(aircraft, cond, opts);
+}
+
+// Default cache directory (relative to the working directory)
+inline constexpr const char *ENVELOPE_CACHE_DIR = "envelope_cache";
+
+// File the envelope of an aircraft is cached in: <directory>/<config hash>.fdenv
+inline std::string envelopeCachePath(const std::string &directory, const Aircraft &aircraft)
+{
+    // configHash() as 16 lowercase hex digits
+    const uint64_t hash = aircraft.configHash();
+    std::string name(16, '0');
+    for (size_t i = 0; i < name.size(); i++)
+        name[name.size() - 1 - i] = "0123456789abcdef"[(hash >> (4 * i)) & 0xf];
+    return (std::filesystem::path(directory) / (name + ".fdenv")).string();
+}
+
+// Envelope of an aircraft from the cache directory, or computed on the pool
+// and stored there when the cached one is missing, stale (different aero
+// model or grid) or unreadable. from_cache, if given, reports which.
+inline FlightEnvelope loadOrComputeEnvelope(const Aircraft &aircraft, const EnvelopeGrid &grid,
+                                            const std::string &directory, ThreadPool &pool,
+                                            bool *from_cache = nullptr)
+{
+    std::string path = envelopeCachePath(directory, aircraft);
+    std::error_code ec;
+    if (std::filesystem::exists(path, ec))
+    {
+        try
+        {
+            FlightEnvelope cached = FlightEnvelope::load(path);
+            if (cached.matches(aircraft, grid))
+            {
+                if (from_cache)
+                    *from_cache = true;
+                return cached;
+            }
+        }
+        catch (const std::exception &)
+        {
+            // Damaged or old format: recomputed and overwritten below
+        }
+    }
+
+    FlightEnvelope env = FlightEnvelope::compute(aircraft, grid, pool);
+    if (from_cache)
+        *from_cache = false;
+    try
+    {
+        // Written next to the target and renamed, so readers never see half a file
+        std::filesystem::create_directories(directory);
+        std::string temp = path + ".tmp";
+        env.save(temp);
+        std::filesystem::rename(temp, path);
+    }
+    catch (const std::exception &)
+    {
+        // A cache that cannot be written only costs the next run the computation
+    }
+    return env;
+}
+
+// Map as a table: one row per grid point
+inline void writeEnvelopeCSV(std::FILE *out, const FlightEnvelope &env)
+{
+    std::fprintf(out, "speed,altitude,status,throttle,alpha_deg\n");
+    const EnvelopeGrid &grid = env.grid();
+    for (int j = 0; j < grid.altitude_count; j++)
+    {
+        for (int i = 0; i < grid.speed_count; i++)
+        {
+            const TrimCell &c = env.cell(i, j);
+            std::fprintf(out, "%.3f,%.1f,%s,%.5f,%.4f\n", grid.speedAt(i), grid.altitudeAt(j), trimStatusName(c.status),
+                         c.throttle, c.alpha_deg);
+        }
+    }
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <vector>
+#include <memory_resource>
+#include <cstddef>
+#include <cstdint>
+
+// Flight history point for visualization
+struct FlightPoint
+{
+    float x, z;
+};
+
+// Fixed-capacity, multi-resolution flight path history
+//
+// Level 0 keeps the most recent points at full rate. Level i keeps every
+// ratio^i-th point in its own ring of the same capacity, so resolution thins
+// out with age while memory stays at levels * level_capacity points.
+// push() is O(1) (at most one write per level, amortised below two), and
+// nothing is ever shifted. forEach() walks the levels from coarsest to
+// finest and yields one chronological polyline without copying.
+//
+// Storage comes from a memory resource (the heap by default, or e.g. a run's
+// MonotonicArena). Copies are made on the heap; assigning into a history
+// keeps that history's resource.
+class FlightPathHistory
+{
+public:
+    explicit FlightPathHistory(size_t level_capacity = 2048, int levels = 6, int ratio = 4,
+                               std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : level_capacity(level_capacity > 0 ? level_capacity : 1),
+          ratio(ratio > 1 ? ratio : 2),
+          pushed(0),
+          levels(levels > 0 ? levels : 1, resource),
+          points(resource)
+    {
+        uint64_t stride = 1;
+        for (Level &level : this->levels)
+        {
+            level.stride = stride;
+            stride *= static_cast<uint64_t>(this->ratio);
+        }
+    }
+
+    void push(const FlightPoint &p)
+    {
+        if (points.empty())
+            points.resize(level_capacity * levels.size()); // Allocated once, on first use
+        FlightPoint *ring = points.data();
+        for (Level &level : levels)
+        {
+            if (pushed % level.stride != 0)
+                break; // Coarser levels have even larger strides
+            ring[level.head] = p;
+            level.head = (level.head + 1) % level_capacity;
+            if (level.count < level_capacity)
+                level.count++;
+            level.newest = pushed;
+            ring += level_capacity;
+        }
+        pushed++;
+    }
+
+    void clear()
+    {
+        for (Level &level : levels)
+        {
+            level.head = 0;
+            level.count = 0;
+            level.newest = 0;
+        }
+        pushed = 0;
+    }
+
+    // Visit the visible history oldest-first as f(const FlightPoint &)
+    template <typename Func>
+    void forEach(Func &&f) const
+    {
+        for (size_t i = levels.size(); i-- > 0;)
+        {
+            const Level &level = levels[i];
+            size_t n = visibleCount(i);
+            const FlightPoint *ring = points.data() + i * level_capacity;
+            size_t start = (level.head + level_capacity - level.count) % level_capacity;
+            for (size_t k = 0; k < n; k++)
+                f(ring[(start + k) % level_capacity]);
+        }
+    }
+
+    // Number of points forEach() visits
+    size_t size() const
+    {
+        size_t total = 0;
+        for (size_t i = 0; i < levels.size(); i++)
+            total += visibleCount(i);
+        return total;
+    }
+
+    bool empty() const { return pushed == 0; }
+
+    // Most recent point (undefined when empty)
+    const FlightPoint &back() const
+    {
+        const Level &level = levels.front();
+        return points[(level.head + level_capacity - 1) % level_capacity];
+    }
+
+    // Total points ever pushed since the last clear()
+    uint64_t pushedCount() const { return pushed; }
+
+    // Upper bound on stored points
+    size_t capacity() const { return level_capacity * levels.size(); }
+
+    // How many pushes back the oldest retained point can reach
+    uint64_t span() const { return static_cast<uint64_t>(level_capacity) * levels.back().stride; }
+
+private:
+    // Level i is the ring points[i * level_capacity, (i + 1) * level_capacity)
+    struct Level
+    {
+        size_t head = 0;     // Next write slot
+        size_t count = 0;    // Valid samples
+        uint64_t newest = 0; // Push index of the newest sample
+        uint64_t stride = 1; // Pushes between samples
+    };
+
+    size_t level_capacity;
+    int ratio;
+    uint64_t pushed;
+    std::pmr::vector<Level> levels;
+    std::pmr::vector<FlightPoint> points; // Every level's ring, back to back
+
+    // Push index of the oldest sample held by a level
+    uint64_t oldestIndex(const Level &level) const
+    {
+        return level.newest - (level.count - 1) * level.stride;
+    }
+
+    // Samples of level i that are older than everything in level i - 1
+    size_t visibleCount(size_t i) const
+    {
+        const Level &level = levels[i];
+        if (level.count == 0)
+            return 0;
+        if (i == 0)
+            return level.count;
+
+        const Level &finer = levels[i - 1];
+        uint64_t bound = oldestIndex(finer);
+        uint64_t oldest = oldestIndex(level);
+        if (bound <= oldest)
+            return 0;
+        uint64_t n = (bound - 1 - oldest) / level.stride + 1;
+        return static_cast<size_t>(n < level.count ? n : level.count);
+    }
+};
@@ -0,0 +1,516 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include "../utils/mapped_file.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+// Columnar flight recording (.fdrec)
+//
+// Layout: a 64-byte RecordingHeader, then chunks of up to chunk_samples
+// samples. Each chunk is a 16-byte RecordingChunkHeader followed by one
+// contiguous block of doubles per channel, in RecordingChannel order. Every
+// chunk but the last holds exactly chunk_samples samples, so the chunk and
+// offset of sample i follow from i alone; with samples evenly spaced by
+// 'interval' the same holds for time, giving O(1) seek. A reader reading a
+// file cut short (e.g. by a crash) ignores the incomplete last chunk.
+// Values are host-order (little-endian) doubles.
+
+enum class RecordingChannel : uint32_t
+{
+    T,
+    X,
+    Y,
+    VX,
+    VY,
+    PitchDeg,
+    AlphaDeg,
+    Throttle,
+    Elevator,
+    ThrustX,
+    ThrustY,
+    DragX,
+    DragY,
+    LiftX,
+    LiftY,
+    WeightX,
+    WeightY,
+    Count
+};
+
+static const char *const RECORDING_CHANNELS[] = {"t", "x", "y", "vx", "vy", "pitch_deg", "alpha_deg", "throttle",
+                                                 "elevator", "thrust_x", "thrust_y", "drag_x", "drag_y", "lift_x",
+                                                 "lift_y", "weight_x", "weight_y"};
+static const uint32_t RECORDING_CHANNEL_COUNT = static_cast<uint32_t>(RecordingChannel::Count);
+static_assert(sizeof(RECORDING_CHANNELS) / sizeof(RECORDING_CHANNELS[0]) == RECORDING_CHANNEL_COUNT,
+              "Every recording channel needs a name");
+
+struct RecordingHeader
+{
+    char magic[8];           // "FDREC\0\0\0"
+    uint32_t version;        // Format version (1)
+    uint32_t channel_count;  // RECORDING_CHANNEL_COUNT
+    uint32_t chunk_samples;  // Samples per full chunk
+    uint32_t reserved0;
+    uint64_t config_hash;    // Aircraft::configHash() of the recorded aircraft
+    double start_time;       // t of the first sample [s]
+    double interval;         // Time between samples [s]
+    uint64_t reserved[2];
+};
+static_assert(sizeof(RecordingHeader) == 64, "RecordingHeader layout");
+
+struct RecordingChunkHeader
+{
+    uint32_t count; // Samples in this chunk
+    uint32_t reserved;
+    double first_time; // t of the chunk's first sample [s]
+};
+static_assert(sizeof(RecordingChunkHeader) == 16, "RecordingChunkHeader layout");
+
+// One row of a recording
+struct RecordedSample
+{
+    double values[RECORDING_CHANNEL_COUNT];
+
+    double operator[](RecordingChannel c) const { return values[static_cast<uint32_t>(c)]; }
+
+    static RecordedSample fromState(const SimulationState &s)
+    {
+        return {{s.t, s.position.x, s.position.y, s.velocity.x, s.velocity.y, s.pitch_deg, s.alpha_deg, s.throttle,
+                 s.elevator, s.F_thrust_viz.x, s.F_thrust_viz.y, s.F_drag_viz.x, s.F_drag_viz.y, s.F_lift_viz.x,
+                 s.F_lift_viz.y, s.F_weight_viz.x, s.F_weight_viz.y}};
+    }
+
+    // Set the recorded quantities on a state used for display
+    void applyTo(SimulationState &s) const
+    {
+        s.t = values[0];
+        s.position = Vec2(values[1], values[2]);
+        s.velocity = Vec2(values[3], values[4]);
+        s.pitch_deg = static_cast<float>(values[5]);
+        s.alpha_deg = static_cast<float>(values[6]);
+        s.throttle = static_cast<float>(values[7]);
+        s.elevator = static_cast<float>(values[8]);
+        s.F_thrust_viz = Vec2(values[9], values[10]);
+        s.F_drag_viz = Vec2(values[11], values[12]);
+        s.F_lift_viz = Vec2(values[13], values[14]);
+        s.F_weight_viz = Vec2(values[15], values[16]);
+    }
+};
+
+// Append-only recording writer
+//
+// write() only stores the sample into the current in-memory chunk; full
+// chunks are handed to a background thread that does the file I/O, so the
+// simulation loop never waits on the disk. A small fixed set of chunk
+// buffers is recycled between the two threads. If the disk falls behind by
+// more than queue_depth chunks, write() waits for a free buffer instead of
+// growing memory without bound.
+class RecordingWriter
+{
+public:
+    RecordingWriter(const std::string &filepath, uint64_t config_hash, double interval,
+                    uint32_t chunk_samples = 4096, size_t queue_depth = 4)
+        : file(nullptr), config_hash(config_hash), interval(interval),
+          chunk_samples(chunk_samples > 0 ? chunk_samples : 1), samples(0), header_written(false),
+          stopping(false), failed(false)
+    {
+        file = std::fopen(filepath.c_str(), "wb");
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open recording output file: " + filepath);
+        }
+        for (size_t i = 0; i < queue_depth + 1; i++)
+            free_chunks.push_back(std::make_unique<Chunk>(this->chunk_samples));
+        current = takeFreeChunk();
+        worker = std::thread(&RecordingWriter::run, this);
+    }
+
+    ~RecordingWriter()
+    {
+        try
+        {
+            close();
+        }
+        catch (const std::exception &)
+        {
+            // Destructors must not throw; call close() to see write errors
+        }
+    }
+
+    RecordingWriter(const RecordingWriter &) = delete;
+    RecordingWriter &operator=(const RecordingWriter &) = delete;
+
+    void write(const RecordedSample &sample)
+    {
+        if (current->count == 0)
+            current->first_time = sample.values[0];
+        for (uint32_t c = 0; c < RECORDING_CHANNEL_COUNT; c++)
+            current->data[static_cast<size_t>(c) * chunk_samples + current->count] = sample.values[c];
+        current->count++;
+        samples++;
+        if (current->count == chunk_samples)
+        {
+            if (failed.load(std::memory_order_acquire))
+            {
+                throw std::runtime_error("Failed to write recording: " + error);
+            }
+            submit();
+        }
+    }
+
+    void write(const SimulationState &state) { write(RecordedSample::fromState(state)); }
+
+    // Write the partial last chunk, wait for the I/O thread and close the
+    // file (also called by the destructor). Throws if any write failed.
+    void close()
+    {
+        if (!file)
+            return;
+        if (current && current->count > 0)
+            submit(false);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+
+        if (!failed && !header_written)
+            writeHeader(0.0); // Empty recording
+        bool ok = !failed && std::fclose(file) == 0;
+        if (failed)
+            std::fclose(file);
+        file = nullptr;
+        if (!ok)
+        {
+            throw std::runtime_error("Failed to write recording: " + (error.empty() ? std::string("close failed") : error));
+        }
+    }
+
+    uint64_t sampleCount() const { return samples; }
+
+private:
+    struct Chunk
+    {
+        std::vector<double> data; // Channel-major: data[channel * chunk_samples + i]
+        uint32_t count = 0;
+        double first_time = 0.0;
+
+        explicit Chunk(uint32_t capacity) : data(static_cast<size_t>(capacity) * RECORDING_CHANNEL_COUNT) {}
+    };
+
+    std::FILE *file;
+    uint64_t config_hash;
+    double interval;
+    uint32_t chunk_samples;
+    uint64_t samples;
+    bool header_written; // I/O thread only (until joined)
+
+    std::unique_ptr<Chunk> current; // Producer only
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;   // I/O thread: chunk queued or stopping
+    std::condition_variable recycled; // Producer: chunk buffer freed
+    std::deque<std::unique_ptr<Chunk>> full_chunks;
+    std::vector<std::unique_ptr<Chunk>> free_chunks;
+    bool stopping;
+    std::atomic<bool> failed;
+    std::string error; // Set by the I/O thread before failed
+
+    std::unique_ptr<Chunk> takeFreeChunk()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        recycled.wait(lock, [this]
+                      { return !free_chunks.empty(); });
+        std::unique_ptr<Chunk> chunk = std::move(free_chunks.back());
+        free_chunks.pop_back();
+        chunk->count = 0;
+        return chunk;
+    }
+
+    void submit(bool replace = true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            full_chunks.push_back(std::move(current));
+        }
+        wake.notify_one();
+        if (replace)
+            current = takeFreeChunk();
+    }
+
+    void run()
+    {
+        for (;;)
+        {
+            std::unique_ptr<Chunk> chunk;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]
+                          { return stopping || !full_chunks.empty(); });
+                if (full_chunks.empty())
+                    return; // Stopping and drained
+                chunk = std::move(full_chunks.front());
+                full_chunks.pop_front();
+            }
+
+            // After a failure chunks are only recycled, so the producer never blocks
+            if (!failed.load(std::memory_order_relaxed))
+                writeChunk(*chunk);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                free_chunks.push_back(std::move(chunk));
+            }
+            recycled.notify_one();
+        }
+    }
+
+    void writeHeader(double start_time)
+    {
+        RecordingHeader header = {};
+        std::memcpy(header.magic, "FDREC\0\0\0", 8);
+        header.version = 1;
+        header.channel_count = RECORDING_CHANNEL_COUNT;
+        header.chunk_samples = chunk_samples;
+        header.config_hash = config_hash;
+        header.start_time = start_time;
+        header.interval = interval;
+        put(&header, sizeof(header));
+        header_written = true;
+    }
+
+    void writeChunk(const Chunk &chunk)
+    {
+        if (!header_written)
+            writeHeader(chunk.first_time);
+
+        RecordingChunkHeader header = {chunk.count, 0, chunk.first_time};
+        put(&header, sizeof(header));
+        if (chunk.count == chunk_samples)
+        {
+            put(chunk.data.data(), chunk.data.size() * sizeof(double));
+        }
+        else
+        {
+            // Partial last chunk: only the filled part of each channel block
+            for (uint32_t c = 0; c < RECORDING_CHANNEL_COUNT; c++)
+                put(chunk.data.data() + static_cast<size_t>(c) * chunk_samples, chunk.count * sizeof(double));
+        }
+    }
+
+    void put(const void *bytes, size_t n)
+    {
+        if (failed.load(std::memory_order_relaxed))
+            return;
+        if (std::fwrite(bytes, 1, n, file) != n)
+        {
+            error = "disk write failed";
+            failed.store(true, std::memory_order_release);
+        }
+    }
+};
+
+// Random-access reader over a memory-mapped recording
+//
+// Nothing is read up front beyond the header; values are fetched straight
+// from the mapping, so recordings larger than RAM can be replayed.
+class RecordingReader
+{
+public:
+    explicit RecordingReader(const std::string &filepath) : map(filepath), header(), samples(0), chunks(0)
+    {
+        if (map.size() < sizeof(RecordingHeader))
+        {
+            throw std::runtime_error("Recording is truncated: " + filepath);
+        }
+        std::memcpy(&header, map.data(), sizeof(header));
+        if (std::memcmp(header.magic, "FDREC", 5) != 0)
+        {
+            throw std::runtime_error("Not a flight recording: " + filepath);
+        }
+        if (header.version != 1)
+        {
+            throw std::runtime_error("Unsupported recording version " + std::to_string(header.version) + ": " +
+                                     filepath);
+        }
+        if (header.channel_count != RECORDING_CHANNEL_COUNT || header.chunk_samples == 0)
+        {
+            throw std::runtime_error("Recording has an unexpected channel layout: " + filepath);
+        }
+
+        chunk_bytes = sizeof(RecordingChunkHeader) +
+                      static_cast<size_t>(header.chunk_samples) * RECORDING_CHANNEL_COUNT * sizeof(double);
+        size_t body = map.size() - sizeof(RecordingHeader);
+        chunks = body / chunk_bytes;
+        samples = static_cast<uint64_t>(chunks) * header.chunk_samples;
+
+        // A shorter last chunk, if it was written completely
+        size_t rest = body - chunks * chunk_bytes;
+        if (rest >= sizeof(RecordingChunkHeader))
+        {
+            const RecordingChunkHeader *last = chunkHeader(chunks);
+            size_t needed = sizeof(RecordingChunkHeader) + static_cast<size_t>(last->count) * RECORDING_CHANNEL_COUNT * sizeof(double);
+            if (last->count > 0 && last->count < header.chunk_samples && needed <= rest)
+            {
+                samples += last->count;
+                chunks++;
+            }
+        }
+    }
+
+    uint64_t sampleCount() const { return samples; }
+    uint64_t configHash() const { return header.config_hash; }
+    double interval() const { return header.interval; }
+    double startTime() const { return header.start_time; }
+    double endTime() const { return samples > 0 ? value(RecordingChannel::T, samples - 1) : header.start_time; }
+    uint32_t chunkSamples() const { return header.chunk_samples; }
+
+    // Sample nearest to time t (clamped to the recording), O(1)
+    uint64_t indexAt(double t) const
+    {
+        if (samples == 0)
+            return 0;
+        double pos = header.interval > 0.0 ? (t - header.start_time) / header.interval : 0.0;
+        if (!(pos > 0.0))
+            return 0;
+        double last = static_cast<double>(samples - 1);
+        return static_cast<uint64_t>(std::llround(std::min(pos, last)));
+    }
+
+    double value(RecordingChannel channel, uint64_t i) const
+    {
+        size_t count = 0;
+        return block(channel, i, count)[0];
+    }
+
+    RecordedSample sample(uint64_t i) const
+    {
+        RecordedSample s;
+        size_t count = 0;
+        for (uint32_t c = 0; c < RECORDING_CHANNEL_COUNT; c++)
+            s.values[c] = block(static_cast<RecordingChannel>(c), i, count)[0];
+        return s;
+    }
+
+    // Contiguous values of one channel from sample i to the end of its chunk
+    // (count receives their number); use for bulk scans without per-sample lookups
+    const double *block(RecordingChannel channel, uint64_t i, size_t &count) const
+    {
+        if (i >= samples)
+        {
+            throw std::out_of_range("Recording sample index out of range");
+        }
+        size_t chunk = static_cast<size_t>(i / header.chunk_samples);
+        size_t offset = static_cast<size_t>(i % header.chunk_samples);
+        size_t stride = chunkHeader(chunk)->count;
+        const uint8_t *base = map.data() + sizeof(RecordingHeader) + chunk * chunk_bytes + sizeof(RecordingChunkHeader);
+        const double *column = reinterpret_cast<const double *>(base) + static_cast<size_t>(channel) * stride;
+        count = stride - offset;
+        return column + offset;
+    }
+
+private:
+    MappedFile map;
+    RecordingHeader header;
+    size_t chunk_bytes = 0;
+    uint64_t samples;
+    size_t chunks;
+
+    const RecordingChunkHeader *chunkHeader(size_t chunk) const
+    {
+        return reinterpret_cast<const RecordingChunkHeader *>(map.data() + sizeof(RecordingHeader) + chunk * chunk_bytes);
+    }
+};
+
+// Replays a recording into a display state for the GUI
+//
+// The flight path shown is rebuilt from the mapped file: consecutive samples
+// are appended while playing forward, and after a seek the path is redrawn
+// from at most path_points evenly spaced samples, so cost per frame stays
+// bounded whatever the recording length.
+class RecordingPlayer
+{
+public:
+    double speed = 1.0; // Playback rate (simulated seconds per wall second)
+    bool playing = true;
+
+    void open(const std::string &filepath)
+    {
+        reader = std::make_unique<RecordingReader>(filepath);
+        time = reader->startTime();
+        shown = 0;
+        has_shown = false;
+    }
+
+    void close() { reader.reset(); }
+    bool isOpen() const { return reader != nullptr; }
+    const RecordingReader &recording() const { return *reader; }
+
+    double currentTime() const { return time; }
+    void seek(double t) { time = t; }
+
+    // Advance by wall time and update the display state; returns false if nothing is open
+    bool update(double wall_dt, SimulationState &view, size_t path_points = 4096)
+    {
+        if (!reader || reader->sampleCount() == 0)
+            return false;
+        if (playing)
+            time += wall_dt * speed;
+        time = std::min(std::max(time, reader->startTime()), reader->endTime());
+        if (playing && time >= reader->endTime())
+            playing = false;
+
+        uint64_t index = reader->indexAt(time);
+        reader->sample(index).applyTo(view);
+        updatePath(view, index, path_points);
+        return true;
+    }
+
+private:
+    std::unique_ptr<RecordingReader> reader;
+    double time = 0.0;
+    uint64_t shown = 0; // Last sample index in the view's path
+    bool has_shown = false;
+
+    void updatePath(SimulationState &view, uint64_t index, size_t path_points)
+    {
+        if (has_shown && index == shown)
+            return;
+
+        if (has_shown && index > shown && index - shown <= path_points)
+        {
+            for (uint64_t i = shown + 1; i <= index; i++)
+                pushPoint(view, i);
+        }
+        else
+        {
+            view.flightPath.clear();
+            uint64_t stride = std::max<uint64_t>(1, index / std::max<size_t>(1, path_points));
+            for (uint64_t i = 0; i < index; i += stride)
+                pushPoint(view, i);
+            pushPoint(view, index);
+        }
+        shown = index;
+        has_shown = true;
+    }
+
+    void pushPoint(SimulationState &view, uint64_t i)
+    {
+        view.recordFlightPoint(static_cast<float>(reader->value(RecordingChannel::X, i)),
+                               static_cast<float>(reader->value(RecordingChannel::Y, i)));
+    }
+};
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "parameter_sweep.hpp"
+#include "../aircraft/aircraft.hpp"
+#include "../core/thread_pool.hpp"
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+// Automatic tuning of the speed and altitude autopilot gains
+//
+// Every candidate gain set is scored by one closed-loop flight: start level
+// at the cruise point, step both setpoints and measure how the loops respond
+// (settling time, overshoot, actuator activity). Candidates fly as
+// SimulationBatch lanes through runSweepBatched, so a grid of a few hundred
+// gain sets costs about as much as a handful of scalar runs.
+//
+// The search is a coarse-to-fine grid in log space: each round grids the
+// three gains of one loop around the best set so far (the other loop keeps its
+// best gains), and every round narrows the window by GainTuneOptions::shrink.
+struct GainTuneOptions
+{
+    double duration = 40.0;         // Simulated seconds per candidate
+    double dt = 0.016;              // Physics timestep [s] (tune at the dt the gains will fly at)
+    double cruise_speed = 22.0;     // Initial speed [m/s]
+    double cruise_altitude = 120.0; // Initial altitude [m]
+    double speed_step = 3.0;        // Speed setpoint minus the initial speed [m/s] (non-zero)
+    double altitude_step = 20.0;    // Altitude setpoint minus the initial altitude [m] (non-zero)
+    int grid = 5;                   // Values per gain and round (grid^3 flights per loop and round)
+    int rounds = 4;                 // Refinements of each loop
+    double shrink = 0.5;            // Fraction of the search window (in decades) kept per round
+    double overshoot_weight = 1.0;  // Per step size of overshoot
+    double effort_weight = 0.5;     // Per unit of actuator travel per second
+    size_t lanes_per_batch = 0;     // 0 = spread each grid evenly over the pool
+    AutopilotGains min_gains = {1e-3, 1e-5, 1e-4, 1e-3, 1e-5, 1e-3};
+    AutopilotGains max_gains = {0.1, 0.01, 0.05, 1.0, 0.01, 2.0}; // Match the GUI slider ranges
+};
+
+struct GainTuneResult
+{
+    AutopilotGains gains; // Best set found
+    double score = 0.0;   // Its score (lower is better)
+    double initial_score = 0.0; // Score of the starting gains
+    SweepMetrics metrics = {};  // Step response with the best gains
+    size_t evaluations = 0;     // Closed-loop flights flown
+    double seconds = 0.0;       // Wall time of the search
+};
+
+// Step-response scenario flown for every candidate
+inline SimulationState gainTuneScenario(const Aircraft &aircraft, const AutopilotGains &gains,
+                                        const GainTuneOptions &opts)
+{
+    SimulationState s;
+    s.flightPath = FlightPathHistory(1, 1); // Not recorded; keeps the copies per batch cheap
+    s.record_flight_path = false;
+    s.aircraft = aircraft;
+    s.reset();
+    s.dt = opts.dt;
+    s.position = Vec2(0.0, opts.cruise_altitude);
+    s.velocity = Vec2(opts.cruise_speed, 0.0);
+    s.autopilot_speed = true;
+    s.speed_setpoint = static_cast<float>(opts.cruise_speed + opts.speed_step);
+    s.autopilot_altitude = true;
+    s.altitude_setpoint = static_cast<float>(opts.cruise_altitude + opts.altitude_step);
+    s.applyAutopilotGains(gains);
+    return s;
+}
+
+// Cost of one step response (lower is better). Each loop adds its settling
+// time as a fraction of the flight, or 2 plus the final error in step sizes
+// if it never settled, and its overshoot in step sizes; actuator activity
+// and hitting the ground are penalized on top.
+inline double gainTuneScore(const SweepMetrics &m, const GainTuneOptions &opts)
+{
+    auto loop = [&](double settling, double overshoot, double final_error, double step)
+    {
+        step = std::abs(step);
+        double s = std::isnan(settling) ? 2.0 + std::abs(final_error) / step : settling / opts.duration;
+        return s + opts.overshoot_weight * std::max(0.0, overshoot) / step;
+    };
+    double speed = loop(m.speed_settling_time, m.speed_overshoot,
+                        m.final_speed - (opts.cruise_speed + opts.speed_step), opts.speed_step);
+    double altitude = loop(m.altitude_settling_time, m.altitude_overshoot,
+                           m.final_altitude - (opts.cruise_altitude + opts.altitude_step), opts.altitude_step);
+    double effort = opts.effort_weight * (m.throttle_activity + m.elevator_activity) / opts.duration;
+    double crash = m.altitude_loss >= opts.cruise_altitude ? 10.0 : 0.0;
+
+    double score = speed + altitude + effort + crash;
+    return std::isfinite(score) ? score : std::numeric_limits<double>::infinity();
+}
+
+namespace detail
+{
+// Fly every case of a gain design from the scenario and score it; failed
+// runs score infinity
+inline std::vector<double> scoreGainDesign(const SimulationState &base, const SweepDesign &design,
+                                           const GainTuneOptions &opts, ThreadPool &pool,
+                                           std::vector<SweepResult> &results)
+{
+    HeadlessRunConfig run;
+    run.duration = opts.duration;
+    run.dt = opts.dt;
+    size_t cases = design.caseCount();
+    size_t lanes = opts.lanes_per_batch > 0 ? opts.lanes_per_batch
+                                            : std::max<size_t>(8, (cases + pool.size() - 1) / pool.size());
+    results = runSweepBatched(base, run, design, pool, lanes);
+
+    std::vector<double> scores(results.size());
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        scores[i] = results[i].error.empty() ? gainTuneScore(results[i].metrics, opts)
+                                             : std::numeric_limits<double>::infinity();
+    }
+    return scores;
+}
+
+inline double clampGain(double v, double lo, double hi)
+{
+    return std::min(hi, std::max(lo, v));
+}
+} // namespace detail
+
+// Score one gain set on the tuning scenario
+inline double scoreAutopilotGains(const Aircraft &aircraft, const AutopilotGains &gains, ThreadPool &pool,
+                                  const GainTuneOptions &opts = GainTuneOptions(), SweepMetrics *metrics = nullptr)
+{
+    SweepDesign single;
+    single.axes.push_back({SweepParameter::SpeedKp, gains.speed_kp, gains.speed_kp, 1});
+    std::vector<SweepResult> results;
+    std::vector<double> scores =
+        detail::scoreGainDesign(gainTuneScenario(aircraft, gains, opts), single, opts, pool, results);
+    if (metrics)
+        *metrics = results[0].metrics;
+    return scores[0];
+}
+
+// Search for the gains with the lowest score, starting from 'start' (clamped
+// into the option ranges). The result is never worse than the start.
+inline GainTuneResult tuneAutopilotGains(const Aircraft &aircraft, const AutopilotGains &start, ThreadPool &pool,
+                                         const GainTuneOptions &opts = GainTuneOptions())
+{
+    auto t0 = std::chrono::steady_clock::now();
+    const AutopilotGains &lo = opts.min_gains;
+    const AutopilotGains &hi = opts.max_gains;
+
+    GainTuneResult result;
+    AutopilotGains &best = result.gains;
+    for (int g = 0; g < 6; g++)
+        best.at(g) = detail::clampGain(start.at(g), lo.at(g), hi.at(g));
+    result.initial_score = scoreAutopilotGains(aircraft, result.gains, pool, opts, &result.metrics);
+    result.score = result.initial_score;
+    result.evaluations = 1;
+
+    const SweepParameter params[6] = {SweepParameter::SpeedKp,    SweepParameter::SpeedKi,
+                                      SweepParameter::SpeedKd,    SweepParameter::AltitudeKp,
+                                      SweepParameter::AltitudeKi, SweepParameter::AltitudeKd};
+    const int grid = std::max(2, opts.grid);
+    double window = 1.0; // Fraction of each full range (in decades) searched this round
+
+    for (int round = 0; round < opts.rounds; round++)
+    {
+        for (int loop = 0; loop < 2; loop++)
+        {
+            SweepDesign design;
+            for (int g = loop * 3; g < loop * 3 + 3; g++)
+            {
+                // Window centred on the best value (in log space), shifted to stay in range
+                double decades = std::log10(hi.at(g) / lo.at(g));
+                double half = 0.5 * decades * window;
+                double center = std::log10(best.at(g) / lo.at(g));
+                center = std::min(decades - half, std::max(half, center));
+                SweepAxis axis{params[g], lo.at(g) * std::pow(10.0, center - half),
+                               lo.at(g) * std::pow(10.0, center + half), grid};
+                axis.log_scale = true;
+                design.axes.push_back(axis);
+            }
+
+            std::vector<SweepResult> results;
+            std::vector<double> scores =
+                detail::scoreGainDesign(gainTuneScenario(aircraft, result.gains, opts), design, opts, pool, results);
+            result.evaluations += scores.size();
+
+            size_t winner = static_cast<size_t>(std::min_element(scores.begin(), scores.end()) - scores.begin());
+            if (scores[winner] < result.score)
+            {
+                result.score = scores[winner];
+                result.metrics = results[winner].metrics;
+                for (int k = 0; k < 3; k++)
+                    best.at(loop * 3 + k) = results[winner].values[k];
+            }
+        }
+        window *= opts.shrink;
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return result;
+}
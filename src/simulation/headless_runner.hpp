@@ -0,0 +1,53 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include "physics_update.hpp"
+#include "specialized_stepper.hpp"
+#include <cmath>
+
+// Settings for a run without a window
+struct HeadlessRunConfig
+{
+    double duration;  // Simulated time to run [s]
+    double dt;        // Physics timestep [s]
+    int record_every; // Call the observer every N steps (1 = every step)
+
+    HeadlessRunConfig() : duration(60.0), dt(0.016), record_every(1) {}
+};
+
+// Advance the simulation as fast as the CPU allows
+// The observer is called as observer(const SimulationState &) for the initial
+// state and then every record_every steps. Returns the number of steps taken.
+template <typename Observer>
+inline long long runHeadless(SimulationState &state, const HeadlessRunConfig &config, Observer &&observer)
+{
+    state.dt = config.dt;
+    state.paused = false;
+    state.record_flight_path = false; // The observer owns the history
+
+    const long long steps = static_cast<long long>(std::ceil(config.duration / config.dt - 1e-9));
+    const int every = config.record_every > 0 ? config.record_every : 1;
+
+    observer(static_cast<const SimulationState &>(state));
+    for (long long i = 1; i <= steps; i++)
+    {
+        updatePhysics(state);
+        if (i % every == 0)
+            observer(static_cast<const SimulationState &>(state));
+    }
+    return steps;
+}
+
+// Overload for runs that only need the final state
+// Nothing observes the intermediate steps, so the configuration is fixed for
+// the whole run and the compile-time specialized stepper can be used.
+inline long long runHeadless(SimulationState &state, const HeadlessRunConfig &config)
+{
+    state.dt = config.dt;
+    state.paused = false;
+    state.record_flight_path = false;
+
+    const long long steps = static_cast<long long>(std::ceil(config.duration / config.dt - 1e-9));
+    runSpecialized(state, steps);
+    return steps;
+}
@@ -0,0 +1,639 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include "headless_runner.hpp"
+#include "simulation_checkpoint.hpp"
+#include "simulation_batch.hpp"
+#include "run_context.hpp"
+#include "../core/thread_pool.hpp"
+#include <vector>
+#include <memory_resource>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+// Parameters a sweep can vary
+enum class SweepParameter
+{
+    Mass,
+    MaxThrust,
+    CD0,
+    SpeedKp,
+    SpeedKi,
+    SpeedKd,
+    AltitudeKp,
+    AltitudeKi,
+    AltitudeKd,
+    WindSpeed,     // Steady wind at the reference altitude
+    Turbulence,    // Turbulence intensity W20 (Dryden unless the base wind names a model)
+    TurbulenceSeed // Turbulence tiles (rounded to an integer)
+};
+
+// Name used on the command line and in result tables (matches the config/state field)
+inline const char *sweepParameterName(SweepParameter p)
+{
+    switch (p)
+    {
+    case SweepParameter::Mass:
+        return "mass";
+    case SweepParameter::MaxThrust:
+        return "maxThrust";
+    case SweepParameter::CD0:
+        return "CD0";
+    case SweepParameter::SpeedKp:
+        return "pid_kp";
+    case SweepParameter::SpeedKi:
+        return "pid_ki";
+    case SweepParameter::SpeedKd:
+        return "pid_kd";
+    case SweepParameter::AltitudeKp:
+        return "alt_pid_kp";
+    case SweepParameter::AltitudeKi:
+        return "alt_pid_ki";
+    case SweepParameter::AltitudeKd:
+        return "alt_pid_kd";
+    case SweepParameter::WindSpeed:
+        return "wind_speed";
+    case SweepParameter::Turbulence:
+        return "turbulence";
+    case SweepParameter::TurbulenceSeed:
+        return "turbulence_seed";
+    }
+    return "";
+}
+
+inline SweepParameter parseSweepParameter(const std::string &name)
+{
+    for (int i = 0; i <= static_cast<int>(SweepParameter::TurbulenceSeed); i++)
+    {
+        SweepParameter p = static_cast<SweepParameter>(i);
+        if (name == sweepParameterName(p))
+            return p;
+    }
+    throw std::runtime_error("Unknown sweep parameter: " + name);
+}
+
+// Set one swept parameter on a state. Gain changes are picked up by
+// updatePhysics, which retunes the controller in place when the gains differ;
+// wind parameters give the state a new wind field from its current conditions.
+inline void applySweepParameter(SimulationState &state, SweepParameter p, double value)
+{
+    WindConditions wind = state.windConditions();
+    switch (p)
+    {
+    case SweepParameter::Mass:
+        state.aircraft.mass = value;
+        break;
+    case SweepParameter::MaxThrust:
+        state.aircraft.maxThrust = value;
+        break;
+    case SweepParameter::CD0:
+        state.aircraft.CD0 = value;
+        break;
+    case SweepParameter::SpeedKp:
+        state.pid_kp = static_cast<float>(value);
+        break;
+    case SweepParameter::SpeedKi:
+        state.pid_ki = static_cast<float>(value);
+        break;
+    case SweepParameter::SpeedKd:
+        state.pid_kd = static_cast<float>(value);
+        break;
+    case SweepParameter::AltitudeKp:
+        state.alt_pid_kp = static_cast<float>(value);
+        break;
+    case SweepParameter::AltitudeKi:
+        state.alt_pid_ki = static_cast<float>(value);
+        break;
+    case SweepParameter::AltitudeKd:
+        state.alt_pid_kd = static_cast<float>(value);
+        break;
+    case SweepParameter::WindSpeed:
+        wind.speed = value;
+        state.setWind(wind);
+        break;
+    case SweepParameter::Turbulence:
+        wind.turbulence_w20 = value;
+        if (wind.turbulence == TurbulenceModel::None)
+            wind.turbulence = TurbulenceModel::Dryden;
+        state.setWind(wind);
+        break;
+    case SweepParameter::TurbulenceSeed:
+        wind.seed = static_cast<uint64_t>(std::llround(std::max(0.0, value)));
+        state.setWind(wind);
+        break;
+    }
+}
+
+// One swept dimension: count evenly spaced values in [min, max] (grid designs).
+// Log axes space the values evenly in log(value), for gains spanning decades
+// (min and max must then be positive).
+struct SweepAxis
+{
+    SweepParameter parameter;
+    double min;
+    double max;
+    int count;
+    bool log_scale = false;
+
+    double valueAt(int i) const
+    {
+        if (count <= 1)
+            return min;
+        if (log_scale)
+            return lerp(static_cast<double>(i) / static_cast<double>(count - 1));
+        return min + (max - min) * static_cast<double>(i) / static_cast<double>(count - 1);
+    }
+
+    // Value a fraction u of the way from min to max
+    double lerp(double u) const
+    {
+        if (log_scale)
+            return min * std::pow(max / min, u);
+        return min + (max - min) * u;
+    }
+};
+
+// Set of runs to perform: full factorial grid or uniform random samples
+struct SweepDesign
+{
+    enum class Kind
+    {
+        Grid,
+        Random
+    };
+
+    Kind kind = Kind::Grid;
+    std::vector<SweepAxis> axes;
+    size_t samples = 0; // Random designs only
+    uint64_t seed = 1;  // Random designs only
+
+    size_t caseCount() const
+    {
+        if (axes.empty())
+            return 0;
+        if (kind == Kind::Random)
+            return samples;
+        size_t n = 1;
+        for (const SweepAxis &a : axes)
+            n *= static_cast<size_t>(std::max(1, a.count));
+        return n;
+    }
+
+    // Parameter values of case 'index', one per axis. Depends only on the
+    // index (random cases use a per-index generator), so results are the
+    // same whatever thread runs them and in whatever order.
+    std::vector<double> caseValues(size_t index) const
+    {
+        std::vector<double> values(axes.size());
+        if (kind == Kind::Random)
+        {
+            uint64_t state = seed ^ (0x9E3779B97F4A7C15ull * (index + 1));
+            for (size_t k = 0; k < axes.size(); k++)
+            {
+                double u = static_cast<double>(splitmix64(state) >> 11) * (1.0 / 9007199254740992.0);
+                values[k] = axes[k].lerp(u);
+            }
+            return values;
+        }
+
+        // Grid: first axis varies fastest
+        for (size_t k = 0; k < axes.size(); k++)
+        {
+            size_t count = static_cast<size_t>(std::max(1, axes[k].count));
+            values[k] = axes[k].valueAt(static_cast<int>(index % count));
+            index /= count;
+        }
+        return values;
+    }
+
+private:
+    static uint64_t splitmix64(uint64_t &state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+// Per-run figures of merit. NaN means "not applicable" (autopilot off) or,
+// for settling times, that the run never settled.
+struct SweepMetrics
+{
+    double speed_settling_time;    // Time after which speed stays in the band [s]
+    double speed_overshoot;        // Peak speed past the setpoint [m/s]
+    double altitude_settling_time; // Time after which altitude stays in the band [s]
+    double altitude_overshoot;     // Peak altitude past the setpoint [m]
+    double altitude_loss;          // Initial altitude minus lowest altitude [m]
+    double fuel;                   // Fuel proxy: thrust impulse, integral of throttle * maxThrust [N s]
+    double throttle_activity;      // Actuator effort: total variation of the throttle, sum of |change|
+    double elevator_activity;      // Total variation of the elevator stick
+    double final_speed;            // Airspeed [m/s]
+    double final_altitude;         // [m]
+};
+
+// Settling bands: fraction of the setpoint, with an absolute floor
+struct SweepTolerances
+{
+    double band_fraction = 0.02;
+    double speed_band_min = 0.1;    // [m/s]
+    double altitude_band_min = 0.5; // [m]
+};
+
+// What SweepMetricsObserver needs from one step (from a state or a batch lane)
+struct SweepSample
+{
+    double t;
+    double speed; // Airspeed (what the speed autopilot holds)
+    double altitude;
+    double throttle;
+    double elevator;
+    double max_thrust;
+    bool autopilot_speed;
+    bool autopilot_altitude;
+    double speed_setpoint;
+    double altitude_setpoint;
+};
+
+// Step observer that accumulates SweepMetrics; call finish() after the run
+class SweepMetricsObserver
+{
+public:
+    explicit SweepMetricsObserver(const SweepTolerances &tol = SweepTolerances()) : tol(tol), started(false) {}
+
+    void operator()(const SimulationState &s)
+    {
+        sample({s.t, (s.velocity - s.wind_velocity).magnitude(), s.position.y, s.throttle, s.elevator, s.aircraft.maxThrust,
+                s.autopilot_speed, s.autopilot_altitude, s.speed_setpoint, s.altitude_setpoint});
+    }
+
+    void sample(const SweepSample &s)
+    {
+        if (!started)
+        {
+            started = true;
+            initial_altitude = s.altitude;
+            min_altitude = s.altitude;
+            speed_loop.begin(s.autopilot_speed, s.speed_setpoint, s.speed, tol.speed_band_min, tol.band_fraction);
+            altitude_loop.begin(s.autopilot_altitude, s.altitude_setpoint, s.altitude, tol.altitude_band_min,
+                                tol.band_fraction);
+            fuel = 0.0;
+            throttle_activity = 0.0;
+            elevator_activity = 0.0;
+            last_t = s.t;
+        }
+        else
+        {
+            fuel += s.throttle * s.max_thrust * (s.t - last_t);
+            throttle_activity += std::abs(s.throttle - last_throttle);
+            elevator_activity += std::abs(s.elevator - last_elevator);
+            last_t = s.t;
+        }
+        last_throttle = s.throttle;
+        last_elevator = s.elevator;
+
+        min_altitude = std::min(min_altitude, s.altitude);
+        speed_loop.sample(s.t, s.speed);
+        altitude_loop.sample(s.t, s.altitude);
+        final_speed = s.speed;
+        final_altitude = s.altitude;
+    }
+
+    SweepMetrics finish() const
+    {
+        SweepMetrics m;
+        m.speed_settling_time = speed_loop.settlingTime();
+        m.speed_overshoot = speed_loop.overshoot();
+        m.altitude_settling_time = altitude_loop.settlingTime();
+        m.altitude_overshoot = altitude_loop.overshoot();
+        m.altitude_loss = started ? std::max(0.0, initial_altitude - min_altitude) : 0.0;
+        m.fuel = started ? fuel : 0.0;
+        m.throttle_activity = started ? throttle_activity : 0.0;
+        m.elevator_activity = started ? elevator_activity : 0.0;
+        m.final_speed = started ? final_speed : 0.0;
+        m.final_altitude = started ? final_altitude : 0.0;
+        return m;
+    }
+
+private:
+    // Step response of one controlled quantity
+    struct LoopTracker
+    {
+        bool active = false;
+        double setpoint = 0.0;
+        double direction = 1.0; // Sign of the initial error
+        double band = 0.0;
+        double peak = 0.0;             // Largest excursion past the setpoint
+        double last_outside = 0.0;     // Last time outside the band
+        bool outside_at_end = true;
+
+        void begin(bool enabled, double sp, double value, double band_min, double fraction)
+        {
+            active = enabled;
+            setpoint = sp;
+            direction = (sp - value) >= 0.0 ? 1.0 : -1.0;
+            band = std::max(band_min, fraction * std::abs(sp));
+            peak = 0.0;
+            last_outside = 0.0;
+            outside_at_end = true;
+        }
+
+        void sample(double t, double value)
+        {
+            if (!active)
+                return;
+            double error = value - setpoint;
+            peak = std::max(peak, error * direction);
+            outside_at_end = std::abs(error) > band;
+            if (outside_at_end)
+                last_outside = t;
+        }
+
+        double settlingTime() const
+        {
+            if (!active || outside_at_end)
+                return std::numeric_limits<double>::quiet_NaN();
+            return last_outside;
+        }
+
+        double overshoot() const { return active ? peak : std::numeric_limits<double>::quiet_NaN(); }
+    };
+
+    SweepTolerances tol;
+    bool started;
+    double initial_altitude = 0.0, min_altitude = 0.0;
+    double fuel = 0.0, last_t = 0.0;
+    double throttle_activity = 0.0, elevator_activity = 0.0;
+    double last_throttle = 0.0, last_elevator = 0.0;
+    double final_speed = 0.0, final_altitude = 0.0;
+    LoopTracker speed_loop, altitude_loop;
+};
+
+// Outcome of one case
+struct SweepResult
+{
+    size_t index = 0;
+    size_t config = 0;          // Aircraft config variant (multi-config sweeps; see writeSweepCSV)
+    std::vector<double> values; // One per design axis
+    SweepMetrics metrics = {};
+    long long steps = 0;
+    std::string error; // Non-empty if the run failed
+};
+
+namespace detail
+{
+// Apply case 'index' to a prepared state and fly it, collecting metrics
+inline void flySweepCase(SimulationState &state, const HeadlessRunConfig &run, const SweepDesign &design,
+                         const SweepTolerances &tol, SweepResult &result)
+{
+    for (size_t k = 0; k < design.axes.size(); k++)
+        applySweepParameter(state, design.axes[k].parameter, result.values[k]);
+
+    SweepMetricsObserver observer(tol);
+    HeadlessRunConfig every_step = run;
+    every_step.record_every = 1; // Metrics need every step
+    result.steps = runHeadless(state, every_step, observer);
+    result.metrics = observer.finish();
+}
+} // namespace detail
+
+// Run one case of a design from the base state (in the calling thread's
+// RunContext; pass a borrowedRunBase() to skip the aero table refcount)
+inline SweepResult runSweepCase(const SimulationState &base, const HeadlessRunConfig &run, const SweepDesign &design,
+                                size_t index, const SweepTolerances &tol = SweepTolerances())
+{
+    SweepResult result;
+    result.index = index;
+    result.values = design.caseValues(index);
+    try
+    {
+        SimulationState &state = RunContext::forThread().begin(base);
+        detail::flySweepCase(state, run, design, tol, result);
+    }
+    catch (const std::exception &e)
+    {
+        result.error = e.what();
+    }
+    return result;
+}
+
+// Run one case branching off a shared checkpoint. The swept parameters are
+// applied at the fork and run.duration is the time flown after it; metrics
+// cover only that part of the flight.
+inline SweepResult runSweepCase(const SimulationCheckpoint &fork, const HeadlessRunConfig &run,
+                                const SweepDesign &design, size_t index,
+                                const SweepTolerances &tol = SweepTolerances())
+{
+    SweepResult result;
+    result.index = index;
+    result.values = design.caseValues(index);
+    try
+    {
+        // Fields outside the checkpoint start from a default state, as a fresh state would
+        static const SimulationState blank = borrowedRunBase(SimulationState());
+        SimulationState &state = RunContext::forThread().begin(blank);
+        fork.restore(state);
+        detail::flySweepCase(state, run, design, tol, result);
+    }
+    catch (const std::exception &e)
+    {
+        result.error = e.what();
+    }
+    return result;
+}
+
+// Run cases [first, first + count) of a design on the pool (a slice of the
+// design, e.g. one chunk of a distributed sweep). Results are ordered by case index.
+inline std::vector<SweepResult> runSweepRange(const SimulationState &base, const HeadlessRunConfig &run,
+                                              const SweepDesign &design, size_t first, size_t count,
+                                              ThreadPool &pool, const SweepTolerances &tol = SweepTolerances())
+{
+    std::vector<SweepResult> results(count);
+
+    // Runs are independent and each writes only its own slot. A grain of 1
+    // keeps load balanced when some runs are much slower than others.
+    const SimulationState shared = borrowedRunBase(base);
+    pool.parallelFor(0, results.size(), [&](size_t i)
+                     { results[i] = runSweepCase(shared, run, design, first + i, tol); }, 1);
+    return results;
+}
+
+// Same, with every case forked from one mid-flight checkpoint so the common
+// prefix is simulated once instead of once per case
+inline std::vector<SweepResult> runSweepRange(const SimulationCheckpoint &fork, const HeadlessRunConfig &run,
+                                              const SweepDesign &design, size_t first, size_t count,
+                                              ThreadPool &pool, const SweepTolerances &tol = SweepTolerances())
+{
+    std::vector<SweepResult> results(count);
+    SimulationCheckpoint shared = fork;
+    shared.aircraft = fork.aircraft.borrowed();
+    if (fork.wind)
+        shared.wind = std::shared_ptr<const WindField>(std::shared_ptr<const WindField>(), fork.wind.get());
+    pool.parallelFor(0, results.size(), [&](size_t i)
+                     { results[i] = runSweepCase(shared, run, design, first + i, tol); }, 1);
+    return results;
+}
+
+// Run every case of a design on the pool
+inline std::vector<SweepResult> runSweep(const SimulationState &base, const HeadlessRunConfig &run,
+                                         const SweepDesign &design, ThreadPool &pool,
+                                         const SweepTolerances &tol = SweepTolerances())
+{
+    return runSweepRange(base, run, design, 0, design.caseCount(), pool, tol);
+}
+
+inline std::vector<SweepResult> runSweep(const SimulationCheckpoint &fork, const HeadlessRunConfig &run,
+                                         const SweepDesign &design, ThreadPool &pool,
+                                         const SweepTolerances &tol = SweepTolerances())
+{
+    return runSweepRange(fork, run, design, 0, design.caseCount(), pool, tol);
+}
+
+// Same design flown through SimulationBatch: lanes_per_batch cases advance
+// together in one batch (PIDBank autopilots, vectorized force kernels) and
+// the batches are spread over the pool, so thousands of gain sets cost about
+// as much as a few dozen scalar runs. The batch kernel implements the legacy
+// integrator only. Results match runSweep up to rounding (the kernel uses
+// fast trig), and autopilots start from a reset controller. Lanes do not
+// interact, so a case's result does not depend on which cases share its batch.
+// Flies cases [first, first + count) of the design.
+inline std::vector<SweepResult> runSweepBatchedRange(const SimulationState &base, const HeadlessRunConfig &run,
+                                                     const SweepDesign &design, size_t first_case, size_t count,
+                                                     ThreadPool &pool, size_t lanes_per_batch = 256,
+                                                     const SweepTolerances &tol = SweepTolerances())
+{
+    if (base.integration_method != IntegrationMethod::Legacy)
+    {
+        throw std::runtime_error("Batched sweeps support the legacy integrator only");
+    }
+
+    std::vector<SweepResult> results(count);
+    const size_t lanes = std::max<size_t>(1, lanes_per_batch);
+    const size_t batches = (results.size() + lanes - 1) / lanes;
+    const long long steps = static_cast<long long>(std::ceil(run.duration / run.dt - 1e-9));
+    const SimulationState shared = borrowedRunBase(base);
+
+    // One batch of consecutive cases; every batch writes only its own slots.
+    // The batch, state and observers come from the worker's RunContext.
+    auto fly_batch = [&](size_t b)
+    {
+        const size_t first = b * lanes;
+        const size_t n = std::min(lanes, results.size() - first);
+        try
+        {
+            RunContext &context = RunContext::forThread();
+            SimulationState &state = context.begin(shared); // Every case sets all swept fields
+            SimulationBatch &batch = context.batch(n);
+            batch.dt = run.dt;
+            batch.t = base.t;
+            for (size_t i = 0; i < n; i++)
+            {
+                SweepResult &r = results[first + i];
+                r.index = first_case + first + i;
+                r.values = design.caseValues(r.index);
+                for (size_t k = 0; k < design.axes.size(); k++)
+                    applySweepParameter(state, design.axes[k].parameter, r.values[k]);
+                batch.setLane(i, state);
+            }
+
+            std::pmr::vector<SweepMetricsObserver> observers(n, SweepMetricsObserver(tol), &context.scratch());
+            auto observe = [&]
+            {
+                for (size_t i = 0; i < n; i++)
+                {
+                    double air_x = batch.vx[i] - batch.wind_x[i];
+                    double air_y = batch.vy[i] - batch.wind_y[i];
+                    double speed = std::sqrt(air_x * air_x + air_y * air_y);
+                    observers[i].sample({batch.t, speed, batch.y[i], batch.throttle[i], batch.elevator[i],
+                                         batch.max_thrust[i], batch.autopilot_speed[i] != 0,
+                                         batch.autopilot_altitude[i] != 0, batch.speed_setpoint[i],
+                                         batch.altitude_setpoint[i]});
+                }
+            };
+            observe();
+            for (long long s = 1; s <= steps; s++)
+            {
+                batch.step();
+                observe();
+            }
+            for (size_t i = 0; i < n; i++)
+            {
+                results[first + i].metrics = observers[i].finish();
+                results[first + i].steps = steps;
+            }
+        }
+        catch (const std::exception &e)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                results[first + i].index = first_case + first + i;
+                results[first + i].error = e.what();
+            }
+        }
+    };
+    pool.parallelFor(0, batches, fly_batch, 1);
+    return results;
+}
+
+inline std::vector<SweepResult> runSweepBatched(const SimulationState &base, const HeadlessRunConfig &run,
+                                                const SweepDesign &design, ThreadPool &pool,
+                                                size_t lanes_per_batch = 256,
+                                                const SweepTolerances &tol = SweepTolerances())
+{
+    return runSweepBatchedRange(base, run, design, 0, design.caseCount(), pool, lanes_per_batch, tol);
+}
+
+// Fly the shared prefix of a forked sweep: advance a copy of base by
+// fork_time and capture it. Steps through updatePhysics like the cases do,
+// so a forked case matches a full-length run bit for bit.
+inline SimulationCheckpoint flyToFork(SimulationState base, double dt, double fork_time)
+{
+    HeadlessRunConfig prefix;
+    prefix.duration = fork_time;
+    prefix.dt = dt;
+    runHeadless(base, prefix, [](const SimulationState &) {});
+    return SimulationCheckpoint::capture(base);
+}
+
+// Result table: one row per case, swept values then metrics. With more than
+// one config the second column names the config of each case.
+inline void writeSweepCSV(std::FILE *out, const SweepDesign &design, const std::vector<SweepResult> &results,
+                          const std::vector<std::string> &configs = {})
+{
+    const bool named = configs.size() > 1;
+    std::fprintf(out, named ? "case,config" : "case");
+    for (const SweepAxis &a : design.axes)
+        std::fprintf(out, ",%s", sweepParameterName(a.parameter));
+    std::fprintf(out, ",speed_settling_time,speed_overshoot,altitude_settling_time,altitude_overshoot,"
+                      "altitude_loss,fuel,throttle_activity,elevator_activity,final_speed,final_altitude,error\n");
+
+    for (const SweepResult &r : results)
+    {
+        std::fprintf(out, "%zu", r.index);
+        if (named)
+            std::fprintf(out, ",%s", r.config < configs.size() ? configs[r.config].c_str() : "");
+        for (double v : r.values)
+            std::fprintf(out, ",%.6g", v);
+        const SweepMetrics &m = r.metrics;
+        std::fprintf(out, ",%.4f,%.4f,%.4f,%.4f,%.4f,%.1f,%.4f,%.4f,%.4f,%.4f,%s\n", m.speed_settling_time,
+                     m.speed_overshoot, m.altitude_settling_time, m.altitude_overshoot, m.altitude_loss, m.fuel,
+                     m.throttle_activity, m.elevator_activity, m.final_speed, m.final_altitude, r.error.c_str());
+    }
+}
+
+inline void writeSweepCSV(const std::string &path, const SweepDesign &design, const std::vector<SweepResult> &results,
+                          const std::vector<std::string> &configs = {})
+{
+    std::FILE *out = std::fopen(path.c_str(), "w");
+    if (!out)
+    {
+        throw std::runtime_error("Failed to open sweep output file: " + path);
+    }
+    writeSweepCSV(out, design, results, configs);
+    std::fclose(out);
+}
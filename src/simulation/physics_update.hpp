@@ -2,8 +2,10 @@
 
 #include "simulation_state.hpp"
 #include "../environment/atmosphere.hpp"
+#include "../environment/wind.hpp"
 #include "../aerodynamics/aero.hpp"
 #include "../core/integrator.hpp"
+#include "../core/profiler.hpp"
 #include <cmath>
 #include <algorithm>
 
@@ -11,21 +13,286 @@
 #define M_PI 3.14159265358979323846
 #endif
 
+// Force vectors and angle of attack behind one acceleration evaluation
+struct ForceBreakdown
+{
+    Vec2 thrust, drag, lift, weight;
+    double alpha; // Angle of attack [rad]
+};
+
+// Pitch dynamics: elevator commands a pitch rate scaled by dynamic pressure,
+// which the airframe follows with first-order damping [deg/s^2]
+constexpr double pitchAcceleration(double rho, double speed, double elevator, double pitch_rate)
+{
+    // Simplified model: pitch_rate proportional to elevator and dynamic pressure
+    double q_dynamic = 0.5 * rho * speed * speed;
+    double pitch_authority = 50.0; // deg/s per elevator unit at unit dynamic pressure
+    double target_pitch_rate = elevator * pitch_authority * std::min(1.0, q_dynamic / 500.0);
+
+    // Simple pitch damping and response
+    double pitch_damping = 5.0; // Natural damping
+    return (target_pitch_rate - pitch_rate) * pitch_damping;
+}
+
+// Aero coefficient sources for computeAcceleration
+// coefficients(alpha, speed, atm, elevator) returns CL and CD (CD including CD0).
+
+// Linear lift / parabolic drag polar
+struct PolarAeroModel
+{
+    double CL_alpha, CD0, k;
+
+    explicit constexpr PolarAeroModel(double CL_alpha, double CD0, double k) : CL_alpha(CL_alpha), CD0(CD0), k(k) {}
+    explicit PolarAeroModel(const Aircraft &aircraft) : PolarAeroModel(aircraft.CL_alpha, aircraft.CD0, aircraft.k) {}
+
+    constexpr AeroCoefficients coefficients(double alpha, double, const AtmosphereState &, double) const
+    {
+        double CL = calcCL(alpha, CL_alpha);
+        return {CL, calcCD(CL, CD0, k)};
+    }
+};
+
+// Lookup table over alpha (and optionally Mach, Reynolds, elevator)
+// Holds a plain pointer; the aircraft's shared_ptr keeps the table alive.
+struct TableAeroModel
+{
+    const AeroDataTable *table;
+    double CD0;
+    double chord; // 0 unless the table has a Reynolds axis and the chord is known
+
+    explicit TableAeroModel(const Aircraft &aircraft)
+        : table(aircraft.aeroTable.get()), CD0(aircraft.CD0),
+          chord((table->hasAxis(AeroAxis::Reynolds) && aircraft.chord > 0.0) ? aircraft.chord : 0.0)
+    {
+    }
+
+    AeroCoefficients coefficients(double alpha, double speed, const AtmosphereState &atm, double elevator) const
+    {
+        // CL and CD from one lookup over the table's axes
+        PROFILE_ZONE(ProfileZone::AeroLookup);
+        AeroQuery query;
+        query.alpha = alpha;
+        query.mach = speed / atm.a;
+        query.elevator = elevator;
+        if (chord > 0.0)
+            query.reynolds = atm.rho * speed * chord / atm.mu;
+        return calcCLCD(query, CD0, table);
+    }
+};
+
+// Picks the table or the polar at run time (updatePhysics)
+struct AircraftAeroModel
+{
+    const Aircraft &aircraft;
+
+    explicit AircraftAeroModel(const Aircraft &aircraft) : aircraft(aircraft) {}
+
+    AeroCoefficients coefficients(double alpha, double speed, const AtmosphereState &atm, double elevator) const
+    {
+        if (aircraft.hasAeroTable())
+            return TableAeroModel(aircraft).coefficients(alpha, speed, atm, elevator);
+        return PolarAeroModel(aircraft).coefficients(alpha, speed, atm, elevator);
+    }
+};
+
+// Net acceleration of the aircraft for a given air-relative velocity (speed
+// is its magnitude), pitch and control setting
+template <typename AeroModel>
+inline Vec2 computeAcceleration(const Aircraft &aircraft, const AeroModel &aero, const AtmosphereState &atm,
+                                const Vec2 &velocity, double speed, double pitch_deg, double throttle,
+                                double elevator, ForceBreakdown &forces)
+{
+    // Calculate angle of attack from pitch and velocity direction
+    Vec2 velocityDir = (speed > 1e-6) ? velocity.normalized() : Vec2(1.0, 0.0);
+    double velocity_angle = std::atan2(velocity.y, velocity.x); // Flight path angle
+    double pitch_rad = pitch_deg * M_PI / 180.0;
+    double alpha = pitch_rad - velocity_angle; // AoA = pitch - flight path angle
+    forces.alpha = alpha;
+
+    double rho = atm.rho;
+
+    // Calculate aerodynamic coefficients
+    AeroCoefficients coeffs = aero.coefficients(alpha, speed, atm, elevator);
+
+    // Calculate force magnitudes
+    double L_mag = calcLift(rho, speed, aircraft.S, coeffs.CL);
+    double D_mag = calcDrag(rho, speed, aircraft.S, coeffs.CD);
+    double W_mag = calcWeight(aircraft.mass, g);
+    double T_mag = calcThrust(throttle, aircraft.maxThrust);
+
+    // Force vectors (thrust aligned with pitch, lift/drag with velocity)
+    Vec2 thrust_dir(std::cos(pitch_rad), std::sin(pitch_rad));
+    forces.thrust = thrust_dir * T_mag;
+    forces.drag = (speed > 1e-6) ? velocityDir * (-D_mag) : Vec2(0.0, 0.0);
+    forces.lift = velocityDir.rotated(M_PI / 2.0) * L_mag;
+    forces.weight = Vec2(0.0, -W_mag);
+
+    // Net force and acceleration
+    Vec2 F_net = forces.thrust + forces.drag + forces.lift + forces.weight;
+    return F_net / aircraft.mass;
+}
+
+// Time derivative of the full flight state for fixed control settings and wind
+// Used by the coupled integrators, which call it at every stage.
+template <typename AeroModel>
+class BasicFlightDerivative
+{
+public:
+    BasicFlightDerivative(const Aircraft &aircraft, const AeroModel &aero, double throttle, double elevator,
+                          const Vec2 &wind = Vec2(0.0, 0.0))
+        : aircraft(aircraft), aero(aero), throttle(throttle), elevator(elevator), wind(wind)
+    {
+    }
+
+    FlightState operator()(double, const FlightState &y) const
+    {
+        ForceBreakdown forces;
+        return evaluate(y, forces);
+    }
+
+    FlightState evaluate(const FlightState &y, ForceBreakdown &forces) const
+    {
+        AtmosphereState atm = getAtmosphere(std::max(0.0, y.position.y));
+        Vec2 air_velocity = y.velocity - wind;
+        double speed = air_velocity.magnitude();
+        Vec2 acceleration = computeAcceleration(aircraft, aero, atm, air_velocity, speed, y.pitch_deg, throttle,
+                                                elevator, forces);
+        return {y.velocity, acceleration, y.pitch_rate, pitchAcceleration(atm.rho, speed, elevator, y.pitch_rate)};
+    }
+
+private:
+    const Aircraft &aircraft;
+    AeroModel aero;
+    double throttle;
+    double elevator;
+    Vec2 wind;
+};
+
+class FlightDerivative : public BasicFlightDerivative<AircraftAeroModel>
+{
+public:
+    FlightDerivative(const Aircraft &aircraft, double throttle, double elevator)
+        : BasicFlightDerivative<AircraftAeroModel>(aircraft, AircraftAeroModel(aircraft), throttle, elevator)
+    {
+    }
+};
+
+// Wind over the coming step, sampled at the start-of-step altitude and time
+// and held constant over dt like the controls. Advances the turbulence phase
+// by the distance flown through the air during the step. State is
+// SimulationState or any type with the same wind members.
+template <typename State>
+inline Vec2 stepWind(State &state)
+{
+    if (!state.wind)
+        return Vec2(0.0, 0.0);
+    WindSample w = state.wind->sample(state.position.y, state.t, state.turbulence_phase);
+    Vec2 wind(w.x, w.y);
+    WindField::advance(state.turbulence_phase, w, (state.velocity - wind).magnitude() * state.dt);
+    return wind;
+}
+
+// Integration schemes over one dt. State is SimulationState or any type
+// with the same flight state and control members (see SpecializedStepper).
+// Forces act on the velocity relative to the air (velocity - wind).
+
+// Legacy scheme: pitch by semi-implicit Euler, then forces once per step
+// (air_velocity and its magnitude speed at the start of the step)
+template <typename State, typename AeroModel>
+inline void integrateLegacy(State &state, const AeroModel &aero, const AtmosphereState &atm,
+                            const Vec2 &air_velocity, double speed, ForceBreakdown &forces)
+{
+    double pitch_acceleration = pitchAcceleration(atm.rho, speed, state.elevator, state.pitch_rate);
+    state.pitch_rate += static_cast<float>(pitch_acceleration * state.dt);
+    state.pitch_deg += state.pitch_rate * static_cast<float>(state.dt);
+
+    // Normalize pitch angle to [-180, 180] degrees to allow loops
+    while (state.pitch_deg > 180.0f)
+        state.pitch_deg -= 360.0f;
+    while (state.pitch_deg < -180.0f)
+        state.pitch_deg += 360.0f;
+
+    Vec2 acceleration = computeAcceleration(state.aircraft, aero, atm, air_velocity, speed, state.pitch_deg,
+                                            state.throttle, state.elevator, forces);
+
+    // Integrate using RK4
+    integrateRK4(state.position, state.velocity, acceleration, state.dt);
+    state.integrator_evaluations = 1;
+}
+
+// Coupled schemes: forces re-evaluated inside the step (RK4 or adaptive Dormand-Prince)
+template <bool Adaptive, typename State, typename AeroModel>
+inline void integrateCoupled(State &state, const AeroModel &aero, const Vec2 &wind, ForceBreakdown &forces)
+{
+    BasicFlightDerivative<AeroModel> derivative(state.aircraft, aero, state.throttle, state.elevator, wind);
+    FlightState y = {state.position, state.velocity, state.pitch_deg, state.pitch_rate};
+
+    if constexpr (Adaptive)
+    {
+        AdaptiveOptions opts;
+        opts.rel_tol = state.integration_tolerance;
+        opts.abs_tol = state.integration_tolerance;
+        opts.max_dt = state.dt;
+        AdaptiveStats stats = integrateAdaptive(y, state.t, state.dt, state.adaptive_dt, opts, derivative);
+        state.integrator_evaluations = stats.evaluations;
+    }
+    else
+    {
+        y = integrateRK4(y, state.t, state.dt, derivative);
+        state.integrator_evaluations = 4;
+    }
+
+    // Normalize pitch angle to [-180, 180] degrees to allow loops
+    y.pitch_deg = std::remainder(y.pitch_deg, 360.0);
+
+    state.position = y.position;
+    state.velocity = y.velocity;
+    state.pitch_deg = static_cast<float>(y.pitch_deg);
+    state.pitch_rate = static_cast<float>(y.pitch_rate);
+
+    // Forces and AoA at the end of the step for display
+    derivative.evaluate(y, forces);
+    state.integrator_evaluations++;
+}
+
+// Keep the aircraft on the ground plane
+template <typename State>
+inline void applyGroundConstraint(State &state)
+{
+    if (state.position.y < 0.0)
+    {
+        state.position.y = 0.0;
+        if (state.velocity.y < 0.0)
+            state.velocity.y = 0.0;
+        if (state.velocity.magnitude() < 0.1 && state.throttle < 0.01)
+            state.velocity = Vec2(0.0, 0.0);
+    }
+}
+
 // Update simulation physics for one timestep
 inline void updatePhysics(SimulationState &state)
 {
     if (state.paused)
         return;
+    PROFILE_ZONE(ProfileZone::Physics);
 
     double altitude = state.position.y;
-    double speed = state.velocity.magnitude();
+
+    // Airspeed: the autopilot, pitch authority and forces all see the air-relative velocity
+    state.wind_velocity = stepWind(state);
+    Vec2 air_velocity = state.velocity - state.wind_velocity;
+    double speed = air_velocity.magnitude();
+
+    // Atmospheric properties (one table lookup per step)
+    AtmosphereState atm = getAtmosphere(std::max(0.0, altitude));
 
     // Autopilot: Speed control with PID
     if (state.autopilot_speed)
     {
         if (state.pid_kp != state.prev_pid_kp || state.pid_ki != state.prev_pid_ki || state.pid_kd != state.prev_pid_kd)
         {
-            state.speed_pid = PIDController(state.pid_kp, state.pid_ki, state.pid_kd, 0.0, 1.0);
+            // Retune in place: integrator state carries over (bumpless)
+            state.speed_pid.setGains(state.pid_kp, state.pid_ki, state.pid_kd);
             state.prev_pid_kp = state.pid_kp;
             state.prev_pid_ki = state.pid_ki;
             state.prev_pid_kd = state.pid_kd;
@@ -38,104 +305,43 @@ inline void updatePhysics(SimulationState &state)
     {
         if (state.alt_pid_kp != state.prev_alt_pid_kp || state.alt_pid_ki != state.prev_alt_pid_ki || state.alt_pid_kd != state.prev_alt_pid_kd)
         {
-            state.altitude_pid = PIDController(state.alt_pid_kp, state.alt_pid_ki, state.alt_pid_kd, -1.0, 1.0);
+            state.altitude_pid.setGains(state.alt_pid_kp, state.alt_pid_ki, state.alt_pid_kd);
             state.prev_alt_pid_kp = state.alt_pid_kp;
             state.prev_alt_pid_ki = state.alt_pid_ki;
             state.prev_alt_pid_kd = state.alt_pid_kd;
         }
         // PID outputs elevator deflection based on altitude error
-        double altitude_error = state.altitude_setpoint - altitude;
         state.elevator = static_cast<float>(state.altitude_pid.update(state.altitude_setpoint, altitude, state.dt));
     }
 
-    // Flight control: Elevator controls pitch rate
-    // Simplified model: pitch_rate proportional to elevator and dynamic pressure
-    double q_dynamic = 0.5 * getDensity(std::max(0.0, altitude)) * speed * speed;
-    double pitch_authority = 50.0; // deg/s per elevator unit at unit dynamic pressure
-    double target_pitch_rate = state.elevator * pitch_authority * std::min(1.0, q_dynamic / 500.0);
-
-    // Simple pitch damping and response
-    double pitch_damping = 5.0; // Natural damping
-    double pitch_acceleration = (target_pitch_rate - state.pitch_rate) * pitch_damping;
-    state.pitch_rate += static_cast<float>(pitch_acceleration * state.dt);
-    state.pitch_deg += state.pitch_rate * static_cast<float>(state.dt);
-
-    // Normalize pitch angle to [-180, 180] degrees to allow loops
-    while (state.pitch_deg > 180.0f)
-        state.pitch_deg -= 360.0f;
-    while (state.pitch_deg < -180.0f)
-        state.pitch_deg += 360.0f;
-
-    // Calculate angle of attack from pitch and velocity direction
-    Vec2 velocityDir = (speed > 1e-6) ? state.velocity.normalized() : Vec2(1.0, 0.0);
-    double velocity_angle = std::atan2(state.velocity.y, state.velocity.x); // Flight path angle
-    double pitch_rad = state.pitch_deg * M_PI / 180.0;
-    double alpha = pitch_rad - velocity_angle; // AoA = pitch - flight path angle
-    state.alpha_deg = static_cast<float>(alpha * 180.0 / M_PI);
-
-    // Get atmospheric properties
-    double rho = getDensity(std::max(0.0, altitude));
-
-    // Calculate aerodynamic coefficients
-    double CL, CD;
-    if (state.aircraft.hasAeroTable())
+    // Flight dynamics: pitch, forces, position and velocity
+    ForceBreakdown forces;
+    AircraftAeroModel aero(state.aircraft);
     {
-        // Use table-based data
-        CL = calcCL(alpha, state.aircraft.aeroTable.get());
-        CD = calcCD(alpha, state.aircraft.CD0, state.aircraft.aeroTable.get());
-    }
-    else
-    {
-        // Use legacy linear/parabolic model
-        CL = calcCL(alpha, state.aircraft.CL_alpha);
-        CD = calcCD(CL, state.aircraft.CD0, state.aircraft.k);
+        PROFILE_ZONE(ProfileZone::Integrator);
+        if (state.integration_method == IntegrationMethod::Legacy)
+            integrateLegacy(state, aero, atm, air_velocity, speed, forces);
+        else if (state.integration_method == IntegrationMethod::RK4)
+            integrateCoupled<false>(state, aero, state.wind_velocity, forces);
+        else
+            integrateCoupled<true>(state, aero, state.wind_velocity, forces);
     }
 
-    // Calculate force magnitudes
-    double L_mag = calcLift(rho, speed, state.aircraft.S, CL);
-    double D_mag = calcDrag(rho, speed, state.aircraft.S, CD);
-    double W_mag = calcWeight(state.aircraft.mass, g);
-    double T_mag = calcThrust(state.throttle, state.aircraft.maxThrust);
-
-    // Force vectors (thrust aligned with pitch, lift/drag with velocity)
-    Vec2 thrust_dir(std::cos(pitch_rad), std::sin(pitch_rad));
-    Vec2 F_thrust = thrust_dir * T_mag;
-    Vec2 F_drag = (speed > 1e-6) ? velocityDir * (-D_mag) : Vec2(0.0, 0.0);
-    Vec2 F_lift = velocityDir.rotated(M_PI / 2.0) * L_mag;
-    Vec2 F_weight(0.0, -W_mag);
-
-    // Net force and acceleration
-    Vec2 F_net = F_thrust + F_drag + F_lift + F_weight;
-    Vec2 acceleration = F_net / state.aircraft.mass;
+    state.alpha_deg = static_cast<float>(forces.alpha * 180.0 / M_PI);
 
     // Store force vectors for visualization
-    state.F_thrust_viz = F_thrust;
-    state.F_drag_viz = F_drag;
-    state.F_lift_viz = F_lift;
-    state.F_weight_viz = F_weight;
-
-    // Integrate using RK4
-    integrateRK4(state.position, state.velocity, acceleration, state.dt);
+    state.F_thrust_viz = forces.thrust;
+    state.F_drag_viz = forces.drag;
+    state.F_lift_viz = forces.lift;
+    state.F_weight_viz = forces.weight;
 
     // Ground constraint
-    if (state.position.y < 0.0)
-    {
-        state.position.y = 0.0;
-        if (state.velocity.y < 0.0)
-            state.velocity.y = 0.0;
-        if (state.velocity.magnitude() < 0.1 && state.throttle < 0.01)
-            state.velocity = Vec2(0.0, 0.0);
-    }
+    applyGroundConstraint(state);
 
     // Update flight path
-    if (state.flightPath.size() < static_cast<size_t>(state.maxPathPoints))
-    {
-        state.flightPath.push_back({static_cast<float>(state.position.x), static_cast<float>(state.position.y)});
-    }
-    else
+    if (state.record_flight_path)
     {
-        state.flightPath.erase(state.flightPath.begin());
-        state.flightPath.push_back({static_cast<float>(state.position.x), static_cast<float>(state.position.y)});
+        state.recordFlightPoint(static_cast<float>(state.position.x), static_cast<float>(state.position.y));
     }
 
     state.t += state.dt;
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include "simulation_batch.hpp"
+#include "../core/arena.hpp"
+#include <memory_resource>
+#include <cstddef>
+
+// Per-thread storage for many short runs (sweeps, gain tuning, Monte Carlo)
+//
+// A run started from a fresh SimulationState copy pays for the copy's heap
+// blocks (flight path history, aero data file name), an atomic increment on
+// the shared aero table, and whatever scratch the run allocates. A RunContext
+// keeps one state whose history lives in a MonotonicArena and is assigned
+// from the base at begin(), so it reuses the storage of the previous run, and
+// hands out per-run scratch from the same arena; begin() rewinds the arena to
+// just past the state, releasing the last run's scratch at once. Bases
+// prepared with borrowedRunBase() reference their aero table and wind field
+// without owning them, so the per-run copy does not touch their reference
+// counts either.
+//
+// With a pool, use forThread() from inside the task: every worker gets its
+// own context and nothing is shared between threads.
+class RunContext
+{
+public:
+    explicit RunContext(size_t arena_bytes = 64 * 1024)
+        : arena_(arena_bytes), state_(&arena_), scratch_mark(arena_.mark())
+    {
+    }
+
+    RunContext(const RunContext &) = delete;
+    RunContext &operator=(const RunContext &) = delete;
+
+    // Start a run from base and return its state. Scratch from the previous
+    // run is released; references into it must not outlive that run.
+    SimulationState &begin(const SimulationState &base)
+    {
+        arena_.rewind(scratch_mark);
+        state_ = base; // Keeps the arena-backed history; grows only for a larger base history
+        scratch_mark = arena_.mark();
+        return state_;
+    }
+
+    // Memory for the current run's scratch (pmr containers, allocateArray)
+    MonotonicArena &scratch() { return arena_; }
+
+    // Batch reused by batched sweeps on this thread: its lane arrays keep
+    // their capacity, so same-size batches do not allocate
+    SimulationBatch &batch(size_t lanes)
+    {
+        batch_.resize(lanes);
+        return batch_;
+    }
+
+    // Context of the calling thread
+    static RunContext &forThread()
+    {
+        static thread_local RunContext context;
+        return context;
+    }
+
+private:
+    MonotonicArena arena_; // Declared first: the state's history lives in it
+    SimulationState state_;
+    MonotonicArena::Mark scratch_mark; // End of the state's storage
+    SimulationBatch batch_;
+};
+
+// Copy of base for per-run copies: the aero table and wind field are
+// borrowed (base, or whoever owns them, must outlive the runs) and the
+// flight path history is left empty, since runs that use a context do not
+// record one
+inline SimulationState borrowedRunBase(const SimulationState &base)
+{
+    SimulationState shared(base);
+    shared.aircraft = base.aircraft.borrowed();
+    // Aliasing constructor with an empty owner, as Aircraft::borrowed() does
+    if (base.wind)
+        shared.wind = std::shared_ptr<const WindField>(std::shared_ptr<const WindField>(), base.wind.get());
+    shared.flightPath = FlightPathHistory(1, 1);
+    shared.record_flight_path = false;
+    return shared;
+}
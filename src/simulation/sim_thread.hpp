@@ -0,0 +1,464 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include "physics_update.hpp"
+#include "fixed_step.hpp"
+#include "simulation_checkpoint.hpp"
+#include "trim_solver.hpp"
+#include "../telemetry/telemetry_publisher.hpp"
+#include "../core/triple_buffer.hpp"
+#include "../core/spsc_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+
+// Control inputs owned by the UI and pushed to the simulation thread
+struct ControlInputs
+{
+    float throttle;
+    float elevator;
+    bool paused;
+    double dt;
+    float time_warp, step_budget_ms;
+    IntegrationMethod integration_method;
+
+    bool autopilot_speed;
+    float speed_setpoint;
+    float pid_kp, pid_ki, pid_kd;
+
+    bool autopilot_altitude;
+    float altitude_setpoint;
+    float alt_pid_kp, alt_pid_ki, alt_pid_kd;
+
+    static ControlInputs capture(const SimulationState &s)
+    {
+        return {s.throttle, s.elevator, s.paused, s.dt, s.time_warp, s.step_budget_ms, s.integration_method,
+                s.autopilot_speed, s.speed_setpoint, s.pid_kp, s.pid_ki, s.pid_kd,
+                s.autopilot_altitude, s.altitude_setpoint, s.alt_pid_kp, s.alt_pid_ki, s.alt_pid_kd};
+    }
+
+    void applyTo(SimulationState &s) const
+    {
+        // Engaging an autopilot starts its controller from a clean state (same as the UI checkbox)
+        if (autopilot_speed && !s.autopilot_speed)
+            s.speed_pid.reset();
+        if (autopilot_altitude && !s.autopilot_altitude)
+            s.altitude_pid.reset();
+
+        s.throttle = throttle;
+        s.elevator = elevator;
+        s.paused = paused;
+        s.dt = dt;
+        s.time_warp = time_warp;
+        s.step_budget_ms = step_budget_ms;
+        s.integration_method = integration_method;
+        s.autopilot_speed = autopilot_speed;
+        s.speed_setpoint = speed_setpoint;
+        s.pid_kp = pid_kp;
+        s.pid_ki = pid_ki;
+        s.pid_kd = pid_kd;
+        s.autopilot_altitude = autopilot_altitude;
+        s.altitude_setpoint = altitude_setpoint;
+        s.alt_pid_kp = alt_pid_kp;
+        s.alt_pid_ki = alt_pid_ki;
+        s.alt_pid_kd = alt_pid_kd;
+    }
+
+    bool operator==(const ControlInputs &o) const
+    {
+        return throttle == o.throttle && elevator == o.elevator && paused == o.paused && dt == o.dt &&
+               time_warp == o.time_warp && step_budget_ms == o.step_budget_ms &&
+               integration_method == o.integration_method &&
+               autopilot_speed == o.autopilot_speed && speed_setpoint == o.speed_setpoint &&
+               pid_kp == o.pid_kp && pid_ki == o.pid_ki && pid_kd == o.pid_kd &&
+               autopilot_altitude == o.autopilot_altitude && altitude_setpoint == o.altitude_setpoint &&
+               alt_pid_kp == o.alt_pid_kp && alt_pid_ki == o.alt_pid_ki && alt_pid_kd == o.alt_pid_kd;
+    }
+    bool operator!=(const ControlInputs &o) const { return !(*this == o); }
+};
+
+// Message from the UI thread to the simulation thread
+struct SimCommand
+{
+    enum class Type
+    {
+        SetControls,
+        Reset,
+        LoadAircraft,
+        Rewind,      // Return to simulated time 'time' and continue with the current controls
+        ResetTrimmed, // Reset, then start in the trimmed flight 'trim' / 'trim_result'
+        SetTelemetry  // Publish every step to 'telemetry' (null = stop publishing)
+    };
+
+    Type type = Type::SetControls;
+    ControlInputs controls = {};
+    std::shared_ptr<const Aircraft> aircraft; // LoadAircraft only (allocated on the UI thread)
+    double time = 0.0;                        // Rewind only
+    TrimCondition trim = {0.0, 0.0};          // ResetTrimmed only (solved on the UI thread)
+    TrimResult trim_result = {};
+    std::shared_ptr<TelemetryPublisher> telemetry = nullptr; // SetTelemetry only (opened on the UI thread)
+};
+
+// Immutable view of the simulation published after each batch of steps
+struct SimulationSnapshot
+{
+    // Number of recent flight path points carried by every snapshot. The UI may
+    // skip snapshots, so each one repeats the tail of the path rather than only
+    // the points since the previous one.
+    static constexpr int PATH_SEGMENT = 256;
+
+    uint64_t step_count = 0;  // Physics steps since start
+    uint32_t generation = 0;  // Incremented on every reset
+    double publish_time = 0;  // steady_clock seconds at publish
+    int substeps = 0;         // Steps run in the last loop iteration
+    double dropped_time = 0;  // Wall time discarded by the substep guard [s]
+    double rewind_oldest = 0; // Earliest simulated time a Rewind can reach [s]
+    double time_warp = 1.0;     // Requested simulated seconds per wall second
+    double achieved_warp = 1.0; // Measured over the last quarter second (while running)
+    bool warp_limited = false;  // Last wake-up ran out of its step budget
+
+    // Kinematics for render interpolation
+    PhysicsFrame prev = {};
+    PhysicsFrame curr = {};
+    double alpha = 0.0; // Leftover step fraction at publish time
+
+    double t = 0.0;
+    double dt = 0.016;
+    Vec2 position, velocity;
+    float throttle = 0.0f, elevator = 0.0f;
+    float pitch_deg = 0.0f, pitch_rate = 0.0f, alpha_deg = 0.0f;
+
+    Vec2 F_thrust_viz, F_drag_viz, F_lift_viz, F_weight_viz;
+
+    // Controller copies (for the P/I/D term readouts)
+    PIDController speed_pid = PIDController(0.0, 0.0, 0.0);
+    PIDController altitude_pid = PIDController(0.0, 0.0, 0.0);
+
+    // Tail of the flight path: path[0..path_count) ends at point index path_total - 1
+    FlightPoint path[PATH_SEGMENT] = {};
+    int path_count = 0;
+    uint64_t path_total = 0; // Points recorded since the last reset
+
+    // Copy simulation outputs into the UI-side view of the state. Control fields
+    // the UI owns are left alone, except throttle/elevator while an autopilot drives them.
+    // path_seen tracks how many path points the view already holds.
+    void applyTo(SimulationState &view, uint64_t &path_seen) const
+    {
+        view.t = t;
+        view.position = position;
+        view.velocity = velocity;
+        view.pitch_deg = pitch_deg;
+        view.pitch_rate = pitch_rate;
+        view.alpha_deg = alpha_deg;
+        view.F_thrust_viz = F_thrust_viz;
+        view.F_drag_viz = F_drag_viz;
+        view.F_lift_viz = F_lift_viz;
+        view.F_weight_viz = F_weight_viz;
+        view.speed_pid = speed_pid;
+        view.altitude_pid = altitude_pid;
+        if (view.autopilot_speed)
+            view.throttle = throttle;
+        if (view.autopilot_altitude)
+            view.elevator = elevator;
+
+        uint64_t first = path_total - static_cast<uint64_t>(path_count);
+        for (int i = 0; i < path_count; i++)
+        {
+            if (first + i >= path_seen)
+                view.recordFlightPoint(path[i].x, path[i].z);
+        }
+        path_seen = path_total;
+    }
+
+    // Aircraft pose for drawing at wall-clock time 'now' (steady_clock seconds)
+    PhysicsFrame frameAt(double now) const
+    {
+        double a = alpha + (dt > 0.0 ? (now - publish_time) * time_warp / dt : 0.0);
+        return PhysicsFrame::interpolate(prev, curr, std::clamp(a, 0.0, 1.0));
+    }
+};
+
+// Runs updatePhysics on a dedicated thread
+//
+// The UI never blocks on the simulation: it reads the newest snapshot from a
+// triple buffer and posts control changes into a lock-free SPSC queue. The
+// simulation never waits on a frame: it drains the queue between steps, paces
+// itself with a fixed-step accumulator against the steady clock and publishes
+// after each batch of steps.
+//
+// Under time warp the accumulator is fed warp x the wall time. Each wake-up
+// steps for at most step_budget_ms; steps left when the budget runs out are
+// dropped, so a warp the CPU cannot sustain runs as fast as it can instead of
+// building a backlog, and commands and publishes stay responsive. Path points
+// are recorded every round(warp) steps, which keeps their rate per wall second
+// (and the snapshot path segment) the same at any warp.
+class SimulationThread
+{
+public:
+    explicit SimulationThread(const SimulationState &initial)
+        : state(initial), running(false), path_total(0), path_head(0), path_phase(0), generation(0),
+          achieved_warp(1.0), warp_limited(false),
+          controls(ControlInputs::capture(initial))
+    {
+        state.record_flight_path = false; // Path points are handed to the UI via snapshots
+        keyframes.record(state);
+        publish(0, 0.0, PhysicsFrame::capture(state), PhysicsFrame::capture(state), 0.0);
+        snapshots.update();
+    }
+
+    ~SimulationThread() { stop(); }
+
+    SimulationThread(const SimulationThread &) = delete;
+    SimulationThread &operator=(const SimulationThread &) = delete;
+
+    void start()
+    {
+        if (running.exchange(true))
+            return;
+        worker = std::thread(&SimulationThread::run, this);
+    }
+
+    void stop()
+    {
+        if (!running.exchange(false))
+            return;
+        if (worker.joinable())
+            worker.join();
+    }
+
+    // UI thread: queue a command; returns false if the queue is full (retry next frame)
+    bool post(SimCommand command) { return commands.tryPush(std::move(command)); }
+
+    // UI thread: newest published snapshot (never blocks)
+    const SimulationSnapshot &latest()
+    {
+        snapshots.update();
+        return snapshots.readBuffer();
+    }
+
+    static double now()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    static constexpr int PATH_RING = SimulationSnapshot::PATH_SEGMENT;
+
+    SimulationState state; // Owned by the worker once started
+    TripleBuffer<SimulationSnapshot> snapshots;
+    SpscQueue<SimCommand, 64> commands;
+    std::atomic<bool> running;
+    std::thread worker;
+
+    // Recent path points (worker-owned ring)
+    FlightPoint path_ring[PATH_RING];
+    uint64_t path_total;
+    int path_head;
+    int path_phase; // Steps since the last recorded path point
+    uint32_t generation;
+
+    // Time warp as measured by the worker
+    double achieved_warp;
+    bool warp_limited;
+
+    // Rewind history (worker-owned) and the controls last sent by the UI
+    KeyframeRing keyframes;
+    ControlInputs controls;
+
+    // Telemetry output (worker-held; the UI keeps its own reference for the counters)
+    std::shared_ptr<TelemetryPublisher> telemetry;
+
+    void run()
+    {
+        Profiler::instance().setThreadName("simulation");
+        FixedStepAccumulator clock(state.dt, 8);
+        PhysicsFrame prev = PhysicsFrame::capture(state);
+        PhysicsFrame curr = prev;
+        uint64_t steps_total = 0;
+        double warp_wall = 0.0, warp_sim = 0.0; // Current measurement window
+        double last = now();
+
+        while (running.load(std::memory_order_relaxed))
+        {
+            // Apply UI commands at the step boundary
+            SimCommand cmd;
+            while (commands.tryPop(cmd))
+            {
+                if (applyCommand(cmd))
+                {
+                    clock.reset();
+                    prev = curr = PhysicsFrame::capture(state);
+                }
+            }
+
+            double t_now = now();
+            double elapsed = t_now - last;
+            last = t_now;
+
+            // Allow roughly 50 ms of catch-up per wake-up (coarse OS sleep granularity)
+            const double warp =
+                std::clamp(state.time_warp, SimulationState::MIN_TIME_WARP, SimulationState::MAX_TIME_WARP);
+            clock.step = state.dt;
+            clock.max_substeps = std::max(8, static_cast<int>(0.05 * warp / state.dt));
+
+            int substeps = 0;
+            if (state.paused)
+                clock.reset();
+            else
+                substeps = clock.advance(elapsed * warp);
+
+            // The clock is read every 64 steps, so real-time runs never check it
+            const double deadline = t_now + state.step_budget_ms * 1e-3;
+            const int stride = static_cast<int>(warp + 0.5f);
+            int ran = 0;
+            for (; ran < substeps; ran++)
+            {
+                if ((ran & 63) == 63 && now() > deadline)
+                    break;
+                prev = curr;
+                updatePhysics(state);
+                curr = PhysicsFrame::capture(state);
+                if (telemetry)
+                    telemetry->publish(state);
+                if (++path_phase >= stride)
+                {
+                    path_phase = 0;
+                    recordPathPoint();
+                }
+                keyframes.record(state);
+            }
+            steps_total += static_cast<uint64_t>(ran);
+            warp_limited = ran < substeps;
+
+            // Achieved warp = simulated time advanced per wall second while running
+            if (state.paused)
+            {
+                warp_wall = warp_sim = 0.0;
+            }
+            else
+            {
+                warp_wall += elapsed;
+                warp_sim += ran * state.dt;
+                if (warp_wall >= 0.25)
+                {
+                    achieved_warp = warp_sim / warp_wall;
+                    warp_wall = warp_sim = 0.0;
+                }
+            }
+
+            publish(steps_total, clock.droppedTime(), prev, curr, clock.alpha(), ran);
+
+            // Sleep until the next step is due; a budget-limited warp still
+            // yields briefly so it cannot starve the render thread
+            double wait = state.paused ? 0.005 : (1.0 - clock.alpha()) * state.dt / warp;
+            if (warp_limited)
+                wait = 0.001;
+            std::this_thread::sleep_for(std::chrono::duration<double>(std::min(wait, 0.005)));
+        }
+    }
+
+    // Returns true if the command discontinuously changed the state
+    bool applyCommand(const SimCommand &cmd)
+    {
+        switch (cmd.type)
+        {
+        case SimCommand::Type::SetControls:
+            controls = cmd.controls;
+            controls.applyTo(state);
+            return false;
+        case SimCommand::Type::LoadAircraft:
+            if (cmd.aircraft)
+                state.aircraft = *cmd.aircraft;
+            // Older keyframes hold the previous aircraft
+            keyframes.clear();
+            keyframes.record(state);
+            return false;
+        case SimCommand::Type::Rewind:
+            if (!rewindTo(state, keyframes, cmd.time))
+                return false;
+            // The future past this point is discarded; the new branch starts
+            // with what the UI currently shows
+            keyframes.truncateAfter(state.t);
+            controls.applyTo(state);
+            startNewPath();
+            return true;
+        case SimCommand::Type::SetTelemetry:
+            telemetry = cmd.telemetry;
+            if (telemetry)
+                telemetry->publishNow(state);
+            return false;
+        case SimCommand::Type::Reset:
+        case SimCommand::Type::ResetTrimmed:
+            break;
+        }
+        state.reset();
+        if (cmd.type == SimCommand::Type::ResetTrimmed)
+            applyTrim(state, cmd.trim, cmd.trim_result);
+        keyframes.clear();
+        keyframes.record(state);
+        startNewPath();
+        return true;
+    }
+
+    // The UI clears its path history when the generation changes
+    void startNewPath()
+    {
+        generation++;
+        path_total = 0;
+        path_head = 0;
+        path_phase = 0;
+    }
+
+    void recordPathPoint()
+    {
+        path_ring[path_head] = {static_cast<float>(state.position.x), static_cast<float>(state.position.y)};
+        path_head = (path_head + 1) % PATH_RING;
+        path_total++;
+    }
+
+    void publish(uint64_t steps_total, double dropped, const PhysicsFrame &prev, const PhysicsFrame &curr,
+                 double alpha, int substeps = 0)
+    {
+        SimulationSnapshot &s = snapshots.writeBuffer();
+        s.step_count = steps_total;
+        s.generation = generation;
+        s.publish_time = now();
+        s.substeps = substeps;
+        s.dropped_time = dropped;
+        s.rewind_oldest = keyframes.oldestTime();
+        s.time_warp = std::clamp(state.time_warp, SimulationState::MIN_TIME_WARP, SimulationState::MAX_TIME_WARP);
+        s.achieved_warp = achieved_warp;
+        s.warp_limited = warp_limited;
+        s.prev = prev;
+        s.curr = curr;
+        s.alpha = alpha;
+        s.t = state.t;
+        s.dt = state.dt;
+        s.position = state.position;
+        s.velocity = state.velocity;
+        s.throttle = state.throttle;
+        s.elevator = state.elevator;
+        s.pitch_deg = state.pitch_deg;
+        s.pitch_rate = state.pitch_rate;
+        s.alpha_deg = state.alpha_deg;
+        s.F_thrust_viz = state.F_thrust_viz;
+        s.F_drag_viz = state.F_drag_viz;
+        s.F_lift_viz = state.F_lift_viz;
+        s.F_weight_viz = state.F_weight_viz;
+        s.speed_pid = state.speed_pid;
+        s.altitude_pid = state.altitude_pid;
+
+        // Copy the ring tail oldest-first
+        int count = static_cast<int>(std::min<uint64_t>(path_total, PATH_RING));
+        int start = (path_head - count + PATH_RING) % PATH_RING;
+        for (int i = 0; i < count; i++)
+            s.path[i] = path_ring[(start + i) % PATH_RING];
+        s.path_count = count;
+        s.path_total = path_total;
+
+        snapshots.publish();
+    }
+};
@@ -0,0 +1,364 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include "../environment/atmosphere.hpp"
+#include "../environment/wind.hpp"
+#include "../aerodynamics/aero.hpp"
+#include "../core/fast_math.hpp"
+#include "../core/batch_kernel.hpp"
+#include "../control/pid_bank.hpp"
+#include "../core/profiler.hpp"
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// N independent aircraft advanced in lockstep (Monte Carlo, sweeps)
+//
+// Every per-aircraft quantity lives in its own contiguous array (structure of
+// arrays) and step() runs the same force model as updatePhysics as a sequence
+// of phases over all lanes. Most of the phases are plain element-wise loops
+// without calls or branches (trig comes from fast_math.hpp instead of libm),
+// so the compiler can vectorize them. Only the atmosphere, wind and aero
+// table lookups run lane by lane. Every lane has its own wind field and
+// turbulence phase, so Monte Carlo lanes can fly different seeds (see
+// turbulenceSeed()) and each one matches a scalar run with that seed.
+//
+// A lane loaded with setLane() follows the same trajectory as updatePhysics
+// on that state (up to floating-point rounding). Autopilot controllers start
+// from a reset state. Flight path and force vectors are not recorded.
+class SimulationBatch
+{
+public:
+    // Kinematics
+    std::vector<double> x, y, vx, vy;
+    std::vector<float> pitch_deg, pitch_rate, alpha_deg;
+
+    // Controls
+    std::vector<float> throttle, elevator;
+
+    // Aircraft parameters (per lane, so each lane can be a different variant)
+    std::vector<double> mass, S, CL_alpha, CD0, k, max_thrust, chord;
+    std::vector<std::shared_ptr<const AeroDataTable>> aero_table; // Null = legacy model
+
+    // Wind (per lane, null = still air), turbulence phase and the wind over the last step
+    std::vector<std::shared_ptr<const WindField>> wind;
+    std::vector<double> phase_u, phase_w, wind_x, wind_y;
+
+    // Autopilots (flag per lane, 1 = engaged)
+    std::vector<uint8_t> autopilot_speed, autopilot_altitude;
+    std::vector<float> speed_setpoint, altitude_setpoint;
+    PIDBank speed_pid, altitude_pid; // Retune lanes in place with setGains()
+
+    double t;
+    double dt;
+
+    explicit SimulationBatch(size_t lanes = 0) : t(0.0), dt(0.016), lanes(0), wind_active(false)
+    {
+        resize(lanes);
+    }
+
+    size_t size() const { return lanes; }
+
+    // Change the lane count; new lanes hold a default SimulationState after reset()
+    void resize(size_t n)
+    {
+        size_t old = lanes;
+        lanes = n;
+        for (auto *v : {&x, &y, &vx, &vy, &mass, &S, &CL_alpha, &CD0, &k, &max_thrust, &chord, &phase_u, &phase_w,
+                        &wind_x, &wind_y, &altitude, &rho, &sound_speed, &viscosity, &speed, &alpha_rad, &cos_pitch,
+                        &sin_pitch, &CL, &CD, &air_vx, &air_vy, &rate_u, &rate_w})
+            v->resize(n);
+        for (auto *v : {&pitch_deg, &pitch_rate, &alpha_deg, &throttle, &elevator, &speed_setpoint, &altitude_setpoint})
+            v->resize(n);
+        autopilot_speed.resize(n);
+        autopilot_altitude.resize(n);
+        aero_table.resize(n);
+        wind.resize(n);
+        wind_fields.resize(n);
+        speed_pid.resize(n);
+        altitude_pid.resize(n);
+
+        SimulationState defaults;
+        defaults.reset();
+        for (size_t i = old; i < n; i++)
+            setLane(i, defaults);
+    }
+
+    // Copy aircraft, kinematics, controls and autopilot settings from a state
+    void setLane(size_t i, const SimulationState &s)
+    {
+        x[i] = s.position.x;
+        y[i] = s.position.y;
+        vx[i] = s.velocity.x;
+        vy[i] = s.velocity.y;
+        pitch_deg[i] = s.pitch_deg;
+        pitch_rate[i] = s.pitch_rate;
+        alpha_deg[i] = s.alpha_deg;
+        throttle[i] = s.throttle;
+        elevator[i] = s.elevator;
+
+        const Aircraft &ac = s.aircraft;
+        mass[i] = ac.mass;
+        S[i] = ac.S;
+        CL_alpha[i] = ac.CL_alpha;
+        CD0[i] = ac.CD0;
+        k[i] = ac.k;
+        max_thrust[i] = ac.maxThrust;
+        chord[i] = ac.chord;
+        aero_table[i] = ac.aeroTable;
+
+        wind[i] = s.wind;
+        phase_u[i] = s.turbulence_phase.u;
+        phase_w[i] = s.turbulence_phase.w;
+        wind_x[i] = s.wind ? s.wind_velocity.x : 0.0;
+        wind_y[i] = s.wind ? s.wind_velocity.y : 0.0;
+        rate_u[i] = 0.0;
+        rate_w[i] = 0.0;
+
+        autopilot_speed[i] = s.autopilot_speed ? 1 : 0;
+        autopilot_altitude[i] = s.autopilot_altitude ? 1 : 0;
+        speed_setpoint[i] = s.speed_setpoint;
+        altitude_setpoint[i] = s.altitude_setpoint;
+        speed_pid.configure(i, s.pid_kp, s.pid_ki, s.pid_kd, 0.0, 1.0);
+        altitude_pid.configure(i, s.alt_pid_kp, s.alt_pid_ki, s.alt_pid_kd, -1.0, 1.0);
+    }
+
+    // Write kinematics and controls of a lane back into a state
+    void getLane(size_t i, SimulationState &s) const
+    {
+        s.position = Vec2(x[i], y[i]);
+        s.velocity = Vec2(vx[i], vy[i]);
+        s.pitch_deg = pitch_deg[i];
+        s.pitch_rate = pitch_rate[i];
+        s.alpha_deg = alpha_deg[i];
+        s.throttle = throttle[i];
+        s.elevator = elevator[i];
+        s.turbulence_phase.u = phase_u[i];
+        s.turbulence_phase.w = phase_w[i];
+        s.wind_velocity = Vec2(wind_x[i], wind_y[i]);
+        s.t = t;
+        s.dt = dt;
+    }
+
+    // Advance every lane by one timestep
+    void step()
+    {
+        PROFILE_ZONE(ProfileZone::Physics);
+        const size_t n = lanes;
+        const double h = dt;
+
+        // Phase 1: wind, airspeed, turbulence phase and clamped altitude. The
+        // lookup is skipped while every lane is in still air (its wind and
+        // phase rates are zero then); still-air lanes of a windy batch get zeros.
+        bool any_wind = false;
+        for (size_t i = 0; i < n; i++)
+        {
+            wind_fields[i] = wind[i].get();
+            any_wind = any_wind || wind_fields[i];
+        }
+        if (any_wind || wind_active)
+        {
+            WindField::sample(wind_fields.data(), n, y.data(), t, phase_u.data(), phase_w.data(), wind_x.data(),
+                              wind_y.data(), rate_u.data(), rate_w.data());
+        }
+        wind_active = any_wind;
+        airspeedKernel(n, h, vx.data(), vy.data(), y.data(), wind_x.data(), wind_y.data(), rate_u.data(),
+                       rate_w.data(), air_vx.data(), air_vy.data(), speed.data(), altitude.data(), phase_u.data(),
+                       phase_w.data());
+
+        // Phase 2: autopilots
+        speed_pid.update(speed_setpoint.data(), speed.data(), h, autopilot_speed.data(), throttle.data());
+        altitude_pid.update(altitude_setpoint.data(), y.data(), h, autopilot_altitude.data(), elevator.data());
+
+        // Phase 3: atmosphere
+        getAtmosphere(altitude.data(), n, rho.data(), sound_speed.data(), viscosity.data());
+
+        // Phase 4-5: pitch dynamics, angle of attack, thrust direction
+        pitchKernel(n, h, rho.data(), speed.data(), elevator.data(), air_vx.data(), air_vy.data(), pitch_rate.data(),
+                    pitch_deg.data(), alpha_deg.data(), alpha_rad.data(), cos_pitch.data(), sin_pitch.data());
+
+        // Phase 6: aerodynamic coefficients (legacy model for every lane,
+        // then table lanes are overwritten from their lookup)
+        for (size_t i = 0; i < n; i++)
+        {
+            CL[i] = calcCL(alpha_rad[i], CL_alpha[i]);
+            CD[i] = calcCD(CL[i], CD0[i], k[i]);
+        }
+        {
+            PROFILE_ZONE(ProfileZone::AeroLookup);
+            for (size_t i = 0; i < n; i++)
+            {
+                const AeroDataTable *table = aero_table[i].get();
+                if (!table)
+                    continue;
+                AeroQuery query;
+                query.alpha = alpha_rad[i];
+                query.mach = speed[i] / sound_speed[i];
+                query.elevator = elevator[i];
+                if (chord[i] > 0.0 && table->hasAxis(AeroAxis::Reynolds))
+                    query.reynolds = rho[i] * speed[i] * chord[i] / viscosity[i];
+                AeroCoefficients c = calcCLCD(query, CD0[i], table);
+                CL[i] = c.CL;
+                CD[i] = c.CD;
+            }
+        }
+
+        // Phase 7: forces, integration and ground constraint
+        {
+            PROFILE_ZONE(ProfileZone::Integrator);
+            forceKernel(n, h, rho.data(), speed.data(), CL.data(), CD.data(), S.data(), mass.data(),
+                        max_thrust.data(), throttle.data(), cos_pitch.data(), sin_pitch.data(), air_vx.data(),
+                        air_vy.data(), x.data(), y.data(), vx.data(), vy.data());
+        }
+
+        t += h;
+    }
+
+    // Advance every lane by a number of steps
+    void run(long long steps)
+    {
+        for (long long s = 0; s < steps; s++)
+            step();
+    }
+
+private:
+    // Velocity relative to the air and its magnitude, then the turbulence
+    // phase moved by the distance flown through the air (same arithmetic as
+    // stepWind; a step never moves more than one tile length)
+    BATCH_KERNEL static void airspeedKernel(size_t n, double h, const double *__restrict vx,
+                            const double *__restrict vy, const double *__restrict y,
+                            const double *__restrict wind_x, const double *__restrict wind_y,
+                            const double *__restrict rate_u, const double *__restrict rate_w,
+                            double *__restrict air_vx, double *__restrict air_vy, double *__restrict speed,
+                            double *__restrict altitude, double *__restrict phase_u, double *__restrict phase_w)
+    {
+        const double tile = static_cast<double>(TurbulenceTiles::SIZE);
+        for (size_t i = 0; i < n; i++)
+        {
+            double ax = vx[i] - wind_x[i];
+            double ay = vy[i] - wind_y[i];
+            double V = std::sqrt(ax * ax + ay * ay);
+            air_vx[i] = ax;
+            air_vy[i] = ay;
+            speed[i] = V;
+            altitude[i] = std::max(0.0, y[i]);
+
+            double distance = V * h;
+            double pu = phase_u[i] + distance * rate_u[i];
+            double pw = phase_w[i] + distance * rate_w[i];
+            phase_u[i] = pu >= tile ? pu - tile : pu;
+            phase_w[i] = pw >= tile ? pw - tile : pw;
+        }
+    }
+
+    // Pitch response to the elevator, then angle of attack and thrust direction
+    // (vx, vy: velocity relative to the air)
+    BATCH_KERNEL static void pitchKernel(size_t n, double h, const double *__restrict rho, const double *__restrict speed,
+                            const float *__restrict elevator, const double *__restrict vx,
+                            const double *__restrict vy, float *__restrict pitch_rate, float *__restrict pitch_deg,
+                            float *__restrict alpha_deg, double *__restrict alpha_rad,
+                            double *__restrict cos_pitch, double *__restrict sin_pitch)
+    {
+        const float dt_f = static_cast<float>(h);
+        for (size_t i = 0; i < n; i++)
+        {
+            double q_dynamic = 0.5 * rho[i] * speed[i] * speed[i];
+            double target_pitch_rate = elevator[i] * 50.0 * std::min(1.0, q_dynamic / 500.0);
+            double pitch_acceleration = (target_pitch_rate - pitch_rate[i]) * 5.0;
+            float rate = pitch_rate[i] + static_cast<float>(pitch_acceleration * h);
+            float pitch = pitch_deg[i] + rate * dt_f;
+
+            // One wrap is enough: pitch moves far less than 360 deg per step
+            pitch = pitch > 180.0f ? pitch - 360.0f : pitch;
+            pitch = pitch < -180.0f ? pitch + 360.0f : pitch;
+            pitch_rate[i] = rate;
+            pitch_deg[i] = pitch;
+
+            double pitch_rad = pitch * M_PI / 180.0;
+            double alpha = pitch_rad - fastmath::atan2(vy[i], vx[i]);
+            alpha_rad[i] = alpha;
+            alpha_deg[i] = static_cast<float>(alpha * 180.0 / M_PI);
+            double s, c;
+            fastmath::sincos(pitch_rad, s, c);
+            sin_pitch[i] = s;
+            cos_pitch[i] = c;
+        }
+    }
+
+    // Forces (lift and drag along the air-relative velocity air_vx, air_vy),
+    // RK4 with constant acceleration and the ground constraint
+    BATCH_KERNEL static void forceKernel(size_t n, double h, const double *__restrict rho, const double *__restrict speed,
+                            const double *__restrict CL, const double *__restrict CD, const double *__restrict S,
+                            const double *__restrict mass, const double *__restrict max_thrust,
+                            const float *__restrict throttle, const double *__restrict cos_pitch,
+                            const double *__restrict sin_pitch, const double *__restrict air_vx,
+                            const double *__restrict air_vy, double *__restrict x, double *__restrict y,
+                            double *__restrict vx, double *__restrict vy)
+    {
+        // Lift is the velocity direction rotated by +90 deg, with the same rounding as Vec2::rotated
+        const double cos_quarter = std::cos(M_PI / 2.0);
+        const double sin_quarter = std::sin(M_PI / 2.0);
+        for (size_t i = 0; i < n; i++)
+        {
+            double V = speed[i];
+            bool moving = V > 1e-6;
+            double inv_V = 1.0 / (moving ? V : 1.0);
+            double dir_x = moving ? air_vx[i] * inv_V : 1.0;
+            double dir_y = moving ? air_vy[i] * inv_V : 0.0;
+
+            double L_mag = calcLift(rho[i], V, S[i], CL[i]);
+            double D_mag = calcDrag(rho[i], V, S[i], CD[i]);
+            double W_mag = calcWeight(mass[i], g);
+            double T_mag = calcThrust(throttle[i], max_thrust[i]);
+
+            double lift_x = dir_x * cos_quarter - dir_y * sin_quarter;
+            double lift_y = dir_x * sin_quarter + dir_y * cos_quarter;
+
+            double drag_x = moving ? dir_x * -D_mag : 0.0;
+            double drag_y = moving ? dir_y * -D_mag : 0.0;
+            double Fx = cos_pitch[i] * T_mag + drag_x + lift_x * L_mag + 0.0;
+            double Fy = sin_pitch[i] * T_mag + drag_y + lift_y * L_mag + -W_mag;
+            double inv_mass = 1.0 / mass[i];
+            double ax = Fx * inv_mass;
+            double ay = Fy * inv_mass;
+
+            // Same arithmetic as integrateRK4 (acceleration constant over the step)
+            double mid_x = vx[i] + ax * (h * 0.5);
+            double mid_y = vy[i] + ay * (h * 0.5);
+            double end_x = vx[i] + ax * h;
+            double end_y = vy[i] + ay * h;
+            double nx = x[i] + (vx[i] + mid_x * 2.0 + mid_x * 2.0 + end_x) * (h / 6.0);
+            double ny = y[i] + (vy[i] + mid_y * 2.0 + mid_y * 2.0 + end_y) * (h / 6.0);
+            double nvx = vx[i] + (ax + ax * 2.0 + ax * 2.0 + ax) * (h / 6.0);
+            double nvy = vy[i] + (ay + ay * 2.0 + ay * 2.0 + ay) * (h / 6.0);
+
+            // Ground constraint
+            bool below = ny < 0.0;
+            ny = below ? 0.0 : ny;
+            nvy = below && nvy < 0.0 ? 0.0 : nvy;
+            bool stopped = below && nvx * nvx + nvy * nvy < 0.01 && throttle[i] < 0.01;
+            nvx = stopped ? 0.0 : nvx;
+            nvy = stopped ? 0.0 : nvy;
+
+            x[i] = nx;
+            y[i] = ny;
+            vx[i] = nvx;
+            vy[i] = nvy;
+        }
+    }
+
+    size_t lanes;
+    bool wind_active; // Some lane had wind in the last step
+
+    // Per-step scratch arrays
+    std::vector<double> altitude, rho, sound_speed, viscosity, speed, alpha_rad, cos_pitch, sin_pitch, CL, CD;
+    std::vector<double> air_vx, air_vy, rate_u, rate_w;
+    std::vector<const WindField *> wind_fields; // Plain pointers of 'wind' for the batched lookup
+};
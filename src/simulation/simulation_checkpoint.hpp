@@ -0,0 +1,638 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include "physics_update.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+// Everything updatePhysics reads or writes, captured at a step boundary
+//
+// Restoring a checkpoint and stepping on produces bit-for-bit the same
+// trajectory as the original run, because the PID internals (integral,
+// previous error, first-update flag) and the adaptive substep hint are
+// saved along with the flight state. The flight path history is not part of
+// a checkpoint; it is display data and is left as is by restore().
+struct SimulationCheckpoint
+{
+    Aircraft aircraft; // Shares the aero table with the captured state
+    Vec2 position;
+    Vec2 velocity;
+    double t = 0.0;
+    double dt = 0.016;
+
+    float throttle = 0.0f, elevator = 0.0f;
+    float pitch_deg = 0.0f, pitch_rate = 0.0f, alpha_deg = 0.0f;
+    bool paused = false;
+
+    IntegrationMethod integration_method = IntegrationMethod::Legacy;
+    double integration_tolerance = 1e-6;
+    double adaptive_dt = 0.0;
+    int integrator_evaluations = 0;
+
+    bool autopilot_speed = false;
+    float speed_setpoint = 0.0f;
+    float pid_kp = 0.0f, pid_ki = 0.0f, pid_kd = 0.0f;
+    float prev_pid_kp = 0.0f, prev_pid_ki = 0.0f, prev_pid_kd = 0.0f;
+    PIDController speed_pid = PIDController(0.0, 0.0, 0.0);
+
+    bool autopilot_altitude = false;
+    float altitude_setpoint = 0.0f;
+    float alt_pid_kp = 0.0f, alt_pid_ki = 0.0f, alt_pid_kd = 0.0f;
+    float prev_alt_pid_kp = 0.0f, prev_alt_pid_ki = 0.0f, prev_alt_pid_kd = 0.0f;
+    PIDController altitude_pid = PIDController(0.0, 0.0, 0.0);
+
+    Vec2 F_thrust_viz, F_drag_viz, F_lift_viz, F_weight_viz;
+
+    std::shared_ptr<const WindField> wind; // Shared with the captured state (null = still air)
+    TurbulencePhase turbulence_phase;
+    Vec2 wind_velocity;
+
+    // Binary layout: header, then the fields above in declaration order as
+    // host-order (little-endian) values; bools are one byte, the aero data
+    // file is a uint32 length followed by its characters. The wind is stored
+    // as its conditions (a flag, then the WindConditions fields with a uint32
+    // gust count) and rebuilt on load; its tiles come back from the seed.
+    struct BinaryHeader
+    {
+        char magic[8];     // "FDCKPT\0\0"
+        uint32_t version;  // Format version (2; version 1 files predate wind and load as still air)
+        uint32_t size;     // Payload bytes after the header
+    };
+
+    static SimulationCheckpoint capture(const SimulationState &s)
+    {
+        SimulationCheckpoint c;
+        c.aircraft = s.aircraft;
+        c.position = s.position;
+        c.velocity = s.velocity;
+        c.t = s.t;
+        c.dt = s.dt;
+        c.throttle = s.throttle;
+        c.elevator = s.elevator;
+        c.pitch_deg = s.pitch_deg;
+        c.pitch_rate = s.pitch_rate;
+        c.alpha_deg = s.alpha_deg;
+        c.paused = s.paused;
+        c.integration_method = s.integration_method;
+        c.integration_tolerance = s.integration_tolerance;
+        c.adaptive_dt = s.adaptive_dt;
+        c.integrator_evaluations = s.integrator_evaluations;
+        c.autopilot_speed = s.autopilot_speed;
+        c.speed_setpoint = s.speed_setpoint;
+        c.pid_kp = s.pid_kp;
+        c.pid_ki = s.pid_ki;
+        c.pid_kd = s.pid_kd;
+        c.prev_pid_kp = s.prev_pid_kp;
+        c.prev_pid_ki = s.prev_pid_ki;
+        c.prev_pid_kd = s.prev_pid_kd;
+        c.speed_pid = s.speed_pid;
+        c.autopilot_altitude = s.autopilot_altitude;
+        c.altitude_setpoint = s.altitude_setpoint;
+        c.alt_pid_kp = s.alt_pid_kp;
+        c.alt_pid_ki = s.alt_pid_ki;
+        c.alt_pid_kd = s.alt_pid_kd;
+        c.prev_alt_pid_kp = s.prev_alt_pid_kp;
+        c.prev_alt_pid_ki = s.prev_alt_pid_ki;
+        c.prev_alt_pid_kd = s.prev_alt_pid_kd;
+        c.altitude_pid = s.altitude_pid;
+        c.F_thrust_viz = s.F_thrust_viz;
+        c.F_drag_viz = s.F_drag_viz;
+        c.F_lift_viz = s.F_lift_viz;
+        c.F_weight_viz = s.F_weight_viz;
+        c.wind = s.wind;
+        c.turbulence_phase = s.turbulence_phase;
+        c.wind_velocity = s.wind_velocity;
+        return c;
+    }
+
+    // Overwrite the simulated part of a state. A checkpoint read from disk
+    // carries only the aero data file name; the target must already have
+    // that table loaded (e.g. from the same aircraft config).
+    void restore(SimulationState &s) const
+    {
+        std::shared_ptr<const AeroDataTable> table = aircraft.aeroTable;
+        if (!table && !aircraft.aeroDataFile.empty())
+        {
+            if (s.aircraft.aeroDataFile != aircraft.aeroDataFile || !s.aircraft.aeroTable)
+            {
+                throw std::runtime_error("Checkpoint needs aero table '" + aircraft.aeroDataFile +
+                                         "' loaded in the target state");
+            }
+            table = s.aircraft.aeroTable;
+        }
+
+        s.aircraft = aircraft;
+        s.aircraft.aeroTable = table;
+        s.position = position;
+        s.velocity = velocity;
+        s.t = t;
+        s.dt = dt;
+        s.throttle = throttle;
+        s.elevator = elevator;
+        s.pitch_deg = pitch_deg;
+        s.pitch_rate = pitch_rate;
+        s.alpha_deg = alpha_deg;
+        s.paused = paused;
+        s.reset_requested = false;
+        s.integration_method = integration_method;
+        s.integration_tolerance = integration_tolerance;
+        s.adaptive_dt = adaptive_dt;
+        s.integrator_evaluations = integrator_evaluations;
+        s.autopilot_speed = autopilot_speed;
+        s.speed_setpoint = speed_setpoint;
+        s.pid_kp = pid_kp;
+        s.pid_ki = pid_ki;
+        s.pid_kd = pid_kd;
+        s.prev_pid_kp = prev_pid_kp;
+        s.prev_pid_ki = prev_pid_ki;
+        s.prev_pid_kd = prev_pid_kd;
+        s.speed_pid = speed_pid;
+        s.autopilot_altitude = autopilot_altitude;
+        s.altitude_setpoint = altitude_setpoint;
+        s.alt_pid_kp = alt_pid_kp;
+        s.alt_pid_ki = alt_pid_ki;
+        s.alt_pid_kd = alt_pid_kd;
+        s.prev_alt_pid_kp = prev_alt_pid_kp;
+        s.prev_alt_pid_ki = prev_alt_pid_ki;
+        s.prev_alt_pid_kd = prev_alt_pid_kd;
+        s.altitude_pid = altitude_pid;
+        s.F_thrust_viz = F_thrust_viz;
+        s.F_drag_viz = F_drag_viz;
+        s.F_lift_viz = F_lift_viz;
+        s.F_weight_viz = F_weight_viz;
+        s.wind = wind;
+        s.turbulence_phase = turbulence_phase;
+        s.wind_velocity = wind_velocity;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        Writer w;
+        w.reserve(512);
+        BinaryHeader header = {{'F', 'D', 'C', 'K', 'P', 'T', '\0', '\0'}, 2, 0};
+        w.raw(&header, sizeof(header));
+
+        w.value(aircraft.mass);
+        w.value(aircraft.S);
+        w.value(aircraft.CL_alpha);
+        w.value(aircraft.CD0);
+        w.value(aircraft.k);
+        w.value(aircraft.maxThrust);
+        w.value(aircraft.chord);
+        w.string(aircraft.aeroDataFile);
+
+        w.vec(position);
+        w.vec(velocity);
+        w.value(t);
+        w.value(dt);
+        w.value(throttle);
+        w.value(elevator);
+        w.value(pitch_deg);
+        w.value(pitch_rate);
+        w.value(alpha_deg);
+        w.flag(paused);
+
+        w.value(static_cast<int32_t>(integration_method));
+        w.value(integration_tolerance);
+        w.value(adaptive_dt);
+        w.value(static_cast<int32_t>(integrator_evaluations));
+
+        w.flag(autopilot_speed);
+        w.value(speed_setpoint);
+        w.value(pid_kp);
+        w.value(pid_ki);
+        w.value(pid_kd);
+        w.value(prev_pid_kp);
+        w.value(prev_pid_ki);
+        w.value(prev_pid_kd);
+        w.pid(speed_pid);
+
+        w.flag(autopilot_altitude);
+        w.value(altitude_setpoint);
+        w.value(alt_pid_kp);
+        w.value(alt_pid_ki);
+        w.value(alt_pid_kd);
+        w.value(prev_alt_pid_kp);
+        w.value(prev_alt_pid_ki);
+        w.value(prev_alt_pid_kd);
+        w.pid(altitude_pid);
+
+        w.vec(F_thrust_viz);
+        w.vec(F_drag_viz);
+        w.vec(F_lift_viz);
+        w.vec(F_weight_viz);
+
+        w.flag(wind != nullptr);
+        if (wind)
+        {
+            const WindConditions &wc = wind->conditions();
+            w.value(wc.speed);
+            w.value(wc.reference_altitude);
+            w.value(wc.shear_exponent);
+            w.value(static_cast<int32_t>(wc.turbulence));
+            w.value(wc.turbulence_w20);
+            w.value(wc.seed);
+            w.value(static_cast<uint32_t>(wc.gusts.size()));
+            for (const WindGust &g : wc.gusts)
+            {
+                w.value(g.start);
+                w.value(g.duration);
+                w.value(g.u);
+                w.value(g.w);
+            }
+        }
+        w.value(turbulence_phase.u);
+        w.value(turbulence_phase.w);
+        w.vec(wind_velocity);
+
+        uint32_t payload = static_cast<uint32_t>(w.bytes.size() - sizeof(BinaryHeader));
+        std::memcpy(w.bytes.data() + offsetof(BinaryHeader, size), &payload, sizeof(payload));
+        return std::move(w.bytes);
+    }
+
+    static SimulationCheckpoint deserialize(const uint8_t *data, size_t size)
+    {
+        BinaryHeader header;
+        if (size < sizeof(header))
+        {
+            throw std::runtime_error("Checkpoint is truncated");
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, "FDCKPT", 6) != 0)
+        {
+            throw std::runtime_error("Not a simulation checkpoint");
+        }
+        if (header.version != 1 && header.version != 2)
+        {
+            throw std::runtime_error("Unsupported checkpoint version " + std::to_string(header.version));
+        }
+        if (header.size != size - sizeof(header))
+        {
+            throw std::runtime_error("Checkpoint size does not match its header");
+        }
+
+        Reader r{data + sizeof(header), data + size};
+        SimulationCheckpoint c;
+        r.value(c.aircraft.mass);
+        r.value(c.aircraft.S);
+        r.value(c.aircraft.CL_alpha);
+        r.value(c.aircraft.CD0);
+        r.value(c.aircraft.k);
+        r.value(c.aircraft.maxThrust);
+        r.value(c.aircraft.chord);
+        r.string(c.aircraft.aeroDataFile);
+
+        r.vec(c.position);
+        r.vec(c.velocity);
+        r.value(c.t);
+        r.value(c.dt);
+        r.value(c.throttle);
+        r.value(c.elevator);
+        r.value(c.pitch_deg);
+        r.value(c.pitch_rate);
+        r.value(c.alpha_deg);
+        r.flag(c.paused);
+
+        int32_t method = 0, evaluations = 0;
+        r.value(method);
+        if (method < 0 || method > static_cast<int32_t>(IntegrationMethod::DormandPrince45))
+        {
+            throw std::runtime_error("Checkpoint has an invalid integration method");
+        }
+        c.integration_method = static_cast<IntegrationMethod>(method);
+        r.value(c.integration_tolerance);
+        r.value(c.adaptive_dt);
+        r.value(evaluations);
+        c.integrator_evaluations = evaluations;
+
+        r.flag(c.autopilot_speed);
+        r.value(c.speed_setpoint);
+        r.value(c.pid_kp);
+        r.value(c.pid_ki);
+        r.value(c.pid_kd);
+        r.value(c.prev_pid_kp);
+        r.value(c.prev_pid_ki);
+        r.value(c.prev_pid_kd);
+        r.pid(c.speed_pid);
+
+        r.flag(c.autopilot_altitude);
+        r.value(c.altitude_setpoint);
+        r.value(c.alt_pid_kp);
+        r.value(c.alt_pid_ki);
+        r.value(c.alt_pid_kd);
+        r.value(c.prev_alt_pid_kp);
+        r.value(c.prev_alt_pid_ki);
+        r.value(c.prev_alt_pid_kd);
+        r.pid(c.altitude_pid);
+
+        r.vec(c.F_thrust_viz);
+        r.vec(c.F_drag_viz);
+        r.vec(c.F_lift_viz);
+        r.vec(c.F_weight_viz);
+
+        if (header.version >= 2)
+        {
+            bool has_wind = false;
+            r.flag(has_wind);
+            if (has_wind)
+            {
+                WindConditions wc;
+                int32_t model = 0;
+                uint32_t gusts = 0;
+                r.value(wc.speed);
+                r.value(wc.reference_altitude);
+                r.value(wc.shear_exponent);
+                r.value(model);
+                if (model < 0 || model > static_cast<int32_t>(TurbulenceModel::VonKarman))
+                {
+                    throw std::runtime_error("Checkpoint has an invalid turbulence model");
+                }
+                wc.turbulence = static_cast<TurbulenceModel>(model);
+                r.value(wc.turbulence_w20);
+                r.value(wc.seed);
+                r.value(gusts);
+                if (gusts > static_cast<size_t>(r.end - r.p) / (4 * sizeof(double)))
+                {
+                    throw std::runtime_error("Checkpoint is truncated");
+                }
+                wc.gusts.resize(gusts);
+                for (WindGust &g : wc.gusts)
+                {
+                    r.value(g.start);
+                    r.value(g.duration);
+                    r.value(g.u);
+                    r.value(g.w);
+                }
+                c.wind = std::make_shared<const WindField>(wc); // Validates the conditions
+            }
+            r.value(c.turbulence_phase.u);
+            r.value(c.turbulence_phase.w);
+            c.turbulence_phase.u = WindField::wrapPhase(c.turbulence_phase.u);
+            c.turbulence_phase.w = WindField::wrapPhase(c.turbulence_phase.w);
+            r.vec(c.wind_velocity);
+        }
+
+        if (r.p != r.end)
+        {
+            throw std::runtime_error("Checkpoint has trailing data");
+        }
+        return c;
+    }
+
+    static SimulationCheckpoint deserialize(const std::vector<uint8_t> &bytes)
+    {
+        return deserialize(bytes.data(), bytes.size());
+    }
+
+    void save(const std::string &filepath) const
+    {
+        std::vector<uint8_t> bytes = serialize();
+        std::FILE *file = std::fopen(filepath.c_str(), "wb");
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open checkpoint file: " + filepath);
+        }
+        size_t written = std::fwrite(bytes.data(), 1, bytes.size(), file);
+        if (std::fclose(file) != 0 || written != bytes.size())
+        {
+            throw std::runtime_error("Failed to write checkpoint file: " + filepath);
+        }
+    }
+
+    static SimulationCheckpoint load(const std::string &filepath)
+    {
+        std::FILE *file = std::fopen(filepath.c_str(), "rb");
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open checkpoint file: " + filepath);
+        }
+        std::vector<uint8_t> bytes;
+        uint8_t chunk[4096];
+        size_t n;
+        while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+            bytes.insert(bytes.end(), chunk, chunk + n);
+        std::fclose(file);
+        try
+        {
+            return deserialize(bytes);
+        }
+        catch (const std::exception &e)
+        {
+            throw std::runtime_error(filepath + ": " + e.what());
+        }
+    }
+
+private:
+    struct Writer
+    {
+        std::vector<uint8_t> bytes;
+
+        void reserve(size_t n) { bytes.reserve(n); }
+
+        void raw(const void *p, size_t n)
+        {
+            const uint8_t *b = static_cast<const uint8_t *>(p);
+            bytes.insert(bytes.end(), b, b + n);
+        }
+
+        template <typename T>
+        void value(T v) { raw(&v, sizeof(v)); }
+
+        void flag(bool b) { value(static_cast<uint8_t>(b ? 1 : 0)); }
+        void vec(const Vec2 &v)
+        {
+            value(v.x);
+            value(v.y);
+        }
+
+        void string(const std::string &s)
+        {
+            value(static_cast<uint32_t>(s.size()));
+            raw(s.data(), s.size());
+        }
+
+        void pid(const PIDController &pid)
+        {
+            value(pid.getKp());
+            value(pid.getKi());
+            value(pid.getKd());
+            value(pid.getOutputMin());
+            value(pid.getOutputMax());
+            PIDController::State st = pid.getState();
+            value(st.integral);
+            value(st.previous_error);
+            flag(st.first_update);
+            value(st.p_term);
+            value(st.i_term);
+            value(st.d_term);
+        }
+    };
+
+    struct Reader
+    {
+        const uint8_t *p;
+        const uint8_t *end;
+
+        void raw(void *out, size_t n)
+        {
+            if (static_cast<size_t>(end - p) < n)
+            {
+                throw std::runtime_error("Checkpoint is truncated");
+            }
+            std::memcpy(out, p, n);
+            p += n;
+        }
+
+        template <typename T>
+        void value(T &v) { raw(&v, sizeof(v)); }
+
+        void flag(bool &b)
+        {
+            uint8_t v = 0;
+            value(v);
+            b = v != 0;
+        }
+
+        void vec(Vec2 &v)
+        {
+            value(v.x);
+            value(v.y);
+        }
+
+        void string(std::string &s)
+        {
+            uint32_t n = 0;
+            value(n);
+            if (static_cast<size_t>(end - p) < n)
+            {
+                throw std::runtime_error("Checkpoint is truncated");
+            }
+            s.assign(reinterpret_cast<const char *>(p), n);
+            p += n;
+        }
+
+        void pid(PIDController &pid)
+        {
+            double kp, ki, kd, lo, hi;
+            value(kp);
+            value(ki);
+            value(kd);
+            value(lo);
+            value(hi);
+            PIDController::State st;
+            value(st.integral);
+            value(st.previous_error);
+            flag(st.first_update);
+            value(st.p_term);
+            value(st.i_term);
+            value(st.d_term);
+            pid = PIDController(kp, ki, kd, lo, hi);
+            pid.setState(st);
+        }
+    };
+};
+
+// Periodic checkpoints of a running simulation, oldest overwritten first
+//
+// record() is cheap to call every step: it only captures when interval
+// seconds of simulated time have passed since the newest keyframe. With the
+// defaults the ring covers the last ten minutes at one-second spacing, so a
+// rewind replays at most one second of physics.
+class KeyframeRing
+{
+public:
+    explicit KeyframeRing(size_t capacity = 600, double interval = 1.0)
+        : frames(capacity > 0 ? capacity : 1), interval(interval), head(0), count(0)
+    {
+    }
+
+    // Capture the state if a keyframe is due; returns true if one was taken
+    bool record(const SimulationState &state)
+    {
+        if (count > 0 && state.t < newest().t + interval - 1e-9)
+            return false;
+        frames[head] = SimulationCheckpoint::capture(state);
+        head = (head + 1) % frames.size();
+        if (count < frames.size())
+            count++;
+        return true;
+    }
+
+    // Newest keyframe at or before time t, or nullptr if t is older than the ring
+    const SimulationCheckpoint *latestAtOrBefore(double t) const
+    {
+        for (size_t i = count; i-- > 0;)
+        {
+            const SimulationCheckpoint &frame = at(i);
+            if (frame.t <= t + 1e-9)
+                return &frame;
+        }
+        return nullptr;
+    }
+
+    // Drop keyframes later than t (their future no longer happened after a rewind)
+    void truncateAfter(double t)
+    {
+        while (count > 0 && newest().t > t + 1e-9)
+        {
+            head = (head + frames.size() - 1) % frames.size();
+            count--;
+        }
+    }
+
+    void clear()
+    {
+        head = 0;
+        count = 0;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    size_t capacity() const { return frames.size(); }
+    double oldestTime() const { return count > 0 ? at(0).t : 0.0; }
+    double newestTime() const { return count > 0 ? newest().t : 0.0; }
+
+    // i = 0 is the oldest keyframe
+    const SimulationCheckpoint &at(size_t i) const
+    {
+        return frames[(head + frames.size() - count + i) % frames.size()];
+    }
+
+private:
+    std::vector<SimulationCheckpoint> frames;
+    double interval;
+    size_t head; // Next slot to write
+    size_t count;
+
+    const SimulationCheckpoint &newest() const { return at(count - 1); }
+};
+
+// Return the state to simulated time t: restore the nearest earlier keyframe
+// and replay updatePhysics up to t. The replay does not record flight path
+// points. Returns false (state untouched) if t is older than the ring.
+inline bool rewindTo(SimulationState &state, const KeyframeRing &ring, double t)
+{
+    const SimulationCheckpoint *frame = ring.latestAtOrBefore(t);
+    if (!frame)
+        return false;
+
+    bool record = state.record_flight_path;
+    frame->restore(state);
+    state.record_flight_path = false;
+    // Same step count a run from the keyframe would take to reach t
+    long long steps = state.dt > 0.0 ? static_cast<long long>(std::floor((t - state.t) / state.dt + 1e-9)) : 0;
+    bool paused = state.paused;
+    state.paused = false;
+    for (long long i = 0; i < steps; i++)
+        updatePhysics(state);
+    state.paused = paused;
+    state.record_flight_path = record;
+    return true;
+}
@@ -3,12 +3,16 @@
 #include "../core/vec2.hpp"
 #include "../aircraft/aircraft.hpp"
 #include "../control/pid.hpp"
-#include <vector>
+#include "../environment/wind.hpp"
+#include "flight_path.hpp"
+#include <memory>
 
-// Flight history point for visualization
-struct FlightPoint
+// How updatePhysics advances position, velocity and pitch over one dt
+enum class IntegrationMethod
 {
-    float x, z;
+    Legacy,         // Forces evaluated once per step, semi-implicit pitch (matches SimulationBatch)
+    RK4,            // Classic RK4, forces re-evaluated at every stage
+    DormandPrince45 // Adaptive 5(4) substeps within dt, error controlled by integration_tolerance
 };
 
 // Main simulation state
@@ -31,6 +35,25 @@ public:
     bool paused;
     bool reset_requested;
 
+    // Time warp (interactive runs): simulated seconds per wall-clock second, and
+    // the wall time the simulation thread may spend stepping per wake-up
+    static constexpr float MIN_TIME_WARP = 1.0f;
+    static constexpr float MAX_TIME_WARP = 1000.0f;
+    float time_warp;
+    float step_budget_ms;
+
+    // Integrator (controls are held constant over each dt; only the flight state is integrated)
+    IntegrationMethod integration_method;
+    double integration_tolerance; // Relative and absolute tolerance for DormandPrince45
+    double adaptive_dt;           // Substep size carried between steps (0 = start from dt)
+    int integrator_evaluations;   // Force evaluations in the last step
+
+    // Wind (null = still air): the field is immutable and may be shared by
+    // many states; the phase is this aircraft's position in its turbulence
+    std::shared_ptr<const WindField> wind;
+    TurbulencePhase turbulence_phase;
+    Vec2 wind_velocity; // Wind over the last step [m/s]
+
     // Autopilot - Speed Control
     bool autopilot_speed;
     float speed_setpoint;
@@ -50,8 +73,8 @@ public:
     float prev_alt_pid_kp, prev_alt_pid_ki, prev_alt_pid_kd;
 
     // Flight path history
-    std::vector<FlightPoint> flightPath;
-    int maxPathPoints;
+    FlightPathHistory flightPath; // Fixed-capacity ring, thinned with age
+    bool record_flight_path; // Disabled by headless runs that stream their own trajectory
 
     // Force vectors for visualization
     Vec2 F_thrust_viz;
@@ -59,7 +82,10 @@ public:
     Vec2 F_lift_viz;
     Vec2 F_weight_viz;
 
-    SimulationState()
+    SimulationState() : SimulationState(std::pmr::get_default_resource()) {}
+
+    // Flight path history allocated from 'history' (e.g. a run's arena)
+    explicit SimulationState(std::pmr::memory_resource *history)
         : aircraft(),
           position(0.0, 0.0),
           velocity(0.0, 0.0),
@@ -72,6 +98,15 @@ public:
           alpha_deg(0.0f),
           paused(false),
           reset_requested(false),
+          time_warp(1.0f),
+          step_budget_ms(4.0f),
+          integration_method(IntegrationMethod::Legacy),
+          integration_tolerance(1e-6),
+          adaptive_dt(0.0),
+          integrator_evaluations(0),
+          wind(nullptr),
+          turbulence_phase(),
+          wind_velocity(0.0, 0.0),
           autopilot_speed(false),
           speed_setpoint(40.0f),
           pid_kp(0.02f),
@@ -90,7 +125,8 @@ public:
           prev_alt_pid_kp(0.1f),
           prev_alt_pid_ki(0.001f),
           prev_alt_pid_kd(0.5f),
-          maxPathPoints(1000),
+          flightPath(2048, 6, 4, history),
+          record_flight_path(true),
           F_thrust_viz(0.0, 0.0),
           F_drag_viz(0.0, 0.0),
           F_lift_viz(0.0, 0.0),
@@ -98,6 +134,58 @@ public:
     {
     }
 
+    // Fly in a wind built from the conditions (kept even when calm, so the
+    // settings survive; leave wind null for still air)
+    void setWind(const WindConditions &conditions)
+    {
+        wind = std::make_shared<const WindField>(conditions);
+        sampleWind();
+    }
+
+    // Refresh wind_velocity for the current position and time without moving
+    // the turbulence phase (readouts before the first step)
+    void sampleWind()
+    {
+        WindSample w = wind ? wind->sample(position.y, t, turbulence_phase) : WindSample{0.0, 0.0, 0.0, 0.0};
+        wind_velocity = Vec2(w.x, w.y);
+    }
+
+    // Conditions of the current wind (defaults for still air)
+    WindConditions windConditions() const
+    {
+        return wind ? wind->conditions() : WindConditions();
+    }
+
+    // Append a point to the flight path history (O(1), bounded memory)
+    void recordFlightPoint(float x, float z)
+    {
+        flightPath.push({x, z});
+    }
+
+    // Take autopilot gains (e.g. from a config); updatePhysics retunes the
+    // controllers in place on the next step
+    void applyAutopilotGains(const AutopilotGains &g)
+    {
+        pid_kp = static_cast<float>(g.speed_kp);
+        pid_ki = static_cast<float>(g.speed_ki);
+        pid_kd = static_cast<float>(g.speed_kd);
+        alt_pid_kp = static_cast<float>(g.altitude_kp);
+        alt_pid_ki = static_cast<float>(g.altitude_ki);
+        alt_pid_kd = static_cast<float>(g.altitude_kd);
+    }
+
+    AutopilotGains autopilotGains() const
+    {
+        AutopilotGains g;
+        g.speed_kp = pid_kp;
+        g.speed_ki = pid_ki;
+        g.speed_kd = pid_kd;
+        g.altitude_kp = alt_pid_kp;
+        g.altitude_ki = alt_pid_ki;
+        g.altitude_kd = alt_pid_kd;
+        return g;
+    }
+
     void reset()
     {
         position = Vec2(0.0, 0.0);
@@ -108,6 +196,9 @@ public:
         pitch_rate = 0.0f;
         alpha_deg = 0.0f;
         t = 0.0;
+        adaptive_dt = 0.0;
+        turbulence_phase = TurbulencePhase();
+        sampleWind();
         flightPath.clear();
         speed_pid.reset();
         altitude_pid.reset();
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include "physics_update.hpp"
+
+// Compile-time specialized physics stepper for runs with a fixed configuration
+//
+// updatePhysics checks the aero model, both autopilots, the integrator choice
+// and the PID gains on every step and reaches the aero table through the
+// aircraft's shared_ptr. SpecializedStepper fixes those choices as template
+// policies, so the step compiles to straight-line code with the aero model
+// inlined and the table held as a plain pointer. It uses the same force
+// model functions as updatePhysics and follows the same trajectory.
+//
+// Flight path points are not recorded; use withSpecializedStepper() or
+// runSpecialized() to pick the instantiation matching a SimulationState.
+
+// Aero model policies
+struct PolarAero
+{
+    using Model = PolarAeroModel;
+};
+
+struct TableAero
+{
+    using Model = TableAeroModel;
+};
+
+// Autopilot policy: which loops are engaged
+template <bool Speed, bool Altitude>
+struct AutopilotPolicy
+{
+    static constexpr bool speed = Speed;
+    static constexpr bool altitude = Altitude;
+};
+
+using NoAutopilot = AutopilotPolicy<false, false>;
+using SpeedAutopilot = AutopilotPolicy<true, false>;
+using AltitudeAutopilot = AutopilotPolicy<false, true>;
+using FullAutopilot = AutopilotPolicy<true, true>;
+
+// Integrator policies (see integrateLegacy / integrateCoupled)
+struct LegacyIntegrator
+{
+    template <typename State, typename AeroModel>
+    static void integrate(State &state, const AeroModel &aero, double altitude, const Vec2 &air_velocity,
+                          double speed, ForceBreakdown &forces)
+    {
+        AtmosphereState atm = getAtmosphere(std::max(0.0, altitude));
+        integrateLegacy(state, aero, atm, air_velocity, speed, forces);
+    }
+};
+
+struct RK4Integrator
+{
+    template <typename State, typename AeroModel>
+    static void integrate(State &state, const AeroModel &aero, double, const Vec2 &, double, ForceBreakdown &forces)
+    {
+        integrateCoupled<false>(state, aero, state.wind_velocity, forces);
+    }
+};
+
+struct DormandPrinceIntegrator
+{
+    template <typename State, typename AeroModel>
+    static void integrate(State &state, const AeroModel &aero, double, const Vec2 &, double, ForceBreakdown &forces)
+    {
+        integrateCoupled<true>(state, aero, state.wind_velocity, forces);
+    }
+};
+
+// Flight state advanced by the stepper (member names match SimulationState
+// so the shared integration functions work on both)
+struct StepperState
+{
+    Aircraft aircraft;
+    Vec2 position;
+    Vec2 velocity;
+    double t;
+    double dt;
+    float throttle;
+    float elevator;
+    float pitch_deg;
+    float pitch_rate;
+    double integration_tolerance;
+    double adaptive_dt;
+    int integrator_evaluations;
+    std::shared_ptr<const WindField> wind;
+    TurbulencePhase turbulence_phase;
+    Vec2 wind_velocity;
+};
+
+template <typename Aero, typename Autopilot, typename Integrator>
+class SpecializedStepper
+{
+public:
+    explicit SpecializedStepper(const SimulationState &s)
+        : state{s.aircraft, s.position, s.velocity, s.t, s.dt, s.throttle, s.elevator, s.pitch_deg, s.pitch_rate,
+                s.integration_tolerance, s.adaptive_dt, s.integrator_evaluations, s.wind, s.turbulence_phase,
+                s.wind_velocity},
+          aero(state.aircraft),
+          speed_pid(s.speed_pid),
+          altitude_pid(s.altitude_pid),
+          speed_setpoint(s.speed_setpoint),
+          altitude_setpoint(s.altitude_setpoint),
+          forces{s.F_thrust_viz, s.F_drag_viz, s.F_lift_viz, s.F_weight_viz, s.alpha_deg * M_PI / 180.0}
+    {
+        // Gains are fixed for the run: apply a pending change once, the same
+        // in-place retune updatePhysics would do on its next step
+        if (Autopilot::speed &&
+            (s.pid_kp != s.prev_pid_kp || s.pid_ki != s.prev_pid_ki || s.pid_kd != s.prev_pid_kd))
+            speed_pid.setGains(s.pid_kp, s.pid_ki, s.pid_kd);
+        if (Autopilot::altitude &&
+            (s.alt_pid_kp != s.prev_alt_pid_kp || s.alt_pid_ki != s.prev_alt_pid_ki || s.alt_pid_kd != s.prev_alt_pid_kd))
+            altitude_pid.setGains(s.alt_pid_kp, s.alt_pid_ki, s.alt_pid_kd);
+    }
+
+    void step()
+    {
+        PROFILE_ZONE(ProfileZone::Physics);
+        double altitude = state.position.y;
+        state.wind_velocity = stepWind(state);
+        Vec2 air_velocity = state.velocity - state.wind_velocity;
+        double speed = air_velocity.magnitude();
+
+        if constexpr (Autopilot::speed)
+            state.throttle = static_cast<float>(speed_pid.update(speed_setpoint, speed, state.dt));
+        if constexpr (Autopilot::altitude)
+            state.elevator = static_cast<float>(altitude_pid.update(altitude_setpoint, altitude, state.dt));
+
+        {
+            PROFILE_ZONE(ProfileZone::Integrator);
+            Integrator::integrate(state, aero, altitude, air_velocity, speed, forces);
+        }
+        applyGroundConstraint(state);
+        state.t += state.dt;
+    }
+
+    void run(long long steps)
+    {
+        for (long long i = 0; i < steps; i++)
+            step();
+    }
+
+    double time() const { return state.t; }
+
+    // Write the advanced state back (everything updatePhysics changes except the flight path)
+    void store(SimulationState &s) const
+    {
+        s.position = state.position;
+        s.velocity = state.velocity;
+        s.t = state.t;
+        s.throttle = state.throttle;
+        s.elevator = state.elevator;
+        s.pitch_deg = state.pitch_deg;
+        s.pitch_rate = state.pitch_rate;
+        s.adaptive_dt = state.adaptive_dt;
+        s.integrator_evaluations = state.integrator_evaluations;
+        s.turbulence_phase = state.turbulence_phase;
+        s.wind_velocity = state.wind_velocity;
+        s.alpha_deg = static_cast<float>(forces.alpha * 180.0 / M_PI);
+        s.F_thrust_viz = forces.thrust;
+        s.F_drag_viz = forces.drag;
+        s.F_lift_viz = forces.lift;
+        s.F_weight_viz = forces.weight;
+        s.speed_pid = speed_pid;
+        s.altitude_pid = altitude_pid;
+        if (Autopilot::speed)
+        {
+            s.prev_pid_kp = s.pid_kp;
+            s.prev_pid_ki = s.pid_ki;
+            s.prev_pid_kd = s.pid_kd;
+        }
+        if (Autopilot::altitude)
+        {
+            s.prev_alt_pid_kp = s.alt_pid_kp;
+            s.prev_alt_pid_ki = s.alt_pid_ki;
+            s.prev_alt_pid_kd = s.alt_pid_kd;
+        }
+    }
+
+private:
+    StepperState state;
+    typename Aero::Model aero;
+    PIDController speed_pid;
+    PIDController altitude_pid;
+    float speed_setpoint;
+    float altitude_setpoint;
+    ForceBreakdown forces;
+};
+
+namespace detail
+{
+template <typename Aero, typename Autopilot, typename F>
+inline void dispatchIntegrator(const SimulationState &s, F &&f)
+{
+    switch (s.integration_method)
+    {
+    case IntegrationMethod::Legacy:
+    {
+        SpecializedStepper<Aero, Autopilot, LegacyIntegrator> stepper(s);
+        f(stepper);
+        return;
+    }
+    case IntegrationMethod::RK4:
+    {
+        SpecializedStepper<Aero, Autopilot, RK4Integrator> stepper(s);
+        f(stepper);
+        return;
+    }
+    case IntegrationMethod::DormandPrince45:
+    {
+        SpecializedStepper<Aero, Autopilot, DormandPrinceIntegrator> stepper(s);
+        f(stepper);
+        return;
+    }
+    }
+}
+
+template <typename Aero, typename F>
+inline void dispatchAutopilot(const SimulationState &s, F &&f)
+{
+    if (s.autopilot_speed && s.autopilot_altitude)
+        dispatchIntegrator<Aero, FullAutopilot>(s, f);
+    else if (s.autopilot_speed)
+        dispatchIntegrator<Aero, SpeedAutopilot>(s, f);
+    else if (s.autopilot_altitude)
+        dispatchIntegrator<Aero, AltitudeAutopilot>(s, f);
+    else
+        dispatchIntegrator<Aero, NoAutopilot>(s, f);
+}
+} // namespace detail
+
+// Call f(stepper) with the stepper specialized for this state's configuration
+// (the runtime choice is made once here, not per step)
+template <typename F>
+inline void withSpecializedStepper(const SimulationState &s, F &&f)
+{
+    if (s.aircraft.hasAeroTable())
+        detail::dispatchAutopilot<TableAero>(s, f);
+    else
+        detail::dispatchAutopilot<PolarAero>(s, f);
+}
+
+// Equivalent to calling updatePhysics 'steps' times with flight path recording off
+inline void runSpecialized(SimulationState &state, long long steps)
+{
+    if (state.paused)
+        return;
+    withSpecializedStepper(state, [&](auto &stepper)
+                           {
+        stepper.run(steps);
+        stepper.store(state); });
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "simulation_batch.hpp"
+#include "flight_recording.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Many 2-D trajectories in one flat store, for drawing batch and sweep results
+//
+// Points of every run sit back to back in two float arrays (x and altitude),
+// with an offset and count per run, so thousands of trails cost a handful of
+// allocations. Each run also keeps its bounding box, for culling whole runs
+// against the view, and one value per named metric, for colouring them.
+class TrajectorySet
+{
+public:
+    struct Bounds
+    {
+        float x0, z0, x1, z1;
+    };
+
+    void clear()
+    {
+        xs.clear();
+        zs.clear();
+        starts.clear();
+        counts.clear();
+        run_bounds.clear();
+        metric_values.clear();
+        revision++;
+    }
+
+    // Metric names are fixed per set; call before adding runs
+    void setMetricNames(std::vector<std::string> names)
+    {
+        clear();
+        metric_names = std::move(names);
+    }
+
+    const std::vector<std::string> &metricNames() const { return metric_names; }
+    size_t metricCount() const { return metric_names.size(); }
+
+    void reserve(size_t runs, size_t points)
+    {
+        xs.reserve(points);
+        zs.reserve(points);
+        starts.reserve(runs);
+        counts.reserve(runs);
+        run_bounds.reserve(runs);
+        metric_values.reserve(runs * metric_names.size());
+    }
+
+    // Append a run; metrics holds metricCount() values (may be null if there are none).
+    // The bounds cover the finite points only; a run without any has x0 > x1.
+    void addRun(const float *x, const float *z, size_t n, const float *metrics)
+    {
+        Bounds b = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                    std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+        for (size_t i = 0; i < n; i++)
+        {
+            if (!std::isfinite(x[i]) || !std::isfinite(z[i]))
+                continue; // Diverged sample
+            b.x0 = std::min(b.x0, x[i]);
+            b.x1 = std::max(b.x1, x[i]);
+            b.z0 = std::min(b.z0, z[i]);
+            b.z1 = std::max(b.z1, z[i]);
+        }
+        starts.push_back(xs.size());
+        counts.push_back(n);
+        run_bounds.push_back(b);
+        xs.insert(xs.end(), x, x + n);
+        zs.insert(zs.end(), z, z + n);
+        for (size_t m = 0; m < metric_names.size(); m++)
+            metric_values.push_back(metrics ? metrics[m] : 0.0f);
+        revision++;
+    }
+
+    // Append a recording as one run, thinned to at most max_points. The
+    // metrics are filled in by name where the recording has the data
+    // (final altitude, max altitude, final speed, duration).
+    void addRecording(const RecordingReader &rec, size_t max_points = 2048)
+    {
+        uint64_t n = rec.sampleCount();
+        if (n == 0)
+            return;
+        uint64_t stride = std::max<uint64_t>(1, (n + max_points - 1) / std::max<size_t>(1, max_points));
+        std::vector<float> x, z;
+        float max_alt = std::numeric_limits<float>::lowest();
+        for (uint64_t i = 0; i < n; i += stride)
+        {
+            x.push_back(static_cast<float>(rec.value(RecordingChannel::X, i)));
+            z.push_back(static_cast<float>(rec.value(RecordingChannel::Y, i)));
+        }
+        if ((n - 1) % stride != 0)
+        {
+            // Always end on the last sample
+            x.push_back(static_cast<float>(rec.value(RecordingChannel::X, n - 1)));
+            z.push_back(static_cast<float>(rec.value(RecordingChannel::Y, n - 1)));
+        }
+        for (float v : z)
+            max_alt = std::max(max_alt, v);
+
+        double vx = rec.value(RecordingChannel::VX, n - 1), vy = rec.value(RecordingChannel::VY, n - 1);
+        std::vector<float> metrics;
+        for (const std::string &name : metric_names)
+        {
+            if (name == "Final altitude")
+                metrics.push_back(z.back());
+            else if (name == "Max altitude")
+                metrics.push_back(max_alt);
+            else if (name == "Final speed")
+                metrics.push_back(static_cast<float>(std::sqrt(vx * vx + vy * vy)));
+            else if (name == "Duration")
+                metrics.push_back(static_cast<float>(rec.endTime() - rec.startTime()));
+            else
+                metrics.push_back(0.0f);
+        }
+        addRun(x.data(), z.data(), x.size(), metrics.data());
+    }
+
+    size_t size() const { return counts.size(); }
+    bool empty() const { return counts.empty(); }
+    size_t totalPoints() const { return xs.size(); }
+
+    size_t pointCount(size_t run) const { return counts[run]; }
+    const float *x(size_t run) const { return xs.data() + starts[run]; }
+    const float *z(size_t run) const { return zs.data() + starts[run]; }
+    const Bounds &bounds(size_t run) const { return run_bounds[run]; }
+    float metric(size_t run, size_t m) const { return metric_values[run * metric_names.size() + m]; }
+
+    // Smallest and largest value of a metric over all runs
+    void metricRange(size_t m, float &lo, float &hi) const
+    {
+        lo = std::numeric_limits<float>::max();
+        hi = std::numeric_limits<float>::lowest();
+        for (size_t r = 0; r < size(); r++)
+        {
+            lo = std::min(lo, metric(r, m));
+            hi = std::max(hi, metric(r, m));
+        }
+        if (lo > hi)
+            lo = hi = 0.0f;
+    }
+
+    // Changes whenever runs are added or removed (for caches built from the set)
+    uint64_t getRevision() const { return revision; }
+
+private:
+    std::vector<std::string> metric_names;
+    std::vector<float> xs, zs;
+    std::vector<size_t> starts, counts;
+    std::vector<Bounds> run_bounds;
+    std::vector<float> metric_values; // Run-major, metricCount() per run
+    uint64_t revision = 0;
+};
+
+// Fly a batch for a duration, sampling every lane's position every
+// sample_interval seconds, and store the lanes as runs of out with the
+// metrics "Final altitude", "Max altitude", "Final speed" and "Mass"
+inline void flyBatchTrajectories(SimulationBatch &batch, double duration, double sample_interval, TrajectorySet &out)
+{
+    const size_t lanes = batch.size();
+    const long long steps = static_cast<long long>(std::ceil(duration / batch.dt));
+    const long long every = std::max(1LL, static_cast<long long>(std::llround(sample_interval / batch.dt)));
+    const size_t samples = static_cast<size_t>(steps / every) + 1;
+
+    // Lane-major so each run is contiguous when copied out
+    std::vector<float> x(lanes * samples), z(lanes * samples);
+    size_t taken = 0;
+    auto sample = [&]
+    {
+        for (size_t i = 0; i < lanes; i++)
+        {
+            x[i * samples + taken] = static_cast<float>(batch.x[i]);
+            z[i * samples + taken] = static_cast<float>(batch.y[i]);
+        }
+        taken++;
+    };
+
+    sample();
+    for (long long s = 1; s <= steps; s++)
+    {
+        batch.step();
+        if (s % every == 0 && taken < samples)
+            sample();
+    }
+
+    out.setMetricNames({"Final altitude", "Max altitude", "Final speed", "Mass"});
+    out.reserve(lanes, lanes * taken);
+    for (size_t i = 0; i < lanes; i++)
+    {
+        const float *lane_z = z.data() + i * samples;
+        float metrics[4] = {static_cast<float>(batch.y[i]), *std::max_element(lane_z, lane_z + taken),
+                            static_cast<float>(std::sqrt(batch.vx[i] * batch.vx[i] + batch.vy[i] * batch.vy[i])),
+                            static_cast<float>(batch.mass[i])};
+        out.addRun(x.data() + i * samples, lane_z, taken, metrics);
+    }
+}
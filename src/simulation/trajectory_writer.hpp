@@ -0,0 +1,143 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+// One recorded row of the trajectory
+struct TrajectorySample
+{
+    double t;
+    double x, y;   // Position [m]
+    double vx, vy; // Velocity [m/s]
+    double pitch_deg;
+    double alpha_deg;
+    double throttle;
+    double elevator;
+
+    static TrajectorySample fromState(const SimulationState &state)
+    {
+        return {state.t,
+                state.position.x, state.position.y,
+                state.velocity.x, state.velocity.y,
+                state.pitch_deg, state.alpha_deg,
+                state.throttle, state.elevator};
+    }
+};
+
+// Column names shared by the CSV header and the binary format description
+static const char *const TRAJECTORY_COLUMNS[] = {"t", "x", "y", "vx", "vy", "pitch_deg", "alpha_deg", "throttle", "elevator"};
+static const uint32_t TRAJECTORY_COLUMN_COUNT = sizeof(TRAJECTORY_COLUMNS) / sizeof(TRAJECTORY_COLUMNS[0]);
+
+// Streams trajectory samples to disk
+// Both formats go through a large user-space buffer so a run is a handful of
+// write() calls rather than one per sample.
+class TrajectoryWriter
+{
+public:
+    enum class Format
+    {
+        CSV,
+        Binary
+    };
+
+    // Binary layout: header followed by TRAJECTORY_COLUMN_COUNT little-endian doubles per sample
+    struct BinaryHeader
+    {
+        char magic[8];         // "FDTRAJ\0\0"
+        uint32_t version;      // Format version (1)
+        uint32_t column_count; // Doubles per sample
+    };
+
+    TrajectoryWriter(const std::string &filepath, Format format, size_t buffer_bytes = 1 << 20)
+        : file(nullptr), format(format), buffer(buffer_bytes), used(0), samples(0)
+    {
+        file = std::fopen(filepath.c_str(), format == Format::CSV ? "w" : "wb");
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open trajectory output file: " + filepath);
+        }
+
+        if (format == Format::CSV)
+        {
+            std::string header;
+            for (uint32_t i = 0; i < TRAJECTORY_COLUMN_COUNT; i++)
+            {
+                header += TRAJECTORY_COLUMNS[i];
+                header += (i + 1 < TRAJECTORY_COLUMN_COUNT) ? ',' : '\n';
+            }
+            append(header.data(), header.size());
+        }
+        else
+        {
+            BinaryHeader header = {{'F', 'D', 'T', 'R', 'A', 'J', '\0', '\0'}, 1, TRAJECTORY_COLUMN_COUNT};
+            append(&header, sizeof(header));
+        }
+    }
+
+    ~TrajectoryWriter()
+    {
+        close();
+    }
+
+    TrajectoryWriter(const TrajectoryWriter &) = delete;
+    TrajectoryWriter &operator=(const TrajectoryWriter &) = delete;
+
+    void write(const TrajectorySample &s)
+    {
+        if (format == Format::CSV)
+        {
+            char line[320];
+            int n = std::snprintf(line, sizeof(line), "%.6f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                                  s.t, s.x, s.y, s.vx, s.vy, s.pitch_deg, s.alpha_deg, s.throttle, s.elevator);
+            append(line, static_cast<size_t>(n));
+        }
+        else
+        {
+            static_assert(sizeof(TrajectorySample) == TRAJECTORY_COLUMN_COUNT * sizeof(double),
+                          "TrajectorySample must be a packed row of doubles");
+            append(&s, sizeof(s));
+        }
+        samples++;
+    }
+
+    // Flush buffered data and close the file (also called by the destructor)
+    void close()
+    {
+        if (!file)
+            return;
+        flush();
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    size_t sampleCount() const { return samples; }
+
+private:
+    std::FILE *file;
+    Format format;
+    std::vector<char> buffer;
+    size_t used;
+    size_t samples;
+
+    void append(const void *bytes, size_t n)
+    {
+        if (used + n > buffer.size())
+            flush();
+        std::memcpy(buffer.data() + used, bytes, n);
+        used += n;
+    }
+
+    void flush()
+    {
+        if (used > 0 && std::fwrite(buffer.data(), 1, used, file) != used)
+        {
+            throw std::runtime_error("Failed to write trajectory output");
+        }
+        used = 0;
+    }
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include "physics_update.hpp"
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+
+// Steady flight (trim) for the force model of updatePhysics
+//
+// A trimmed aircraft flies a straight line at constant speed: the net force
+// from computeAcceleration is zero and so is the pitch rate. The pitch model
+// commands a pitch rate with the elevator, so the elevator trims at zero and
+// only throttle and angle of attack are unknown. They are found by Newton
+// iteration on the two acceleration components (finite-difference Jacobian,
+// backtracking line search) with the same aero model and atmosphere as the
+// simulation, so a trimmed start holds its speed and altitude when flown.
+
+enum class TrimStatus : uint8_t
+{
+    Trimmed,       // Force balance with the throttle in [0, 1]
+    ThrustLimited, // Balance needs more than full throttle (or less than idle)
+    AlphaLimited,  // Balance only outside the allowed angle of attack range
+    Failed         // No force balance found (e.g. below the stall speed)
+};
+
+inline const char *trimStatusName(TrimStatus s)
+{
+    switch (s)
+    {
+    case TrimStatus::Trimmed:
+        return "trimmed";
+    case TrimStatus::ThrustLimited:
+        return "thrust_limited";
+    case TrimStatus::AlphaLimited:
+        return "alpha_limited";
+    case TrimStatus::Failed:
+        return "failed";
+    }
+    return "";
+}
+
+// Flight condition to trim for
+struct TrimCondition
+{
+    double speed;          // True airspeed [m/s]
+    double altitude;       // [m]
+    double gamma_deg = 0;  // Flight path angle (0 = level, + = climbing)
+};
+
+struct TrimOptions
+{
+    double tolerance = 1e-8;     // Residual acceleration [m/s^2]
+    int max_iterations = 50;
+    double min_alpha_deg = -15.0; // Trims outside this range count as AlphaLimited (an aero
+    double max_alpha_deg = 20.0;  // table further limits it to the alphas it covers)
+
+    // Starting point (negative throttle = estimate from the polar)
+    double throttle_guess = -1.0;
+    double alpha_guess_deg = 0.0;
+};
+
+struct TrimResult
+{
+    TrimStatus status = TrimStatus::Failed;
+    double throttle = 0.0;
+    double alpha_deg = 0.0;
+    double pitch_deg = 0.0; // alpha + flight path angle
+    double residual = 0.0;  // |acceleration| at the solution [m/s^2]
+    int iterations = 0;
+
+    bool trimmed() const { return status == TrimStatus::Trimmed; }
+};
+
+// Solve for throttle and angle of attack with any aero model accepted by
+// computeAcceleration
+template <typename AeroModel>
+inline TrimResult solveTrim(const Aircraft &aircraft, const AeroModel &aero, const TrimCondition &cond,
+                            const TrimOptions &opts = TrimOptions())
+{
+    const double deg = M_PI / 180.0;
+    const double gamma = cond.gamma_deg * deg;
+    const Vec2 velocity(cond.speed * std::cos(gamma), cond.speed * std::sin(gamma));
+    const AtmosphereState atm = getAtmosphere(std::max(0.0, cond.altitude));
+
+    // Net acceleration for a throttle and angle of attack [rad]
+    auto residual = [&](double throttle, double alpha)
+    {
+        ForceBreakdown forces;
+        return computeAcceleration(aircraft, aero, atm, velocity, cond.speed, (alpha + gamma) / deg, throttle, 0.0,
+                                   forces);
+    };
+
+    TrimResult result;
+    double throttle = opts.throttle_guess;
+    double alpha = opts.alpha_guess_deg * deg;
+    if (throttle < 0.0)
+    {
+        // Lift for the weight component normal to the path from the polar
+        double q = 0.5 * atm.rho * cond.speed * cond.speed;
+        double weight = aircraft.mass * g;
+        double CL = q > 0.0 ? weight * std::cos(gamma) / (q * aircraft.S) : 0.0;
+        alpha = std::clamp(CL / aircraft.CL_alpha, -10.0 * deg, 15.0 * deg);
+        double drag = q * aircraft.S * (aircraft.CD0 + aircraft.k * CL * CL);
+        throttle = aircraft.maxThrust > 0.0 ? (drag + weight * std::sin(gamma)) / aircraft.maxThrust : 0.0;
+    }
+
+    Vec2 f = residual(throttle, alpha);
+    double norm = f.magnitude();
+    for (int it = 0; it < opts.max_iterations && norm > opts.tolerance; it++)
+    {
+        result.iterations = it + 1;
+
+        // Central differences; throttle enters linearly, alpha through the aero model
+        const double h_t = 1e-6, h_a = 1e-7;
+        Vec2 dt = (residual(throttle + h_t, alpha) - residual(throttle - h_t, alpha)) / (2.0 * h_t);
+        Vec2 da = (residual(throttle, alpha + h_a) - residual(throttle, alpha - h_a)) / (2.0 * h_a);
+        double det = dt.x * da.y - da.x * dt.y;
+        if (!(std::abs(det) > 1e-300))
+            break;
+        double step_t = -(f.x * da.y - da.x * f.y) / det;
+        double step_a = -(dt.x * f.y - f.x * dt.y) / det;
+
+        // Halve the step until the residual drops
+        double lambda = 1.0;
+        double next_t = throttle, next_a = alpha;
+        Vec2 next_f = f;
+        for (int ls = 0; ls < 30; ls++)
+        {
+            next_t = throttle + lambda * step_t;
+            next_a = std::clamp(alpha + lambda * step_a, -60.0 * deg, 60.0 * deg);
+            next_f = residual(next_t, next_a);
+            if (next_f.magnitude() < norm)
+                break;
+            lambda *= 0.5;
+        }
+        if (!(next_f.magnitude() < norm))
+            break;
+        throttle = next_t;
+        alpha = next_a;
+        f = next_f;
+        norm = f.magnitude();
+    }
+
+    result.throttle = throttle;
+    result.alpha_deg = alpha / deg;
+    result.pitch_deg = (alpha + gamma) / deg;
+    result.residual = norm;
+    if (!(norm <= opts.tolerance))
+        result.status = TrimStatus::Failed;
+    else if (result.alpha_deg < opts.min_alpha_deg || result.alpha_deg > opts.max_alpha_deg)
+        result.status = TrimStatus::AlphaLimited;
+    else if (throttle < 0.0 || throttle > 1.0)
+        result.status = TrimStatus::ThrustLimited;
+    else
+        result.status = TrimStatus::Trimmed;
+    return result;
+}
+
+// Same with the aircraft's own aero model (table if loaded, else the polar)
+inline TrimResult solveTrim(const Aircraft &aircraft, const TrimCondition &cond,
+                            TrimOptions opts = TrimOptions())
+{
+    if (aircraft.hasAeroTable())
+    {
+        // Past the table the coefficients are extrapolated, not measured
+        const double deg = M_PI / 180.0;
+        opts.min_alpha_deg = std::max(opts.min_alpha_deg, aircraft.aeroTable->getMinAlpha() / deg);
+        opts.max_alpha_deg = std::min(opts.max_alpha_deg, aircraft.aeroTable->getMaxAlpha() / deg);
+    }
+    return solveTrim(aircraft, AircraftAeroModel(aircraft), cond, opts);
+}
+
+// Put a state into the trimmed condition: position, velocity, pitch, throttle
+// and a neutral elevator. An engaged speed autopilot gets its integrator
+// preloaded with the trim throttle so it holds trim instead of spooling up
+// from zero; the altitude autopilot trims at zero elevator and starts reset.
+inline void applyTrim(SimulationState &state, const TrimCondition &cond, const TrimResult &trim)
+{
+    const double gamma = cond.gamma_deg * M_PI / 180.0;
+    state.position.y = cond.altitude;
+    state.velocity = Vec2(cond.speed * std::cos(gamma), cond.speed * std::sin(gamma));
+    state.throttle = static_cast<float>(std::clamp(trim.throttle, 0.0, 1.0));
+    state.elevator = 0.0f;
+    state.pitch_deg = static_cast<float>(trim.pitch_deg);
+    state.pitch_rate = 0.0f;
+    state.alpha_deg = static_cast<float>(trim.alpha_deg);
+
+    state.speed_pid.reset();
+    if (state.speed_pid.getKi() > 1e-12)
+    {
+        PIDController::State pid = state.speed_pid.getState();
+        pid.integral = state.throttle / state.speed_pid.getKi();
+        pid.i_term = state.throttle;
+        state.speed_pid.setState(pid);
+    }
+    state.altitude_pid.reset();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../simulation/simulation_state.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Fixed-layout telemetry packet (one per published sample)
+//
+// 144 bytes of host-order (little-endian) values at fixed offsets, with no
+// padding the compiler could choose. The same bytes are sent as one UDP
+// datagram and stored in a shared-memory ring slot, so an external tool can
+// read either with one struct definition (or by offset, e.g. Python's
+// struct.unpack("<4sHHII d 4d 6f 8d", ...)). Filling one in touches only the
+// stack: fromState() is a handful of stores.
+struct TelemetryPacket
+{
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[4];        // "FDTM"
+    uint16_t version;     // VERSION
+    uint16_t size;        // sizeof(TelemetryPacket)
+    uint32_t sequence;    // Packets published by this source (gaps = dropped packets)
+    uint32_t flags;       // FlagSpeedAutopilot | FlagAltitudeAutopilot | FlagPaused
+    double t;             // Simulated time [s]
+    double x, y;          // Position [m] (y = altitude)
+    double vx, vy;        // Velocity [m/s]
+    float pitch_deg;      // Pitch attitude [deg]
+    float alpha_deg;      // Angle of attack [deg]
+    float pitch_rate;     // [deg/s]
+    float throttle;       // 0..1
+    float elevator;       // -1..1
+    float reserved;       // Zero
+    double thrust_x, thrust_y; // Force vectors [N]
+    double drag_x, drag_y;
+    double lift_x, lift_y;
+    double weight_x, weight_y;
+
+    enum Flags : uint32_t
+    {
+        FlagSpeedAutopilot = 1u << 0,
+        FlagAltitudeAutopilot = 1u << 1,
+        FlagPaused = 1u << 2
+    };
+
+    static TelemetryPacket fromState(const SimulationState &s, uint32_t sequence)
+    {
+        TelemetryPacket p;
+        std::memcpy(p.magic, "FDTM", 4);
+        p.version = VERSION;
+        p.size = sizeof(TelemetryPacket);
+        p.sequence = sequence;
+        p.flags = (s.autopilot_speed ? FlagSpeedAutopilot : 0u) | (s.autopilot_altitude ? FlagAltitudeAutopilot : 0u) |
+                  (s.paused ? FlagPaused : 0u);
+        p.t = s.t;
+        p.x = s.position.x;
+        p.y = s.position.y;
+        p.vx = s.velocity.x;
+        p.vy = s.velocity.y;
+        p.pitch_deg = s.pitch_deg;
+        p.alpha_deg = s.alpha_deg;
+        p.pitch_rate = s.pitch_rate;
+        p.throttle = s.throttle;
+        p.elevator = s.elevator;
+        p.reserved = 0.0f;
+        p.thrust_x = s.F_thrust_viz.x;
+        p.thrust_y = s.F_thrust_viz.y;
+        p.drag_x = s.F_drag_viz.x;
+        p.drag_y = s.F_drag_viz.y;
+        p.lift_x = s.F_lift_viz.x;
+        p.lift_y = s.F_lift_viz.y;
+        p.weight_x = s.F_weight_viz.x;
+        p.weight_y = s.F_weight_viz.y;
+        return p;
+    }
+
+    // True for a packet of this layout (e.g. after receiving a datagram)
+    bool valid() const
+    {
+        return std::memcmp(magic, "FDTM", 4) == 0 && version == VERSION && size == sizeof(TelemetryPacket);
+    }
+};
+
+// The layout is part of the wire format
+static_assert(sizeof(TelemetryPacket) == 144, "TelemetryPacket layout changed");
+static_assert(offsetof(TelemetryPacket, t) == 16, "TelemetryPacket layout changed");
+static_assert(offsetof(TelemetryPacket, pitch_deg) == 56, "TelemetryPacket layout changed");
+static_assert(offsetof(TelemetryPacket, thrust_x) == 80, "TelemetryPacket layout changed");
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "telemetry_packet.hpp"
+#include "telemetry_ring.hpp"
+#include "../utils/udp_socket.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <stdexcept>
+
+// Where and how often to publish telemetry
+struct TelemetryOptions
+{
+    std::string udp_address;  // IPv4 unicast or multicast group ("" = no UDP)
+    uint16_t udp_port = 5005;
+    int multicast_ttl = 1;    // 1 = stay on the local network
+    std::string shm_name;     // Shared-memory ring name ("" = no ring)
+    uint32_t shm_slots = 1024;
+    double rate_hz = 100.0;   // Samples per simulated second (0 = every physics step)
+
+    bool enabled() const { return !udp_address.empty() || !shm_name.empty(); }
+};
+
+// Publishes TelemetryPacket samples of a running simulation
+//
+// Called from the physics loop after each step, so publish() never blocks
+// and never allocates: the packet is built on the stack, the UDP send is
+// non-blocking (a full socket buffer drops the packet and counts it) and the
+// ring write is wait-free. Samples are spaced by simulated time, so the rate
+// is the same under time warp and in headless runs; a time that jumps back
+// (reset, rewind) restarts the spacing. Outputs are opened by the
+// constructor, which throws if one cannot be.
+class TelemetryPublisher
+{
+public:
+    explicit TelemetryPublisher(const TelemetryOptions &opts)
+        : options(opts), period(opts.rate_hz > 0.0 ? 1.0 / opts.rate_hz : 0.0), next_time(0.0), started(false),
+          sequence(0), sent(0), dropped(0)
+    {
+        if (!options.enabled())
+            throw std::runtime_error("Telemetry needs a UDP address or a shared-memory name");
+        if (!options.udp_address.empty())
+            socket.connect(options.udp_address, options.udp_port, options.multicast_ttl);
+        if (!options.shm_name.empty())
+            ring = std::make_unique<TelemetryRingWriter>(options.shm_name, options.shm_slots);
+    }
+
+    // Publish a sample if one is due at the state's simulated time
+    void publish(const SimulationState &s) noexcept
+    {
+        // Due from half a step before the time, so rounding in t does not delay a sample a whole step
+        const bool went_back = s.t < next_time - 2.0 * period;
+        if (started && s.t + 0.5 * s.dt < next_time && !went_back)
+            return;
+        // Stay on the period grid unless time jumped (reset, rewind, a long gap)
+        if (started && !went_back && s.t < next_time + period)
+            next_time += period;
+        else
+            next_time = s.t + period;
+        started = true;
+        publishNow(s);
+    }
+
+    // Publish a sample regardless of the rate (e.g. the initial state)
+    void publishNow(const SimulationState &s) noexcept
+    {
+        const TelemetryPacket p = TelemetryPacket::fromState(s, sequence++);
+        if (socket.isOpen() && !socket.send(&p, sizeof(p)))
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        if (ring)
+            ring->write(p);
+        sent.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const TelemetryOptions &getOptions() const { return options; }
+
+    // Safe to read from any thread
+    uint64_t packetsSent() const { return sent.load(std::memory_order_relaxed); }
+    uint64_t udpDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    TelemetryOptions options;
+    UdpSocket socket;
+    std::unique_ptr<TelemetryRingWriter> ring;
+    double period;
+    double next_time;
+    bool started;
+    uint32_t sequence;
+    std::atomic<uint64_t> sent;
+    std::atomic<uint64_t> dropped;
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "telemetry_packet.hpp"
+#include "../utils/shared_memory.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <stdexcept>
+
+// Lock-free shared-memory ring of telemetry packets (one writer, any number
+// of readers, same host)
+//
+// Layout of the region: a 64-byte header, then capacity slots of
+// {uint64 sequence, TelemetryPacket}. The writer never waits for readers. It
+// stores packet n in slot n % capacity, marking the slot odd (2n + 1) while
+// copying and even (2n + 2) when done, then publishes written = n + 1. A
+// reader copies a slot and re-checks its sequence, so a slot overwritten
+// mid-copy is detected and skipped rather than returned torn. A reader that
+// falls more than capacity packets behind loses the oldest ones.
+namespace telemetry_ring
+{
+inline constexpr char MAGIC[8] = {'F', 'D', 'T', 'R', 'I', 'N', 'G', '\0'};
+inline constexpr uint32_t VERSION = 1;
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t slot_size;   // sizeof(Slot)
+    uint32_t capacity;    // Slots (power of two)
+    uint32_t packet_size; // sizeof(TelemetryPacket)
+    std::atomic<uint64_t> written; // Packets published so far
+    uint8_t reserved[64 - 32];
+};
+
+struct Slot
+{
+    std::atomic<uint64_t> sequence;
+    TelemetryPacket packet;
+};
+
+static_assert(sizeof(Header) == 64, "Ring header layout changed");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared-memory ring needs lock-free 64-bit atomics");
+
+inline size_t regionSize(uint32_t capacity) { return sizeof(Header) + capacity * sizeof(Slot); }
+} // namespace telemetry_ring
+
+class TelemetryRingWriter
+{
+public:
+    // Create the named region (replacing an old one); capacity is rounded up to a power of two
+    TelemetryRingWriter(const std::string &name, uint32_t capacity = 1024)
+    {
+        uint32_t slots = 1;
+        while (slots < capacity)
+            slots <<= 1;
+        memory = SharedMemory::create(name, telemetry_ring::regionSize(slots));
+
+        header = new (memory.data()) telemetry_ring::Header();
+        header->version = telemetry_ring::VERSION;
+        header->slot_size = sizeof(telemetry_ring::Slot);
+        header->capacity = slots;
+        header->packet_size = sizeof(TelemetryPacket);
+        header->written.store(0, std::memory_order_relaxed);
+        slots_base = reinterpret_cast<telemetry_ring::Slot *>(memory.data() + sizeof(telemetry_ring::Header));
+        for (uint32_t i = 0; i < slots; i++)
+            new (&slots_base[i].sequence) std::atomic<uint64_t>(0);
+        mask = slots - 1;
+
+        // Readers check the magic last, so they never see a half-initialized header
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->magic, telemetry_ring::MAGIC, sizeof(telemetry_ring::MAGIC));
+    }
+
+    // Wait-free: a copy and three stores
+    void write(const TelemetryPacket &p)
+    {
+        uint64_t n = header->written.load(std::memory_order_relaxed);
+        telemetry_ring::Slot &slot = slots_base[n & mask];
+        slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.packet, &p, sizeof(TelemetryPacket));
+        slot.sequence.store(2 * n + 2, std::memory_order_release);
+        header->written.store(n + 1, std::memory_order_release);
+    }
+
+    uint64_t written() const { return header->written.load(std::memory_order_relaxed); }
+    uint32_t capacity() const { return mask + 1; }
+
+private:
+    SharedMemory memory;
+    telemetry_ring::Header *header = nullptr;
+    telemetry_ring::Slot *slots_base = nullptr;
+    uint32_t mask = 0;
+};
+
+class TelemetryRingReader
+{
+public:
+    enum class Result
+    {
+        Packet,  // 'out' holds the next packet
+        Empty,   // Nothing new yet
+        Overrun  // The writer lapped the reader; the cursor skipped ahead
+    };
+
+    // Map an existing ring; starts at the newest packet
+    explicit TelemetryRingReader(const std::string &name) : memory(SharedMemory::open(name))
+    {
+        if (memory.size() < sizeof(telemetry_ring::Header))
+            throw std::runtime_error("Telemetry ring too small: " + name);
+        header = reinterpret_cast<const telemetry_ring::Header *>(memory.data());
+        if (std::memcmp(header->magic, telemetry_ring::MAGIC, sizeof(telemetry_ring::MAGIC)) != 0 ||
+            header->version != telemetry_ring::VERSION || header->slot_size != sizeof(telemetry_ring::Slot) ||
+            header->packet_size != sizeof(TelemetryPacket) || header->capacity == 0 ||
+            (header->capacity & (header->capacity - 1)) != 0 ||
+            memory.size() < telemetry_ring::regionSize(header->capacity))
+        {
+            throw std::runtime_error("Not a telemetry ring (or a different version): " + name);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        slots_base = reinterpret_cast<const telemetry_ring::Slot *>(memory.data() + sizeof(telemetry_ring::Header));
+        mask = header->capacity - 1;
+        cursor = header->written.load(std::memory_order_acquire);
+    }
+
+    // Next packet after the cursor, in order
+    Result next(TelemetryPacket &out)
+    {
+        uint64_t written = header->written.load(std::memory_order_acquire);
+        if (cursor >= written)
+            return Result::Empty;
+        uint64_t oldest = written > mask + 1 ? written - (mask + 1) : 0;
+        if (cursor < oldest)
+        {
+            cursor = oldest;
+            return Result::Overrun;
+        }
+        if (!readSlot(cursor, out))
+        {
+            // Overwritten while copying: everything up to the writer's position is suspect
+            uint64_t now = header->written.load(std::memory_order_acquire);
+            cursor = std::max(cursor + 1, now > mask ? now - mask : 0);
+            return Result::Overrun;
+        }
+        cursor++;
+        return Result::Packet;
+    }
+
+    // Newest complete packet, skipping anything older; false if none yet
+    bool latest(TelemetryPacket &out)
+    {
+        for (int attempt = 0; attempt < 4; attempt++)
+        {
+            uint64_t written = header->written.load(std::memory_order_acquire);
+            if (written == 0)
+                return false;
+            if (readSlot(written - 1, out))
+            {
+                cursor = written;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint64_t position() const { return cursor; }
+    uint32_t capacity() const { return mask + 1; }
+
+private:
+    SharedMemory memory;
+    const telemetry_ring::Header *header = nullptr;
+    const telemetry_ring::Slot *slots_base = nullptr;
+    uint32_t mask = 0;
+    uint64_t cursor = 0;
+
+    bool readSlot(uint64_t n, TelemetryPacket &out) const
+    {
+        const telemetry_ring::Slot &slot = slots_base[n & mask];
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * n + 2)
+            return false;
+        std::memcpy(&out, &slot.packet, sizeof(TelemetryPacket));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == before;
+    }
+};
@@ -1,19 +1,14 @@
 #pragma once
 
 #include <SDL3/SDL.h>
+#include "config_watcher.hpp" // AircraftConfigEntry
+#include <memory>
 #include <string>
 #include <vector>
 #include <filesystem>
 #include <fstream>
 #include <algorithm>
 
-// Aircraft configuration entry
-struct AircraftConfigEntry
-{
-    std::string name;
-    std::string filepath;
-};
-
 // Manages loading and scanning of aircraft configuration files
 class AircraftConfigManager
 {
@@ -129,7 +124,18 @@ public:
                     {
                         filename[0] = std::toupper(filename[0]);
                     }
-                    configs.push_back({filename, filepath});
+                    // Warm the shared aero table cache so selecting the config
+                    // later does not parse its table again
+                    std::shared_ptr<const AeroDataTable> table;
+                    try
+                    {
+                        table = AircraftLoader::loadFromJSON(filepath).aeroTable;
+                    }
+                    catch (const std::exception &e)
+                    {
+                        SDL_Log("Warning: Failed to read aircraft config %s: %s", filepath.c_str(), e.what());
+                    }
+                    configs.push_back({filename, filepath, table});
                 }
             }
         }
@@ -145,7 +151,7 @@ public:
         if (configs.empty())
         {
             SDL_Log("No aircraft configs found, using embedded default");
-            configs.push_back({"Default (Embedded)", ""});
+            configs.push_back({"Default (Embedded)", "", nullptr});
         }
         else
         {
@@ -0,0 +1,299 @@
+#pragma once
+
+#include "../aircraft/aircraft_loader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// Aircraft configuration entry
+struct AircraftConfigEntry
+{
+    std::string name;
+    std::string filepath;
+    std::shared_ptr<const AeroDataTable> aeroTable; // Keeps the cached table alive while listed
+};
+
+// Outcome of a config load done by ConfigWatcher
+struct ConfigLoadResult
+{
+    std::string filepath;
+    std::shared_ptr<const Aircraft> aircraft; // Null if loading failed
+    std::string error;
+    bool reload = false; // File changed on disk (otherwise an explicit request)
+};
+
+// Scans, loads and watches aircraft configs on a background thread
+//
+// The UI thread only polls for finished work (takeConfigs/takeResult), so a
+// large or slow config directory never stalls a frame. After a config has
+// been loaded its JSON and aero CSV are polled for changes every
+// poll_interval seconds; an edit is re-parsed off-thread and reported as a
+// reload, which the caller hands to the simulation thread (LoadAircraft
+// swaps it in at a step boundary). The directories of the listed configs are
+// watched the same way and trigger a rescan when files come or go.
+//
+// Change detection compares modification time and size, which works the
+// same on every platform and on network shares without notification support.
+class ConfigWatcher
+{
+public:
+    using ScanFunction = std::function<std::vector<AircraftConfigEntry>()>;
+
+    explicit ConfigWatcher(ScanFunction scan, double poll_interval = 0.5)
+        : scan(std::move(scan)), poll_interval(poll_interval)
+    {
+    }
+
+    ~ConfigWatcher() { stop(); }
+
+    ConfigWatcher(const ConfigWatcher &) = delete;
+    ConfigWatcher &operator=(const ConfigWatcher &) = delete;
+
+    // Starts with a scan of the config directory
+    void start()
+    {
+        if (worker.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = true;
+            rescan_requested = true;
+        }
+        worker = std::thread([this]
+                             { run(); });
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wake.notify_all();
+        if (worker.joinable())
+            worker.join();
+    }
+
+    // Load a config off-thread and watch it from then on. Replaces any
+    // previously watched config.
+    void requestLoad(const std::string &filepath)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            load_requests.push_back(filepath);
+        }
+        wake.notify_all();
+    }
+
+    void requestRescan()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            rescan_requested = true;
+        }
+        wake.notify_all();
+    }
+
+    // UI thread: the newest config list, if one arrived since the last call
+    bool takeConfigs(std::vector<AircraftConfigEntry> &out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!configs_ready)
+            return false;
+        out = std::move(configs);
+        configs_ready = false;
+        return true;
+    }
+
+    // UI thread: next finished load or reload
+    bool takeResult(ConfigLoadResult &out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (results.empty())
+            return false;
+        out = std::move(results.front());
+        results.pop_front();
+        return true;
+    }
+
+    // True until the first scan has been published
+    bool scanning() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !scanned;
+    }
+
+private:
+    // What a file looked like when last checked
+    struct FileStamp
+    {
+        bool exists = false;
+        std::filesystem::file_time_type mtime{};
+        uintmax_t size = 0;
+
+        bool operator==(const FileStamp &o) const
+        {
+            return exists == o.exists && mtime == o.mtime && size == o.size;
+        }
+        bool operator!=(const FileStamp &o) const { return !(*this == o); }
+    };
+
+    struct WatchedFile
+    {
+        std::string path;
+        FileStamp stamp;
+    };
+
+    static FileStamp stampOf(const std::string &path)
+    {
+        FileStamp s;
+        std::error_code ec;
+        s.mtime = std::filesystem::last_write_time(path, ec);
+        if (ec)
+            return FileStamp();
+        if (!std::filesystem::is_directory(path, ec))
+            s.size = std::filesystem::file_size(path, ec);
+        s.exists = !ec;
+        return s;
+    }
+
+    static bool changed(std::vector<WatchedFile> &files)
+    {
+        bool any = false;
+        for (WatchedFile &f : files)
+        {
+            FileStamp now = stampOf(f.path);
+            if (now != f.stamp)
+            {
+                f.stamp = now;
+                any = true;
+            }
+        }
+        return any;
+    }
+
+    static std::vector<WatchedFile> stamped(const std::vector<std::string> &paths)
+    {
+        std::vector<WatchedFile> files;
+        for (const std::string &p : paths)
+            files.push_back({p, stampOf(p)});
+        return files;
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running)
+        {
+            bool rescan = rescan_requested;
+            rescan_requested = false;
+            std::deque<std::string> requests;
+            requests.swap(load_requests);
+            lock.unlock();
+
+            if (rescan || changed(watched_dirs))
+                doScan();
+            if (!requests.empty())
+                doLoad(requests.back(), false); // Only the newest request matters
+            else if (!watched_config.empty() && changed(watched_files))
+                doLoad(watched_config, true);
+
+            lock.lock();
+            if (!running || rescan_requested || !load_requests.empty())
+                continue;
+            wake.wait_for(lock, std::chrono::duration<double>(poll_interval));
+        }
+    }
+
+    void doScan()
+    {
+        std::vector<AircraftConfigEntry> list;
+        try
+        {
+            list = scan();
+        }
+        catch (const std::exception &)
+        {
+            return; // Keep the previous list; the directory is polled again
+        }
+
+        std::vector<std::string> dirs;
+        for (const AircraftConfigEntry &e : list)
+        {
+            if (e.filepath.empty())
+                continue;
+            std::string dir = std::filesystem::path(e.filepath).parent_path().string();
+            if (dir.empty())
+                dir = ".";
+            if (std::find(dirs.begin(), dirs.end(), dir) == dirs.end())
+                dirs.push_back(dir);
+        }
+        watched_dirs = stamped(dirs);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        configs = std::move(list);
+        configs_ready = true;
+        scanned = true;
+    }
+
+    void doLoad(const std::string &filepath, bool reload)
+    {
+        ConfigLoadResult result;
+        result.filepath = filepath;
+        result.reload = reload;
+
+        // Stamp before parsing so an edit made during the load is seen next poll
+        std::vector<WatchedFile> files = {{filepath, stampOf(filepath)}};
+        try
+        {
+            Aircraft ac = AircraftLoader::loadFromJSON(filepath);
+            if (!ac.aeroDataFile.empty())
+            {
+                std::string aero = (std::filesystem::path(filepath).parent_path() / ac.aeroDataFile).string();
+                files.push_back({aero, stampOf(aero)});
+                if (!ac.aeroTable)
+                    throw std::runtime_error("Failed to load aero data file: " + aero);
+            }
+            result.aircraft = std::make_shared<const Aircraft>(std::move(ac));
+        }
+        catch (const std::exception &e)
+        {
+            result.error = e.what();
+        }
+        if (!reload)
+            watched_config = filepath;
+        if (watched_config == filepath)
+            watched_files = std::move(files);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        results.push_back(std::move(result));
+    }
+
+    ScanFunction scan;
+    double poll_interval;
+    std::thread worker;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    bool running = false;
+    bool rescan_requested = false;
+    bool scanned = false;
+    std::deque<std::string> load_requests;
+    std::vector<AircraftConfigEntry> configs;
+    bool configs_ready = false;
+    std::deque<ConfigLoadResult> results;
+
+    // Worker thread only
+    std::string watched_config;
+    std::vector<WatchedFile> watched_files;
+    std::vector<WatchedFile> watched_dirs;
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only memory mapping of a whole file
+//
+// Pages are loaded by the OS on first access and can be dropped again under
+// memory pressure, so files much larger than RAM can be read at random
+// without copying them into the process.
+class MappedFile
+{
+public:
+    MappedFile() : base(nullptr), length(0) {}
+
+    explicit MappedFile(const std::string &filepath) : base(nullptr), length(0)
+    {
+        open(filepath);
+    }
+
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept : base(other.base), length(other.length)
+    {
+        other.base = nullptr;
+        other.length = 0;
+    }
+
+    MappedFile &operator=(MappedFile &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            base = other.base;
+            length = other.length;
+            other.base = nullptr;
+            other.length = 0;
+        }
+        return *this;
+    }
+
+    void open(const std::string &filepath)
+    {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("Failed to open file: " + filepath);
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+        {
+            CloseHandle(file);
+            throw std::runtime_error("Failed to get file size: " + filepath);
+        }
+        length = static_cast<size_t>(size.QuadPart);
+        if (length > 0)
+        {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping)
+            {
+                base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+        if (length > 0 && !base)
+        {
+            length = 0;
+            throw std::runtime_error("Failed to map file: " + filepath);
+        }
+#else
+        int fd = ::open(filepath.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Failed to open file: " + filepath);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Failed to get file size: " + filepath);
+        }
+        length = static_cast<size_t>(st.st_size);
+        if (length > 0)
+        {
+            void *p = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                ::close(fd);
+                length = 0;
+                throw std::runtime_error("Failed to map file: " + filepath);
+            }
+            base = p;
+        }
+        ::close(fd); // The mapping keeps the file referenced
+#endif
+    }
+
+    void close()
+    {
+        if (base)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(base);
+#else
+            munmap(base, length);
+#endif
+        }
+        base = nullptr;
+        length = 0;
+    }
+
+    // Ask the OS to start reading a range in ahead of use; no-op where unsupported
+    void prefetch(size_t offset, size_t bytes) const
+    {
+#ifndef _WIN32
+        if (!base || offset >= length)
+            return;
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t start = offset / page * page;
+        size_t end = std::min(length, offset + bytes);
+        madvise(static_cast<char *>(base) + start, end - start, MADV_WILLNEED);
+#else
+        (void)offset;
+        (void)bytes;
+#endif
+    }
+
+    const uint8_t *data() const { return static_cast<const uint8_t *>(base); }
+    size_t size() const { return length; }
+    bool isOpen() const { return base != nullptr; }
+
+private:
+    void *base;
+    size_t length;
+};
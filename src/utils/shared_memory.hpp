@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Named shared memory region, read-write mapped
+//
+// create() makes (or replaces) a zero-filled region of a given size and
+// owns the name: on POSIX it is unlinked again when the owner closes, so a
+// consumer that still has it mapped keeps its pages but new consumers cannot
+// open a stale region. open() maps an existing region by name. Names are
+// plain identifiers ("flightsim_telemetry"); the platform prefix is added.
+class SharedMemory
+{
+public:
+    SharedMemory() : base(nullptr), length(0), owner(false) {}
+
+    ~SharedMemory() { close(); }
+
+    SharedMemory(const SharedMemory &) = delete;
+    SharedMemory &operator=(const SharedMemory &) = delete;
+
+    SharedMemory(SharedMemory &&other) noexcept
+        : base(other.base), length(other.length), owner(other.owner), name(std::move(other.name))
+    {
+#ifdef _WIN32
+        mapping = other.mapping;
+        other.mapping = nullptr;
+#endif
+        other.base = nullptr;
+        other.length = 0;
+        other.owner = false;
+    }
+
+    SharedMemory &operator=(SharedMemory &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            base = other.base;
+            length = other.length;
+            owner = other.owner;
+            name = std::move(other.name);
+#ifdef _WIN32
+            mapping = other.mapping;
+            other.mapping = nullptr;
+#endif
+            other.base = nullptr;
+            other.length = 0;
+            other.owner = false;
+        }
+        return *this;
+    }
+
+    static SharedMemory create(const std::string &name, size_t bytes)
+    {
+        SharedMemory m;
+        m.name = name;
+        m.length = bytes;
+        m.owner = true;
+#ifdef _WIN32
+        HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                            static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32),
+                                            static_cast<DWORD>(bytes & 0xFFFFFFFFu), name.c_str());
+        if (!mapping)
+            throw std::runtime_error("Failed to create shared memory: " + name);
+        m.base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+        m.mapping = mapping;
+        if (!m.base)
+            throw std::runtime_error("Failed to map shared memory: " + name);
+        std::memset(m.base, 0, bytes); // An existing region of that name may hold old data
+#else
+        std::string path = "/" + name;
+        shm_unlink(path.c_str()); // Replace a region left behind by a crashed run
+        int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+            throw std::runtime_error("Failed to create shared memory: " + name);
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+        {
+            ::close(fd);
+            shm_unlink(path.c_str());
+            throw std::runtime_error("Failed to size shared memory: " + name);
+        }
+        m.map(fd);
+#endif
+        return m;
+    }
+
+    static SharedMemory open(const std::string &name)
+    {
+        SharedMemory m;
+        m.name = name;
+#ifdef _WIN32
+        HANDLE mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+        if (!mapping)
+            throw std::runtime_error("Failed to open shared memory: " + name);
+        m.mapping = mapping;
+        m.base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+        if (!m.base)
+            throw std::runtime_error("Failed to map shared memory: " + name);
+        MEMORY_BASIC_INFORMATION info;
+        VirtualQuery(m.base, &info, sizeof(info));
+        m.length = info.RegionSize; // Rounded up to whole pages
+#else
+        int fd = shm_open(("/" + name).c_str(), O_RDWR, 0);
+        if (fd < 0)
+            throw std::runtime_error("Failed to open shared memory: " + name);
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Failed to get shared memory size: " + name);
+        }
+        m.length = static_cast<size_t>(st.st_size);
+        m.map(fd);
+#endif
+        return m;
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+        if (base)
+            UnmapViewOfFile(base);
+        if (mapping)
+            CloseHandle(mapping);
+        mapping = nullptr;
+#else
+        if (base)
+            munmap(base, length);
+        if (owner)
+            shm_unlink(("/" + name).c_str());
+#endif
+        base = nullptr;
+        length = 0;
+        owner = false;
+    }
+
+    uint8_t *data() const { return static_cast<uint8_t *>(base); }
+    size_t size() const { return length; }
+    bool isOpen() const { return base != nullptr; }
+
+private:
+    void *base;
+    size_t length;
+    bool owner;
+    std::string name;
+#ifdef _WIN32
+    HANDLE mapping = nullptr;
+#else
+    void map(int fd)
+    {
+        void *p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd); // The mapping keeps the region referenced
+        if (p == MAP_FAILED)
+        {
+            length = 0;
+            throw std::runtime_error("Failed to map shared memory: " + name);
+        }
+        base = p;
+    }
+#endif
+};
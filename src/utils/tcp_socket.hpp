@@ -0,0 +1,275 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Blocking IPv4 TCP stream (one end of a connection)
+//
+// sendAll() and receiveAll() move whole buffers: they return only once every
+// byte went through, and throw std::runtime_error if the peer closed the
+// connection or the receive timeout expired. Nagle's algorithm is off, since
+// the users exchange small request/reply messages.
+class TcpStream
+{
+public:
+    TcpStream() : handle(INVALID) {}
+
+    ~TcpStream() { close(); }
+
+    TcpStream(const TcpStream &) = delete;
+    TcpStream &operator=(const TcpStream &) = delete;
+
+    TcpStream(TcpStream &&other) noexcept : handle(other.handle) { other.handle = INVALID; }
+
+    TcpStream &operator=(TcpStream &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            handle = other.handle;
+            other.handle = INVALID;
+        }
+        return *this;
+    }
+
+    // Connect to host (name or IPv4 address) and port
+    void connect(const std::string &host, uint16_t port)
+    {
+        close();
+        startNetworking();
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo *found = nullptr;
+        if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &found) != 0 || !found)
+            throw std::runtime_error("Cannot resolve host: " + host);
+
+        handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        bool connected = handle != INVALID && ::connect(handle, found->ai_addr, static_cast<int>(found->ai_addrlen)) == 0;
+        freeaddrinfo(found);
+        if (!connected)
+        {
+            close();
+            throw std::runtime_error("Cannot connect to " + host + ":" + std::to_string(port));
+        }
+        configure();
+    }
+
+    // Fail receives that wait longer than this (0 = wait forever)
+    void setReceiveTimeout(double seconds)
+    {
+#ifdef _WIN32
+        DWORD ms = static_cast<DWORD>(seconds * 1000.0);
+        setsockopt(handle, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char *>(&ms), sizeof(ms));
+#else
+        timeval tv{};
+        tv.tv_sec = static_cast<time_t>(seconds);
+        tv.tv_usec = static_cast<suseconds_t>((seconds - static_cast<double>(tv.tv_sec)) * 1e6);
+        setsockopt(handle, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+#endif
+    }
+
+    void sendAll(const void *data, size_t bytes)
+    {
+        const char *p = static_cast<const char *>(data);
+        while (bytes > 0)
+        {
+            int chunk = static_cast<int>(bytes < (1u << 30) ? bytes : (1u << 30));
+            auto sent = ::send(handle, p, chunk, SEND_FLAGS);
+            if (sent <= 0)
+                throw std::runtime_error("Connection lost while sending");
+            p += sent;
+            bytes -= static_cast<size_t>(sent);
+        }
+    }
+
+    void receiveAll(void *data, size_t bytes)
+    {
+        char *p = static_cast<char *>(data);
+        while (bytes > 0)
+        {
+            int chunk = static_cast<int>(bytes < (1u << 30) ? bytes : (1u << 30));
+            auto got = ::recv(handle, p, chunk, 0);
+            if (got <= 0)
+                throw std::runtime_error(got == 0 ? "Connection closed by peer" : "Connection lost while receiving");
+            p += got;
+            bytes -= static_cast<size_t>(got);
+        }
+    }
+
+    // Remote address as "ip:port" (empty if not connected)
+    std::string peerName() const
+    {
+        sockaddr_in peer{};
+        socklen_t length = sizeof(peer);
+        if (handle == INVALID || getpeername(handle, reinterpret_cast<sockaddr *>(&peer), &length) != 0)
+            return "";
+        char text[INET_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET, &peer.sin_addr, text, sizeof(text));
+        return std::string(text) + ":" + std::to_string(ntohs(peer.sin_port));
+    }
+
+    bool isOpen() const { return handle != INVALID; }
+
+    // Stop both directions; a thread blocked in receiveAll() returns with an error
+    void shutdown()
+    {
+        if (handle != INVALID)
+        {
+#ifdef _WIN32
+            ::shutdown(handle, SD_BOTH);
+#else
+            ::shutdown(handle, SHUT_RDWR);
+#endif
+        }
+    }
+
+    void close()
+    {
+        if (handle == INVALID)
+            return;
+#ifdef _WIN32
+        closesocket(handle);
+#else
+        ::close(handle);
+#endif
+        handle = INVALID;
+    }
+
+    // Winsock is started once per process and left running
+    static void startNetworking()
+    {
+#ifdef _WIN32
+        static const bool started = []
+        {
+            WSADATA wsa;
+            return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+        }();
+        if (!started)
+            throw std::runtime_error("Failed to start Winsock");
+#endif
+    }
+
+private:
+    friend class TcpListener;
+
+#ifdef _WIN32
+    using Handle = SOCKET;
+    static constexpr Handle INVALID = INVALID_SOCKET;
+    static constexpr int SEND_FLAGS = 0;
+#else
+    using Handle = int;
+    static constexpr Handle INVALID = -1;
+    static constexpr int SEND_FLAGS = MSG_NOSIGNAL; // A closed peer is an error, not SIGPIPE
+#endif
+
+    Handle handle;
+
+    explicit TcpStream(Handle h) : handle(h) { configure(); }
+
+    void configure()
+    {
+        int one = 1;
+        setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&one), sizeof(one));
+    }
+};
+
+// Listening IPv4 TCP socket
+class TcpListener
+{
+public:
+    TcpListener() : handle(TcpStream::INVALID) {}
+
+    ~TcpListener() { close(); }
+
+    TcpListener(const TcpListener &) = delete;
+    TcpListener &operator=(const TcpListener &) = delete;
+
+    // Listen on all interfaces (port 0 = any free port, see localPort())
+    void listen(uint16_t port)
+    {
+        close();
+        TcpStream::startNetworking();
+        handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (handle == TcpStream::INVALID)
+            throw std::runtime_error("Failed to create TCP socket");
+        int reuse = 1;
+        setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+
+        sockaddr_in local{};
+        local.sin_family = AF_INET;
+        local.sin_port = htons(port);
+        local.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (::bind(handle, reinterpret_cast<const sockaddr *>(&local), sizeof(local)) != 0 ||
+            ::listen(handle, SOMAXCONN) != 0)
+        {
+            close();
+            throw std::runtime_error("Failed to listen on TCP port " + std::to_string(port));
+        }
+    }
+
+    // Next incoming connection, or a closed stream if none arrived within timeout seconds
+    TcpStream accept(double timeout)
+    {
+#ifdef _WIN32
+        WSAPOLLFD fd = {handle, POLLRDNORM, 0};
+        int ready = WSAPoll(&fd, 1, static_cast<int>(timeout * 1000.0));
+#else
+        pollfd fd = {handle, POLLIN, 0};
+        int ready = poll(&fd, 1, static_cast<int>(timeout * 1000.0));
+#endif
+        if (ready <= 0)
+            return TcpStream();
+        TcpStream::Handle h = ::accept(handle, nullptr, nullptr);
+        return h == TcpStream::INVALID ? TcpStream() : TcpStream(h);
+    }
+
+    uint16_t localPort() const
+    {
+        sockaddr_in local{};
+        socklen_t length = sizeof(local);
+        if (handle == TcpStream::INVALID || getsockname(handle, reinterpret_cast<sockaddr *>(&local), &length) != 0)
+            return 0;
+        return ntohs(local.sin_port);
+    }
+
+    bool isOpen() const { return handle != TcpStream::INVALID; }
+
+    void close()
+    {
+        if (handle == TcpStream::INVALID)
+            return;
+#ifdef _WIN32
+        closesocket(handle);
+#else
+        ::close(handle);
+#endif
+        handle = TcpStream::INVALID;
+    }
+
+private:
+    TcpStream::Handle handle;
+};
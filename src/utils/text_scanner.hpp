@@ -0,0 +1,166 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <system_error>
+
+// Parse failure with the position it happened at
+// what() reads "source:line:column: message" (1-based line and column).
+class ParseError : public std::runtime_error
+{
+public:
+    ParseError(const std::string &source, size_t line, size_t column, const std::string &message)
+        : std::runtime_error(source + ":" + std::to_string(line) + ":" + std::to_string(column) + ": " + message),
+          line_(line), column_(column)
+    {
+    }
+
+    size_t line() const { return line_; }
+    size_t column() const { return column_; }
+
+private:
+    size_t line_;
+    size_t column_;
+};
+
+// Forward-only cursor over a text buffer for hand-written single-pass parsers
+//
+// Nothing is copied: tokens are returned as views into the buffer, and
+// numbers are converted in place with std::from_chars. Line and column are
+// only worked out when an error is reported, so the happy path is a plain
+// pointer walk.
+class TextScanner
+{
+public:
+    // source names the buffer in error messages and must outlive the scanner
+    TextScanner(const char *begin, const char *end, std::string_view source)
+        : begin(begin), end(end), p(begin), source(source)
+    {
+    }
+
+    bool atEnd() const { return p >= end; }
+    char peek() const { return p < end ? *p : '\0'; }
+    const char *position() const { return p; }
+    void advance() { p++; }
+
+    // Spaces, tabs and carriage returns (stays on the line)
+    void skipSpaces()
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+            p++;
+    }
+
+    // Any whitespace including newlines
+    void skipWhitespace()
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+            p++;
+    }
+
+    bool atLineEnd() const { return p >= end || *p == '\n' || *p == '\r'; }
+
+    // Move past the end of the current line
+    void skipLine()
+    {
+        while (p < end && *p != '\n')
+            p++;
+        if (p < end)
+            p++;
+    }
+
+    bool consume(char c)
+    {
+        if (p < end && *p == c)
+        {
+            p++;
+            return true;
+        }
+        return false;
+    }
+
+    bool consume(std::string_view word)
+    {
+        if (static_cast<size_t>(end - p) >= word.size() && std::memcmp(p, word.data(), word.size()) == 0)
+        {
+            p += word.size();
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c, const char *what)
+    {
+        if (!consume(c))
+            fail(std::string("expected ") + what);
+    }
+
+    // Characters up to (not including) the first of the stop characters or the end of the line
+    std::string_view token(const char *stops)
+    {
+        const char *start = p;
+        while (p < end && *p != '\n' && std::strchr(stops, *p) == nullptr)
+            p++;
+        return std::string_view(start, static_cast<size_t>(p - start));
+    }
+
+    // Decimal floating point number (no leading '+', no surrounding spaces)
+    double number()
+    {
+        double value = 0.0;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        std::from_chars_result r = std::from_chars(p, end, value);
+        if (r.ec == std::errc::invalid_argument)
+            fail("expected a number");
+        if (r.ec == std::errc::result_out_of_range)
+            fail("number out of range");
+        p = r.ptr;
+#else
+        // Standard libraries without floating-point from_chars: strtod on a
+        // bounded, NUL-terminated copy (still no heap allocation)
+        char buffer[64];
+        size_t n = 0;
+        while (p + n < end && n + 1 < sizeof(buffer) && p[n] != '\0' && std::strchr("0123456789+-.eEinfINFaA", p[n]) != nullptr)
+            n++;
+        std::memcpy(buffer, p, n);
+        buffer[n] = '\0';
+        char *stop = nullptr;
+        value = std::strtod(buffer, &stop);
+        if (stop == buffer || buffer[0] == '+')
+            fail("expected a number");
+        p += stop - buffer;
+#endif
+        return value;
+    }
+
+    // Report an error at the current position
+    [[noreturn]] void fail(const std::string &message) const { failAt(p, message); }
+
+    [[noreturn]] void failAt(const char *where, const std::string &message) const
+    {
+        size_t line = 1, column = 1;
+        for (const char *c = begin; c < where && c < end; c++)
+        {
+            if (*c == '\n')
+            {
+                line++;
+                column = 1;
+            }
+            else
+            {
+                column++;
+            }
+        }
+        throw ParseError(std::string(source), line, column, message);
+    }
+
+private:
+    const char *begin;
+    const char *end;
+    const char *p;
+    std::string_view source;
+};
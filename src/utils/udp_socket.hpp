@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Non-blocking IPv4 UDP socket
+//
+// connect() makes a sender for one destination (unicast or a multicast
+// group), bind() a receiver. Neither send() nor receive() ever waits: a
+// datagram that does not fit in the socket buffer is dropped and send()
+// returns false.
+class UdpSocket
+{
+public:
+    UdpSocket() : handle(INVALID), destination() {}
+
+    ~UdpSocket() { close(); }
+
+    UdpSocket(const UdpSocket &) = delete;
+    UdpSocket &operator=(const UdpSocket &) = delete;
+
+    UdpSocket(UdpSocket &&other) noexcept : handle(other.handle), destination(other.destination)
+    {
+        other.handle = INVALID;
+    }
+
+    UdpSocket &operator=(UdpSocket &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            handle = other.handle;
+            destination = other.destination;
+            other.handle = INVALID;
+        }
+        return *this;
+    }
+
+    // Sender to address:port. Multicast groups get the TTL and loopback, so
+    // receivers on the same host see the packets too.
+    void connect(const std::string &address, uint16_t port, int multicast_ttl = 1)
+    {
+        open();
+        destination = makeAddress(address, port);
+        if (isMulticast(destination.sin_addr))
+        {
+            int ttl = multicast_ttl;
+            unsigned char loop = 1;
+            setsockopt(handle, IPPROTO_IP, IP_MULTICAST_TTL, reinterpret_cast<const char *>(&ttl), sizeof(ttl));
+            setsockopt(handle, IPPROTO_IP, IP_MULTICAST_LOOP, reinterpret_cast<const char *>(&loop), sizeof(loop));
+        }
+    }
+
+    // Receiver on port (0 = any free port, see localPort()), joining group
+    // if it is a multicast address
+    void bind(uint16_t port, const std::string &group = "")
+    {
+        open();
+        int reuse = 1;
+        setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+
+        sockaddr_in local = makeAddress("0.0.0.0", port);
+        if (::bind(handle, reinterpret_cast<const sockaddr *>(&local), sizeof(local)) != 0)
+        {
+            close();
+            throw std::runtime_error("Failed to bind UDP port " + std::to_string(port));
+        }
+        if (!group.empty())
+        {
+            ip_mreq request{};
+            request.imr_multiaddr = makeAddress(group, port).sin_addr;
+            request.imr_interface.s_addr = htonl(INADDR_ANY);
+            if (!isMulticast(request.imr_multiaddr) ||
+                setsockopt(handle, IPPROTO_IP, IP_ADD_MEMBERSHIP, reinterpret_cast<const char *>(&request),
+                           sizeof(request)) != 0)
+            {
+                close();
+                throw std::runtime_error("Failed to join multicast group: " + group);
+            }
+        }
+    }
+
+    // Queue one datagram; false if it was dropped (buffer full, no route)
+    bool send(const void *data, size_t bytes)
+    {
+        if (handle == INVALID)
+            return false;
+        auto sent = sendto(handle, static_cast<const char *>(data), static_cast<int>(bytes), 0,
+                           reinterpret_cast<const sockaddr *>(&destination), sizeof(destination));
+        return sent == static_cast<decltype(sent)>(bytes);
+    }
+
+    // Bytes of the next waiting datagram copied into data, 0 if none is waiting
+    size_t receive(void *data, size_t bytes)
+    {
+        if (handle == INVALID)
+            return 0;
+        auto got = recv(handle, static_cast<char *>(data), static_cast<int>(bytes), 0);
+        return got > 0 ? static_cast<size_t>(got) : 0;
+    }
+
+    uint16_t localPort() const
+    {
+        sockaddr_in local{};
+        socklen_t length = sizeof(local);
+        if (handle == INVALID || getsockname(handle, reinterpret_cast<sockaddr *>(&local), &length) != 0)
+            return 0;
+        return ntohs(local.sin_port);
+    }
+
+    bool isOpen() const { return handle != INVALID; }
+
+    void close()
+    {
+        if (handle == INVALID)
+            return;
+#ifdef _WIN32
+        closesocket(handle);
+#else
+        ::close(handle);
+#endif
+        handle = INVALID;
+    }
+
+    static bool isMulticast(const std::string &address)
+    {
+        in_addr a{};
+        return inet_pton(AF_INET, address.c_str(), &a) == 1 && isMulticast(a);
+    }
+
+private:
+#ifdef _WIN32
+    using Handle = SOCKET;
+    static constexpr Handle INVALID = INVALID_SOCKET;
+#else
+    using Handle = int;
+    static constexpr Handle INVALID = -1;
+#endif
+
+    Handle handle;
+    sockaddr_in destination;
+
+    void open()
+    {
+        close();
+#ifdef _WIN32
+        // Winsock is started once per process and left running
+        static const bool started = []
+        {
+            WSADATA wsa;
+            return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+        }();
+        if (!started)
+            throw std::runtime_error("Failed to start Winsock");
+#endif
+        handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (handle == INVALID)
+            throw std::runtime_error("Failed to create UDP socket");
+#ifdef _WIN32
+        u_long non_blocking = 1;
+        ioctlsocket(handle, FIONBIO, &non_blocking);
+#else
+        fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    }
+
+    static sockaddr_in makeAddress(const std::string &address, uint16_t port)
+    {
+        sockaddr_in a{};
+        a.sin_family = AF_INET;
+        a.sin_port = htons(port);
+        if (inet_pton(AF_INET, address.c_str(), &a.sin_addr) != 1)
+            throw std::runtime_error("Invalid IPv4 address: " + address);
+        return a;
+    }
+
+    static bool isMulticast(const in_addr &a) { return (ntohl(a.s_addr) & 0xF0000000u) == 0xE0000000u; }
+};
@@ -2,7 +2,12 @@
 #include "catch_amalgamated.hpp"
 #include "aerodynamics/aero.hpp"
 #include "aerodynamics/aero_data.hpp"
+#include "aerodynamics/aero_table_cache.hpp"
 #include "environment/atmosphere.hpp" // for g if needed
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 
 const double tol = 1e-6; // Tolerance for floating-point comparisons
 
@@ -92,3 +97,415 @@ TEST_CASE("AeroDataTable basic functionality")
     REQUIRE(table.getMinAlpha() == 0.0);
     REQUIRE(table.getMaxAlpha() == 0.0);
 }
+
+namespace
+{
+// Reference: linear scan with the documented extrapolation/clamping rules
+AeroCoefficients referenceLookup(const std::vector<AeroDataTable::DataPoint> &pts, double alpha)
+{
+    size_t n = pts.size();
+    size_t i = 0;
+    if (alpha > pts.back().alpha)
+        i = n - 2;
+    else
+        while (i + 2 < n && alpha > pts[i + 1].alpha)
+            i++;
+    double t = (alpha - pts[i].alpha) / (pts[i + 1].alpha - pts[i].alpha);
+    double CL = pts[i].CL + t * (pts[i + 1].CL - pts[i].CL);
+    double CD = pts[i].CD + t * (pts[i + 1].CD - pts[i].CD);
+    if (alpha < pts.front().alpha)
+        return {std::max(0.0, CL), pts.front().CD};
+    if (alpha > pts.back().alpha)
+        return {std::max(0.0, CL), pts.back().CD};
+    return {CL, CD};
+}
+
+void requireMatchesReference(const AeroDataTable &table, const std::vector<AeroDataTable::DataPoint> &pts)
+{
+    for (double deg = -30.0; deg <= 30.0; deg += 0.37)
+    {
+        double alpha = deg * M_PI / 180.0;
+        AeroCoefficients expected = referenceLookup(pts, alpha);
+        AeroCoefficients c = table.getCLCD(alpha);
+        REQUIRE(std::abs(c.CL - expected.CL) < 1e-9);
+        REQUIRE(std::abs(c.CD - expected.CD) < 1e-9);
+        REQUIRE(c.CL == table.getCL(alpha));
+        REQUIRE(c.CD == table.getCD(alpha));
+    }
+}
+} // namespace
+
+TEST_CASE("AeroDataTable uniform grid lookup")
+{
+    std::vector<AeroDataTable::DataPoint> pts;
+    for (int i = 0; i <= 40; i++)
+    {
+        double deg = -10.0 + 0.5 * i;
+        pts.push_back({deg * M_PI / 180.0, 0.1 * deg + 0.2, 0.02 + 0.0005 * deg * deg});
+    }
+    AeroDataTable table = AeroDataTable::fromPoints(pts);
+    REQUIRE(table.isUniform());
+    requireMatchesReference(table, pts);
+}
+
+TEST_CASE("AeroDataTable resamples whole-multiple spacing onto a uniform grid")
+{
+    // 2 deg spacing at the ends, 0.5 deg around the stall
+    std::vector<AeroDataTable::DataPoint> pts;
+    double deg = -10.0;
+    while (deg <= 20.0 + 1e-9)
+    {
+        pts.push_back({deg * M_PI / 180.0, std::sin(deg * M_PI / 90.0), 0.03 + 0.001 * deg * deg});
+        deg += (deg >= 8.0 && deg < 14.0) ? 0.5 : 2.0;
+    }
+    AeroDataTable table = AeroDataTable::fromPoints(pts);
+    REQUIRE(table.isUniform());
+    REQUIRE(table.size() == pts.size());
+    requireMatchesReference(table, pts);
+}
+
+TEST_CASE("AeroDataTable non-uniform table falls back to binary search")
+{
+    std::vector<AeroDataTable::DataPoint> pts = {
+        {-0.1, 0.0, 0.03}, {0.0, 0.3, 0.025}, {0.07, 0.75, 0.03}, {0.123, 1.1, 0.045}, {0.3, 0.9, 0.12}};
+    AeroDataTable table = AeroDataTable::fromPoints(pts);
+    REQUIRE_FALSE(table.isUniform());
+    requireMatchesReference(table, pts);
+}
+
+TEST_CASE("AeroDataTable fused lookup through calcCLCD")
+{
+    std::vector<AeroDataTable::DataPoint> pts = {{0.0, 0.4, 0.025}, {0.174533, 0.8, 0.030}, {0.349066, 1.2, 0.050}};
+    AeroDataTable table = AeroDataTable::fromPoints(pts);
+
+    AeroCoefficients c = calcCLCD(0.1, 0.01, &table);
+    REQUIRE(std::abs(c.CL - calcCL(0.1, &table)) < tol);
+    REQUIRE(std::abs(c.CD - calcCD(0.1, 0.01, &table)) < tol);
+
+    AeroCoefficients none = calcCLCD(0.1, 0.01, nullptr);
+    REQUIRE(none.CL == 0.0);
+    REQUIRE(none.CD == 0.0);
+}
+
+#ifdef FLIGHT_CONFIG_DIR
+TEST_CASE("AeroDataTable shipped polars use the O(1) lookup")
+{
+    AeroDataTable table = AeroDataTable::loadFromCSV(std::string(FLIGHT_CONFIG_DIR) + "/2yp.csv");
+    REQUIRE(table.isUniform());
+    REQUIRE(table.size() == 87);
+}
+#endif
+
+TEST_CASE("AeroDataTable multilinear lookup over alpha x Mach x elevator")
+{
+    // A function linear in each axis is reproduced exactly by multilinear interpolation
+    auto cl = [](double a, double m, double e)
+    { return 0.2 + 5.0 * a - 0.3 * m + 0.4 * e + 1.5 * a * m * e; };
+    auto cd = [](double a, double m, double e)
+    { return 0.02 + 0.1 * a + 0.05 * m * e; };
+
+    std::vector<AeroDataTable::GridAxis> grid = {{AeroAxis::Alpha, {-0.1, 0.0, 0.1, 0.2}},
+                                                 {AeroAxis::Mach, {0.0, 0.1, 0.3}},
+                                                 {AeroAxis::Elevator, {-1.0, 0.0, 1.0}}};
+    std::vector<double> CL, CD;
+    for (double e : grid[2].values)
+        for (double m : grid[1].values)
+            for (double a : grid[0].values)
+            {
+                CL.push_back(cl(a, m, e));
+                CD.push_back(cd(a, m, e));
+            }
+    AeroDataTable table = AeroDataTable::fromGrid(grid, CL, CD);
+    REQUIRE(table.dimensions() == 3);
+    REQUIRE(table.hasAxis(AeroAxis::Mach));
+    REQUIRE_FALSE(table.hasAxis(AeroAxis::Reynolds));
+
+    for (double a : {-0.07, 0.03, 0.15})
+        for (double m : {0.02, 0.17, 0.29})
+            for (double e : {-0.6, 0.1, 0.9})
+            {
+                AeroQuery q;
+                q.alpha = a;
+                q.mach = m;
+                q.elevator = e;
+                AeroCoefficients c = table.getCLCD(q);
+                REQUIRE(std::abs(c.CL - cl(a, m, e)) < 1e-12);
+                REQUIRE(std::abs(c.CD - cd(a, m, e)) < 1e-12);
+            }
+
+    // Non-alpha axes clamp to the grid
+    AeroQuery fast;
+    fast.alpha = 0.05;
+    fast.mach = 0.9;
+    fast.elevator = 2.0;
+    REQUIRE(std::abs(table.getCLCD(fast).CL - cl(0.05, 0.3, 1.0)) < 1e-12);
+
+    // Alpha still extrapolates CL and holds CD
+    AeroQuery high;
+    high.alpha = 0.25;
+    high.mach = 0.1;
+    REQUIRE(std::abs(table.getCLCD(high).CL - cl(0.25, 0.1, 0.0)) < 1e-12);
+    REQUIRE(std::abs(table.getCLCD(high).CD - cd(0.2, 0.1, 0.0)) < 1e-12);
+}
+
+TEST_CASE("AeroDataTable rejects malformed grids")
+{
+    std::vector<AeroDataTable::GridAxis> grid = {{AeroAxis::Alpha, {0.0, 0.1}}, {AeroAxis::Mach, {0.0, 0.2}}};
+    REQUIRE_THROWS(AeroDataTable::fromGrid(grid, {0.1, 0.2, 0.3}, {0.01, 0.02, 0.03}));
+
+    std::vector<AeroDataTable::GridAxis> noAlpha = {{AeroAxis::Mach, {0.0, 0.2}}};
+    REQUIRE_THROWS(AeroDataTable::fromGrid(noAlpha, {0.1, 0.2}, {0.01, 0.02}));
+}
+
+TEST_CASE("AeroDataTable loads a gridded CSV")
+{
+    std::string path = "aero_grid_test.csv";
+    {
+        std::ofstream out(path);
+        out << "alpha,mach,CL,CD\n";
+        // Rows in any order
+        out << "0,0.2,0.30,0.030\n";
+        out << "10,0.0,1.00,0.040\n";
+        out << "0,0.0,0.20,0.020\n";
+        out << "10,0.2,1.20,0.060\n";
+    }
+    AeroDataTable table = AeroDataTable::loadFromCSV(path);
+    REQUIRE(table.dimensions() == 2);
+    REQUIRE(table.size() == 4);
+
+    AeroQuery q;
+    q.alpha = 5.0 * M_PI / 180.0;
+    q.mach = 0.1;
+    AeroCoefficients c = table.getCLCD(q);
+    REQUIRE(std::abs(c.CL - 0.675) < 1e-9);
+    REQUIRE(std::abs(c.CD - 0.0375) < 1e-9);
+
+    // Missing grid point
+    {
+        std::ofstream out(path);
+        out << "alpha,mach,CL,CD\n0,0.0,0.2,0.02\n10,0.0,1.0,0.04\n0,0.2,0.3,0.03\n";
+    }
+    REQUIRE_THROWS(AeroDataTable::loadFromCSV(path));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("AeroDataTable CSV parser reports error positions")
+{
+    // CRLF line endings, spaces and a trailing comma are accepted
+    const std::string good = "alpha, CL, CD\r\n-5, -0.1, 0.02,\r\n\r\n5 ,0.6,0.03\r\n";
+    AeroDataTable table = AeroDataTable::parseCSV(good.data(), good.data() + good.size(), "good.csv");
+    REQUIRE(table.size() == 2);
+    REQUIRE(std::abs(table.getCL(0.0) - 0.25) < 1e-9);
+
+    const std::string bad = "alpha,CL,CD\n0,0.2,0.02\n5,0.6x,0.03\n";
+    try
+    {
+        AeroDataTable::parseCSV(bad.data(), bad.data() + bad.size(), "bad.csv");
+        FAIL("expected a ParseError");
+    }
+    catch (const ParseError &e)
+    {
+        REQUIRE(e.line() == 3);
+        REQUIRE(e.column() == 6);
+        REQUIRE(std::string(e.what()).rfind("bad.csv:3:6:", 0) == 0);
+    }
+
+    const std::string shortRow = "alpha,mach,CL,CD\n0,0,0.2,0.02\n10,0,1.0\n";
+    try
+    {
+        AeroDataTable::parseCSV(shortRow.data(), shortRow.data() + shortRow.size(), "grid.csv");
+        FAIL("expected a ParseError");
+    }
+    catch (const ParseError &e)
+    {
+        REQUIRE(e.line() == 3);
+        REQUIRE(e.column() == 1);
+    }
+}
+
+TEST_CASE("AeroDataTable rejects repeated alpha and survives a NaN query")
+{
+    // The repeat is reported at its own row, wherever it sits in the file
+    const std::string repeated = "alpha,CL,CD\n5,0.6,0.03\n0,0.2,0.02\n5,0.7,0.04\n";
+    try
+    {
+        AeroDataTable::parseCSV(repeated.data(), repeated.data() + repeated.size(), "repeat.csv");
+        FAIL("expected a ParseError");
+    }
+    catch (const ParseError &e)
+    {
+        REQUIRE(e.line() == 4);
+    }
+    std::vector<AeroDataTable::DataPoint> pts = {{0.0, 0.2, 0.02}, {0.1, 0.6, 0.03}, {0.1, 0.7, 0.04}};
+    REQUIRE_THROWS(AeroDataTable::fromPoints(pts));
+
+    // A NaN alpha gives NaN coefficients from both lookups, not an out-of-range cell
+    std::vector<AeroDataTable::DataPoint> uniform = {{0.0, 0.2, 0.02}, {0.1, 0.6, 0.03}, {0.2, 1.0, 0.05}};
+    std::vector<AeroDataTable::DataPoint> spread = {{0.0, 0.2, 0.02}, {0.07, 0.6, 0.03}, {0.3, 1.0, 0.05}};
+    AeroDataTable direct = AeroDataTable::fromPoints(uniform);
+    AeroDataTable searched = AeroDataTable::fromPoints(spread);
+    REQUIRE(direct.isUniform());
+    REQUIRE_FALSE(searched.isUniform());
+    REQUIRE(std::isnan(direct.getCL(std::nan(""))));
+    REQUIRE(std::isnan(searched.getCL(std::nan(""))));
+}
+
+TEST_CASE("AeroTableCache shares one table per file contents")
+{
+    AeroTableCache &cache = AeroTableCache::instance();
+    cache.clear();
+    const std::string a = "aero_cache_a.csv", b = "aero_cache_b.csv";
+    for (const std::string &path : {a, b})
+    {
+        std::ofstream out(path);
+        out << "alpha,CL,CD\n-5,-0.1,0.02\n5,0.6,0.03\n";
+    }
+
+    std::shared_ptr<const AeroDataTable> first = cache.load(a);
+    REQUIRE(cache.load(a) == first);
+    REQUIRE(cache.load("./" + a) == first); // Same canonical path
+    REQUIRE(cache.load(b) == first);        // Same contents
+    REQUIRE(cache.getStats().parses == 1);
+    REQUIRE(cache.getStats().hits == 3);
+
+    // Edited file is parsed again; the old table stays valid for its holders
+    {
+        std::ofstream out(a);
+        out << "alpha,CL,CD\n-5,-0.2,0.02\n5,0.8,0.03\n";
+    }
+    std::shared_ptr<const AeroDataTable> edited = cache.load(a);
+    REQUIRE(edited != first);
+    REQUIRE(std::abs(edited->getCL(0.0) - 0.3) < 1e-9);
+    REQUIRE(std::abs(first->getCL(0.0) - 0.25) < 1e-9);
+    REQUIRE(cache.getStats().parses == 2);
+
+    // Tables are released with their last user
+    first.reset();
+    edited.reset();
+    REQUIRE(cache.size() == 0);
+
+    REQUIRE_THROWS(cache.load("no_such_aero_file.csv"));
+    for (const std::string &path : {a, b})
+    {
+        std::remove(path.c_str());
+        std::remove(AeroDataTable::compiledPath(path).c_str());
+    }
+    cache.clear();
+}
+
+TEST_CASE("AeroDataTable compiled file is used in place and matches the parsed table")
+{
+    // Alpha spacing that gets resampled, times a Mach axis
+    std::string csv = "alpha,mach,CL,CD\n";
+    for (double m : {0.0, 0.2, 0.5})
+        for (double deg : {-8.0, -4.0, 0.0, 2.0, 4.0, 4.5, 5.0, 12.0})
+            csv += std::to_string(deg) + "," + std::to_string(m) + "," + std::to_string(0.1 * deg + m) + "," +
+                   std::to_string(0.02 + 0.001 * deg * deg + 0.01 * m) + "\n";
+    AeroDataTable parsed = AeroDataTable::parseCSV(csv.data(), csv.data() + csv.size(), "compiled.csv");
+    REQUIRE_FALSE(parsed.isMapped());
+
+    const std::string path = "aero_compiled_test.fdaero";
+    const AeroDataTable::CompiledSource source{AeroDataTable::hashBytes(csv.data(), csv.size()), csv.size()};
+    parsed.saveCompiled(path, source);
+
+    AeroDataTable::CompiledSource read;
+    AeroDataTable mapped = AeroDataTable::loadCompiled(path, &read);
+    REQUIRE(mapped.isMapped());
+    REQUIRE(read.hash == source.hash);
+    REQUIRE(read.size == source.size);
+    REQUIRE(mapped.size() == parsed.size());
+    REQUIRE(mapped.dimensions() == 2);
+    REQUIRE(mapped.isUniform() == parsed.isUniform());
+    REQUIRE(mapped.getMinAlpha() == parsed.getMinAlpha());
+    REQUIRE(mapped.getMaxAlpha() == parsed.getMaxAlpha());
+
+    // Same arrays, so bit-identical lookups (inside, between and outside the grid)
+    AeroDataTable copy = mapped; // Shares the mapping
+    for (double deg = -12.0; deg <= 16.0; deg += 0.37)
+        for (double m : {-0.1, 0.0, 0.13, 0.5, 0.8})
+        {
+            AeroQuery q;
+            q.alpha = deg * M_PI / 180.0;
+            q.mach = m;
+            AeroCoefficients want = parsed.getCLCD(q), got = copy.getCLCD(q);
+            REQUIRE(got.CL == want.CL);
+            REQUIRE(got.CD == want.CD);
+        }
+
+    // Truncated or foreign files are rejected, never read past their end
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    REQUIRE_THROWS(AeroDataTable::loadCompiled(path));
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << csv;
+    }
+    REQUIRE_THROWS(AeroDataTable::loadCompiled(path));
+    REQUIRE_THROWS(AeroDataTable::loadCompiled("no_such_table.fdaero"));
+    std::remove(path.c_str());
+    REQUIRE(AeroDataTable::compiledPath("config/2yp.csv") == "config/2yp.fdaero");
+    REQUIRE(AeroDataTable::compiledPath("dir.v2/polar") == "dir.v2/polar.fdaero");
+}
+
+TEST_CASE("AeroTableCache maps a compiled table built from the same CSV bytes")
+{
+    AeroTableCache &cache = AeroTableCache::instance();
+    cache.clear();
+    const std::string csv = "aero_cache_compiled.csv";
+    const std::string compiled = AeroDataTable::compiledPath(csv);
+    std::remove(compiled.c_str());
+    {
+        std::ofstream out(csv);
+        out << "alpha,CL,CD\n-4,0.0,0.02\n0,0.4,0.025\n8,1.2,0.05\n";
+    }
+    // Loading parses and leaves the directory alone
+    std::shared_ptr<const AeroDataTable> parsed = cache.load(csv);
+    REQUIRE(cache.getStats().parses == 1);
+    REQUIRE_FALSE(std::filesystem::exists(compiled));
+    const double cl = parsed->getCL(0.05);
+    parsed.reset();
+
+    // Once compiled, a fresh process (emptied cache) maps it instead of parsing
+    REQUIRE(AeroTableCache::compile(csv) == compiled);
+    cache.clear();
+    std::shared_ptr<const AeroDataTable> mapped = cache.load(csv);
+    REQUIRE(mapped->isMapped());
+    REQUIRE(mapped->getCL(0.05) == cl);
+    REQUIRE(cache.getStats().compiled == 1);
+    REQUIRE(cache.getStats().parses == 0);
+    mapped.reset();
+
+    // An edit of the same size, dated before the compiled file, is still caught by the hash
+    auto compiledTime = std::filesystem::last_write_time(compiled);
+    {
+        std::ofstream out(csv);
+        out << "alpha,CL,CD\n-4,0.0,0.02\n0,0.5,0.025\n8,1.2,0.05\n";
+    }
+    std::filesystem::last_write_time(csv, compiledTime - std::chrono::hours(1));
+    cache.clear();
+    std::shared_ptr<const AeroDataTable> edited = cache.load(csv);
+    REQUIRE_FALSE(edited->isMapped());
+    REQUIRE(std::abs(edited->getCL(0.0) - 0.5) < 1e-12);
+    REQUIRE(cache.getStats().parses == 1);
+    edited.reset();
+
+    // Writing on load is opt-in, and leaves no temporary files behind
+    cache.clear();
+    cache.setWriteCompiled(true);
+    cache.load(csv);
+    cache.setWriteCompiled(false);
+    cache.clear();
+    REQUIRE(cache.load(csv)->isMapped());
+    for (const auto &entry : std::filesystem::directory_iterator("."))
+        REQUIRE(entry.path().filename().string().rfind(compiled + ".tmp", 0) == std::string::npos);
+
+    // With compiled tables off nothing is read or written
+    std::remove(compiled.c_str());
+    cache.clear();
+    cache.setUseCompiled(false);
+    REQUIRE_FALSE(cache.load(csv)->isMapped());
+    REQUIRE_FALSE(std::filesystem::exists(compiled));
+    cache.setUseCompiled(true);
+
+    std::remove(csv.c_str());
+    cache.clear();
+}
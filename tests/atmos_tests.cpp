@@ -28,3 +28,37 @@ TEST_CASE("Speed of sound calculation")
     double a0 = 340.3; // m/s at sea level
     REQUIRE(std::abs(getSpeedOfSound(0) - a0) < 1.0);
 }
+
+TEST_CASE("Dynamic viscosity calculation")
+{
+    double mu0 = 1.789e-5; // Pa s at sea level
+    REQUIRE(std::abs(getDynamicViscosity(0) - mu0) < 1e-7);
+    REQUIRE(getDynamicViscosity(5000) < mu0); // Decreases with temperature
+}
+
+TEST_CASE("Tabulated atmosphere matches the analytic model")
+{
+    // Off-grid altitudes across the whole table, including both ends
+    for (double h = 0.0; h <= ATMOS_TABLE_TOP; h += 7.3)
+    {
+        AtmosphereState table = getAtmosphere(h);
+        REQUIRE(std::abs(table.T - getTemperature(h)) < 1e-9 * getTemperature(h));
+        // The bounds documented with the table in atmosphere.cpp
+        REQUIRE(std::abs(table.p - getPressure(h)) < 2e-6 * getPressure(h));
+        REQUIRE(std::abs(table.rho - getDensity(h)) < 2e-6 * getDensity(h));
+        REQUIRE(std::abs(table.a - getSpeedOfSound(h)) < 1e-7 * getSpeedOfSound(h));
+        REQUIRE(std::abs(table.mu - getDynamicViscosity(h)) < 1e-7 * getDynamicViscosity(h));
+    }
+}
+
+TEST_CASE("Tabulated atmosphere falls back outside its range")
+{
+    for (double h : {-50.0, ATMOS_TABLE_TOP + 1.0, 30000.0})
+    {
+        AtmosphereState table = getAtmosphere(h);
+        AtmosphereState exact = computeAtmosphere(h);
+        REQUIRE(table.p == exact.p);
+        REQUIRE(table.rho == exact.rho);
+        REQUIRE(std::abs(exact.rho - getDensity(h)) < 1e-12 * getDensity(h));
+    }
+}
@@ -0,0 +1,157 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#undef BENCHMARK // Catch's micro-benchmark macro; the harness defines its own
+#include "benchmark_harness.hpp"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * TEST STRATEGY:
+ * 1. comparePerf verdicts on fixed sample sets: faster, slower, within the
+ *    threshold, too noisy to tell, and benchmarks on only one side
+ * 2. printPerfTable counts slower and missing benchmarks as failures
+ * 3. readBaseline keeps repetition rows, falls back to median aggregates,
+ *    reads the machine context and rejects malformed files
+ */
+
+namespace
+{
+using Verdict = bench::PerfComparison::Verdict;
+
+// Write text to a file in the temp directory and return its path
+std::string writeTemp(const std::string &name, const std::string &text)
+{
+    std::string path = (std::filesystem::temp_directory_path() / name).string();
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+    return path;
+}
+} // namespace
+
+TEST_CASE("comparePerf - clearly faster and slower runs")
+{
+    const std::vector<double> baseline = {100.0, 101.0, 99.0, 100.5, 99.5, 100.2, 99.8, 100.1};
+    std::vector<double> faster, slower;
+    for (double x : baseline)
+    {
+        faster.push_back(0.8 * x);
+        slower.push_back(1.25 * x);
+    }
+
+    bench::PerfComparison f = bench::comparePerf("BM_Fast", baseline, faster, 0.10);
+    REQUIRE(f.verdict == Verdict::Faster);
+    REQUIRE(std::abs(f.change + 0.2) < 1e-9);
+    REQUIRE(f.ci_high < -0.10);
+    REQUIRE(f.baseline_ns == 100.05);
+
+    bench::PerfComparison s = bench::comparePerf("BM_Slow", baseline, slower, 0.10);
+    REQUIRE(s.verdict == Verdict::Slower);
+    REQUIRE(std::abs(s.change - 0.25) < 1e-9);
+    REQUIRE(s.ci_low > 0.10);
+    REQUIRE(s.ci_low <= s.change);
+    REQUIRE(s.change <= s.ci_high);
+
+    // Fixed bootstrap seed: the same numbers give the same interval
+    bench::PerfComparison again = bench::comparePerf("BM_Slow", baseline, slower, 0.10);
+    REQUIRE(again.ci_low == s.ci_low);
+    REQUIRE(again.ci_high == s.ci_high);
+}
+
+TEST_CASE("comparePerf - small or noisy changes pass")
+{
+    const std::vector<double> baseline = {100.0, 101.0, 99.0, 100.5, 99.5, 100.2, 99.8, 100.1};
+
+    // A confident 3% slowdown is inside the 10% threshold
+    std::vector<double> drift;
+    for (double x : baseline)
+        drift.push_back(1.03 * x);
+    bench::PerfComparison d = bench::comparePerf("BM_Drift", baseline, drift, 0.10);
+    REQUIRE(d.verdict == Verdict::Same);
+    REQUIRE(d.ci_low > 0.0);
+
+    // The medians differ by more than the threshold, but the samples are too
+    // scattered for the interval to exclude it
+    const std::vector<double> noisy_base = {60.0, 140.0, 90.0, 110.0, 70.0, 130.0, 100.0};
+    const std::vector<double> noisy_now = {66.0, 160.0, 100.0, 125.0, 80.0, 150.0, 115.0};
+    bench::PerfComparison n = bench::comparePerf("BM_Noisy", noisy_base, noisy_now, 0.10);
+    REQUIRE(n.change > 0.10);
+    REQUIRE(n.ci_low <= 0.10);
+    REQUIRE(n.verdict == Verdict::Same);
+}
+
+TEST_CASE("comparePerf - benchmarks on one side only")
+{
+    bench::PerfComparison added = bench::comparePerf("BM_New", {}, {50.0, 52.0, 51.0}, 0.10);
+    REQUIRE(added.verdict == Verdict::New);
+    REQUIRE(added.current_ns == 51.0);
+
+    bench::PerfComparison gone = bench::comparePerf("BM_Gone", {40.0, 42.0}, {}, 0.10);
+    REQUIRE(gone.verdict == Verdict::Missing);
+    REQUIRE(gone.baseline_ns == 41.0);
+
+    // Slower and missing fail the check; new and same do not
+    const std::vector<double> base = {100.0, 100.0, 100.0};
+    std::vector<bench::PerfComparison> rows = {added, gone,
+                                               bench::comparePerf("BM_Same", base, base, 0.10),
+                                               bench::comparePerf("BM_Slow", base, {150.0, 150.0, 150.0}, 0.10)};
+    std::ostringstream table;
+    REQUIRE(bench::printPerfTable(table, rows, 0.10) == 2);
+    REQUIRE(table.str().find("BM_Gone") != std::string::npos);
+}
+
+TEST_CASE("readBaseline - repetitions, aggregates and machine context")
+{
+    const std::string json = R"({
+  "context": {
+    "date": "2026-01-01T00:00:00",
+    "num_cpus": 8,
+    "caches": [{"type": "Data", "level": 1, "size": 32768}],
+    "library_build_type": "release"
+  },
+  "benchmarks": [
+    {"name": "BM_A", "run_type": "iteration", "repetitions": 3, "real_time": 10.0, "cpu_time": 10.0},
+    {"name": "BM_A", "run_type": "iteration", "repetitions": 3, "real_time": 12.0, "cpu_time": 12.0},
+    {"name": "BM_A", "run_type": "iteration", "repetitions": 3, "real_time": 11.0, "cpu_time": 11.0},
+    {"name": "BM_A_median", "run_type": "aggregate", "aggregate_name": "median", "real_time": 11.0},
+    {"name": "BM_B/64_median", "run_type": "aggregate", "aggregate_name": "median", "real_time": 5e2},
+    {"name": "BM_B/64_mean", "run_type": "aggregate", "aggregate_name": "mean", "real_time": 6e2},
+    {"name": "BM_\"Quoted\"", "real_time": 1.5, "label": null, "ok": true}
+  ]
+})";
+    std::string path = writeTemp("bench_baseline_good.json", json);
+    bench::BaselineMachine machine;
+    std::map<std::string, std::vector<double>> samples = bench::readBaseline(path, &machine);
+    std::filesystem::remove(path);
+
+    REQUIRE(samples.size() == 3);
+    REQUIRE(samples["BM_A"] == std::vector<double>{10.0, 12.0, 11.0}); // Aggregate ignored next to the runs
+    REQUIRE(samples["BM_B/64"] == std::vector<double>{500.0});         // Only a median: one sample
+    REQUIRE(samples["BM_\"Quoted\""] == std::vector<double>{1.5});
+    REQUIRE(machine.num_cpus == 8);
+    REQUIRE(machine.build_type == "release");
+}
+
+TEST_CASE("readBaseline - malformed or empty files throw")
+{
+    REQUIRE_THROWS(bench::readBaseline("no_such_baseline.json"));
+
+    const std::vector<std::string> bad = {
+        R"({"benchmarks": [{"name": "BM_A", "real_time": 10.0})",  // Truncated
+        R"({"benchmarks": [{"name" "BM_A", "real_time": 10.0}]})", // Missing ':'
+        R"({"benchmarks": [{"name": "BM_A", "real_time": fast}]})", // Not a number
+        R"({"benchmarks": [{"name": "BM_A)",                       // Unterminated string
+        R"({"benchmarks": [{"name": "BM_A" "real_time": 10.0}]})",  // Missing ','
+        R"({"context": {}, "benchmarks": []})",                     // No results
+    };
+    for (size_t i = 0; i < bad.size(); i++)
+    {
+        std::string path = writeTemp("bench_baseline_bad.json", bad[i]);
+        INFO("case " << i);
+        REQUIRE_THROWS_AS(bench::readBaseline(path), std::runtime_error);
+        std::filesystem::remove(path);
+    }
+}
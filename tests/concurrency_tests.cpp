@@ -0,0 +1,1301 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "core/triple_buffer.hpp"
+#include "core/spsc_queue.hpp"
+#include "simulation/sim_thread.hpp"
+#include "core/thread_pool.hpp"
+#include "simulation/parameter_sweep.hpp"
+#include "simulation/distributed_sweep.hpp"
+#include "simulation/gain_tuner.hpp"
+#include "simulation/flight_envelope.hpp"
+#include "aircraft/aircraft_loader.hpp"
+#include "utils/config_watcher.hpp"
+#include "core/profiler.hpp"
+#include "telemetry/telemetry_publisher.hpp"
+#include "simulation/headless_runner.hpp"
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+
+TEST_CASE("TripleBuffer - consumer sees the newest published value")
+{
+    TripleBuffer<int> buffer;
+
+    // Nothing published yet
+    REQUIRE_FALSE(buffer.update());
+
+    buffer.writeBuffer() = 1;
+    buffer.publish();
+    buffer.writeBuffer() = 2;
+    buffer.publish();
+
+    // Intermediate values are skipped, never blocked on
+    REQUIRE(buffer.update());
+    REQUIRE(buffer.readBuffer() == 2);
+    REQUIRE_FALSE(buffer.update());
+    REQUIRE(buffer.readBuffer() == 2);
+}
+
+TEST_CASE("TripleBuffer - a published value is never torn across threads")
+{
+    struct Pair
+    {
+        long long a = 0, b = 0;
+    };
+    TripleBuffer<Pair> buffer;
+    const long long count = 200000;
+
+    std::thread producer([&]
+                         {
+        for (long long i = 1; i <= count; i++)
+        {
+            Pair &p = buffer.writeBuffer();
+            p.a = i;
+            p.b = -i;
+            buffer.publish();
+        } });
+
+    long long last = 0;
+    bool consistent = true, monotonic = true;
+    while (last < count)
+    {
+        if (buffer.update())
+        {
+            const Pair &p = buffer.readBuffer();
+            consistent = consistent && (p.a == -p.b);
+            monotonic = monotonic && (p.a > last);
+            last = p.a;
+        }
+    }
+    producer.join();
+
+    REQUIRE(consistent);
+    REQUIRE(monotonic);
+}
+
+TEST_CASE("SpscQueue - FIFO order and capacity")
+{
+    SpscQueue<int, 4> queue;
+    for (int i = 0; i < 4; i++)
+        REQUIRE(queue.tryPush(i));
+    REQUIRE_FALSE(queue.tryPush(99)); // Full: fails instead of blocking
+
+    int v = -1;
+    for (int i = 0; i < 4; i++)
+    {
+        REQUIRE(queue.tryPop(v));
+        REQUIRE(v == i);
+    }
+    REQUIRE_FALSE(queue.tryPop(v));
+}
+
+TEST_CASE("SpscQueue - every item arrives once, in order, across threads")
+{
+    SpscQueue<long long, 64> queue;
+    const long long count = 200000;
+
+    std::thread producer([&]
+                         {
+        for (long long i = 0; i < count; i++)
+            while (!queue.tryPush(i))
+                std::this_thread::yield(); });
+
+    long long expected = 0;
+    bool in_order = true;
+    long long v;
+    while (expected < count)
+    {
+        if (queue.tryPop(v))
+        {
+            in_order = in_order && (v == expected);
+            expected++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    REQUIRE(in_order);
+}
+
+TEST_CASE("SimulationThread - steps in the background and applies posted controls")
+{
+    SimulationState initial;
+    initial.reset();
+    initial.dt = 0.002;
+    SimulationThread sim(initial);
+    sim.start();
+
+    ControlInputs controls = ControlInputs::capture(initial);
+    controls.throttle = 0.9f;
+    REQUIRE(sim.post({SimCommand::Type::SetControls, controls, nullptr}));
+
+    // Wait (without blocking the simulation) until it has advanced
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    const SimulationSnapshot *snap = &sim.latest();
+    while ((snap->t < 0.1 || snap->throttle != 0.9f) && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        snap = &sim.latest();
+    }
+    REQUIRE(snap->t >= 0.1);
+    REQUIRE(snap->throttle == 0.9f);
+    REQUIRE(snap->path_count > 0);
+
+    // Reset bumps the generation so the UI can drop its path
+    uint32_t generation = snap->generation;
+    REQUIRE(sim.post({SimCommand::Type::Reset, {}, nullptr}));
+    while (snap->generation == generation && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        snap = &sim.latest();
+    }
+    REQUIRE(snap->generation == generation + 1);
+
+    sim.stop();
+}
+
+TEST_CASE("SimulationThread - time warp runs faster within the step budget")
+{
+    SimulationState initial;
+    initial.reset();
+    initial.dt = 0.01;
+    initial.position = Vec2(0.0, 2000.0);
+    initial.velocity = Vec2(40.0, 0.0);
+    SimulationThread sim(initial);
+    sim.start();
+
+    ControlInputs controls = ControlInputs::capture(initial);
+    controls.time_warp = 100.0f;
+    REQUIRE(sim.post({SimCommand::Type::SetControls, controls, nullptr}));
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    const SimulationSnapshot *snap = &sim.latest();
+    while (snap->t < 30.0 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        snap = &sim.latest();
+    }
+    REQUIRE(snap->t >= 30.0);
+    REQUIRE(snap->time_warp == 100.0);
+
+    // One path point per 100 steps, so the path grows at the real-time rate
+    REQUIRE(snap->path_total <= snap->step_count / 100 + 1);
+    REQUIRE(snap->path_total >= snap->step_count / 100 - 1);
+
+    // A warp the budget cannot sustain runs slower instead of falling behind
+    controls.dt = 0.0005;
+    controls.time_warp = SimulationState::MAX_TIME_WARP;
+    controls.step_budget_ms = 0.05f;
+    REQUIRE(sim.post({SimCommand::Type::SetControls, controls, nullptr}));
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    snap = &sim.latest();
+    sim.stop();
+
+    REQUIRE(snap->warp_limited);
+    REQUIRE(snap->achieved_warp > 1.0);
+    REQUIRE(snap->achieved_warp < 0.9 * SimulationState::MAX_TIME_WARP);
+}
+
+TEST_CASE("SimulationSnapshot - path points are appended exactly once")
+{
+    SimulationSnapshot snap;
+    SimulationState view;
+    uint64_t seen = 0;
+
+    // First snapshot carries points 0..2
+    for (int i = 0; i < 3; i++)
+        snap.path[i] = {static_cast<float>(i), 0.0f};
+    snap.path_count = 3;
+    snap.path_total = 3;
+    snap.applyTo(view, seen);
+    REQUIRE(view.flightPath.size() == 3);
+
+    // Next one repeats the tail (1..4); only 3 and 4 are new
+    for (int i = 0; i < 4; i++)
+        snap.path[i] = {static_cast<float>(i + 1), 0.0f};
+    snap.path_count = 4;
+    snap.path_total = 5;
+    snap.applyTo(view, seen);
+    REQUIRE(view.flightPath.size() == 5);
+    REQUIRE(view.flightPath.back().x == 4.0f);
+}
+
+TEST_CASE("ThreadPool - parallelFor runs every index exactly once")
+{
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> hits(10007);
+    for (auto &h : hits)
+        h = 0;
+
+    pool.parallelFor(0, hits.size(), [&](size_t i)
+                     { hits[i]++; });
+
+    bool all_once = true;
+    for (auto &h : hits)
+        all_once = all_once && h == 1;
+    REQUIRE(all_once);
+
+    // Pool is reusable and handles empty ranges
+    pool.parallelFor(5, 5, [&](size_t)
+                     { hits[0]++; });
+    REQUIRE(hits[0] == 1);
+}
+
+TEST_CASE("ThreadPool - tasks submitted from tasks are waited for")
+{
+    ThreadPool pool(3);
+    std::atomic<int> count(0);
+    for (int i = 0; i < 16; i++)
+    {
+        pool.submit([&]
+                    {
+            for (int j = 0; j < 16; j++)
+                pool.submit([&] { count++; }); });
+    }
+    pool.wait();
+    REQUIRE(count == 256);
+}
+
+TEST_CASE("SweepDesign - grid and random cases")
+{
+    SweepDesign grid;
+    grid.axes.push_back({SweepParameter::Mass, 1.0, 3.0, 3});
+    grid.axes.push_back({SweepParameter::SpeedKp, 0.0, 1.0, 2});
+    REQUIRE(grid.caseCount() == 6);
+
+    // First axis varies fastest
+    REQUIRE(grid.caseValues(0) == std::vector<double>{1.0, 0.0});
+    REQUIRE(grid.caseValues(2) == std::vector<double>{3.0, 0.0});
+    REQUIRE(grid.caseValues(4) == std::vector<double>{2.0, 1.0});
+
+    SweepDesign random = grid;
+    random.kind = SweepDesign::Kind::Random;
+    random.samples = 50;
+    random.seed = 42;
+    REQUIRE(random.caseCount() == 50);
+    bool in_range = true;
+    for (size_t i = 0; i < random.caseCount(); i++)
+    {
+        std::vector<double> v = random.caseValues(i);
+        in_range = in_range && v[0] >= 1.0 && v[0] <= 3.0 && v[1] >= 0.0 && v[1] <= 1.0;
+    }
+    REQUIRE(in_range);
+    REQUIRE(random.caseValues(7) == random.caseValues(7));
+    REQUIRE(random.caseValues(7) != random.caseValues(8));
+
+    REQUIRE(parseSweepParameter("alt_pid_kd") == SweepParameter::AltitudeKd);
+    REQUIRE_THROWS(parseSweepParameter("wingspan"));
+}
+
+TEST_CASE("ParameterSweep - results do not depend on the thread count")
+{
+    SimulationState base;
+    base.reset();
+    base.position = Vec2(0.0, 100.0);
+    base.velocity = Vec2(20.0, 0.0);
+    base.autopilot_speed = true;
+    base.speed_setpoint = 22.0f;
+    base.autopilot_altitude = true;
+    base.altitude_setpoint = 110.0f;
+
+    HeadlessRunConfig run;
+    run.duration = 20.0;
+    run.dt = 0.01;
+
+    SweepDesign design;
+    design.axes.push_back({SweepParameter::Mass, 0.8 * base.aircraft.mass, 1.2 * base.aircraft.mass, 3});
+    design.axes.push_back({SweepParameter::SpeedKp, 0.2, 0.8, 3});
+
+    ThreadPool one(1), four(4);
+    std::vector<SweepResult> a = runSweep(base, run, design, one);
+    std::vector<SweepResult> b = runSweep(base, run, design, four);
+    REQUIRE(a.size() == 9);
+    REQUIRE(b.size() == 9);
+
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        REQUIRE(a[i].error.empty());
+        REQUIRE(a[i].index == i);
+        REQUIRE(a[i].steps == 2000);
+        REQUIRE(a[i].values == b[i].values);
+        REQUIRE(a[i].metrics.final_speed == b[i].metrics.final_speed);
+        REQUIRE(a[i].metrics.final_altitude == b[i].metrics.final_altitude);
+        REQUIRE(a[i].metrics.fuel == b[i].metrics.fuel);
+        REQUIRE(a[i].metrics.fuel > 0.0);
+        REQUIRE(a[i].metrics.altitude_loss >= 0.0);
+    }
+
+    // The case matches a plain headless run with the same parameters
+    SimulationState single = base;
+    single.aircraft.mass = a[4].values[0];
+    single.pid_kp = static_cast<float>(a[4].values[1]);
+    runHeadless(single, run);
+    REQUIRE(single.velocity.magnitude() == a[4].metrics.final_speed);
+}
+
+TEST_CASE("ParameterSweep - batched cases match scalar runs")
+{
+    SimulationState base;
+    base.reset();
+    base.position = Vec2(0.0, 100.0);
+    base.velocity = Vec2(20.0, 0.0);
+    base.autopilot_speed = true;
+    base.speed_setpoint = 22.0f;
+    base.autopilot_altitude = true;
+    base.altitude_setpoint = 110.0f;
+
+    HeadlessRunConfig run;
+    run.duration = 20.0;
+    run.dt = 0.01;
+
+    SweepDesign design;
+    design.axes.push_back({SweepParameter::SpeedKp, 0.05, 0.8, 4});
+    design.axes.push_back({SweepParameter::AltitudeKd, 0.1, 1.0, 3});
+    design.axes.push_back({SweepParameter::Mass, 0.9 * base.aircraft.mass, 1.1 * base.aircraft.mass, 2});
+
+    ThreadPool pool(3);
+    std::vector<SweepResult> scalar = runSweep(base, run, design, pool);
+    std::vector<SweepResult> batched = runSweepBatched(base, run, design, pool, 5); // Last batch is partial
+    REQUIRE(batched.size() == 24);
+
+    for (size_t i = 0; i < batched.size(); i++)
+    {
+        const SweepMetrics &a = scalar[i].metrics, &b = batched[i].metrics;
+        REQUIRE(batched[i].error.empty());
+        REQUIRE(batched[i].index == i);
+        REQUIRE(batched[i].values == scalar[i].values);
+        REQUIRE(batched[i].steps == scalar[i].steps);
+        REQUIRE(std::abs(a.final_speed - b.final_speed) < 1e-4);
+        REQUIRE(std::abs(a.final_altitude - b.final_altitude) < 1e-4);
+        REQUIRE(std::abs(a.fuel - b.fuel) < 1e-3 * a.fuel);
+        REQUIRE(std::abs(a.speed_overshoot - b.speed_overshoot) < 1e-4);
+        REQUIRE(std::abs(a.altitude_overshoot - b.altitude_overshoot) < 1e-4);
+    }
+
+    SimulationState rk4 = base;
+    rk4.integration_method = IntegrationMethod::RK4;
+    REQUIRE_THROWS(runSweepBatched(rk4, run, design, pool));
+}
+
+TEST_CASE("SweepMetricsObserver - settling time and overshoot of a step response")
+{
+    SweepMetricsObserver observer;
+    SimulationState s;
+    s.reset();
+    s.autopilot_speed = true;
+    s.speed_setpoint = 20.0f;
+    s.aircraft.maxThrust = 10.0;
+    s.throttle = 0.5f;
+
+    // Speed ramps 10 -> 21 (overshoot 1 m/s) then settles at 20 from t = 3
+    const double speeds[] = {10.0, 15.0, 21.0, 20.5, 20.1, 20.0, 20.0};
+    for (int i = 0; i < 7; i++)
+    {
+        s.t = i;
+        s.velocity = Vec2(speeds[i], 0.0);
+        observer(s);
+    }
+    SweepMetrics m = observer.finish();
+    REQUIRE(m.speed_overshoot == Catch::Approx(1.0));
+    REQUIRE(m.speed_settling_time == Catch::Approx(3.0)); // Band is 0.4 m/s
+    REQUIRE(m.fuel == Catch::Approx(30.0));
+    REQUIRE(std::isnan(m.altitude_settling_time)); // Altitude autopilot off
+    REQUIRE(m.throttle_activity == 0.0);            // Throttle held
+}
+
+TEST_CASE("GainTuner - tuned gains beat the defaults")
+{
+    // The default gains do not hold the default aircraft at the tuning point
+    Aircraft aircraft;
+    GainTuneOptions opts;
+    opts.rounds = 2;
+    ThreadPool pool(4);
+    GainTuneResult result = tuneAutopilotGains(aircraft, AutopilotGains(), pool, opts);
+
+    REQUIRE(result.evaluations == 1 + 2 * 2 * 125);
+    REQUIRE(std::isfinite(result.score));
+    REQUIRE(result.score < 0.5 * result.initial_score);
+    REQUIRE(result.metrics.altitude_loss < opts.cruise_altitude); // No longer flies into the ground
+    REQUIRE(std::abs(result.metrics.final_speed - (opts.cruise_speed + opts.speed_step)) < 1.0);
+    for (int i = 0; i < 6; i++)
+    {
+        REQUIRE(result.gains.at(i) >= opts.min_gains.at(i) * (1.0 - 1e-9));
+        REQUIRE(result.gains.at(i) <= opts.max_gains.at(i) * (1.0 + 1e-9));
+    }
+
+    // The score is reproducible for the returned gains
+    REQUIRE(scoreAutopilotGains(aircraft, result.gains, pool, opts) == Catch::Approx(result.score).epsilon(1e-3));
+}
+
+TEST_CASE("FlightEnvelope - trim map seeds the solver and is cached per aircraft")
+{
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "envelope_cache_test";
+    fs::remove_all(dir);
+
+    Aircraft aircraft = AircraftLoader::loadFromJSON(std::string(FLIGHT_CONFIG_DIR) + "/2yp.json");
+    ThreadPool pool(4);
+    EnvelopeGrid grid;
+    bool from_cache = true;
+    FlightEnvelope env = loadOrComputeEnvelope(aircraft, grid, dir.string(), pool, &from_cache);
+    REQUIRE(!from_cache);
+    REQUIRE(env.matches(aircraft, grid));
+    REQUIRE(env.trimmedCount() > 0);
+
+    // Every trimmed cell is a converged solve; the table aircraft stalls below ~14 m/s
+    double lo = 0.0, hi = 0.0;
+    REQUIRE(env.speedRange(0.0, lo, hi));
+    REQUIRE(lo > 10.0);
+    REQUIRE(hi > 25.0);
+    for (int j = 0; j < grid.altitude_count; j++)
+    {
+        for (int i = 0; i < grid.speed_count; i++)
+        {
+            const TrimCell &c = env.cell(i, j);
+            if (c.status != TrimStatus::Trimmed)
+                continue;
+            TrimResult fresh = solveTrim(aircraft, {grid.speedAt(i), grid.altitudeAt(j)});
+            REQUIRE(fresh.trimmed());
+            REQUIRE(c.throttle == Catch::Approx(fresh.throttle).margin(1e-5));
+            REQUIRE(c.alpha_deg == Catch::Approx(fresh.alpha_deg).margin(1e-4));
+        }
+    }
+
+    // Between grid points the map is a starting guess that Newton finishes quickly
+    TrimCondition cond = {21.3, 130.0};
+    TrimResult cold = solveTrim(aircraft, cond);
+    TrimResult warm = trimFromEnvelope(aircraft, &env, cond);
+    REQUIRE(warm.trimmed());
+    REQUIRE(warm.iterations <= cold.iterations);
+    REQUIRE(warm.throttle == Catch::Approx(cold.throttle).margin(1e-9));
+    REQUIRE(trimFromEnvelope(aircraft, nullptr, cond).throttle == Catch::Approx(cold.throttle).margin(1e-9));
+
+    // The second request loads the same map from disk
+    FlightEnvelope cached = loadOrComputeEnvelope(aircraft, grid, dir.string(), pool, &from_cache);
+    REQUIRE(from_cache);
+    REQUIRE(cached.configHash() == env.configHash());
+    REQUIRE(cached.trimmedCount() == env.trimmedCount());
+    REQUIRE(std::memcmp(&cached.cell(7, 3), &env.cell(7, 3), sizeof(TrimCell)) == 0);
+
+    // Another airframe gets its own file, a damaged file is recomputed
+    Aircraft heavier = aircraft;
+    heavier.mass *= 1.5;
+    REQUIRE(envelopeCachePath(dir.string(), heavier) != envelopeCachePath(dir.string(), aircraft));
+    FlightEnvelope heavy = loadOrComputeEnvelope(heavier, grid, dir.string(), pool, &from_cache);
+    REQUIRE(!from_cache);
+    REQUIRE(heavy.speedRange(0.0, lo, hi));
+    REQUIRE(lo > 14.0); // Stalls faster
+
+    const std::string path = envelopeCachePath(dir.string(), aircraft);
+    char expected[32];
+    std::snprintf(expected, sizeof(expected), "%016llx.fdenv", static_cast<unsigned long long>(aircraft.configHash()));
+    REQUIRE(fs::path(path).filename().string() == expected);
+    fs::resize_file(path, fs::file_size(path) / 2);
+    REQUIRE_THROWS(FlightEnvelope::load(path));
+    loadOrComputeEnvelope(aircraft, grid, dir.string(), pool, &from_cache);
+    REQUIRE(!from_cache);
+    REQUIRE(FlightEnvelope::load(path).trimmedCount() == env.trimmedCount());
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("SimulationThread - trimmed reset starts in level flight")
+{
+    SimulationState initial;
+    initial.reset();
+    initial.dt = 0.002;
+    SimulationThread sim(initial);
+    sim.start();
+
+    SimCommand cmd;
+    cmd.type = SimCommand::Type::ResetTrimmed;
+    cmd.trim = {40.0, 300.0};
+    cmd.trim_result = solveTrim(initial.aircraft, cmd.trim);
+    REQUIRE(cmd.trim_result.trimmed());
+    uint32_t generation = sim.latest().generation;
+    REQUIRE(sim.post(cmd));
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    const SimulationSnapshot *snap = &sim.latest();
+    while ((snap->generation == generation || snap->t < 1.0) && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        snap = &sim.latest();
+    }
+    sim.stop();
+
+    REQUIRE(snap->generation == generation + 1);
+    REQUIRE(snap->t >= 1.0);
+    REQUIRE(std::abs(snap->position.y - 300.0) < 0.01);
+    REQUIRE(std::abs(snap->velocity.magnitude() - 40.0) < 0.01);
+    REQUIRE(snap->throttle == static_cast<float>(cmd.trim_result.throttle));
+}
+
+TEST_CASE("ParameterSweep - forked cases match re-flying the common prefix")
+{
+    SimulationState base;
+    base.reset();
+    base.position = Vec2(0.0, 100.0);
+    base.velocity = Vec2(20.0, 0.0);
+    base.autopilot_speed = true;
+    base.speed_setpoint = 22.0f;
+
+    HeadlessRunConfig rest;
+    rest.duration = 10.0;
+    rest.dt = 0.01;
+    const double fork_time = 5.0;
+
+    SweepDesign design;
+    design.axes.push_back({SweepParameter::Mass, 100.0, 140.0, 3});
+    design.axes.push_back({SweepParameter::AltitudeKp, 0.05, 0.2, 2});
+
+    ThreadPool pool(4);
+    SimulationCheckpoint fork = flyToFork(base, rest.dt, fork_time);
+    REQUIRE(std::abs(fork.t - fork_time) < 1e-9);
+    std::vector<SweepResult> forked = runSweep(fork, rest, design, pool);
+    REQUIRE(forked.size() == 6);
+
+    for (const SweepResult &r : forked)
+    {
+        REQUIRE(r.error.empty());
+        REQUIRE(r.steps == 1000);
+
+        // Same case flown from t = 0, parameters applied at the fork time
+        SimulationState full = base;
+        HeadlessRunConfig prefix = rest;
+        prefix.duration = fork_time;
+        runHeadless(full, prefix, [](const SimulationState &) {});
+        for (size_t k = 0; k < design.axes.size(); k++)
+            applySweepParameter(full, design.axes[k].parameter, r.values[k]);
+        runHeadless(full, rest, [](const SimulationState &) {});
+
+        REQUIRE(full.velocity.magnitude() == r.metrics.final_speed);
+        REQUIRE(full.position.y == r.metrics.final_altitude);
+    }
+}
+
+TEST_CASE("SweepStore - shards merge into one table ordered by case")
+{
+    SweepDesign design;
+    design.axes.push_back({SweepParameter::Mass, 800.0, 1200.0, 5});
+    design.axes.push_back({SweepParameter::SpeedKp, 0.2, 0.8, 2});
+
+    std::vector<SweepResult> all(10);
+    for (size_t i = 0; i < all.size(); i++)
+    {
+        all[i].index = i;
+        all[i].config = i % 2;
+        all[i].values = design.caseValues(i);
+        all[i].metrics.final_speed = 20.0 + i;
+        all[i].metrics.speed_settling_time = std::numeric_limits<double>::quiet_NaN();
+        all[i].steps = 100 * static_cast<long long>(i);
+        if (i == 7)
+            all[i].error = "crashed";
+    }
+    auto slice = [&](size_t first, size_t n)
+    { return std::vector<SweepResult>(all.begin() + first, all.begin() + first + n); };
+
+    // Chunks round-trip through the columnar encoding
+    std::vector<uint8_t> bytes = encodeSweepChunk(slice(4, 3), 2);
+    REQUIRE(bytes.size() == sizeof(SweepChunkHeader) + sweepColumnCount(2) * 3 * sizeof(double));
+    size_t consumed = 0;
+    std::vector<SweepResult> decoded = decodeSweepChunk(bytes.data(), bytes.size(), 2, consumed);
+    REQUIRE(consumed == bytes.size());
+    REQUIRE(decoded.size() == 3);
+    REQUIRE(decoded[1].index == 5);
+    REQUIRE(decoded[1].config == 1);
+    REQUIRE(decoded[1].values == all[5].values);
+    REQUIRE(decoded[1].metrics.final_speed == 25.0);
+    REQUIRE(std::isnan(decoded[1].metrics.speed_settling_time));
+    REQUIRE(decoded[1].steps == 500);
+    REQUIRE_THROWS(decodeSweepChunk(bytes.data(), bytes.size() - 8, 2, consumed));
+
+    // Chunks out of order, spread over shards, one stored twice
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "fd_sweep_store_test";
+    std::vector<std::string> configs = {"a.json", "b.json"};
+    {
+        SweepStore store(dir.string(), design, configs, all.size(), 3);
+        REQUIRE(store.shardCount() == 3);
+        const size_t firsts[] = {8, 0, 4, 4};
+        const size_t sizes[] = {2, 4, 4, 4};
+        for (size_t k = 0; k < 4; k++)
+        {
+            std::vector<uint8_t> chunk = encodeSweepChunk(slice(firsts[k], sizes[k]), 2);
+            store.append(firsts[k] / 4, chunk.data(), chunk.size());
+        }
+    }
+
+    SweepStoreContents contents = readSweepStore(dir.string());
+    REQUIRE(contents.case_count == 10);
+    REQUIRE(contents.axis_count == 2);
+    REQUIRE(contents.configs == configs);
+    REQUIRE(contents.columns == sweepColumnNames(design));
+    REQUIRE(contents.columns[2] == "mass");
+    REQUIRE(contents.results.size() == 10);
+    for (size_t i = 0; i < contents.results.size(); i++)
+    {
+        REQUIRE(contents.results[i].index == i);
+        REQUIRE(contents.results[i].config == i % 2);
+        REQUIRE(contents.results[i].metrics.final_speed == 20.0 + i);
+        REQUIRE(contents.results[i].error.empty() == (i != 7));
+    }
+
+    // A new store replaces the old shards
+    {
+        SweepStore store(dir.string(), design, {}, 10, 1);
+    }
+    REQUIRE(readSweepStore(dir.string()).results.empty());
+    std::filesystem::remove_all(dir);
+    REQUIRE_THROWS(readSweepStore(dir.string()));
+}
+
+// Flies chunks with runSweepRange; optionally drops its connection once,
+// after the given number of chunks
+class TestSweepJob : public SweepWorkerJob
+{
+public:
+    TestSweepJob(const SimulationState &base, const HeadlessRunConfig &run, const SweepDesign &design,
+                 int fail_after = -1)
+        : base(base), run_config(run), design(design), pool(1), fail_after(fail_after)
+    {
+    }
+
+    void prepare(const std::vector<std::string> &args, uint64_t case_count) override
+    {
+        REQUIRE(args == std::vector<std::string>{"--sweep", "test"});
+        REQUIRE(case_count == design.caseCount());
+        prepared++;
+    }
+
+    std::vector<SweepResult> run(size_t first, size_t count) override
+    {
+        if (flown++ == fail_after)
+            throw std::runtime_error("Connection lost while sending");
+        return runSweepRange(base, run_config, design, first, count, pool);
+    }
+
+    size_t axisCount() const override { return design.axes.size(); }
+
+    int prepared = 0;
+    int flown = 0;
+
+private:
+    SimulationState base;
+    HeadlessRunConfig run_config;
+    SweepDesign design;
+    ThreadPool pool;
+    int fail_after;
+};
+
+TEST_CASE("SweepCoordinator - loopback workers fill the store, surviving a dropped worker")
+{
+    SimulationState base;
+    base.reset();
+    base.position = Vec2(0.0, 100.0);
+    base.velocity = Vec2(20.0, 0.0);
+    base.autopilot_speed = true;
+    base.speed_setpoint = 22.0f;
+
+    HeadlessRunConfig run;
+    run.duration = 5.0;
+    run.dt = 0.01;
+
+    SweepDesign design;
+    design.axes.push_back({SweepParameter::Mass, 0.8 * base.aircraft.mass, 1.2 * base.aircraft.mass, 4});
+    design.axes.push_back({SweepParameter::SpeedKp, 0.2, 0.8, 4});
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "fd_sweep_coordinator_test";
+    SweepStore store(dir.string(), design, {}, design.caseCount(), 4);
+    SweepCoordinatorOptions options;
+    options.chunk_cases = 3; // 6 chunks, the last one short
+    options.wait_interval = 0.01;
+    SweepCoordinator coordinator({"--sweep", "test"}, design.caseCount(), store, options);
+    REQUIRE(coordinator.port() != 0);
+
+    SweepCoordinatorStats stats;
+    std::thread serving([&] { stats = coordinator.run(); });
+
+    // Peers that connect and leave do not pile up while the sweep runs
+    for (int i = 0; i < 5; i++)
+    {
+        TcpStream passing;
+        passing.connect("127.0.0.1", coordinator.port());
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (coordinator.connectionCount() > 0 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    REQUIRE(coordinator.connectionCount() == 0);
+
+    // The flaky worker drops its connection on its second chunk, then reconnects
+    TestSweepJob steady(base, run, design), flaky(base, run, design, 1);
+    SweepWorkerOptions worker_options;
+    worker_options.retry_delay = 0.01;
+    SweepWorkerStats steady_stats, flaky_stats;
+    std::thread a([&] { steady_stats = runSweepWorker("127.0.0.1", coordinator.port(), steady, worker_options); });
+    std::thread b([&] { flaky_stats = runSweepWorker("127.0.0.1", coordinator.port(), flaky, worker_options); });
+    a.join();
+    b.join();
+    serving.join();
+    store.close();
+
+    REQUIRE(coordinator.isFinished());
+    REQUIRE(stats.cases == 16);
+    REQUIRE(stats.chunks == 6);
+    REQUIRE(stats.workers >= 2);
+    REQUIRE(steady_stats.chunks + flaky_stats.chunks >= 6);
+    REQUIRE(flaky_stats.connections >= 1); // Reconnects unless the others finished first
+    REQUIRE(flaky.prepared == static_cast<int>(flaky_stats.connections));
+    REQUIRE(stats.reissued >= 1); // The dropped worker's leases went back to the queue
+    REQUIRE(stats.steps == 16 * 500);
+
+    // Every case once, matching a local sweep exactly
+    ThreadPool pool(2);
+    std::vector<SweepResult> local = runSweep(base, run, design, pool);
+    SweepStoreContents contents = readSweepStore(dir.string());
+    REQUIRE(contents.results.size() == local.size());
+    for (size_t i = 0; i < local.size(); i++)
+    {
+        REQUIRE(contents.results[i].index == i);
+        REQUIRE(contents.results[i].values == local[i].values);
+        REQUIRE(contents.results[i].steps == local[i].steps);
+        REQUIRE(contents.results[i].metrics.final_speed == local[i].metrics.final_speed);
+        REQUIRE(contents.results[i].metrics.fuel == local[i].metrics.fuel);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("SweepCoordinator - an overdue lease is flown again by an idle worker")
+{
+    SweepDesign design;
+    design.axes.push_back({SweepParameter::Mass, 800.0, 1200.0, 2});
+    HeadlessRunConfig run;
+    run.duration = 0.5;
+    run.dt = 0.01;
+    SimulationState base;
+    base.reset();
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "fd_sweep_lease_test";
+    SweepStore store(dir.string(), design, {}, 2, 1);
+    SweepCoordinatorOptions options;
+    options.chunk_cases = 2; // One chunk
+    options.lease_timeout = 0.05;
+    options.wait_interval = 0.01;
+    SweepCoordinator coordinator({"--sweep", "test"}, 2, store, options);
+    SweepCoordinatorStats stats;
+    std::thread serving([&] { stats = coordinator.run(); });
+
+    // A client that takes the chunk and never answers
+    TcpStream stuck;
+    stuck.connect("127.0.0.1", coordinator.port());
+    SweepMessage hello;
+    hello.type = SweepMessageType::Hello;
+    hello.put(SWEEP_PROTOCOL_VERSION);
+    hello.put(uint32_t(1));
+    hello.putString("stuck");
+    sendSweepMessage(stuck, hello);
+    REQUIRE(receiveSweepMessage(stuck).type == SweepMessageType::Job);
+    sendSweepMessage(stuck, SweepMessageType::Request);
+    REQUIRE(receiveSweepMessage(stuck).type == SweepMessageType::Chunk);
+
+    TestSweepJob job(base, run, design);
+    SweepWorkerStats worker_stats = runSweepWorker("127.0.0.1", coordinator.port(), job);
+    serving.join();
+    store.close();
+    REQUIRE(worker_stats.chunks == 1);
+    REQUIRE(stats.reissued == 1);
+    REQUIRE(readSweepStore(dir.string()).results.size() == 2);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("SweepCoordinator - drops peers that announce huge messages or go silent")
+{
+    SweepDesign design;
+    design.axes.push_back({SweepParameter::Mass, 800.0, 1200.0, 2});
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "fd_sweep_peer_test";
+    SweepStore store(dir.string(), design, {}, 2, 1);
+    SweepCoordinatorOptions options;
+    options.lease_timeout = 0.2;
+    SweepCoordinator coordinator({"--sweep", "test"}, 2, store, options);
+    std::thread serving([&] { coordinator.run(); });
+
+    // A 1 TiB payload is refused from the header alone
+    TcpStream greedy;
+    greedy.connect("127.0.0.1", coordinator.port());
+    SweepMessageHeader header = {{'F', 'D', 'S', 'W'}, static_cast<uint32_t>(SweepMessageType::Hello),
+                                 uint64_t(1) << 40};
+    greedy.sendAll(&header, sizeof(header));
+    greedy.setReceiveTimeout(5.0);
+    char byte;
+    REQUIRE_THROWS_WITH(greedy.receiveAll(&byte, 1), "Connection closed by peer");
+
+    // A peer that never says hello is cut off after the lease timeout
+    TcpStream silent;
+    silent.connect("127.0.0.1", coordinator.port());
+    silent.setReceiveTimeout(5.0);
+    auto start = std::chrono::steady_clock::now();
+    REQUIRE_THROWS_WITH(silent.receiveAll(&byte, 1), "Connection closed by peer");
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(4));
+
+    coordinator.stop();
+    serving.join();
+    REQUIRE(!coordinator.isFinished());
+    store.close();
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("SimulationThread - rewind returns to an earlier time")
+{
+    SimulationState initial;
+    initial.reset();
+    initial.dt = 0.002;
+    initial.position = Vec2(0.0, 100.0);
+    initial.velocity = Vec2(25.0, 0.0);
+    SimulationThread sim(initial);
+    sim.start();
+
+    // Run until a few keyframes exist
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (sim.latest().t < 2.5 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    const SimulationSnapshot &before = sim.latest();
+    REQUIRE(before.t >= 2.5);
+    uint32_t generation = before.generation;
+
+    SimCommand rewind;
+    rewind.type = SimCommand::Type::Rewind;
+    rewind.time = 1.0;
+    REQUIRE(sim.post(rewind));
+
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (sim.latest().generation == generation && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const SimulationSnapshot &after = sim.latest();
+    sim.stop();
+
+    REQUIRE(after.generation == generation + 1);
+    REQUIRE(after.t < 2.0);
+    REQUIRE(after.rewind_oldest == 0.0);
+}
+
+TEST_CASE("ConfigWatcher - background scan and load with hot reload")
+{
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "config_watcher_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    // Files are replaced by rename so the watcher never sees a half-written one
+    auto writeFile = [&](const std::string &file, const std::string &text)
+    {
+        const fs::path tmp = dir.string() + "_" + file + ".tmp";
+        {
+            std::ofstream out(tmp);
+            out << text;
+        }
+        fs::rename(tmp, dir / file);
+    };
+    auto writeConfig = [&](const std::string &file, double mass)
+    {
+        writeFile(file, "{\"mass\": " + std::to_string(mass) + ", \"S\": 1.5, \"CL_alpha\": 5.7, \"CD0\": 0.03, " +
+                            "\"k\": 0.04, \"maxThrust\": 300, \"aeroDataFile\": \"polar.csv\"}\n");
+    };
+    auto writePolar = [&](const std::string &cl)
+    { writeFile("polar.csv", "alpha,CL,CD\n-10,-0.5,0.05\n10," + cl + ",0.05\n"); };
+    writeConfig("a.json", 10.0);
+    writePolar("1.0");
+
+    ConfigWatcher watcher([&]
+                          {
+        std::vector<AircraftConfigEntry> list;
+        for (const auto &entry : fs::directory_iterator(dir))
+        {
+            if (entry.path().extension() == ".json")
+                list.push_back({entry.path().stem().string(), entry.path().string(), nullptr});
+        }
+        std::sort(list.begin(), list.end(), [](const AircraftConfigEntry &a, const AircraftConfigEntry &b)
+                  { return a.name < b.name; });
+        return list; }, 0.01);
+
+    auto waitFor = [](auto &&done)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            if (done())
+                return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        return false;
+    };
+
+    std::vector<AircraftConfigEntry> configs;
+    ConfigLoadResult result;
+    watcher.start();
+    REQUIRE(waitFor([&]
+                    { return watcher.takeConfigs(configs); }));
+    REQUIRE(configs.size() == 1);
+    REQUIRE_FALSE(watcher.scanning());
+
+    const std::string path = (dir / "a.json").string();
+    watcher.requestLoad(path);
+    REQUIRE(waitFor([&]
+                    { return watcher.takeResult(result); }));
+    REQUIRE_FALSE(result.reload);
+    REQUIRE(result.aircraft);
+    REQUIRE(result.aircraft->mass == 10.0);
+    std::shared_ptr<const AeroDataTable> table = result.aircraft->aeroTable;
+
+    // Editing the JSON reloads it off-thread
+    writeConfig("a.json", 250.0);
+    REQUIRE(waitFor([&]
+                    { return watcher.takeResult(result); }));
+    REQUIRE(result.reload);
+    REQUIRE(result.aircraft->mass == 250.0);
+    REQUIRE(result.aircraft->aeroTable == table); // Unchanged CSV: still the cached table
+
+    // Editing the aero CSV reloads too
+    writePolar("1.25");
+    REQUIRE(waitFor([&]
+                    { return watcher.takeResult(result); }));
+    REQUIRE(result.reload);
+    REQUIRE(result.aircraft->aeroTable != table);
+
+    // A broken edit is reported, not swapped in
+    writeFile("a.json", "{\"mass\": oops}\n");
+    REQUIRE(waitFor([&]
+                    { return watcher.takeResult(result); }));
+    REQUIRE_FALSE(result.aircraft);
+    REQUIRE(result.error.find("a.json:1:10") != std::string::npos);
+
+    // New files in the directory trigger a rescan
+    writeConfig("b.json", 20.0);
+    REQUIRE(waitFor([&]
+                    { return watcher.takeConfigs(configs) && configs.size() == 2; }));
+
+    watcher.stop();
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Profiler - per-thread zones, percentiles and Chrome trace")
+{
+    Profiler &profiler = Profiler::instance();
+    profiler.clear();
+    profiler.setEnabled(true);
+
+    // Zones from several threads land in their own rings without locking
+    const int threads = 4, per_thread = 500;
+    std::vector<std::thread> workers;
+    for (int w = 0; w < threads; w++)
+    {
+        workers.emplace_back([&profiler, w]
+                             {
+                                 profiler.setThreadName("test " + std::to_string(w));
+                                 for (int i = 0; i < per_thread; i++)
+                                 {
+                                     ProfileScope zone(ProfileZone::AeroLookup);
+                                 } });
+    }
+    for (std::thread &t : workers)
+        t.join();
+
+    REQUIRE(profiler.threadCount() >= static_cast<size_t>(threads));
+    std::thread([]
+                { ProfileScope zone(ProfileZone::PID); })
+        .join();
+
+#if FLIGHT_PROFILER
+    // The physics step is instrumented
+    SimulationState state;
+    state.reset();
+    for (int i = 0; i < 10; i++)
+        updatePhysics(state);
+#endif
+
+    ProfileSummary summary = profiler.summarize(60.0);
+    const ProfileZoneStats &aero = summary.zones[static_cast<size_t>(ProfileZone::AeroLookup)];
+    REQUIRE(aero.count == static_cast<size_t>(threads * per_thread));
+    REQUIRE(aero.p50_us <= aero.p95_us);
+    REQUIRE(aero.p95_us <= aero.p99_us);
+    REQUIRE(aero.p99_us <= aero.max_us);
+    REQUIRE(aero.recent_us.size() == 240);
+    float binned = 0.0f;
+    for (float c : aero.histogram)
+        binned += c;
+    REQUIRE(binned == static_cast<float>(aero.count));
+    REQUIRE(summary.zones[static_cast<size_t>(ProfileZone::PID)].count == 1);
+#if FLIGHT_PROFILER
+    REQUIRE(summary.zones[static_cast<size_t>(ProfileZone::Physics)].count == 10);
+    REQUIRE(summary.zones[static_cast<size_t>(ProfileZone::Integrator)].count == 10);
+#endif
+
+    // One complete ("X") event per zone, plus a name per thread
+    namespace fs = std::filesystem;
+    const std::string path = (fs::temp_directory_path() / "flight_profiler_test.json").string();
+    size_t written = profiler.writeChromeTrace(path);
+    profiler.setEnabled(false);
+    std::ifstream in(path);
+    std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    fs::remove(path);
+
+    auto occurrences = [&json](const std::string &needle)
+    {
+        size_t n = 0;
+        for (size_t pos = json.find(needle); pos != std::string::npos; pos = json.find(needle, pos + 1))
+            n++;
+        return n;
+    };
+    REQUIRE(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0);
+    REQUIRE(json.find("\n]}") != std::string::npos);
+    REQUIRE(occurrences("\"ph\":\"X\"") == written);
+    REQUIRE(written >= static_cast<size_t>(threads * per_thread + 1));
+    REQUIRE(occurrences("\"name\":\"Aero lookup\"") == static_cast<size_t>(threads * per_thread));
+    for (int w = 0; w < threads; w++)
+        REQUIRE(occurrences("\"args\":{\"name\":\"test " + std::to_string(w) + "\"}") == 1);
+
+    // Once enough rings exist, finished threads hand theirs to new ones
+    for (int i = 0; i < 40; i++)
+    {
+        std::thread([]
+                    { ProfileScope zone(ProfileZone::PID); })
+            .join();
+    }
+    REQUIRE(profiler.threadCount() <= 16);
+
+    // After clear() nothing old is reported
+    profiler.clear();
+    REQUIRE(profiler.snapshot().empty());
+}
+
+TEST_CASE("ProfileRing - keeps the newest events when it wraps")
+{
+    ProfileRing ring(1);
+    const size_t total = ProfileRing::Capacity + 100;
+    for (size_t i = 0; i < total; i++)
+        ring.push({i, 1, ProfileZone::Physics});
+
+    std::vector<ProfileEvent> events;
+    size_t cursor = ring.copySince(0, events);
+    REQUIRE(cursor == total);
+    REQUIRE(events.size() == ProfileRing::Capacity);
+    REQUIRE(events.front().start_ns == 100);
+    REQUIRE(events.back().start_ns == total - 1);
+
+    // Incremental reads only return what was pushed since the cursor
+    ring.push({total, 1, ProfileZone::Physics});
+    events.clear();
+    REQUIRE(ring.copySince(cursor, events) == total + 1);
+    REQUIRE(events.size() == 1);
+    REQUIRE(events[0].start_ns == total);
+}
+
+namespace
+{
+// Shared-memory names must not collide with a concurrent test run
+std::string uniqueRingName(const char *prefix)
+{
+    return prefix + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+} // namespace
+
+TEST_CASE("TelemetryRing - packets arrive in order and a lapped reader skips ahead")
+{
+    const std::string name = uniqueRingName("fdtest_ring_");
+    TelemetryRingWriter writer(name, 12);
+    REQUIRE(writer.capacity() == 16);
+
+    TelemetryRingReader reader(name);
+    TelemetryPacket p;
+    REQUIRE(reader.next(p) == TelemetryRingReader::Result::Empty);
+    REQUIRE_FALSE(reader.latest(p));
+
+    SimulationState state;
+    state.reset();
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        state.t = i * 0.5;
+        writer.write(TelemetryPacket::fromState(state, i));
+    }
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        REQUIRE(reader.next(p) == TelemetryRingReader::Result::Packet);
+        REQUIRE(p.valid());
+        REQUIRE(p.sequence == i);
+        REQUIRE(p.t == i * 0.5);
+    }
+    REQUIRE(reader.next(p) == TelemetryRingReader::Result::Empty);
+
+    // 40 more packets lap the 16 slots: the reader resumes at the oldest one kept
+    for (uint32_t i = 10; i < 50; i++)
+        writer.write(TelemetryPacket::fromState(state, i));
+    REQUIRE(reader.next(p) == TelemetryRingReader::Result::Overrun);
+    REQUIRE(reader.next(p) == TelemetryRingReader::Result::Packet);
+    REQUIRE(p.sequence == 34);
+    REQUIRE(reader.latest(p));
+    REQUIRE(p.sequence == 49);
+    REQUIRE(reader.next(p) == TelemetryRingReader::Result::Empty);
+
+    // Anything else under the name is rejected
+    REQUIRE_THROWS(TelemetryRingReader(name + "_missing"));
+}
+
+TEST_CASE("TelemetryRing - a concurrent reader never sees a torn packet")
+{
+    const std::string name = uniqueRingName("fdtest_torn_");
+    TelemetryRingWriter writer(name, 8); // Small, so the writer laps the reader constantly
+    TelemetryRingReader reader(name);
+
+    const uint32_t total = 200000;
+    std::thread producer([&]
+                         {
+                             SimulationState state;
+                             state.reset();
+                             for (uint32_t i = 0; i < total; i++)
+                             {
+                                 state.t = i;
+                                 state.position = Vec2(i, 2.0 * i);
+                                 state.velocity = Vec2(3.0 * i, 4.0 * i);
+                                 writer.write(TelemetryPacket::fromState(state, i));
+                             }
+                         });
+
+    uint64_t packets = 0, torn = 0;
+    int64_t last = -1;
+    bool ordered = true;
+    TelemetryPacket p;
+    while (reader.position() < total)
+    {
+        TelemetryRingReader::Result r = reader.next(p);
+        if (r == TelemetryRingReader::Result::Packet)
+        {
+            packets++;
+            if (p.x != p.t || p.y != 2.0 * p.t || p.vx != 3.0 * p.t || p.vy != 4.0 * p.t ||
+                static_cast<double>(p.sequence) != p.t)
+                torn++;
+            ordered = ordered && static_cast<int64_t>(p.sequence) > last;
+            last = p.sequence;
+        }
+        else if (r == TelemetryRingReader::Result::Empty)
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    REQUIRE(packets > 0);
+    REQUIRE(torn == 0);
+    REQUIRE(ordered);
+}
+
+TEST_CASE("TelemetryPublisher - UDP and ring outputs at the configured simulated rate")
+{
+    UdpSocket receiver;
+    receiver.bind(0);
+    REQUIRE(receiver.localPort() != 0);
+
+    TelemetryOptions opts;
+    opts.udp_address = "127.0.0.1";
+    opts.udp_port = receiver.localPort();
+    opts.shm_name = uniqueRingName("fdtest_pub_");
+    opts.shm_slots = 4096;
+    opts.rate_hz = 20.0;
+    TelemetryPublisher publisher(opts);
+    TelemetryRingReader ring(opts.shm_name);
+
+    // 10 s at 200 Hz physics: one packet every 10 steps, including the initial state
+    SimulationState state;
+    state.reset();
+    state.throttle = 0.7f;
+    HeadlessRunConfig run;
+    run.duration = 10.0;
+    run.dt = 0.005;
+    runHeadless(state, run, [&](const SimulationState &s) { publisher.publish(s); });
+    REQUIRE(publisher.packetsSent() == 201);
+    REQUIRE(publisher.udpDropped() == 0);
+
+    // Every ring packet, spaced 50 ms apart in simulated time
+    TelemetryPacket p;
+    std::vector<TelemetryPacket> from_ring;
+    while (ring.next(p) == TelemetryRingReader::Result::Packet)
+        from_ring.push_back(p);
+    REQUIRE(from_ring.size() == 201);
+    for (size_t i = 1; i < from_ring.size(); i++)
+    {
+        REQUIRE(from_ring[i].sequence == from_ring[i - 1].sequence + 1);
+        REQUIRE(from_ring[i].t - from_ring[i - 1].t == Catch::Approx(0.05).margin(1e-9));
+    }
+    REQUIRE(from_ring.back().t == Catch::Approx(state.t));
+    REQUIRE(from_ring.back().x == state.position.x);
+    REQUIRE(from_ring.back().throttle == 0.7f);
+    REQUIRE(from_ring.back().thrust_x == state.F_thrust_viz.x);
+
+    // The same bytes over UDP (loopback never reorders within a socket buffer this small)
+    std::vector<TelemetryPacket> from_udp;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (from_udp.size() < from_ring.size() && std::chrono::steady_clock::now() < deadline)
+    {
+        if (receiver.receive(&p, sizeof(p)) == sizeof(p))
+            from_udp.push_back(p);
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(from_udp.size() == from_ring.size());
+    REQUIRE(from_udp.back().valid());
+    REQUIRE(std::memcmp(&from_udp.back(), &from_ring.back(), sizeof(TelemetryPacket)) == 0);
+
+    // Going back in time (a reset) restarts the spacing instead of pausing the stream
+    state.reset();
+    publisher.publish(state);
+    REQUIRE(publisher.packetsSent() == 202);
+    REQUIRE(ring.next(p) == TelemetryRingReader::Result::Packet);
+    REQUIRE(p.t == 0.0);
+}
+
+TEST_CASE("SimulationThread - publishes telemetry from the physics loop")
+{
+    SimulationState initial;
+    initial.reset();
+    initial.dt = 0.002;
+    SimulationThread sim(initial);
+
+    TelemetryOptions opts;
+    opts.shm_name = uniqueRingName("fdtest_sim_");
+    opts.rate_hz = 0.0; // Every step
+    auto publisher = std::make_shared<TelemetryPublisher>(opts);
+    TelemetryRingReader ring(opts.shm_name);
+
+    SimCommand cmd;
+    cmd.type = SimCommand::Type::SetTelemetry;
+    cmd.telemetry = publisher;
+    REQUIRE(sim.post(cmd));
+    sim.start();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (publisher->packetsSent() < 50 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    REQUIRE(publisher->packetsSent() >= 50);
+
+    // One packet per physics step, the first one the state at the time of the command
+    TelemetryPacket first, second;
+    REQUIRE(ring.next(first) == TelemetryRingReader::Result::Packet);
+    REQUIRE(ring.next(second) == TelemetryRingReader::Result::Packet);
+    REQUIRE(first.t == 0.0);
+    REQUIRE(second.t == Catch::Approx(0.002));
+
+    // Stopping: the worker drops its reference, after which nothing more is published
+    cmd.telemetry.reset();
+    REQUIRE(sim.post(cmd));
+    while (publisher.use_count() > 1 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    REQUIRE(publisher.use_count() == 1);
+    uint64_t sent = publisher->packetsSent();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(publisher->packetsSent() == sent);
+    sim.stop();
+}
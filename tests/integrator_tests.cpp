@@ -169,6 +169,100 @@ TEST_CASE("RK4 integrator - small timestep consistency")
     REQUIRE(std::abs(vel1.y - vel2.y) < 1e-6);
 }
 
+// Unit harmonic oscillator x'' = -x in the position.x / velocity.x components
+static FlightState oscillator(double, const FlightState &y)
+{
+    return {y.velocity, y.position * -1.0, 0.0, 0.0};
+}
+
+TEST_CASE("Coupled RK4 - re-evaluates the derivative at every stage (4th order)")
+{
+    auto errorAfterOnePeriod = [](int steps)
+    {
+        FlightState y = {Vec2(1.0, 0.0), Vec2(0.0, 0.0), 0.0, 0.0};
+        double dt = 2.0 * M_PI / steps;
+        for (int i = 0; i < steps; i++)
+            y = integrateRK4(y, i * dt, dt, oscillator);
+        return std::abs(y.position.x - 1.0) + std::abs(y.velocity.x);
+    };
+
+    // Halving dt cuts the error by ~2^4
+    double coarse = errorAfterOnePeriod(50);
+    double fine = errorAfterOnePeriod(100);
+    REQUIRE(coarse < 1e-4);
+    REQUIRE(coarse / fine > 14.0);
+    REQUIRE(coarse / fine < 18.0);
+}
+
+TEST_CASE("Dormand-Prince - adaptive steps meet the tolerance")
+{
+    FlightState y = {Vec2(1.0, 0.0), Vec2(0.0, 0.0), 0.0, 0.0};
+    AdaptiveOptions opts;
+    opts.rel_tol = 1e-8;
+    opts.abs_tol = 1e-8;
+    opts.max_dt = 10.0;
+    double dt_hint = 0.01;
+
+    AdaptiveStats stats = integrateAdaptive(y, 0.0, 2.0 * M_PI, dt_hint, opts, oscillator);
+
+    // Lands exactly on the end of the interval
+    REQUIRE(std::abs(y.position.x - 1.0) < 1e-6);
+    REQUIRE(std::abs(y.velocity.x) < 1e-6);
+
+    // Grew well past the initial 0.01 s guess: far fewer than 628 steps
+    REQUIRE(stats.accepted < 100);
+    REQUIRE(dt_hint > 0.05);
+    REQUIRE(stats.evaluations == 1 + 6 * (stats.accepted + stats.rejected));
+}
+
+TEST_CASE("Dormand-Prince - tighter tolerance gives a smaller error")
+{
+    auto run = [](double tolerance)
+    {
+        FlightState y = {Vec2(1.0, 0.0), Vec2(0.0, 0.0), 0.0, 0.0};
+        AdaptiveOptions opts;
+        opts.rel_tol = tolerance;
+        opts.abs_tol = tolerance;
+        opts.max_dt = 10.0;
+        double dt_hint = 0.0;
+        integrateAdaptive(y, 0.0, 10.0, dt_hint, opts, oscillator);
+        return std::abs(y.position.x - std::cos(10.0));
+    };
+
+    double loose = run(1e-4);
+    double tight = run(1e-9);
+    REQUIRE(loose < 1e-2);
+    REQUIRE(tight < 1e-7);
+    REQUIRE(tight < loose);
+}
+
+TEST_CASE("Dormand-Prince - a NaN derivative ends the interval instead of looping")
+{
+    FlightState y = {Vec2(1.0, 0.0), Vec2(0.0, 0.0), 0.0, 0.0};
+    auto broken = [](double, const FlightState &s)
+    { return FlightState{s.velocity, Vec2(std::nan(""), 0.0), 0.0, 0.0}; };
+    AdaptiveOptions opts;
+    double dt_hint = 0.01;
+
+    // Shrinks to min_dt, then carries the NaN to the end like the fixed-step methods
+    AdaptiveStats stats = integrateAdaptive(y, 0.0, 1.0, dt_hint, opts, broken);
+    REQUIRE(std::isnan(y.velocity.x));
+    REQUIRE(stats.accepted == 1);
+    REQUIRE(stats.rejected < 20);
+    REQUIRE(dt_hint == opts.min_dt);
+
+    // The next interval gives up at once
+    stats = integrateAdaptive(y, 1.0, 1.0, dt_hint, opts, broken);
+    REQUIRE(stats.accepted + stats.rejected == 1);
+}
+
+// Vec2 arithmetic is usable in constant expressions
+static_assert((Vec2(1.0, 2.0) + Vec2(3.0, 4.0)).x == 4.0, "addition");
+static_assert((Vec2(1.0, 2.0) - Vec2(3.0, 5.0)).y == -3.0, "subtraction");
+static_assert((2.0 * Vec2(1.5, -1.0)).x == 3.0 && (Vec2(4.0, 2.0) / 2.0).y == 1.0, "scaling");
+static_assert(Vec2(3.0, 4.0).dot(Vec2(1.0, 1.0)) == 7.0 && Vec2(3.0, 4.0).magnitudeSquared() == 25.0, "products");
+static_assert((FlightState{Vec2(1.0, 0.0), Vec2(), 2.0, 0.0} * 0.5).pitch_deg == 1.0, "FlightState scaling");
+
 TEST_CASE("Vec2 - magnitude and normalization")
 {
     Vec2 v(3.0, 4.0);
@@ -1,6 +1,9 @@
 #define CATCH_CONFIG_MAIN
 #include "catch_amalgamated.hpp"
 #include "control/pid.hpp"
+#include "control/pid_bank.hpp"
+#include <cstdint>
+#include <vector>
 #include <cmath>
 
 const double tol = 1e-6;
@@ -230,3 +233,93 @@ TEST_CASE("PID - Zero gain stability")
     double output = pid.update(50.0, 30.0, 0.1);
     REQUIRE(std::abs(output - 0.0) < tol);
 }
+
+TEST_CASE("PID - Restored state continues identically")
+{
+    PIDController original(0.5, 0.1, 0.05, 0.0, 1.0);
+    for (int i = 0; i < 20; i++)
+        original.update(30.0, 20.0 + 0.3 * i, 0.1);
+
+    // Copy the internals into a fresh controller with the same gains
+    PIDController restored(original.getKp(), original.getKi(), original.getKd(),
+                           original.getOutputMin(), original.getOutputMax());
+    restored.setState(original.getState());
+    REQUIRE(restored.getIntegralTerm() == original.getIntegralTerm());
+
+    for (int i = 0; i < 20; i++)
+    {
+        double measurement = 26.0 + 0.1 * i;
+        REQUIRE(restored.update(30.0, measurement, 0.1) == original.update(30.0, measurement, 0.1));
+    }
+}
+
+TEST_CASE("PID - setGains keeps the integral term (bumpless)")
+{
+    PIDController pid(0.5, 0.2, 0.0, -10.0, 10.0);
+    for (int i = 0; i < 50; i++)
+        pid.update(10.0, 8.0, 0.1);
+    double i_term = pid.getIntegralTerm();
+    REQUIRE(i_term > 0.0);
+
+    // Doubling Ki halves the stored integral, so Ki * integral is unchanged
+    pid.setGains(0.5, 0.4, 0.0);
+    REQUIRE(std::abs(pid.getIntegralTerm() - i_term) < tol);
+    REQUIRE(pid.getKi() == 0.4);
+
+    // The next output continues from there instead of restarting at zero
+    double output = pid.update(10.0, 8.0, 0.1);
+    REQUIRE(std::abs(output - (0.5 * 2.0 + i_term + 0.4 * 2.0 * 0.1)) < tol);
+
+    // A new Ki is still subject to the anti-windup bound
+    pid.setGains(0.5, 1000.0, 0.0);
+    REQUIRE(std::abs(pid.getState().integral) <= 20.0 / 1000.0 + tol);
+}
+
+TEST_CASE("PIDBank - every lane matches a PIDController")
+{
+    const size_t n = 37; // Not a multiple of any vector width
+    const double dt = 0.05;
+    PIDBank bank(n);
+    std::vector<PIDController> scalar;
+    std::vector<float> setpoint(n), output(n, -5.0f);
+    std::vector<double> measurement(n);
+    std::vector<uint8_t> enabled(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        double kp = 0.1 + 0.05 * i, ki = 0.01 * (i % 5), kd = 0.02 * (i % 3);
+        double lo = i % 2 ? -1.0 : 0.0;
+        bank.configure(i, kp, ki, kd, lo, 1.0);
+        scalar.emplace_back(kp, ki, kd, lo, 1.0);
+        setpoint[i] = 20.0f + static_cast<float>(i);
+        measurement[i] = 10.0 + 0.5 * i;
+        enabled[i] = i % 7 != 3; // A few lanes stay off
+    }
+
+    for (int step = 0; step < 300; step++)
+    {
+        // Retune half of the lanes in the middle of the run
+        if (step == 150)
+        {
+            for (size_t i = 0; i < n; i += 2)
+            {
+                bank.setGains(i, 0.3, 0.05, 0.01);
+                scalar[i].setGains(0.3, 0.05, 0.01);
+            }
+        }
+        bank.update(setpoint.data(), measurement.data(), dt, enabled.data(), output.data());
+        for (size_t i = 0; i < n; i++)
+        {
+            if (!enabled[i])
+            {
+                REQUIRE(output[i] == -5.0f); // Untouched
+                continue;
+            }
+            float expected = static_cast<float>(scalar[i].update(setpoint[i], measurement[i], dt));
+            REQUIRE(std::abs(output[i] - expected) < 1e-6f);
+            REQUIRE(std::abs(bank.getIntegral(i) - scalar[i].getState().integral) < 1e-9);
+            measurement[i] += 0.2 * output[i] - 0.01 * (measurement[i] - 15.0);
+        }
+    }
+    REQUIRE(bank.getKp(0) == 0.3);
+    REQUIRE(bank.getKp(1) == 0.1 + 0.05);
+}
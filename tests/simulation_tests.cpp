@@ -0,0 +1,1098 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "simulation/simulation_state.hpp"
+#include "simulation/physics_update.hpp"
+#include "simulation/fixed_step.hpp"
+#include "simulation/simulation_batch.hpp"
+#include "simulation/specialized_stepper.hpp"
+#include "simulation/simulation_checkpoint.hpp"
+#include "simulation/flight_recording.hpp"
+#include "simulation/trajectory_set.hpp"
+#include "simulation/trim_solver.hpp"
+#include "simulation/run_context.hpp"
+#include "simulation/headless_runner.hpp"
+#include "aircraft/aircraft_loader.hpp"
+#include "core/fast_math.hpp"
+#include <cmath>
+#include <filesystem>
+
+const double tol = 1e-9;
+
+TEST_CASE("Fixed-step accumulator - converts wall time into whole steps")
+{
+    FixedStepAccumulator clock(0.01, 8);
+
+    // 25 ms of wall time = 2 steps with 5 ms left over
+    REQUIRE(clock.advance(0.025) == 2);
+    REQUIRE(std::abs(clock.alpha() - 0.5) < 1e-6);
+
+    // Leftover carries into the next frame
+    REQUIRE(clock.advance(0.005) == 1);
+    REQUIRE(clock.alpha() < 1e-6);
+}
+
+TEST_CASE("Fixed-step accumulator - simulated time tracks wall time at any frame rate")
+{
+    const double dt = 0.002; // 500 Hz physics
+    FixedStepAccumulator clock(dt, 100);
+
+    // 1 second rendered at an uneven ~37 fps
+    int steps = 0;
+    double wall = 0.0;
+    for (int frame = 0; frame < 37; frame++)
+    {
+        double frame_dt = (frame % 2 == 0) ? 0.020 : 0.034054;
+        wall += frame_dt;
+        steps += clock.advance(frame_dt);
+    }
+
+    double simulated = steps * dt + clock.alpha() * dt;
+    REQUIRE(std::abs(simulated - wall) < 1e-9);
+}
+
+TEST_CASE("Fixed-step accumulator - substep guard drops the backlog")
+{
+    FixedStepAccumulator clock(0.01, 4);
+
+    // A 1 s stall must not trigger 100 catch-up steps
+    REQUIRE(clock.advance(1.0) == 4);
+    REQUIRE(clock.alpha() < 1.0);
+    REQUIRE(std::abs(clock.droppedTime() - 0.96) < 1e-6);
+
+    // Back to normal afterwards
+    REQUIRE(clock.advance(0.01) == 1);
+}
+
+TEST_CASE("PhysicsFrame - interpolation between steps")
+{
+    PhysicsFrame a{Vec2(0.0, 100.0), Vec2(20.0, 0.0), 10.0f};
+    PhysicsFrame b{Vec2(2.0, 101.0), Vec2(22.0, 2.0), 20.0f};
+
+    PhysicsFrame mid = PhysicsFrame::interpolate(a, b, 0.5);
+    REQUIRE(std::abs(mid.position.x - 1.0) < tol);
+    REQUIRE(std::abs(mid.position.y - 100.5) < tol);
+    REQUIRE(std::abs(mid.velocity.x - 21.0) < tol);
+    REQUIRE(std::abs(mid.pitch_deg - 15.0f) < 1e-5f);
+
+    // Pitch takes the short way across the +/-180 wrap
+    PhysicsFrame c{Vec2(), Vec2(), 170.0f};
+    PhysicsFrame d{Vec2(), Vec2(), -170.0f};
+    PhysicsFrame wrap = PhysicsFrame::interpolate(c, d, 0.5);
+    REQUIRE(std::abs(std::abs(wrap.pitch_deg) - 180.0f) < 1e-4f);
+}
+
+TEST_CASE("FlightPathHistory - keeps recent points at full rate")
+{
+    FlightPathHistory history(8, 3, 2);
+    for (int i = 0; i < 5; i++)
+        history.push({static_cast<float>(i), 0.0f});
+
+    std::vector<float> xs;
+    history.forEach([&](const FlightPoint &p)
+                    { xs.push_back(p.x); });
+    REQUIRE(xs == std::vector<float>{0, 1, 2, 3, 4});
+    REQUIRE(history.size() == 5);
+    REQUIRE(history.back().x == 4.0f);
+}
+
+TEST_CASE("FlightPathHistory - older points thin out, order stays chronological")
+{
+    FlightPathHistory history(16, 4, 4);
+    const int pushes = 5000;
+    for (int i = 0; i < pushes; i++)
+        history.push({static_cast<float>(i), 0.0f});
+
+    std::vector<float> xs;
+    history.forEach([&](const FlightPoint &p)
+                    { xs.push_back(p.x); });
+
+    // Bounded memory, strictly increasing, ends at the newest point
+    REQUIRE(xs.size() == history.size());
+    REQUIRE(xs.size() <= history.capacity());
+    for (size_t i = 1; i < xs.size(); i++)
+        REQUIRE(xs[i] > xs[i - 1]);
+    REQUIRE(xs.back() == static_cast<float>(pushes - 1));
+
+    // The newest 16 points are consecutive (full rate)
+    for (size_t i = xs.size() - 16; i < xs.size(); i++)
+        REQUIRE(xs[i] == xs.back() - static_cast<float>(xs.size() - 1 - i));
+
+    // The trail reaches back roughly span() pushes, far beyond level-0 capacity
+    REQUIRE(xs.front() <= static_cast<float>(pushes) - 0.5f * static_cast<float>(history.span()));
+}
+
+TEST_CASE("FlightPathHistory - clear empties all levels")
+{
+    FlightPathHistory history(4, 2, 2);
+    for (int i = 0; i < 20; i++)
+        history.push({static_cast<float>(i), 1.0f});
+    history.clear();
+    REQUIRE(history.empty());
+    REQUIRE(history.size() == 0);
+
+    history.push({42.0f, 1.0f});
+    REQUIRE(history.size() == 1);
+    REQUIRE(history.back().x == 42.0f);
+}
+
+TEST_CASE("MonotonicArena - rewinding reuses its blocks")
+{
+    MonotonicArena arena(256);
+    MonotonicArena::Mark start = arena.mark();
+    for (int run = 0; run < 3; run++)
+    {
+        arena.rewind(start);
+        double *a = arena.allocateArray<double>(10);
+        void *aligned = arena.allocate(100, 64);
+        char *big = arena.allocateArray<char>(5000); // Larger than the first block
+        REQUIRE(reinterpret_cast<uintptr_t>(a) % alignof(double) == 0);
+        REQUIRE(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+        big[4999] = 1;
+        a[9] = 1.0;
+        REQUIRE(arena.blockCount() == 2); // Only the first run asks the heap for memory
+    }
+    REQUIRE(arena.used() >= 10 * sizeof(double) + 100 + 5000);
+    REQUIRE(arena.highWater() >= arena.used());
+
+    // pmr containers live in it; a block past the rewind point that is too small is replaced
+    arena.reset();
+    std::pmr::vector<int> v(&arena);
+    v.assign(10000, 7);
+    REQUIRE(v[9999] == 7);
+    REQUIRE(arena.capacity() >= 10000 * sizeof(int));
+}
+
+TEST_CASE("RunContext - reused state matches a fresh copy")
+{
+    Aircraft yp = AircraftLoader::loadFromJSON(std::string(FLIGHT_CONFIG_DIR) + "/2yp.json");
+    SimulationState base;
+    base.aircraft = yp;
+    base.reset();
+    base.position = Vec2(0.0, 100.0);
+    base.velocity = Vec2(20.0, 0.0);
+    base.autopilot_speed = true;
+    base.speed_setpoint = 22.0f;
+    for (int i = 0; i < 50; i++)
+        updatePhysics(base); // Base with a recorded history
+
+    // Borrowing leaves the table's reference count alone
+    long owners = yp.aeroTable.use_count();
+    SimulationState shared = borrowedRunBase(base);
+    REQUIRE(!shared.aircraft.ownsAeroTable());
+    REQUIRE(shared.aircraft.aeroTable.get() == yp.aeroTable.get());
+    REQUIRE(shared.flightPath.empty());
+    {
+        Aircraft copy = shared.aircraft;
+        REQUIRE(yp.aeroTable.use_count() == owners);
+    }
+
+    RunContext context(4096);
+    HeadlessRunConfig run;
+    run.duration = 2.0;
+    run.dt = 0.01;
+    size_t blocks = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        SimulationState fresh = base;
+        fresh.pid_kp = 0.05f * (i + 1);
+        runHeadless(fresh, run, [](const SimulationState &) {});
+
+        SimulationState &state = context.begin(shared);
+        state.pid_kp = 0.05f * (i + 1);
+        std::pmr::vector<double> scratch(1000, 0.0, &context.scratch());
+        runHeadless(state, run, [](const SimulationState &) {});
+        REQUIRE(state.position.x == fresh.position.x);
+        REQUIRE(state.position.y == fresh.position.y);
+        REQUIRE(state.throttle == fresh.throttle);
+
+        // Same-size runs reuse the arena instead of growing it
+        if (i == 1)
+            blocks = context.scratch().blockCount();
+        if (i > 1)
+            REQUIRE(context.scratch().blockCount() == blocks);
+    }
+    REQUIRE(yp.aeroTable.use_count() == owners);
+}
+
+TEST_CASE("updatePhysics - records the flight path only when enabled")
+{
+    SimulationState state;
+    state.reset();
+    for (int i = 0; i < 10; i++)
+        updatePhysics(state);
+    REQUIRE(state.flightPath.size() == 10);
+
+    state.reset();
+    state.record_flight_path = false;
+    for (int i = 0; i < 10; i++)
+        updatePhysics(state);
+    REQUIRE(state.flightPath.empty());
+}
+
+// Climb with both autopilots, run for 'duration' seconds
+static SimulationState integratorRun(IntegrationMethod method, double dt, double duration)
+{
+    SimulationState s;
+    s.reset();
+    s.record_flight_path = false;
+    s.integration_method = method;
+    s.integration_tolerance = 1e-8;
+    s.dt = dt;
+    s.position = Vec2(0.0, 100.0);
+    s.velocity = Vec2(30.0, 0.0);
+    s.elevator = 0.3f;
+    s.throttle = 0.8f;
+    int steps = static_cast<int>(std::lround(duration / dt));
+    for (int i = 0; i < steps; i++)
+        updatePhysics(s);
+    return s;
+}
+
+static double positionError(const SimulationState &a, const SimulationState &b)
+{
+    return (a.position - b.position).magnitude();
+}
+
+TEST_CASE("updatePhysics - coupled integrators converge to the reference trajectory")
+{
+    // Open loop pull-up (controls fixed, so every method integrates the same ODE).
+    // Pitch is stored as float between steps, so few large steps make the
+    // best reference.
+    SimulationState reference = integratorRun(IntegrationMethod::DormandPrince45, 0.5, 10.0);
+
+    SimulationState legacy = integratorRun(IntegrationMethod::Legacy, 0.02, 10.0);
+    SimulationState rk4 = integratorRun(IntegrationMethod::RK4, 0.02, 10.0);
+    SimulationState dp45 = integratorRun(IntegrationMethod::DormandPrince45, 0.25, 10.0);
+
+    // Re-evaluating the forces makes RK4 far more accurate at the same dt
+    REQUIRE(positionError(rk4, reference) < 1e-3);
+    REQUIRE(positionError(rk4, reference) * 100.0 < positionError(legacy, reference));
+
+    // The adaptive method takes 40 outer steps of 0.25 s and still matches
+    REQUIRE(positionError(dp45, reference) < 1e-3);
+    REQUIRE(std::abs(dp45.t - 10.0) < 1e-9);
+    REQUIRE(std::abs(dp45.pitch_deg - reference.pitch_deg) < 1e-3f);
+    REQUIRE(std::abs(dp45.alpha_deg - reference.alpha_deg) < 1e-3f);
+    REQUIRE(dp45.adaptive_dt > 0.0);
+}
+
+TEST_CASE("updatePhysics - dp45 returns on a state that turns NaN")
+{
+    // Zero mass makes the acceleration non-finite; every step must still end
+    SimulationState s;
+    s.reset();
+    s.record_flight_path = false;
+    s.integration_method = IntegrationMethod::DormandPrince45;
+    s.aircraft.mass = 0.0;
+    s.position = Vec2(0.0, 100.0);
+    s.velocity = Vec2(30.0, 0.0);
+    s.throttle = 0.5f;
+    HeadlessRunConfig run;
+    run.duration = 2.0;
+    run.dt = 0.016;
+    REQUIRE(runHeadless(s, run) == 125);
+    REQUIRE(std::abs(s.t - 2.0) < 1e-6);
+    REQUIRE_FALSE(std::isfinite(s.position.x + s.velocity.x));
+}
+
+TEST_CASE("updatePhysics - default integrator is the legacy scheme")
+{
+    SimulationState s;
+    REQUIRE(s.integration_method == IntegrationMethod::Legacy);
+    s.reset();
+    updatePhysics(s);
+    REQUIRE(s.integrator_evaluations == 1);
+
+    s.integration_method = IntegrationMethod::RK4;
+    updatePhysics(s);
+    REQUIRE(s.integrator_evaluations == 5); // 4 stages + forces for display
+}
+
+// The force model building blocks are constexpr and can be checked at compile time
+static_assert(pitchAcceleration(1.225, 0.0, 1.0, 0.0) == 0.0, "no pitch authority without airspeed");
+static_assert(pitchAcceleration(1.225, 40.0, 0.5, 0.0) == 0.5 * 50.0 * 5.0, "full authority above q = 500 Pa");
+static_assert(pitchAcceleration(1.225, 40.0, 0.0, 10.0) == -50.0, "pitch rate is damped");
+static_assert(PolarAeroModel(5.0, 0.02, 0.05).coefficients(0.1, 30.0, AtmosphereState{}, 0.0).CL == 0.5,
+              "linear lift");
+static_assert(calcThrust(0.5, 400.0) == 200.0 && calcWeight(2.0, 10.0) == 20.0, "thrust and weight");
+
+// Step 'steps' times with updatePhysics and with the specialized stepper and compare
+static void requireSpecializedMatchesUpdatePhysics(SimulationState s, int steps)
+{
+    s.record_flight_path = false;
+    SimulationState reference = s;
+    for (int i = 0; i < steps; i++)
+        updatePhysics(reference);
+
+    runSpecialized(s, steps);
+
+    auto close = [](double a, double b)
+    { return std::abs(a - b) <= 1e-9 * (1.0 + std::abs(b)); };
+    REQUIRE(close(s.position.x, reference.position.x));
+    REQUIRE(close(s.position.y, reference.position.y));
+    REQUIRE(close(s.velocity.x, reference.velocity.x));
+    REQUIRE(close(s.velocity.y, reference.velocity.y));
+    REQUIRE(std::abs(s.pitch_deg - reference.pitch_deg) < 1e-4f);
+    REQUIRE(std::abs(s.alpha_deg - reference.alpha_deg) < 1e-4f);
+    REQUIRE(std::abs(s.throttle - reference.throttle) < 1e-6f);
+    REQUIRE(std::abs(s.elevator - reference.elevator) < 1e-6f);
+    REQUIRE(close(s.F_lift_viz.y, reference.F_lift_viz.y));
+    REQUIRE(s.t == reference.t);
+    REQUIRE(s.integrator_evaluations == reference.integrator_evaluations);
+}
+
+TEST_CASE("SpecializedStepper - follows updatePhysics for every policy combination")
+{
+    Aircraft table_aircraft = AircraftLoader::loadFromJSON(std::string(FLIGHT_CONFIG_DIR) + "/2yp.json");
+    REQUIRE(table_aircraft.hasAeroTable());
+
+    const IntegrationMethod methods[] = {IntegrationMethod::Legacy, IntegrationMethod::RK4,
+                                         IntegrationMethod::DormandPrince45};
+    for (int table = 0; table < 2; table++)
+    {
+        for (int autopilot = 0; autopilot < 4; autopilot++)
+        {
+            for (IntegrationMethod method : methods)
+            {
+                SimulationState s;
+                if (table)
+                    s.aircraft = table_aircraft;
+                s.reset();
+                s.dt = 0.01;
+                s.position = Vec2(0.0, 80.0);
+                s.velocity = Vec2(22.0, 0.0);
+                s.elevator = 0.1f;
+                s.integration_method = method;
+                s.autopilot_speed = (autopilot & 1) != 0;
+                s.autopilot_altitude = (autopilot & 2) != 0;
+                s.speed_setpoint = 25.0f;
+                s.altitude_setpoint = 90.0f;
+                s.pid_kp = 0.05f; // Pending gain change, applied on the first step
+                requireSpecializedMatchesUpdatePhysics(s, 800);
+            }
+        }
+    }
+}
+
+// Run each state with updatePhysics and the same states as batch lanes and compare
+static void requireBatchMatchesScalar(std::vector<SimulationState> states, int steps)
+{
+    SimulationBatch batch(states.size());
+    batch.dt = states[0].dt;
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        states[i].record_flight_path = false;
+        batch.setLane(i, states[i]);
+    }
+
+    batch.run(steps);
+    for (SimulationState &s : states)
+    {
+        for (int n = 0; n < steps; n++)
+            updatePhysics(s);
+    }
+
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        SimulationState lane;
+        batch.getLane(i, lane);
+        const SimulationState &ref = states[i];
+        REQUIRE(std::abs(lane.position.x - ref.position.x) < 1e-6 * (1.0 + std::abs(ref.position.x)));
+        REQUIRE(std::abs(lane.position.y - ref.position.y) < 1e-6 * (1.0 + std::abs(ref.position.y)));
+        REQUIRE(std::abs(lane.velocity.x - ref.velocity.x) < 1e-6 * (1.0 + std::abs(ref.velocity.x)));
+        REQUIRE(std::abs(lane.velocity.y - ref.velocity.y) < 1e-6 * (1.0 + std::abs(ref.velocity.y)));
+        REQUIRE(std::abs(lane.pitch_deg - ref.pitch_deg) < 1e-3f);
+        REQUIRE(std::abs(lane.throttle - ref.throttle) < 1e-5f);
+        REQUIRE(std::abs(lane.elevator - ref.elevator) < 1e-5f);
+        REQUIRE(std::abs(lane.t - ref.t) < tol);
+    }
+}
+
+TEST_CASE("SimulationBatch - lanes follow updatePhysics (legacy model)")
+{
+    std::vector<SimulationState> states(4);
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        SimulationState &s = states[i];
+        s.reset();
+        s.dt = 0.01;
+        s.position = Vec2(0.0, 50.0 + 20.0 * i);
+        s.velocity = Vec2(25.0 + i, 0.0);
+        s.aircraft.mass = 100.0 + 10.0 * i;
+    }
+    states[0].elevator = 0.2f;               // Open loop pitch-up
+    states[1].autopilot_speed = true;        // Speed hold
+    states[2].autopilot_altitude = true;     // Altitude hold
+    states[3].autopilot_speed = true;        // Both
+    states[3].autopilot_altitude = true;
+
+    requireBatchMatchesScalar(states, 1000);
+}
+
+TEST_CASE("SimulationBatch - lanes follow updatePhysics (table model, ground contact)")
+{
+    std::vector<AeroDataTable::DataPoint> pts;
+    for (int deg = -10; deg <= 20; deg += 2)
+        pts.push_back({deg * M_PI / 180.0, 0.4 + 0.1 * deg - (deg > 12 ? 0.15 * (deg - 12) : 0.0), 0.02 + 0.0004 * deg * deg});
+    auto table = std::make_shared<AeroDataTable>(AeroDataTable::fromPoints(pts));
+
+    std::vector<SimulationState> states(3);
+    for (SimulationState &s : states)
+    {
+        s.reset();
+        s.aircraft.aeroTable = table;
+    }
+    states[0].velocity = Vec2(30.0, 0.0);
+    states[0].position = Vec2(0.0, 100.0);
+    states[0].autopilot_speed = true;
+    states[0].autopilot_altitude = true;
+    states[1].throttle = 0.0f; // Sits on the ground
+    states[2].throttle = 1.0f; // Takeoff roll
+    states[2].elevator = 0.3f;
+
+    requireBatchMatchesScalar(states, 1500);
+}
+
+TEST_CASE("fastmath - sincos and atan2 match libm")
+{
+    for (double x = -10.0; x <= 10.0; x += 0.001)
+    {
+        double s, c;
+        fastmath::sincos(x, s, c);
+        REQUIRE(std::abs(s - std::sin(x)) < 1e-15);
+        REQUIRE(std::abs(c - std::cos(x)) < 1e-15);
+    }
+    for (double a = -3.2; a <= 3.2; a += 0.01)
+    {
+        for (double r : {1e-3, 1.0, 250.0})
+        {
+            double y = r * std::sin(a), x = r * std::cos(a);
+            REQUIRE(std::abs(fastmath::atan2(y, x) - std::atan2(y, x)) < 1e-15);
+        }
+    }
+    REQUIRE(fastmath::atan2(0.0, 0.0) == 0.0);
+    REQUIRE(std::abs(fastmath::atan2(0.0, -1.0) - M_PI) < 1e-15);
+    REQUIRE(std::abs(fastmath::atan2(1.0, 0.0) - M_PI / 2.0) < 1e-15);
+}
+
+// Powered climb with both autopilots, partway through the step response
+static SimulationState checkpointTestState(IntegrationMethod method)
+{
+    SimulationState s;
+    s.aircraft = AircraftLoader::loadFromJSON(std::string(FLIGHT_CONFIG_DIR) + "/2yp.json");
+    s.reset();
+    s.dt = 0.01;
+    s.position = Vec2(0.0, 100.0);
+    s.velocity = Vec2(20.0, 0.0);
+    s.integration_method = method;
+    s.autopilot_speed = true;
+    s.speed_setpoint = 22.0f;
+    s.autopilot_altitude = true;
+    s.altitude_setpoint = 120.0f;
+    s.record_flight_path = false;
+    for (int i = 0; i < 700; i++)
+        updatePhysics(s);
+    return s;
+}
+
+static void requireSameFlightState(const SimulationState &a, const SimulationState &b)
+{
+    REQUIRE(a.t == b.t);
+    REQUIRE(a.position.x == b.position.x);
+    REQUIRE(a.position.y == b.position.y);
+    REQUIRE(a.velocity.x == b.velocity.x);
+    REQUIRE(a.velocity.y == b.velocity.y);
+    REQUIRE(a.pitch_deg == b.pitch_deg);
+    REQUIRE(a.pitch_rate == b.pitch_rate);
+    REQUIRE(a.throttle == b.throttle);
+    REQUIRE(a.elevator == b.elevator);
+    REQUIRE(a.adaptive_dt == b.adaptive_dt);
+    REQUIRE(a.speed_pid.getIntegralTerm() == b.speed_pid.getIntegralTerm());
+    REQUIRE(a.altitude_pid.getIntegralTerm() == b.altitude_pid.getIntegralTerm());
+}
+
+TEST_CASE("SimulationCheckpoint - restored run continues bit for bit")
+{
+    const IntegrationMethod methods[] = {IntegrationMethod::Legacy, IntegrationMethod::RK4,
+                                         IntegrationMethod::DormandPrince45};
+    for (IntegrationMethod method : methods)
+    {
+        SimulationState original = checkpointTestState(method);
+        SimulationCheckpoint checkpoint = SimulationCheckpoint::capture(original);
+
+        // Restore into a state that has flown something else entirely
+        SimulationState restored;
+        restored.reset();
+        restored.velocity = Vec2(50.0, 5.0);
+        restored.autopilot_speed = true;
+        for (int i = 0; i < 50; i++)
+            updatePhysics(restored);
+        checkpoint.restore(restored);
+        restored.record_flight_path = false;
+
+        for (int i = 0; i < 1500; i++)
+        {
+            updatePhysics(original);
+            updatePhysics(restored);
+        }
+        requireSameFlightState(original, restored);
+    }
+}
+
+TEST_CASE("SimulationCheckpoint - binary round trip")
+{
+    SimulationState original = checkpointTestState(IntegrationMethod::DormandPrince45);
+    std::vector<uint8_t> bytes = SimulationCheckpoint::capture(original).serialize();
+    SimulationCheckpoint loaded = SimulationCheckpoint::deserialize(bytes);
+    REQUIRE_FALSE(loaded.aircraft.hasAeroTable()); // Only the file name is stored
+
+    // The table comes from the target, which loaded the same config
+    SimulationState restored;
+    restored.aircraft = AircraftLoader::loadFromJSON(std::string(FLIGHT_CONFIG_DIR) + "/2yp.json");
+    restored.record_flight_path = false;
+    loaded.restore(restored);
+    REQUIRE(restored.aircraft.hasAeroTable());
+    REQUIRE(restored.integration_method == IntegrationMethod::DormandPrince45);
+    REQUIRE(restored.autopilot_speed);
+    REQUIRE(restored.altitude_setpoint == original.altitude_setpoint);
+
+    for (int i = 0; i < 500; i++)
+    {
+        updatePhysics(original);
+        updatePhysics(restored);
+    }
+    requireSameFlightState(original, restored);
+
+    // A target without the table cannot take the checkpoint
+    SimulationState polar;
+    REQUIRE_THROWS_AS(loaded.restore(polar), std::runtime_error);
+
+    // Corrupted input is rejected, not misread
+    std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 8);
+    REQUIRE_THROWS_AS(SimulationCheckpoint::deserialize(truncated), std::runtime_error);
+    std::vector<uint8_t> bad_magic = bytes;
+    bad_magic[0] = 'X';
+    REQUIRE_THROWS_AS(SimulationCheckpoint::deserialize(bad_magic), std::runtime_error);
+}
+
+// Moderate Dryden turbulence over a light headwind, with a gust at t = 3 s
+static WindConditions testWind(uint64_t seed)
+{
+    WindConditions c;
+    c.speed = -4.0;
+    c.turbulence = TurbulenceModel::Dryden;
+    c.turbulence_w20 = turbulenceIntensity("moderate");
+    c.seed = seed;
+    c.gusts.push_back(WindGust{3.0, 1.5, 3.0, -2.0});
+    return c;
+}
+
+TEST_CASE("Wind - calm conditions fly exactly as still air")
+{
+    SimulationState still = checkpointTestState(IntegrationMethod::RK4);
+    SimulationState calm = still;
+    calm.setWind(WindConditions{});
+    for (int i = 0; i < 1000; i++)
+    {
+        updatePhysics(still);
+        updatePhysics(calm);
+    }
+    requireSameFlightState(still, calm);
+    REQUIRE(calm.wind_velocity.x == 0.0);
+}
+
+// Trimmed level cruise with the speed hold engaged (stays airborne for minutes)
+static SimulationState windCruiseState(IntegrationMethod method)
+{
+    SimulationState s;
+    s.reset();
+    s.dt = 0.01;
+    s.integration_method = method;
+    s.record_flight_path = false;
+    s.autopilot_speed = true;
+    s.speed_setpoint = 40.0f;
+    TrimCondition cond = {40.0, 500.0};
+    applyTrim(s, cond, solveTrim(s.aircraft, cond));
+    return s;
+}
+
+TEST_CASE("Wind - speed hold flies airspeed in a headwind")
+{
+    for (IntegrationMethod method : {IntegrationMethod::Legacy, IntegrationMethod::RK4})
+    {
+        WindConditions c;
+        c.speed = -5.0;
+        c.shear_exponent = 0.0;
+
+        // Entering the headwind at the trimmed ground speed: the autopilot
+        // slows down until the airspeed is back at the setpoint
+        SimulationState s = windCruiseState(method);
+        s.setWind(c);
+        REQUIRE(s.wind_velocity.x == -5.0);
+        for (int i = 0; i < 6000; i++)
+            updatePhysics(s);
+        Vec2 air = s.velocity - s.wind_velocity;
+        REQUIRE(std::abs(air.magnitude() - s.speed_setpoint) < 1.0);
+        REQUIRE(std::abs(s.velocity.x - (s.speed_setpoint - 5.0)) < 1.0);
+        REQUIRE(std::abs(s.position.y - 500.0) < 10.0);
+
+        // Moving with a uniform wind flies exactly as still air
+        SimulationState still = windCruiseState(method);
+        SimulationState drifting = still;
+        drifting.setWind(c);
+        drifting.velocity = drifting.velocity + drifting.wind_velocity;
+        for (int i = 0; i < 3000; i++)
+        {
+            updatePhysics(still);
+            updatePhysics(drifting);
+        }
+        Vec2 drift_air = drifting.velocity - drifting.wind_velocity;
+        REQUIRE(std::abs(drift_air.x - still.velocity.x) < 1e-6);
+        REQUIRE(std::abs(drift_air.y - still.velocity.y) < 1e-6);
+        REQUIRE(std::abs(drifting.position.y - still.position.y) < 1e-6);
+        REQUIRE(std::abs(drifting.throttle - still.throttle) < 1e-5);
+    }
+}
+
+TEST_CASE("Wind - turbulence is reproducible per seed")
+{
+    SimulationState a = windCruiseState(IntegrationMethod::RK4);
+    SimulationState b = a, c = a;
+    a.setWind(testWind(21));
+    b.setWind(testWind(21));
+    c.setWind(testWind(22));
+    for (int i = 0; i < 3000; i++)
+    {
+        updatePhysics(a);
+        updatePhysics(b);
+        updatePhysics(c);
+    }
+    requireSameFlightState(a, b);
+    REQUIRE(a.turbulence_phase.u == b.turbulence_phase.u);
+    REQUIRE(a.turbulence_phase.u > 0.0);
+    REQUIRE(a.position.y > 400.0);
+    REQUIRE(a.position.y != c.position.y);
+
+    // reset() flies the same air again
+    a.reset();
+    REQUIRE(a.turbulence_phase.u == 0.0);
+    REQUIRE(a.wind != nullptr);
+}
+
+TEST_CASE("Wind - specialized stepper and batch lanes follow updatePhysics")
+{
+    Aircraft table_aircraft = AircraftLoader::loadFromJSON(std::string(FLIGHT_CONFIG_DIR) + "/2yp.json");
+    for (IntegrationMethod method : {IntegrationMethod::Legacy, IntegrationMethod::RK4,
+                                     IntegrationMethod::DormandPrince45})
+    {
+        SimulationState s;
+        s.aircraft = table_aircraft;
+        s.reset();
+        s.dt = 0.01;
+        s.position = Vec2(0.0, 80.0);
+        s.velocity = Vec2(22.0, 0.0);
+        s.integration_method = method;
+        s.autopilot_speed = true;
+        s.autopilot_altitude = true;
+        s.speed_setpoint = 24.0f;
+        s.altitude_setpoint = 90.0f;
+        s.setWind(testWind(5));
+        requireSpecializedMatchesUpdatePhysics(s, 800);
+    }
+
+    // Lanes with their own seeds (and one in still air) next to each other
+    std::vector<SimulationState> states(4);
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        SimulationState &s = states[i];
+        s.reset();
+        s.dt = 0.01;
+        s.position = Vec2(0.0, 60.0 + 10.0 * i);
+        s.velocity = Vec2(25.0, 0.0);
+        s.autopilot_speed = true;
+        s.autopilot_altitude = true;
+        if (i > 0)
+            s.setWind(testWind(turbulenceSeed(9, i)));
+    }
+    requireBatchMatchesScalar(states, 1000);
+}
+
+TEST_CASE("Wind - checkpoint carries the field and the turbulence phase")
+{
+    SimulationState original = checkpointTestState(IntegrationMethod::Legacy);
+    original.setWind(testWind(77));
+    for (int i = 0; i < 200; i++)
+        updatePhysics(original);
+
+    std::vector<uint8_t> bytes = SimulationCheckpoint::capture(original).serialize();
+    SimulationCheckpoint loaded = SimulationCheckpoint::deserialize(bytes);
+    SimulationState restored;
+    restored.aircraft = AircraftLoader::loadFromJSON(std::string(FLIGHT_CONFIG_DIR) + "/2yp.json");
+    restored.record_flight_path = false;
+    loaded.restore(restored);
+    REQUIRE(restored.wind != nullptr);
+    REQUIRE(restored.windConditions().seed == 77);
+    REQUIRE(restored.windConditions().gusts.size() == 1);
+    REQUIRE(restored.turbulence_phase.u == original.turbulence_phase.u);
+
+    for (int i = 0; i < 500; i++)
+    {
+        updatePhysics(original);
+        updatePhysics(restored);
+    }
+    requireSameFlightState(original, restored);
+
+    std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 20);
+    REQUIRE_THROWS_AS(SimulationCheckpoint::deserialize(truncated), std::runtime_error);
+}
+
+TEST_CASE("KeyframeRing - rewind reproduces the original trajectory")
+{
+    SimulationState s = checkpointTestState(IntegrationMethod::Legacy);
+    KeyframeRing ring(8, 1.0);
+
+    // 12 s of flight: keyframes once per second, only the last 8 kept
+    std::vector<SimulationState> history;
+    ring.record(s);
+    for (int i = 0; i < 1200; i++)
+    {
+        updatePhysics(s);
+        ring.record(s);
+        if (i == 1049)
+            history.push_back(s); // 10.5 s after the start of the ring
+    }
+    REQUIRE(ring.size() == 8);
+    REQUIRE(std::abs(ring.newestTime() - (ring.oldestTime() + 7.0)) < 1e-6);
+    REQUIRE(ring.latestAtOrBefore(ring.oldestTime() - 0.5) == nullptr);
+
+    SimulationState rewound = s;
+    REQUIRE(rewindTo(rewound, ring, history[0].t));
+    requireSameFlightState(rewound, history[0]);
+
+    // Dropping the discarded future leaves the keyframe the rewind started from
+    ring.truncateAfter(rewound.t);
+    REQUIRE(ring.newestTime() <= rewound.t);
+    REQUIRE(ring.newestTime() > rewound.t - 1.0);
+
+    // Too old for the ring
+    REQUIRE_FALSE(rewindTo(rewound, ring, ring.oldestTime() - 1.0));
+}
+
+TEST_CASE("FlightRecording - columnar chunks round trip with O(1) seek")
+{
+    std::string path = (std::filesystem::temp_directory_path() / "flight_recording_test.fdrec").string();
+
+    SimulationState s = checkpointTestState(IntegrationMethod::Legacy);
+    std::vector<RecordedSample> expected;
+    {
+        // Small chunks so the run spans many of them and ends in a partial one
+        RecordingWriter writer(path, s.aircraft.configHash(), s.dt, 64, 2);
+        for (int i = 0; i < 1000; i++)
+        {
+            updatePhysics(s);
+            RecordedSample sample = RecordedSample::fromState(s);
+            writer.write(sample);
+            expected.push_back(sample);
+        }
+        writer.close();
+        REQUIRE(writer.sampleCount() == 1000);
+    }
+
+    RecordingReader reader(path);
+    REQUIRE(reader.sampleCount() == 1000);
+    REQUIRE(reader.chunkSamples() == 64);
+    REQUIRE(reader.configHash() == s.aircraft.configHash());
+    REQUIRE(reader.startTime() == expected.front()[RecordingChannel::T]);
+    REQUIRE(reader.endTime() == expected.back()[RecordingChannel::T]);
+
+    for (uint64_t i = 0; i < expected.size(); i++)
+    {
+        RecordedSample got = reader.sample(i);
+        for (uint32_t c = 0; c < RECORDING_CHANNEL_COUNT; c++)
+            REQUIRE(got.values[c] == expected[i].values[c]);
+    }
+
+    // Seek by time lands on the matching sample, clamped at both ends
+    REQUIRE(reader.indexAt(expected[500][RecordingChannel::T]) == 500);
+    REQUIRE(reader.indexAt(expected[999][RecordingChannel::T] + 0.4 * s.dt) == 999);
+    REQUIRE(reader.indexAt(-100.0) == 0);
+    REQUIRE(reader.indexAt(1e9) == 999);
+
+    // Block access runs to the end of the chunk (the last one is partial)
+    size_t count = 0;
+    const double *x = reader.block(RecordingChannel::X, 130, count);
+    REQUIRE(count == 62);
+    REQUIRE(x[0] == expected[130][RecordingChannel::X]);
+    x = reader.block(RecordingChannel::X, 999, count);
+    REQUIRE(count == 1);
+    REQUIRE_THROWS_AS(reader.value(RecordingChannel::X, 1000), std::out_of_range);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("FlightRecording - a file cut off mid-chunk keeps its complete chunks")
+{
+    std::string path = (std::filesystem::temp_directory_path() / "flight_recording_cut.fdrec").string();
+    {
+        RecordingWriter writer(path, 42, 0.01, 32);
+        SimulationState s;
+        for (int i = 0; i < 100; i++)
+        {
+            s.t = i * 0.01;
+            s.position = Vec2(i, -i);
+            writer.write(s);
+        }
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 100);
+
+    RecordingReader reader(path);
+    REQUIRE(reader.sampleCount() == 96); // Three full chunks; the short fourth is incomplete
+    REQUIRE(reader.value(RecordingChannel::X, 95) == 95.0);
+    REQUIRE(reader.value(RecordingChannel::Y, 95) == -95.0);
+    std::filesystem::remove(path);
+
+    // Not a recording at all
+    std::string junk = (std::filesystem::temp_directory_path() / "flight_recording_junk.fdrec").string();
+    {
+        std::FILE *f = std::fopen(junk.c_str(), "wb");
+        std::fputs("this is not a flight recording, only some text that is long enough for a header", f);
+        std::fclose(f);
+    }
+    REQUIRE_THROWS_AS(RecordingReader(junk), std::runtime_error);
+    std::filesystem::remove(junk);
+}
+
+TEST_CASE("Aircraft - config hash tracks the configuration")
+{
+    Aircraft a, b;
+    REQUIRE(a.configHash() == b.configHash());
+    b.mass += 1.0;
+    REQUIRE(a.configHash() != b.configHash());
+    b = a;
+    b.aeroDataFile = "polar.csv";
+    REQUIRE(a.configHash() != b.configHash());
+}
+
+TEST_CASE("AircraftLoader - single-pass JSON parse")
+{
+    const std::string json = "{\n  \"mass\": 25.0, \"S\": 1.45,\n  \"notes\": {\"tags\": [1, \"a\\\"b\", true, null]},\n"
+                             "  \"CL_alpha\": 5.7, \"CD0\": 0.175, \"k\": 0.04,\n  \"maxThrust\": 1.6e2,\n"
+                             "  \"chord\": 0.3, \"aeroDataFile\": \"dir\\/polar.csv\"\n}\n";
+    Aircraft ac = AircraftLoader::parseJSON(json.data(), json.data() + json.size(), "inline.json");
+    REQUIRE(ac.mass == 25.0);
+    REQUIRE(ac.maxThrust == 160.0);
+    REQUIRE(ac.chord == 0.3);
+    REQUIRE(ac.aeroDataFile == "dir/polar.csv");
+
+    // Shipped configs load as before
+    Aircraft yp = AircraftLoader::loadFromJSON(std::string(FLIGHT_CONFIG_DIR) + "/2yp.json");
+    REQUIRE(yp.mass == 25.0);
+    REQUIRE(yp.aeroTable != nullptr);
+
+    // Variants naming the same aero file share one parsed table
+    for (int i = 0; i < 1000; i++)
+        REQUIRE(AircraftLoader::loadFromJSON(std::string(FLIGHT_CONFIG_DIR) + "/2yp.json").aeroTable == yp.aeroTable);
+
+    const std::string bad = "{\n  \"mass\": 25.0,\n  \"S\": 1.45x\n}";
+    try
+    {
+        AircraftLoader::parseJSON(bad.data(), bad.data() + bad.size(), "bad.json");
+        FAIL("expected a ParseError");
+    }
+    catch (const ParseError &e)
+    {
+        REQUIRE(e.line() == 3);
+        REQUIRE(e.column() == 12);
+    }
+
+    const std::string missing = "{\"mass\": 25.0}";
+    REQUIRE_THROWS_WITH(AircraftLoader::parseJSON(missing.data(), missing.data() + missing.size(), "m.json"),
+                        "Key not found in JSON: S");
+}
+
+TEST_CASE("AircraftLoader - autopilot gains are written back in place")
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "gains_test.json").string();
+    const std::string original = "{\n  \"mass\": 25.0, \"S\": 1.45,\n  \"notes\": {\"pid_kp\": [1, 2]},\n"
+                                 "  \"CL_alpha\": 5.7, \"CD0\": 0.175, \"k\": 0.04,\n  \"pid_kp\":  9.5e-3 ,\n"
+                                 "  \"maxThrust\": 160.0\n}\n";
+    {
+        std::FILE *f = std::fopen(path.c_str(), "wb");
+        std::fputs(original.c_str(), f);
+        std::fclose(f);
+    }
+    Aircraft before = AircraftLoader::loadFromJSON(path);
+    REQUIRE(before.autopilotFromConfig);
+    REQUIRE(before.autopilot.speed_kp == 9.5e-3);
+    REQUIRE(before.autopilot.altitude_kd == AutopilotGains().altitude_kd); // Missing keys keep the defaults
+
+    AutopilotGains gains;
+    gains.speed_kp = 0.0421697;
+    gains.speed_ki = 0.01;
+    gains.speed_kd = 0.00486247;
+    gains.altitude_kp = 0.177828;
+    gains.altitude_ki = 1e-05;
+    gains.altitude_kd = 0.379254;
+    AircraftLoader::writeAutopilotGains(path, gains);
+
+    Aircraft after = AircraftLoader::loadFromJSON(path);
+    for (int i = 0; i < 6; i++)
+        REQUIRE(after.autopilot.at(i) == gains.at(i));
+    REQUIRE(after.mass == 25.0);
+    REQUIRE(after.maxThrust == 160.0);
+    REQUIRE(after.configHash() == before.configHash()); // Gains are not part of the airframe
+
+    // Everything else is untouched: the nested key is skipped, the present
+    // gain changes in place and the rest are appended with the file's indent
+    std::string text;
+    {
+        std::FILE *f = std::fopen(path.c_str(), "rb");
+        char buf[1024];
+        size_t n = std::fread(buf, 1, sizeof(buf), f);
+        std::fclose(f);
+        text.assign(buf, n);
+    }
+    REQUIRE(text.find("\"notes\": {\"pid_kp\": [1, 2]}") != std::string::npos);
+    REQUIRE(text.find("\"pid_kp\":  0.0421697 ,") != std::string::npos);
+    REQUIRE(text.find("\"maxThrust\": 160.0,\n  \"pid_ki\": 0.01,\n") != std::string::npos);
+    REQUIRE(text.substr(text.size() - 3) == "\n}\n");
+    REQUIRE(!std::filesystem::exists(path + ".tmp"));
+    std::filesystem::remove(path);
+
+    REQUIRE_THROWS(AircraftLoader::writeAutopilotGains(path, gains)); // File must exist
+}
+
+TEST_CASE("TrimSolver - trimmed start holds level flight")
+{
+    Aircraft yp = AircraftLoader::loadFromJSON(std::string(FLIGHT_CONFIG_DIR) + "/2yp.json");
+    Aircraft polar;
+    for (const Aircraft &aircraft : {yp, polar})
+    {
+        TrimCondition cond = {aircraft.hasAeroTable() ? 22.0 : 40.0, 120.0};
+        TrimResult trim = solveTrim(aircraft, cond);
+        REQUIRE(trim.trimmed());
+        REQUIRE(trim.residual < 1e-8);
+        REQUIRE(trim.iterations < 15);
+        REQUIRE(trim.throttle > 0.0);
+        REQUIRE(trim.throttle < 1.0);
+        REQUIRE(trim.pitch_deg == trim.alpha_deg); // Level: pitch equals alpha
+
+        for (IntegrationMethod method : {IntegrationMethod::Legacy, IntegrationMethod::RK4})
+        {
+            SimulationState s;
+            s.aircraft = aircraft;
+            s.reset();
+            s.dt = 0.01;
+            s.integration_method = method;
+            applyTrim(s, cond, trim);
+            for (int i = 0; i < 3000; i++)
+                updatePhysics(s);
+
+            // Throttle and pitch are stored as float, so the balance is only float-exact
+            REQUIRE(std::abs(s.position.y - cond.altitude) < 0.05);
+            REQUIRE(std::abs(s.velocity.magnitude() - cond.speed) < 0.01);
+            REQUIRE(std::abs(s.pitch_deg - trim.pitch_deg) < 1e-4);
+        }
+    }
+}
+
+TEST_CASE("TrimSolver - climbing trim and the limits of the envelope")
+{
+    Aircraft aircraft;
+
+    // A climb needs more thrust at a lower angle of attack, pitched up by gamma
+    TrimResult level = solveTrim(aircraft, {40.0, 500.0});
+    TrimResult climb = solveTrim(aircraft, {40.0, 500.0, 5.0});
+    REQUIRE(level.trimmed());
+    REQUIRE(climb.trimmed());
+    REQUIRE(climb.throttle > level.throttle);
+    REQUIRE(climb.alpha_deg < level.alpha_deg);
+    REQUIRE(climb.pitch_deg == Catch::Approx(climb.alpha_deg + 5.0));
+
+    // Too fast for the engine, too slow for the wing
+    REQUIRE(solveTrim(aircraft, {150.0, 0.0}).status == TrimStatus::ThrustLimited);
+    TrimStatus slow = solveTrim(aircraft, {8.0, 0.0}).status;
+    REQUIRE((slow == TrimStatus::AlphaLimited || slow == TrimStatus::Failed));
+
+    // An engaged speed autopilot takes over at the trim throttle
+    SimulationState s;
+    s.aircraft = aircraft;
+    s.reset();
+    s.dt = 0.01;
+    s.autopilot_speed = true;
+    s.speed_setpoint = 40.0f;
+    applyTrim(s, {40.0, 500.0}, level);
+    REQUIRE(s.speed_pid.getState().i_term == Catch::Approx(s.throttle));
+    for (int i = 0; i < 1000; i++)
+        updatePhysics(s);
+    REQUIRE(std::abs(s.velocity.magnitude() - 40.0) < 0.05);
+    REQUIRE(std::abs(s.throttle - level.throttle) < 1e-3);
+}
+
+TEST_CASE("TrajectorySet - batch lanes and recordings become runs")
+{
+    SimulationState base = checkpointTestState(IntegrationMethod::Legacy);
+    SimulationBatch batch(8);
+    batch.dt = base.dt;
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        SimulationState lane = base;
+        lane.aircraft.mass = base.aircraft.mass + 5.0 * static_cast<double>(i);
+        batch.setLane(i, lane);
+    }
+    SimulationBatch reference = batch;
+
+    TrajectorySet set;
+    flyBatchTrajectories(batch, 2.0, 0.1, set);
+    REQUIRE(set.size() == 8);
+    REQUIRE(set.metricCount() == 4);
+    reference.run(static_cast<long long>(std::ceil(2.0 / base.dt)));
+    for (size_t r = 0; r < set.size(); r++)
+    {
+        size_t n = set.pointCount(r);
+        REQUIRE(n == static_cast<size_t>(std::ceil(2.0 / base.dt)) / static_cast<size_t>(std::llround(0.1 / base.dt)) + 1);
+        REQUIRE(set.x(r)[n - 1] == static_cast<float>(reference.x[r]));
+        REQUIRE(set.metric(r, 0) == static_cast<float>(reference.y[r]));
+        REQUIRE(set.metric(r, 3) == static_cast<float>(reference.mass[r]));
+        const TrajectorySet::Bounds &b = set.bounds(r);
+        for (size_t i = 0; i < n; i++)
+            REQUIRE((set.z(r)[i] >= b.z0 && set.z(r)[i] <= b.z1));
+    }
+    float lo, hi;
+    set.metricRange(3, lo, hi);
+    REQUIRE(lo == static_cast<float>(base.aircraft.mass));
+    REQUIRE(hi == static_cast<float>(base.aircraft.mass + 35.0));
+
+    // A recording is thinned but keeps its last sample
+    std::string path = (std::filesystem::temp_directory_path() / "trajectory_set_test.fdrec").string();
+    SimulationState s = base;
+    {
+        RecordingWriter writer(path, s.aircraft.configHash(), s.dt);
+        for (int i = 0; i < 1000; i++)
+        {
+            updatePhysics(s);
+            writer.write(RecordedSample::fromState(s));
+        }
+        writer.close();
+    }
+    TrajectorySet recordings;
+    recordings.setMetricNames({"Final altitude", "Duration"});
+    recordings.addRecording(RecordingReader(path), 100);
+    REQUIRE(recordings.size() == 1);
+    REQUIRE(recordings.pointCount(0) <= 101);
+    REQUIRE(recordings.z(0)[recordings.pointCount(0) - 1] == static_cast<float>(s.position.y));
+    REQUIRE(recordings.metric(0, 0) == static_cast<float>(s.position.y));
+    std::filesystem::remove(path);
+
+    // Bounds cover the finite points only; a run with none has empty bounds
+    TrajectorySet diverged;
+    const float nan = std::numeric_limits<float>::quiet_NaN(), inf = std::numeric_limits<float>::infinity();
+    const float xs[4] = {0.0f, nan, 30.0f, inf}, zs[4] = {5.0f, 1.0f, -2.0f, 0.0f};
+    diverged.addRun(xs, zs, 4, nullptr);
+    diverged.addRun(xs + 1, zs + 1, 1, nullptr);
+    REQUIRE(diverged.bounds(0).x0 == 0.0f);
+    REQUIRE(diverged.bounds(0).x1 == 30.0f);
+    REQUIRE(diverged.bounds(0).z0 == -2.0f);
+    REQUIRE(diverged.bounds(0).z1 == 5.0f);
+    REQUIRE(diverged.bounds(1).x0 > diverged.bounds(1).x1);
+}
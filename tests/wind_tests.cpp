@@ -0,0 +1,288 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "environment/wind.hpp"
+#include <cmath>
+#include <stdexcept>
+
+const double tol = 1e-9;
+
+static WindConditions turbulentConditions(TurbulenceModel model, uint64_t seed)
+{
+    WindConditions c;
+    c.turbulence = model;
+    c.turbulence_w20 = 15.0;
+    c.seed = seed;
+    return c;
+}
+
+// Mean and variance of one tile component
+static void tileMoments(const TurbulenceTiles &tiles, bool vertical, double &mean, double &variance)
+{
+    mean = variance = 0.0;
+    for (size_t i = 0; i < TurbulenceTiles::SIZE; i++)
+        mean += vertical ? tiles.w(i) : tiles.u(i);
+    mean /= TurbulenceTiles::SIZE;
+    for (size_t i = 0; i < TurbulenceTiles::SIZE; i++)
+    {
+        double d = (vertical ? tiles.w(i) : tiles.u(i)) - mean;
+        variance += d * d;
+    }
+    variance /= TurbulenceTiles::SIZE;
+}
+
+// Circular autocorrelation of a unit-variance tile at a lag in samples
+static double autocorrelation(const TurbulenceTiles &tiles, bool vertical, size_t lag)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < TurbulenceTiles::SIZE; i++)
+    {
+        size_t j = (i + lag) % TurbulenceTiles::SIZE;
+        sum += vertical ? tiles.w(i) * tiles.w(j) : tiles.u(i) * tiles.u(j);
+    }
+    return sum / TurbulenceTiles::SIZE;
+}
+
+TEST_CASE("Wind - calm conditions blow nothing")
+{
+    WindConditions c;
+    REQUIRE(c.calm());
+    c.turbulence = TurbulenceModel::Dryden; // No intensity
+    REQUIRE(c.calm());
+    c.gusts.push_back(WindGust{});           // No amplitude
+    REQUIRE(c.calm());
+
+    WindField field(c);
+    REQUIRE_FALSE(field.turbulent());
+    WindSample s = field.sample(120.0, 10.0, TurbulencePhase{});
+    REQUIRE(s.x == 0.0);
+    REQUIRE(s.y == 0.0);
+    REQUIRE(s.rate_u == 0.0);
+    REQUIRE(s.rate_w == 0.0);
+}
+
+TEST_CASE("Wind - power law shear with altitude")
+{
+    WindConditions c;
+    c.speed = -8.0;
+    c.reference_altitude = 10.0;
+    c.shear_exponent = 1.0 / 7.0;
+    REQUIRE_FALSE(c.calm());
+    WindField field(c);
+
+    REQUIRE(std::abs(field.sample(10.0, 0.0, TurbulencePhase{}).x + 8.0) < tol);
+    REQUIRE(field.sample(0.0, 0.0, TurbulencePhase{}).x == 0.0);
+    // Profile rows are exact; between them the error of the interpolation is small
+    REQUIRE(std::abs(field.sample(200.0, 0.0, TurbulencePhase{}).x + 8.0 * std::pow(20.0, 1.0 / 7.0)) < tol);
+    REQUIRE(std::abs(field.sample(52.5, 0.0, TurbulencePhase{}).x + 8.0 * std::pow(5.25, 1.0 / 7.0)) < 1e-2);
+    // Constant above the profile, and at the ground below it
+    double top = field.sample(WindField::PROFILE_TOP, 0.0, TurbulencePhase{}).x;
+    REQUIRE(field.sample(5000.0, 0.0, TurbulencePhase{}).x == top);
+    REQUIRE(field.sample(-3.0, 0.0, TurbulencePhase{}).x == 0.0);
+    REQUIRE(field.sample(NAN, 0.0, TurbulencePhase{}).x == 0.0);
+
+    c.shear_exponent = 0.0; // Uniform wind
+    WindField uniform(c);
+    REQUIRE(std::abs(uniform.sample(0.0, 0.0, TurbulencePhase{}).x + 8.0) < tol);
+    REQUIRE(std::abs(uniform.sample(700.0, 0.0, TurbulencePhase{}).x + 8.0) < tol);
+}
+
+TEST_CASE("Wind - 1-cosine gust")
+{
+    WindConditions c;
+    c.gusts.push_back(WindGust{5.0, 2.0, 4.0, -3.0});
+    WindField field(c);
+
+    auto at = [&](double t) { return field.sample(100.0, t, TurbulencePhase{}); };
+    REQUIRE(at(4.9).x == 0.0);
+    REQUIRE(at(5.0).x == 0.0);
+    REQUIRE(std::abs(at(6.0).x - 4.0) < tol);
+    REQUIRE(std::abs(at(6.0).y + 3.0) < tol);
+    REQUIRE(std::abs(at(5.5).x - 2.0) < tol);
+    REQUIRE(std::abs(at(6.5).y + 1.5) < tol);
+    REQUIRE(at(7.0).x == 0.0);
+    REQUIRE(at(9.0).y == 0.0);
+
+    // Overlapping gusts add up
+    c.gusts.push_back(WindGust{6.0, 2.0, 1.0, 0.0});
+    WindField both(c);
+    REQUIRE(std::abs(both.sample(100.0, 6.5, TurbulencePhase{}).x - (2.0 + 0.5)) < tol);
+}
+
+TEST_CASE("Wind - invalid conditions are rejected")
+{
+    WindConditions c;
+    c.reference_altitude = 0.0;
+    REQUIRE_THROWS_AS(WindField(c), std::runtime_error);
+    c = WindConditions{};
+    c.shear_exponent = -0.1;
+    REQUIRE_THROWS_AS(WindField(c), std::runtime_error);
+    c = WindConditions{};
+    c.turbulence_w20 = NAN;
+    REQUIRE_THROWS_AS(WindField(c), std::runtime_error);
+    c = WindConditions{};
+    c.gusts.push_back(WindGust{1.0, 0.0, 5.0, 0.0});
+    REQUIRE_THROWS_AS(WindField(c), std::runtime_error);
+    REQUIRE_THROWS_AS(TurbulenceTiles(TurbulenceModel::None, 1), std::runtime_error);
+}
+
+TEST_CASE("TurbulenceTiles - zero mean unit variance and periodic")
+{
+    for (TurbulenceModel model : {TurbulenceModel::Dryden, TurbulenceModel::VonKarman})
+    {
+        TurbulenceTiles tiles(model, 42);
+        for (bool vertical : {false, true})
+        {
+            double mean, variance;
+            tileMoments(tiles, vertical, mean, variance);
+            REQUIRE(std::abs(mean) < 1e-6);
+            REQUIRE(std::abs(variance - 1.0) < 1e-5);
+        }
+        // The sample after the last one is the first again
+        REQUIRE(tiles.u(TurbulenceTiles::SIZE - 0.5) ==
+                Catch::Approx(0.5 * (tiles.u(TurbulenceTiles::SIZE - 1) + tiles.u(0))));
+        REQUIRE(tiles.w(0.25) == Catch::Approx(0.75 * tiles.w(0) + 0.25 * tiles.w(1)));
+    }
+}
+
+TEST_CASE("TurbulenceTiles - deterministic per seed and shared")
+{
+    TurbulenceTiles a(TurbulenceModel::Dryden, 7), b(TurbulenceModel::Dryden, 7), c(TurbulenceModel::Dryden, 8);
+    bool same = true, differs = false;
+    for (size_t i = 0; i < TurbulenceTiles::SIZE; i++)
+    {
+        same = same && a.u(i) == b.u(i) && a.w(i) == b.w(i);
+        differs = differs || a.u(i) != c.u(i);
+    }
+    REQUIRE(same);
+    REQUIRE(differs);
+
+    // The u and w components are independent streams
+    double cross = 0.0;
+    for (size_t i = 0; i < TurbulenceTiles::SIZE; i++)
+        cross += a.u(i) * a.w(i);
+    REQUIRE(std::abs(cross / TurbulenceTiles::SIZE) < 0.2);
+
+    auto shared = TurbulenceTiles::get(TurbulenceModel::Dryden, 7);
+    REQUIRE(TurbulenceTiles::get(TurbulenceModel::Dryden, 7) == shared);
+    REQUIRE(TurbulenceTiles::get(TurbulenceModel::VonKarman, 7) != shared);
+    REQUIRE(shared->u(100.0) == a.u(100.0));
+
+    // Fields of the same conditions share one set of tiles
+    WindField f1(turbulentConditions(TurbulenceModel::Dryden, 7));
+    WindField f2(turbulentConditions(TurbulenceModel::Dryden, 7));
+    TurbulencePhase p{123.4, 567.8};
+    REQUIRE(f1.sample(50.0, 0.0, p).x == f2.sample(50.0, 0.0, p).x);
+    REQUIRE(f1.withSeed(8)->sample(50.0, 0.0, p).x != f1.sample(50.0, 0.0, p).x);
+    REQUIRE(f1.withSeed(8)->conditions().seed == 8);
+}
+
+TEST_CASE("TurbulenceTiles - Dryden correlation at one scale length")
+{
+    // Exponential u correlation e^-1; w correlation (1 - x/2) e^-x = 0.18 at x = 1
+    const size_t lag = static_cast<size_t>(1.0 / TurbulenceTiles::SPACING);
+    double u = 0.0, w = 0.0;
+    const int seeds = 16;
+    for (int seed = 1; seed <= seeds; seed++)
+    {
+        TurbulenceTiles tiles(TurbulenceModel::Dryden, seed);
+        u += autocorrelation(tiles, false, lag) / seeds;
+        w += autocorrelation(tiles, true, lag) / seeds;
+    }
+    REQUIRE(std::abs(u - std::exp(-1.0)) < 0.08);
+    REQUIRE(std::abs(w - 0.5 * std::exp(-1.0)) < 0.08);
+}
+
+TEST_CASE("Wind - MIL-F-8785C intensities and scale lengths")
+{
+    WindField field(turbulentConditions(TurbulenceModel::Dryden, 3));
+    REQUIRE(field.turbulent());
+
+    // Above 2000 ft: sigma = 0.1 W20, L = 1750 ft for both components
+    double sum_u = 0.0, sum_w = 0.0;
+    const double L = 1750.0 * 0.3048;
+    TurbulencePhase p;
+    WindSample s{};
+    for (size_t i = 0; i < TurbulenceTiles::SIZE; i++)
+    {
+        p.u = p.w = static_cast<double>(i);
+        s = field.sample(800.0, 0.0, p);
+        sum_u += s.x * s.x;
+        sum_w += s.y * s.y;
+    }
+    REQUIRE(std::abs(std::sqrt(sum_u / TurbulenceTiles::SIZE) - 1.5) < 1e-4);
+    REQUIRE(std::abs(std::sqrt(sum_w / TurbulenceTiles::SIZE) - 1.5) < 1e-4);
+    REQUIRE(std::abs(s.rate_u - 1.0 / (L * TurbulenceTiles::SPACING)) < 1e-9);
+    REQUIRE(std::abs(s.rate_w - s.rate_u) < 1e-12);
+
+    // Low altitude: horizontal turbulence is stronger and longer than vertical
+    WindSample low = field.sample(50.0, 0.0, TurbulencePhase{});
+    REQUIRE(low.rate_u < low.rate_w);
+
+    // Von Karman uses its own high altitude scale lengths
+    WindField karman(turbulentConditions(TurbulenceModel::VonKarman, 3));
+    WindSample k = karman.sample(800.0, 0.0, TurbulencePhase{});
+    REQUIRE(std::abs(k.rate_u - 1.0 / (2500.0 * 0.3048 * TurbulenceTiles::SPACING)) < 1e-9);
+    REQUIRE(std::abs(k.rate_w - 1.0 / (1250.0 * 0.3048 * TurbulenceTiles::SPACING)) < 1e-9);
+}
+
+TEST_CASE("Wind - batched sample matches single samples")
+{
+    WindField shear([] { WindConditions c; c.speed = 6.0; return c; }());
+    WindField rough(turbulentConditions(TurbulenceModel::VonKarman, 11));
+    const WindField *fields[] = {&shear, nullptr, &rough, &rough};
+    const double altitude[] = {30.0, 100.0, 12.5, 640.0};
+    const double phase_u[] = {0.0, 0.0, 17.3, 2048.9};
+    const double phase_w[] = {0.0, 0.0, 401.2, 3.5};
+    double x[4], y[4], ru[4], rw[4];
+    WindField::sample(fields, 4, altitude, 2.0, phase_u, phase_w, x, y, ru, rw);
+
+    REQUIRE(x[1] == 0.0);
+    REQUIRE(y[1] == 0.0);
+    for (size_t k : {0, 2, 3})
+    {
+        WindSample s = fields[k]->sample(altitude[k], 2.0, TurbulencePhase{phase_u[k], phase_w[k]});
+        REQUIRE(x[k] == s.x);
+        REQUIRE(y[k] == s.y);
+        REQUIRE(ru[k] == s.rate_u);
+        REQUIRE(rw[k] == s.rate_w);
+    }
+}
+
+TEST_CASE("Wind - phase advance wraps around the tile")
+{
+    const double size = TurbulenceTiles::SIZE;
+    REQUIRE(WindField::wrapPhase(10.5) == 10.5);
+    REQUIRE(WindField::wrapPhase(size + 1.25) == 1.25);
+    REQUIRE(WindField::wrapPhase(-0.5) == size - 0.5);
+    REQUIRE(WindField::wrapPhase(3.0 * size + 2.0) == 2.0);
+    REQUIRE(WindField::wrapPhase(NAN) == 0.0);
+    REQUIRE(WindField::wrapPhase(INFINITY) == 0.0);
+    REQUIRE(WindField::wrapPhase(-1e-20) < size);
+
+    TurbulencePhase p{size - 1.0, 0.0};
+    WindField::advance(p, WindSample{0.0, 0.0, 0.5, 0.25}, 8.0);
+    REQUIRE(p.u == 3.0);
+    REQUIRE(p.w == 2.0);
+}
+
+TEST_CASE("Wind - names intensities and per-run seeds")
+{
+    REQUIRE(std::abs(turbulenceIntensity("light") - 7.71666) < 1e-3);
+    REQUIRE(std::abs(turbulenceIntensity("moderate") - 15.4333) < 1e-3);
+    REQUIRE(std::abs(turbulenceIntensity("severe") - 23.15) < 1e-3);
+    REQUIRE(turbulenceIntensity("gale") < 0.0);
+
+    for (TurbulenceModel m : {TurbulenceModel::None, TurbulenceModel::Dryden, TurbulenceModel::VonKarman})
+    {
+        TurbulenceModel parsed = TurbulenceModel::None;
+        REQUIRE(parseTurbulenceModel(turbulenceModelName(m), parsed));
+        REQUIRE(parsed == m);
+    }
+    TurbulenceModel unchanged = TurbulenceModel::Dryden;
+    REQUIRE_FALSE(parseTurbulenceModel("karman", unchanged));
+    REQUIRE(unchanged == TurbulenceModel::Dryden);
+
+    REQUIRE(turbulenceSeed(5, 0) == turbulenceSeed(5, 0));
+    REQUIRE(turbulenceSeed(5, 0) != turbulenceSeed(5, 1));
+    REQUIRE(turbulenceSeed(5, 1) != turbulenceSeed(6, 1));
+}